@@ -33,11 +33,11 @@
 class CBaseDrawable
 {
 public:
-	CBaseDrawable(){return;}
+	CBaseDrawable(){parent = NULL; entity = -1;}
 	CBaseDrawable( CBaseObject* pParent ){Set(pParent);}
 	virtual ~CBaseDrawable(){return;}
 
-	void Set ( CBaseObject* pParent ){parent = pParent;}
+	void Set ( CBaseObject* pParent ){parent = pParent; entity = pParent ? pParent->GetEntity() : -1;}
 
 	virtual void Init ( void ) = 0;
 	virtual void Think ( void ) = 0;
@@ -47,6 +47,7 @@ public:
 	const char* GetName ( void ){return className.c_str();}
 protected:
 	CBaseObject			*parent;
+	int							entity;		// parent's component store slot, -1 to go thru the parent
 	std::string			className;
 };
 
@@ -78,9 +79,13 @@ public:
 protected:
 	typedef std::map<std::string,CBaseDrawableFactory*> factoryMap;
 	factoryMap	factories;
-	typedef std::map<int,CBaseDrawable*> drawableMap;
-	drawableMap	drawables;
-	int							lastID;
+
+	// drawables are packed so ThinkAll is a straight walk, the IDs handed out
+	// map to a slot and get reused once they are deleted
+	std::vector<CBaseDrawable*>	drawables;
+	std::vector<int>						drawableIDs;	// ID of the drawable in each slot
+	std::vector<int>						slots;				// slot for each ID, -1 if it's free
+	std::vector<int>						freeIDs;
 };
 
 #endif //_DRAW_MANAGER_H_
@@ -27,7 +27,6 @@ CDrawManager* Singleton<CDrawManager>::_instance = (CDrawManager*)0;
 
 CDrawManager::CDrawManager()
 {
-	lastID = -1;
 }
 
 CDrawManager::~CDrawManager()
@@ -61,49 +60,70 @@ int CDrawManager::New ( const char* name, CBaseObject* parent )
 	if (!object)
 		return -1;
 
-	lastID++;
+	int id;
+	if (freeIDs.size())
+	{
+		id = freeIDs.back();
+		freeIDs.pop_back();
+	}
+	else
+	{
+		id = (int)slots.size();
+		slots.push_back(-1);
+	}
 
 	object->SetName(name);
 	object->Init();
-	drawables[lastID] = object;
 
-	return lastID;
+	slots[id] = (int)drawables.size();
+	drawables.push_back(object);
+	drawableIDs.push_back(id);
+
+	return id;
 }
 
 bool CDrawManager::Delete ( int item )
 {
-	drawableMap::iterator itr = drawables.find(item);
-
-	if (itr == drawables.end())
+	if (item < 0 || item >= (int)slots.size() || slots[item] == -1)
 		return false;
 
-	factories[itr->second->GetName()]->Delete(itr->second);
-	drawables.erase(itr);
+	int slot = slots[item];
+	CBaseDrawable *object = drawables[slot];
+
+	// fill the hole with the last one so the list stays packed
+	int last = (int)drawables.size()-1;
+	if (slot != last)
+	{
+		drawables[slot] = drawables[last];
+		drawableIDs[slot] = drawableIDs[last];
+		slots[drawableIDs[slot]] = slot;
+	}
+	drawables.pop_back();
+	drawableIDs.pop_back();
+
+	slots[item] = -1;
+	freeIDs.push_back(item);
+
+	factories[object->GetName()]->Delete(object);
 
 	return true;
 }
 
 void CDrawManager::ClearAll ( void )
 {
-	drawableMap::iterator itr = drawables.begin();
+	for (unsigned int i = 0; i < drawables.size(); i++)
+		factories[drawables[i]->GetName()]->Delete(drawables[i]);
 
-	while (itr != drawables.end())
-	{
-		factories[itr->second->GetName()]->Delete(itr->second);
-		itr++;
-	}
 	drawables.clear();
+	drawableIDs.clear();
+	slots.clear();
+	freeIDs.clear();
 	factories.clear();
 }
 
 void CDrawManager::ThinkAll ( void )
 {
-	drawableMap::iterator itr = drawables.begin();
-
-	while (itr != drawables.end())
-	{
-		itr->second->Think();
-		itr++;
-	}
+	for (unsigned int i = 0; i < drawables.size(); i++)
+		drawables[i]->Think();
 }
 
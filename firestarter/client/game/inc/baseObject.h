@@ -27,7 +27,7 @@
 class CBaseObject
 {
 public:
-		CBaseObject(){return;}
+		CBaseObject(){entity = -1;}
 		virtual ~CBaseObject(){return;}
 
 		// basic
@@ -43,7 +43,11 @@ public:
 		virtual const char* GetValueS ( const char *item ){return 0;}
 
 		virtual	bool Visible ( void ) { return true; }
+
+		// slot in the component store, -1 if the object keeps it's own transforms
+		int GetEntity ( void ) { return entity; }
 protected:
+		int entity;
 };
 
 #endif //_BASE_OBJECT_H_
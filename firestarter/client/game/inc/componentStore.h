@@ -0,0 +1,84 @@
+/* Firestarter
+* componentStore.h :
+*
+* Copyright (C) 2004 Jeffrey Myers
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+* email: jeffm2501@sbcglobal.net
+*/
+
+#ifndef _COMPONENT_STORE_H_
+#define _COMPONENT_STORE_H_
+
+#include <vector>
+#include "Singleton.h"
+
+class CBaseObject;
+
+// entity flags
+#define _COMPONENT_ALIVE		0x01
+#define _COMPONENT_MOVING		0x02		// Integrate moves it along it's vec
+#define _COMPONENT_GROUNDED	0x04		// Integrate won't let it go below 0
+
+#define _COMPONENT_INITAL_SIZE	256
+
+// the transforms for every game object live here, one slot per entity ID,
+// so the things that touch all of them each frame can just walk the arrays
+class CComponentStore : public Singleton<CComponentStore>
+{
+public:
+	CComponentStore();
+	~CComponentStore();
+
+	int New ( CBaseObject* owner, unsigned char flags = 0 );
+	void Delete ( int entity );
+	void ClearAll ( void );
+
+	// the pointers are good till the next New, so don't hang on to them
+	float* GetPos ( int entity ) { return &pos[entity*3]; }
+	float* GetRot ( int entity ) { return &rot[entity*3]; }
+	float* GetScale ( int entity ) { return &scale[entity*3]; }
+	float* GetVec ( int entity ) { return &vec[entity*3]; }
+
+	unsigned char GetFlags ( int entity ) { return flags[entity]; }
+	void SetFlags ( int entity, unsigned char value ) { flags[entity] = value | _COMPONENT_ALIVE; }
+	CBaseObject* GetOwner ( int entity ) { return owners[entity]; }
+
+	// one past the highest entity ID in use
+	int GetCount ( void ) { return (int)flags.size(); }
+
+	// move everything that is flaged as moving
+	void Integrate ( float frameTime );
+
+	// slow path for scripts and anything else that only knows the names
+	// "posX" "rotZ" "scaleY" "vecX" and so on
+	bool GetValueF ( int entity, const char *item, float &value );
+	bool SetValueF ( int entity, const char *item, float value );
+
+protected:
+	float* findValue ( int entity, const char *item );
+
+	std::vector<float>				pos;
+	std::vector<float>				rot;
+	std::vector<float>				scale;
+	std::vector<float>				vec;
+	std::vector<unsigned char>	flags;
+	std::vector<CBaseObject*>	owners;
+
+	std::vector<int>					freeEntities;
+};
+
+#endif //_COMPONENT_STORE_H_
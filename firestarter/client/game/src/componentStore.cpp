@@ -0,0 +1,174 @@
+/* Firestarter
+* componentStore.cpp :
+*
+* Copyright (C) 2004 Jeffrey Myers
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+* email: jeffm2501@sbcglobal.net
+*/
+
+#include "componentStore.h"
+#include <string.h>
+
+template <>
+CComponentStore* Singleton<CComponentStore>::_instance = (CComponentStore*)0;
+
+CComponentStore::CComponentStore()
+{
+	pos.reserve(_COMPONENT_INITAL_SIZE*3);
+	rot.reserve(_COMPONENT_INITAL_SIZE*3);
+	scale.reserve(_COMPONENT_INITAL_SIZE*3);
+	vec.reserve(_COMPONENT_INITAL_SIZE*3);
+	flags.reserve(_COMPONENT_INITAL_SIZE);
+	owners.reserve(_COMPONENT_INITAL_SIZE);
+}
+
+CComponentStore::~CComponentStore()
+{
+	ClearAll();
+}
+
+int CComponentStore::New ( CBaseObject* owner, unsigned char entityFlags )
+{
+	int entity;
+
+	if (freeEntities.size())
+	{
+		entity = freeEntities.back();
+		freeEntities.pop_back();
+	}
+	else
+	{
+		entity = (int)flags.size();
+		pos.resize(pos.size()+3);
+		rot.resize(rot.size()+3);
+		scale.resize(scale.size()+3);
+		vec.resize(vec.size()+3);
+		flags.push_back(0);
+		owners.push_back(NULL);
+	}
+
+	float *p = &pos[entity*3];
+	float *r = &rot[entity*3];
+	float *s = &scale[entity*3];
+	float *v = &vec[entity*3];
+
+	p[0] = p[1] = p[2] = 0;
+	r[0] = r[1] = r[2] = 0;
+	s[0] = s[1] = s[2] = 1;
+	v[0] = v[1] = v[2] = 0;
+
+	flags[entity] = entityFlags | _COMPONENT_ALIVE;
+	owners[entity] = owner;
+
+	return entity;
+}
+
+void CComponentStore::Delete ( int entity )
+{
+	if (entity < 0 || entity >= (int)flags.size() || !(flags[entity] & _COMPONENT_ALIVE))
+		return;
+
+	flags[entity] = 0;
+	owners[entity] = NULL;
+	freeEntities.push_back(entity);
+}
+
+void CComponentStore::ClearAll ( void )
+{
+	pos.clear();
+	rot.clear();
+	scale.clear();
+	vec.clear();
+	flags.clear();
+	owners.clear();
+	freeEntities.clear();
+}
+
+void CComponentStore::Integrate ( float frameTime )
+{
+	int count = (int)flags.size();
+	if (!count)
+		return;
+
+	float *p = &pos[0];
+	float *v = &vec[0];
+	const unsigned char *f = &flags[0];
+
+	for (int i = 0; i < count; i++, p += 3, v += 3)
+	{
+		if (!(f[i] & _COMPONENT_MOVING))
+			continue;
+
+		p[0] += v[0]*frameTime;
+		p[1] += v[1]*frameTime;
+		p[2] += v[2]*frameTime;
+
+		if ((f[i] & _COMPONENT_GROUNDED) && p[2] < 0)
+			p[2] = 0;
+	}
+}
+
+float* CComponentStore::findValue ( int entity, const char *item )
+{
+	if (!item || entity < 0 || entity >= (int)flags.size() || !(flags[entity] & _COMPONENT_ALIVE))
+		return NULL;
+
+	float	*base = NULL;
+	size_t	len = strlen(item);
+
+	if (len == 4 && strncmp(item,"pos",3) == 0)
+		base = &pos[entity*3];
+	else if (len == 4 && strncmp(item,"rot",3) == 0)
+		base = &rot[entity*3];
+	else if (len == 4 && strncmp(item,"vec",3) == 0)
+		base = &vec[entity*3];
+	else if (len == 6 && strncmp(item,"scale",5) == 0)
+		base = &scale[entity*3];
+	else
+		return NULL;
+
+	switch(item[len-1])
+	{
+		case 'X':
+			return base;
+		case 'Y':
+			return base+1;
+		case 'Z':
+			return base+2;
+	}
+	return NULL;
+}
+
+bool CComponentStore::GetValueF ( int entity, const char *item, float &value )
+{
+	float *p = findValue(entity,item);
+	if (!p)
+		return false;
+
+	value = *p;
+	return true;
+}
+
+bool CComponentStore::SetValueF ( int entity, const char *item, float value )
+{
+	float *p = findValue(entity,item);
+	if (!p)
+		return false;
+
+	*p = value;
+	return true;
+}
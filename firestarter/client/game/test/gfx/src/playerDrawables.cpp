@@ -13,6 +13,22 @@
 
 #include "playerDrawables.h"
 #include "firestarter.h"
+#include "componentStore.h"
+
+// read the parent's transform straight out of the store when it has an entity
+static void getTransform ( CBaseObject *parent, int entity, float *pos, float *rot )
+{
+	if (entity != -1)
+	{
+		CComponentStore	&store = CComponentStore::instance();
+		memcpy(pos,store.GetPos(entity),sizeof(float)*3);
+		memcpy(rot,store.GetRot(entity),sizeof(float)*3);
+		return;
+	}
+
+	parent->GetPos(pos);
+	parent->GetRot(rot);
+}
 
 // player factory
 CBaseDrawable* CPlayerObjectFactory::New ( CBaseObject* parent )
@@ -120,12 +136,9 @@ void CPlayerDrawObject::Think ( void )
 
 	if (vis)
 	{
-		float rot[3];
-		parent->GetRot(rot);
+		float pos[3], rot[3];
+		getTransform(parent,entity,pos,rot);
 		rot[2] += 90.0f;
-
-		float pos[3];
-		parent->GetPos(pos);
 		pos[2] += 1.5f;
 
 		node->rotate(Vector3(0,0,1),rot[2]-lastRot);
@@ -192,13 +205,10 @@ void CShotDrawObject::Init ( void )
 
 void CShotDrawObject::Think ( void )
 {
-	float rot[3];
-	parent->GetRot(rot);
+	float pos[3], rot[3];
+	getTransform(parent,entity,pos,rot);
 	rot[2] += 90.0f;
 
-	float pos[3];
-	parent->GetPos(pos);
-
 	node->rotate(Vector3(0,0,1),rot[2]-lastRot);
 	node->setPosition(pos[0],pos[1],pos[2]); 
 	lastRot = rot[2];
@@ -18,6 +18,18 @@
 #include <vector>
 #include <vector>
 #include "baseObject.h"
+#include "componentStore.h"
+
+// server snapshots kept per player for interpolation
+#define _MAX_PLAYER_SNAPSHOTS	32
+#define _MAX_EXTRAPOLATION		0.25f
+
+typedef struct
+{
+	float	stamp;
+	float	pos[3];
+	float	rot[3];
+}trPlayerSnapshot;
 
 class CPlayerObject : public CBaseObject
 {
@@ -45,12 +57,22 @@ public:
 	bool GetMaterial (  const char * item, char *szMaterial );
 	bool Visible ( void ) { return forceHidden ?  false :active; }
 
+	// snapshots are kept in stamp order, late ones are slotted in where they belong
+	void AddSnapshot ( float stamp, float *pPos, float *pRot );
+	void ClearSnapshots ( void );
+
+	// put the player where the snapshots say it was at the synced time,
+	// returns false if there are no snapshots to go on
+	bool Interpolate ( float time );
+
+	// the transforms live in the component store, these are only good till the next entity is made
+	float* Pos ( void ) { return CComponentStore::instance().GetPos(entity); }
+	float* Rot ( void ) { return CComponentStore::instance().GetRot(entity); }
+	float* Vec ( void ) { return CComponentStore::instance().GetVec(entity); }
+
 	int					idNumber;
 	bool				active;
 	std::string name;
-	float				pos[3];
-	float				rot[3];
-	float				vec[3];	
 	std::string	material;
 	std::string mesh;
 
@@ -60,6 +82,8 @@ public:
 	float				lastShotTime;
 protected:
 	int					drawable;
+
+	std::vector<trPlayerSnapshot>	snapshots;
 };
 
 typedef std::map<int, CPlayerObject*> tmPlayerMap;
@@ -85,9 +109,9 @@ public:
 	bool GetPos ( float *pPos );
 	bool GetRot ( float *pRot );
 
-	float				pos[3];
-	float				rot[3];
-	float				vec[3];	
+	float* Pos ( void ) { return CComponentStore::instance().GetPos(entity); }
+	float* Rot ( void ) { return CComponentStore::instance().GetRot(entity); }
+	float* Vec ( void ) { return CComponentStore::instance().GetVec(entity); }
 
 	std::string mesh;
 
@@ -75,12 +75,26 @@ class CTestGame : public CBaseGame , CNetworkMessageProcessor, CBaseObject
 		float								lastSyncPingTime;
 		float								syncPingInterval;
 
+		// how often the network counters are printed, 0 for never
+		float								netStatsInterval;
+		float								lastNetStatsTime;
+
+		// jitter buffer, other players are drawn this far behind the synced clock
+		float								snapshotDelay;
+		float								snapshotTargetDelay;
+		float								snapshotLateness;
+		float								snapshotJitter;
+		float								snapshotInterval;
+		float								lastSnapshotStamp;
+		int									lastSnapshotTick;
+
 		int									camera;
 		// game info
 		trGameParams				gameParams;
 
 		// game methods
 		bool processPlayerInput ( void );
+		void updateSnapshotDelay ( float stamp, int tick );
 };
 
 #endif //_TEST_GAME_H_
\ No newline at end of file
@@ -21,9 +21,7 @@ CPlayerObject::CPlayerObject()
 	drawable = -1;
 	idNumber = -1;
 	active = false;
-	pos[0] = pos[1] = pos[2] = 0;
-	rot[0] = rot[1] = rot[2] = 0;
-	vec[0] = vec[1] = vec[2] = 0;
+	entity = CComponentStore::instance().New(this,_COMPONENT_GROUNDED);
 	material = "default";
 	forceHidden = false;
 	dontUpdate = false;
@@ -34,6 +32,7 @@ CPlayerObject::~CPlayerObject()
 {
 	Kill();
 	active = false;
+	CComponentStore::instance().Delete(entity);
 }
 
 void CPlayerObject::Init ( bool draw )
@@ -59,6 +58,8 @@ bool CPlayerObject::Think ( void )
 	if (!dontUpdate)
 	{
 		float frameTime = CSyncedClock::instance().GetFrameTime();
+		float *pos = Pos();
+		float *vec = Vec();
 		pos[0] += vec[0]*frameTime;
 		pos[1] += vec[1]*frameTime;
 		pos[2] += vec[2]*frameTime;
@@ -77,6 +78,87 @@ void CPlayerObject::Kill ( void )
 	drawable = -1;
 }
 
+void CPlayerObject::AddSnapshot ( float stamp, float *pPos, float *pRot )
+{
+	trPlayerSnapshot	snapshot;
+	snapshot.stamp = stamp;
+	memcpy(snapshot.pos,pPos,sizeof(float)*3);
+	memcpy(snapshot.rot,pRot,sizeof(float)*3);
+
+	std::vector<trPlayerSnapshot>::iterator itr = snapshots.end();
+	while (itr != snapshots.begin() && (itr-1)->stamp > stamp)
+		itr--;
+
+	// we already have this one
+	if (itr != snapshots.begin() && (itr-1)->stamp == stamp)
+		return;
+
+	snapshots.insert(itr,snapshot);
+
+	if (snapshots.size() > _MAX_PLAYER_SNAPSHOTS)
+		snapshots.erase(snapshots.begin());
+}
+
+void CPlayerObject::ClearSnapshots ( void )
+{
+	snapshots.clear();
+}
+
+static float lerpAngle ( float from, float to, float t )
+{
+	float delta = to - from;
+	while (delta > 180.0f)
+		delta -= 360.0f;
+	while (delta < -180.0f)
+		delta += 360.0f;
+
+	return from + delta*t;
+}
+
+bool CPlayerObject::Interpolate ( float time )
+{
+	if (!snapshots.size())
+		return false;
+
+	// toss the ones we are past, but keep one at or before the time to lerp from
+	while (snapshots.size() > 2 && snapshots[1].stamp <= time)
+		snapshots.erase(snapshots.begin());
+
+	float *pos = Pos();
+	float *rot = Rot();
+	float *vec = Vec();
+
+	trPlayerSnapshot	&from = snapshots[0];
+	if (snapshots.size() == 1 || time <= from.stamp)
+	{
+		memcpy(pos,from.pos,sizeof(float)*3);
+		memcpy(rot,from.rot,sizeof(float)*3);
+		vec[0] = vec[1] = vec[2] = 0;
+		return true;
+	}
+
+	trPlayerSnapshot	&to = snapshots[1];
+	float span = to.stamp - from.stamp;
+
+	// if the buffer ran dry keep going the way we were headed, but not for long
+	if (time > to.stamp + _MAX_EXTRAPOLATION)
+		time = to.stamp + _MAX_EXTRAPOLATION;
+
+	float t = (time - from.stamp)/span;
+
+	for (int i = 0; i < 3; i++)
+	{
+		vec[i] = (to.pos[i] - from.pos[i])/span;
+		pos[i] = from.pos[i] + (to.pos[i] - from.pos[i])*t;
+		rot[i] = lerpAngle(from.rot[i],to.rot[i],t);
+	}
+
+	if (pos[2] < 0)
+		pos[2] = 0;
+
+	return true;
+}
+
 const char* CPlayerObject::GetValueS ( const char *item )
 {
 	std::string label = item;
@@ -97,7 +179,9 @@ const char* CPlayerObject::GetValueS ( const char *item )
 
 float CPlayerObject::GetValueF ( const char *item )
 {
-	return 0;
+	float value = 0;
+	CComponentStore::instance().GetValueF(entity,item,value);
+	return value;
 }
 
 int CPlayerObject::GetValueI ( const char *item )
@@ -110,7 +194,7 @@ bool CPlayerObject::GetPos ( float *pPos )
 	if (!pPos)
 		return false;
 
-	memcpy(pPos,pos,sizeof(float)*3);
+	memcpy(pPos,Pos(),sizeof(float)*3);
 	return true;
 }
 
@@ -119,7 +203,7 @@ bool CPlayerObject::GetRot ( float *pRot )
 	if (!pRot)
 		return false;
 
-	memcpy(pRot,rot,sizeof(float)*3);
+	memcpy(pRot,Rot(),sizeof(float)*3);
 	return true;
 }
 
@@ -155,17 +239,9 @@ bool CPlayerObject::GetMaterial (  const char * item, char *szMaterial )
 // shots
 CShotObject::CShotObject()
 {
-	pos[0] = 0;
-	pos[1] = 0;
-	pos[2] = -10000.0f;
-
-	rot[0] = 0;
-	rot[1] = 0;
-	rot[2] = 0;
-
-	vec[0] = 0;
-	vec[1] = 0;
-	vec[2] = 0;
+	// shots just fly, the store moves them all in one go
+	entity = CComponentStore::instance().New(this,_COMPONENT_MOVING);
+	Pos()[2] = -10000.0f;
 
 	mesh = "shot.mesh";
 	drawable = -1;
@@ -177,6 +253,7 @@ CShotObject::CShotObject()
 CShotObject::~CShotObject()
 {
 	Kill();
+	CComponentStore::instance().Delete(entity);
 }
 
 void CShotObject::Init ( bool draw )
@@ -188,12 +265,7 @@ void CShotObject::Init ( bool draw )
 
 bool CShotObject::Think ( void )
 {
-	// do some dead rec
-	float frameTime = CSyncedClock::instance().GetFrameTime();
-	pos[0] += vec[0]*frameTime;
-	pos[1] += vec[1]*frameTime;
-	pos[2] += vec[2]*frameTime;
-
+	// the dead rec is done by CComponentStore::Integrate
 	if ( CSyncedClock::instance().GetTime() - lanchTime >= timeToLive)
 		return false;
 
@@ -216,6 +288,10 @@ void CShotObject::Shoot ( int player, float *pPos, float* pRot, float speed, int
 
 	float timeOffset = thisTime - lanchTime;
 
+	float *pos = Pos();
+	float *rot = Rot();
+	float *vec = Vec();
+
 	float deg2rad = 0.017453292519943295769236907684886f;
 	float h = cos((rot[2]+90)*deg2rad);
 	float v = sin((rot[2]+90)*deg2rad);
@@ -255,7 +331,9 @@ const char* CShotObject::GetValueS ( const char *item )
 
 float CShotObject::GetValueF ( const char *item )
 {
-	return 0;
+	float value = 0;
+	CComponentStore::instance().GetValueF(entity,item,value);
+	return value;
 }
 
 int CShotObject::GetValueI ( const char *item )
@@ -268,7 +346,7 @@ bool CShotObject::GetPos ( float *pPos )
 	if (!pPos)
 		return false;
 
-	memcpy(pPos,pos,sizeof(float)*3);
+	memcpy(pPos,Pos(),sizeof(float)*3);
 	return true;
 
 }
@@ -278,7 +356,7 @@ bool CShotObject::GetRot ( float *pRot )
 	if (!pRot)
 		return false;
 
-	memcpy(pRot,rot,sizeof(float)*3);
+	memcpy(pRot,Rot(),sizeof(float)*3);
 	return true;
 
 }
@@ -20,6 +20,7 @@
 #include "worldDrawables.h"
 #include "playerDrawables.h"
 #include "messages.h"
+#include "messageSchema.h"
 
 void CTestGame::registerFactory (const char* name, CBaseDrawableFactory* factory)
 {
@@ -52,6 +53,10 @@ void CTestGame::Init ( void )
 
 	lastSyncPingTime = -1;
 	syncPingInterval = CPrefsManager::instance().GetItemF("syncUpdateTime");
+
+	netStatsInterval = 60;
+	if (CPrefsManager::instance().ItemExists("NetworkStatsTime"))
+		netStatsInterval = CPrefsManager::instance().GetItemF("NetworkStatsTime");
 }
 
 void CTestGame::Kill ( void )
@@ -69,10 +74,22 @@ void CTestGame::Attach ( void )
 
 	players.clear();
 	localPlayer = NULL;
+
+	snapshotDelay = 0.1f;
+	snapshotTargetDelay = 0.1f;
+	snapshotLateness = 0;
+	snapshotJitter = 0;
+	snapshotInterval = 0.05f;
+	lastSnapshotStamp = 0;
+	lastSnapshotTick = -1;
+
 	// get the connection info
 
 	// log into that sucker
 	network.SetMesageHandaler(this);
+	network.SetThreaded(prefs.GetItemI("NetworkThread") != 0);
+	network.ResetStats();
+	lastNetStatsTime = (float)CTimer::instance().GetTime();
 
 	std::string url = loop.GetGameStartString();
 	
@@ -142,9 +159,27 @@ bool CTestGame::Think ( void )
 	if (network.Connected())
 		network.ProcessMessages();
 
-	// check for a clock sync
+	// print how long messages waited on us
+	if (netStatsInterval > 0 && CTimer::instance().GetTime() - lastNetStatsTime > netStatsInterval)
+	{
+		const trNetStats &stats = network.GetStats();
+
+		double averageDelay = 0;
+		if (stats.messagesIn)
+			averageDelay = stats.totalReceiveDelay/stats.messagesIn;
+
+		printf("network: %u messages in, %u out, receive delay %.1fms average %ums max\n",stats.messagesIn,stats.messagesOut,averageDelay,stats.maxReceiveDelay);
+		network.ResetStats();
+		lastNetStatsTime = (float)CTimer::instance().GetTime();
+	}
+
+	// check for a clock sync, ping fast till the clock has a full set of samples
+
+	float pingInterval = syncPingInterval;
+	if (CSyncedClock::instance().GetSyncSamples() < _SYNC_CLOCK_SAMPLES)
+		pingInterval = 0.25f;
 
-	if (CTimer::instance().GetTime() - lastSyncPingTime > syncPingInterval )
+	if (CTimer::instance().GetTime() - lastSyncPingTime > pingInterval )
 	{
 		lastSyncPingTime = CTimer::instance().GetTime();
 		CNetworkMessage message;
@@ -170,7 +205,9 @@ bool CTestGame::Think ( void )
 	
 	if (!exit)
 	{
-		// move the shots
+		// move everything that just flys, then toss the shots that are done
+		CComponentStore::instance().Integrate(CSyncedClock::instance().GetFrameTime());
+
 		tvShotList::iterator shotItr = shots.begin();
 		while (shotItr != shots.end())
 		{
@@ -184,13 +221,26 @@ bool CTestGame::Think ( void )
 				shotItr++;
 		}
 
-		// process the player DR
+		// ease the delay over to the target so the other players don't hitch when it changes
+		float delayError = snapshotTargetDelay - snapshotDelay;
+		float maxDelayStep = CSyncedClock::instance().GetFrameTime() * 0.1f;
+		if (delayError > maxDelayStep)
+			delayError = maxDelayStep;
+		else if (delayError < -maxDelayStep)
+			delayError = -maxDelayStep;
+		snapshotDelay += delayError;
+
+		// place the other players from the snapshots, DR the ones we have none for
+		float renderTime = CSyncedClock::instance().GetTime() - snapshotDelay;
 		tmPlayerMap::iterator itr = players.begin();
 
 		while (itr != players.end())
 		{
 			if (itr->second && itr->second->active)
-				itr->second->Think();
+			{
+				if (itr->second == localPlayer || !itr->second->Interpolate(renderTime))
+					itr->second->Think();
+			}
 			itr++;
 		}
 
@@ -200,16 +250,18 @@ bool CTestGame::Think ( void )
 		// if we haven't done an update in a while then send
 			float updateTime = 1.0f/10.0f;
 
-			bool still = false; //localPlayer->vec[0] == 0 && localPlayer->vec[1] == 0 && localPlayer->vec[2] ==0;
+			bool still = false; //localPlayer->Vec()[0] == 0 && localPlayer->Vec()[1] == 0 && localPlayer->Vec()[2] ==0;
 
 			if (!still && CTimer::instance().GetTime() - lastNetUpdateTime > updateTime)
 			{
+				trClientUpdateMessage	update;
+				memcpy(update.pos,localPlayer->Pos(),sizeof(float)*3);
+				memcpy(update.rot,localPlayer->Rot(),sizeof(float)*3);
+				memcpy(update.vec,localPlayer->Vec(),sizeof(float)*3);
+				update.stamp = (float)CSyncedClock::instance().GetTime();
+
 				CNetworkMessage message;
-				message.SetType(_MESSAGE_UPDATE);
-				message.AddV(localPlayer->pos);
-				message.AddV(localPlayer->rot);
-				message.AddV(localPlayer->vec);
-				message.AddF(CSyncedClock::instance().GetTime());
+				PackMessage(message,update);
 
 				message.Send(network.GetServerPeer(),false);
 				lastNetUpdateTime = CTimer::instance().GetTime();
@@ -321,11 +373,12 @@ void CTestGame::OnMessage ( CNetworkPeer &peer, CNetworkMessage &message )
 				newPlayer->name = message.ReadStr();
 				newPlayer->material = message.ReadStr();
 				newPlayer->mesh = message.ReadStr();
+				newPlayer->ClearSnapshots();
 
 				// get there current pos
-				message.ReadV(newPlayer->pos);
-				message.ReadV(newPlayer->rot);
-				message.ReadV(newPlayer->vec);
+				message.ReadV(newPlayer->Pos());
+				message.ReadV(newPlayer->Rot());
+				message.ReadV(newPlayer->Vec());
 
 				// give them a model
 				newPlayer->Init(true);
@@ -341,9 +394,10 @@ void CTestGame::OnMessage ( CNetworkPeer &peer, CNetworkMessage &message )
 
 				if (newPlayer && !newPlayer->active)
 				{
-					message.ReadV(newPlayer->pos);
-					message.ReadV(newPlayer->rot);
-					message.ReadV(newPlayer->vec);
+					message.ReadV(newPlayer->Pos());
+					message.ReadV(newPlayer->Rot());
+					message.ReadV(newPlayer->Vec());
+					newPlayer->ClearSnapshots();
 					newPlayer->active = true;
 					newPlayer->Init(true);
 				}
@@ -352,18 +406,46 @@ void CTestGame::OnMessage ( CNetworkPeer &peer, CNetworkMessage &message )
 
 		case _MESSAGE_UPDATE:// yes we even accept updates to oursleves
 			{	
-				int playerID = message.ReadI();
+				trPlayerUpdateMessage	update;
+				if (!UnpackMessage(message,update))
+					break;
+
 				CPlayerObject	*newPlayer = localPlayer;
-				if (playerID != localPlayer->idNumber)
-					newPlayer = players[playerID];
+				if (update.playerID != localPlayer->idNumber)
+					newPlayer = players[update.playerID];
 
 			//	newPlayer->updateTime = CSyncedClock::instance().GetTime();
 
 				if (newPlayer->active)
 				{
-					message.ReadV(newPlayer->pos);
-					message.ReadV(newPlayer->rot);
-					message.ReadV(newPlayer->vec);
+					memcpy(newPlayer->Pos(),update.pos,sizeof(float)*3);
+					memcpy(newPlayer->Rot(),update.rot,sizeof(float)*3);
+					memcpy(newPlayer->Vec(),update.vec,sizeof(float)*3);
+				}
+			}
+			break;
+
+		case _MESSAGE_SNAPSHOT: // the state of everyone as of a server tick
+			{
+				trSnapshotMessage	snapshot;
+				if (!UnpackMessage(message,snapshot))
+					break;
+
+				updateSnapshotDelay(snapshot.stamp,snapshot.tick);
+
+				trSnapshotPlayer	player;
+				for (int i = 0; i < snapshot.count; i++)
+				{
+					if (!UnpackMessage(message,player))
+						break;
+
+					// we drive ourselves
+					if (localPlayer && player.playerID == localPlayer->idNumber)
+						continue;
+
+					tmPlayerMap::iterator itr = players.find(player.playerID);
+					if (itr != players.end() && itr->second && itr->second->active)
+						itr->second->AddSnapshot(snapshot.stamp,player.pos,player.rot);
 				}
 			}
 			break;
@@ -378,13 +460,58 @@ void CTestGame::OnMessage ( CNetworkPeer &peer, CNetworkMessage &message )
 	}
 }
 
+void CTestGame::updateSnapshotDelay ( float stamp, int tick )
+{
+	// how long after the tick it got here, by the synced clock
+	float lateness = CSyncedClock::instance().GetTime() - stamp;
+
+	if (lastSnapshotTick < 0)
+	{
+		snapshotLateness = lateness;
+		snapshotJitter = 0;
+	}
+	else
+	{
+		float error = lateness - snapshotLateness;
+
+		// the clock itself jumped, start over
+		if (fabs(error) > _SYNC_CLOCK_SNAP)
+		{
+			snapshotLateness = lateness;
+			snapshotJitter = 0;
+		}
+		else
+		{
+			snapshotLateness += error * 0.1f;
+			snapshotJitter += ((float)fabs(error) - snapshotJitter) * 0.1f;
+		}
+	}
+
+	if (tick > lastSnapshotTick)
+	{
+		if (lastSnapshotTick >= 0)
+			snapshotInterval = (stamp - lastSnapshotStamp)/(float)(tick - lastSnapshotTick);
+
+		lastSnapshotTick = tick;
+		lastSnapshotStamp = stamp;
+	}
+
+	// stay far enough back that the next snapshot has almost always arrived
+	snapshotTargetDelay = snapshotLateness + snapshotInterval + snapshotJitter * 2.0f;
+
+	if (snapshotTargetDelay < snapshotInterval)
+		snapshotTargetDelay = snapshotInterval;
+	else if (snapshotTargetDelay > 1.0f)
+		snapshotTargetDelay = 1.0f;
+}
+
 bool CTestGame::GetPos ( float *pos )
 {
 	if (!localPlayer)
 		return false;
 
 	float camPos[3];
-	memcpy(camPos,localPlayer->pos,sizeof(float)*3);
+	memcpy(camPos,localPlayer->Pos(),sizeof(float)*3);
 
 	float camHeight = 1.5f;
 
@@ -399,7 +526,7 @@ bool CTestGame::GetRot ( float *rot )
 	if (!localPlayer)
 		return false;
 
-	memcpy(rot,localPlayer->rot,sizeof(float)*3);
+	memcpy(rot,localPlayer->Rot(),sizeof(float)*3);
 	return true;
 }
 
@@ -416,20 +543,20 @@ bool CTestGame::processPlayerInput ( void )
 	// compute a new rotation
 	if (input.KeyDown(KEY_LEFT))
 	{
-		localPlayer->rot[2] += gameParams.rotspeed*frameTime;
+		localPlayer->Rot()[2] += gameParams.rotspeed*frameTime;
 	}
 	else if (input.KeyDown(KEY_RIGHT))
 	{
-		localPlayer->rot[2] -= gameParams.rotspeed*frameTime;
+		localPlayer->Rot()[2] -= gameParams.rotspeed*frameTime;
 	}
 
 	float h,v;
 	float deg2rad = 0.017453292519943295769236907684886f;
 
-	h = cos((localPlayer->rot[2]+90)*deg2rad);
-	v = sin((localPlayer->rot[2]+90)*deg2rad);
+	h = cos((localPlayer->Rot()[2]+90)*deg2rad);
+	v = sin((localPlayer->Rot()[2]+90)*deg2rad);
 
-	bool bCanMove = (localPlayer->pos[2] < 0.01);
+	bool bCanMove = (localPlayer->Pos()[2] < 0.01);
 	bool moved = false;
 
 	// compute new thrust vector
@@ -437,22 +564,22 @@ bool CTestGame::processPlayerInput ( void )
 	{
 		if (input.KeyDown(KEY_UP))
 		{
-			localPlayer->vec[0] = gameParams.linspeed*h;
-			localPlayer->vec[1] = gameParams.linspeed*v;
+			localPlayer->Vec()[0] = gameParams.linspeed*h;
+			localPlayer->Vec()[1] = gameParams.linspeed*v;
 			moved = true;
 		}
 		else if (input.KeyDown(KEY_DOWN))
 		{
-			localPlayer->vec[0] = gameParams.linspeed*h*gameParams.reversemod;
-			localPlayer->vec[1] = gameParams.linspeed*v*gameParams.reversemod;
+			localPlayer->Vec()[0] = gameParams.linspeed*h*gameParams.reversemod;
+			localPlayer->Vec()[1] = gameParams.linspeed*v*gameParams.reversemod;
 			moved = true;
 		}
 	}
 	
 	if (!moved)
 	{
-		localPlayer->vec[0] -= localPlayer->vec[0]*gameParams.friction*frameTime;
-		localPlayer->vec[1] -= localPlayer->vec[1]*gameParams.friction*frameTime;
+		localPlayer->Vec()[0] -= localPlayer->Vec()[0]*gameParams.friction*frameTime;
+		localPlayer->Vec()[1] -= localPlayer->Vec()[1]*gameParams.friction*frameTime;
 	}
 
 	if (input.KeyDown(KEY_SPACE))
@@ -463,19 +590,19 @@ bool CTestGame::processPlayerInput ( void )
 			CShotObject *newShot = new CShotObject;
 			
 			float pos[3];
-			memcpy(pos,localPlayer->pos,sizeof(float)*3);
+			memcpy(pos,localPlayer->Pos(),sizeof(float)*3);
 			pos[2] += 1.5f;
 			int type = 0;
 
-			newShot->Shoot(localPlayer->idNumber,pos,localPlayer->rot,gameParams.shotSpeed,type,timer.GetTime());
+			newShot->Shoot(localPlayer->idNumber,pos,localPlayer->Rot(),gameParams.shotSpeed,type,timer.GetTime());
 			shots.push_back(newShot);
 
 			// send a message saying we shot
 		/*	CNetworkMessage	message;
 			message.SetType(_MESSAGE_CREATE_SHOT);
 			message.AddI(type);
-			message.AddV(localPlayer->pos);
-			message.AddV(localPlayer->rot);
+			message.AddV(localPlayer->Pos());
+			message.AddV(localPlayer->Rot());
 			message.AddF(gameParams.shotSpeed);
 			message.AddF(timer.GetTime()); */
 		}
@@ -483,70 +610,70 @@ bool CTestGame::processPlayerInput ( void )
 
 	if (input.KeyDown(KEY_END))
 	{
-		localPlayer->vec[0] = 0;
-		localPlayer->vec[1] = 0;
+		localPlayer->Vec()[0] = 0;
+		localPlayer->Vec()[1] = 0;
 	}
 
 	// this is actual physics stuff
-	if (localPlayer->vec[0]*localPlayer->vec[0] + localPlayer->vec[1]*localPlayer->vec[1] < gameParams.stoptol*gameParams.stoptol)
-		localPlayer->vec[0] = localPlayer->vec[1] = 0;
+	if (localPlayer->Vec()[0]*localPlayer->Vec()[0] + localPlayer->Vec()[1]*localPlayer->Vec()[1] < gameParams.stoptol*gameParams.stoptol)
+		localPlayer->Vec()[0] = localPlayer->Vec()[1] = 0;
 
 	// apply gravity if above 0;
 
-	if (localPlayer->pos[2] > 0)
+	if (localPlayer->Pos()[2] > 0)
 	{
-		if ( localPlayer->pos[2] >= 0.1f)
-			localPlayer->vec[2] = gameParams.grav;
+		if ( localPlayer->Pos()[2] >= 0.1f)
+			localPlayer->Vec()[2] = gameParams.grav;
 	}
 	else
-		localPlayer->vec[2] = 0;
+		localPlayer->Vec()[2] = 0;
 
 	// run the vector
 //	float frameTime = CSyncedClock::instance().GetFrameTime();
-	localPlayer->pos[0] += localPlayer->vec[0]*frameTime;
-	localPlayer->pos[1] += localPlayer->vec[1]*frameTime;
-	localPlayer->pos[2] += localPlayer->vec[2]*frameTime;
+	localPlayer->Pos()[0] += localPlayer->Vec()[0]*frameTime;
+	localPlayer->Pos()[1] += localPlayer->Vec()[1]*frameTime;
+	localPlayer->Pos()[2] += localPlayer->Vec()[2]*frameTime;
 
-	if (localPlayer->pos[2] < 0)
-		localPlayer->pos[2] = 0;
+	if (localPlayer->Pos()[2] < 0)
+		localPlayer->Pos()[2] = 0;
 
 	bool smack = false;
 
-	if ( localPlayer->pos[0] > world.GetXSize()*0.5f-gameParams.tankRad )
+	if ( localPlayer->Pos()[0] > world.GetXSize()*0.5f-gameParams.tankRad )
 	{
-		localPlayer->vec[0] *= gameParams.bounceFriction;
-		localPlayer->vec[1] *= (float)fabs(gameParams.bounceFriction);
-		localPlayer->pos[0] = world.GetXSize()*0.5f-gameParams.tankRad-gameParams.bonceBuffer;
+		localPlayer->Vec()[0] *= gameParams.bounceFriction;
+		localPlayer->Vec()[1] *= (float)fabs(gameParams.bounceFriction);
+		localPlayer->Pos()[0] = world.GetXSize()*0.5f-gameParams.tankRad-gameParams.bonceBuffer;
 		smack = true;
 	}
-	else if ( localPlayer->pos[0] < world.GetXSize()*-0.5f+gameParams.tankRad )
+	else if ( localPlayer->Pos()[0] < world.GetXSize()*-0.5f+gameParams.tankRad )
 	{
-		localPlayer->vec[0] *= gameParams.bounceFriction;
-		localPlayer->vec[1] *= (float)fabs(gameParams.bounceFriction);;
-		localPlayer->pos[0] = world.GetXSize()*-0.5f+gameParams.tankRad+gameParams.bonceBuffer;
+		localPlayer->Vec()[0] *= gameParams.bounceFriction;
+		localPlayer->Vec()[1] *= (float)fabs(gameParams.bounceFriction);;
+		localPlayer->Pos()[0] = world.GetXSize()*-0.5f+gameParams.tankRad+gameParams.bonceBuffer;
 		smack = true;
 	}
 	
-	if ( localPlayer->pos[1] > world.GetYSize()*0.5f-gameParams.tankRad )
+	if ( localPlayer->Pos()[1] > world.GetYSize()*0.5f-gameParams.tankRad )
 	{
-		localPlayer->vec[0] *= (float)fabs(gameParams.bounceFriction);;
-		localPlayer->vec[1] *= gameParams.bounceFriction;
-		localPlayer->pos[1] = world.GetYSize()*0.5f-gameParams.tankRad-gameParams.bonceBuffer;
+		localPlayer->Vec()[0] *= (float)fabs(gameParams.bounceFriction);;
+		localPlayer->Vec()[1] *= gameParams.bounceFriction;
+		localPlayer->Pos()[1] = world.GetYSize()*0.5f-gameParams.tankRad-gameParams.bonceBuffer;
 		smack = true;
 	}
-	else if ( localPlayer->pos[1] < world.GetYSize()*-0.5f+gameParams.tankRad )
+	else if ( localPlayer->Pos()[1] < world.GetYSize()*-0.5f+gameParams.tankRad )
 	{
-		localPlayer->vec[0] *= (float)fabs(gameParams.bounceFriction);;
-		localPlayer->vec[1] *= gameParams.bounceFriction;
-		localPlayer->pos[1] = world.GetYSize()*-0.5f+gameParams.tankRad+gameParams.bonceBuffer;
+		localPlayer->Vec()[0] *= (float)fabs(gameParams.bounceFriction);;
+		localPlayer->Vec()[1] *= gameParams.bounceFriction;
+		localPlayer->Pos()[1] = world.GetYSize()*-0.5f+gameParams.tankRad+gameParams.bonceBuffer;
 		smack = true;
 	}
 
 	if (smack)
 	{
 		// do some sora effect here
-	//	localPlayer->vec[0] = 0;
-	//	localPlayer->vec[1] = 0;
+	//	localPlayer->Vec()[0] = 0;
+	//	localPlayer->Vec()[1] = 0;
 	}
 
 	return false;
@@ -52,7 +52,7 @@ void CFirestarterLoop::verifyDefaults ( void )
 		prefs.SetItem("PlayerMesh","mk3.mesh");
 
 	if (!prefs.ItemExists("syncUpdateTime"))
-		prefs.SetItem("syncUpdateTime",60.0f);
+		prefs.SetItem("syncUpdateTime",10.0f);
 
 	prefs.Update();
 }
@@ -74,6 +74,7 @@ bool CFirestarterLoop::OnInit ( void )
 	game.Init();
 
 	// contact the list server and see if we can get some lists
+	// the list fills in from GameLoop as it comes down
 	listServer.get();
 
 	if (inUI)
@@ -128,6 +129,9 @@ const char* CFirestarterLoop:: GetWindowName ( void )
 
 bool CFirestarterLoop::GameLoop ( void )
 {
+	// pick up any servers the list server has sent us
+	listServer.process();
+
 	// check for sreenshot
 	CGameManger &game = CGameManger::instance();
 	float togleTime = 0.5f;
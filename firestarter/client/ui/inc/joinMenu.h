@@ -39,11 +39,14 @@ public:
 	virtual tePanelReturn Process ( std::string &next );
 
 protected:
+	void fillServerList ( void );
+
 	SceneNode		*ships[4];
 	Overlay*		mainMenu;
 	SceneNode		*mGroundNode;
 
 	int					currentItem;
+	int					listedServers;
 };
 
 #endif //_JOIN_MENU_H_
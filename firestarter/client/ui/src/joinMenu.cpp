@@ -42,74 +42,46 @@ void CJoinMenu::Init ( void  )
 	ships[0] = ships[1] = ships[2] = ships[3] = NULL;
 
 	currentItem = 0;
+	listedServers = 0;
 }
 
-void CJoinMenu::Attach ( void )
+void CJoinMenu::fillServerList ( void )
 {
 	CFirestarterLoop &gameLoop = CFirestarterLoop::instance();
 
-	mainMenu = (Overlay*)OverlayManager::getSingleton().getByName("menu/joinMenu");
-	mainMenu->show();
-
 	GuiContainer* container = mainMenu->getChild("join/menuPanel");
-// fill in the servers
 	char temp[512];
 
-	GuiElement* selction = container->getChild("join/server1");
-	if (gameLoop.getListServer().count() >0 && selction)
-	{
-		trServerInfo	&info = gameLoop.getListServer().info(0);
-		sprintf(temp,"%s:%d - %s - %s  %d/%d",info.address.c_str(),info.port,info.name.c_str(),info.game.c_str(),info.currentPlayers,info.maxPlayers);
-		Ogre::String	caption(temp);
-		selction->setCaption(caption);
-	}
-	else if (selction)
-		selction->setCaption("-");
-
-	selction = container->getChild("join/server2");
-	if (gameLoop.getListServer().count() >1 && selction)
-	{
-		trServerInfo	&info = gameLoop.getListServer().info(1);
-		sprintf(temp,"%s:%d - %s - %s  %d/%d",info.address.c_str(),info.port,info.name.c_str(),info.game.c_str(),info.currentPlayers,info.maxPlayers);
-		Ogre::String	caption(temp);
-		selction->setCaption(caption);
-	}
-	else if (selction)
-		selction->setCaption("-");
+	listedServers = gameLoop.getListServer().count();
 
-	selction = container->getChild("join/server3");
-	if (gameLoop.getListServer().count() >2 && selction)
+	for (int i = 0; i < 5; i++)
 	{
-		trServerInfo	&info = gameLoop.getListServer().info(2);
-		sprintf(temp,"%s:%d - %s - %s  %d/%d",info.address.c_str(),info.port,info.name.c_str(),info.game.c_str(),info.currentPlayers,info.maxPlayers);
-		Ogre::String	caption(temp);
-		selction->setCaption(caption);
+		sprintf(temp,"join/server%d",i+1);
+		GuiElement* selction = container->getChild(temp);
+		if (!selction)
+			continue;
+
+		if (listedServers > i)
+		{
+			trServerInfo	&info = gameLoop.getListServer().info(i);
+			sprintf(temp,"%s:%d - %s - %s  %d/%d",info.address.c_str(),info.port,info.name.c_str(),info.game.c_str(),info.currentPlayers,info.maxPlayers);
+			Ogre::String	caption(temp);
+			selction->setCaption(caption);
+		}
+		else
+			selction->setCaption("-");
 	}
-	else if (selction)
-		selction->setCaption("-");
+}
 
-	selction = container->getChild("join/server4");
-	if (gameLoop.getListServer().count() >3 && selction)
-	{
-		trServerInfo	&info = gameLoop.getListServer().info(3);
-		sprintf(temp,"%s:%d - %s - %s  %d/%d",info.address.c_str(),info.port,info.name.c_str(),info.game.c_str(),info.currentPlayers,info.maxPlayers);
-		Ogre::String	caption(temp);
-		selction->setCaption(caption);
-	}
-	else if (selction)
-		selction->setCaption("-");
+void CJoinMenu::Attach ( void )
+{
+	CFirestarterLoop &gameLoop = CFirestarterLoop::instance();
 
-	selction = container->getChild("join/server5");
-	if (gameLoop.getListServer().count() >4 && selction)
-	{
-		trServerInfo	&info = gameLoop.getListServer().info(4);
-		sprintf(temp,"%s:%d - %s - %s  %d/%d",info.address.c_str(),info.port,info.name.c_str(),info.game.c_str(),info.currentPlayers,info.maxPlayers);
-		Ogre::String	caption(temp);
-		selction->setCaption(caption);
-	}
-	else if (selction)
-		selction->setCaption("-");
+	mainMenu = (Overlay*)OverlayManager::getSingleton().getByName("menu/joinMenu");
+	mainMenu->show();
 
+	// fill in the servers
+	fillServerList();
 
 	gameLoop.GetCamera()->moveRelative(Vector3(0,1.5f,0));
 
@@ -194,7 +166,11 @@ tePanelReturn CJoinMenu::Process ( std::string &next )
 		ships[2]->rotate(Vector3(0,0,1),rotSpeed);
 		ships[3]->rotate(Vector3(0,0,1),-rotSpeed);
 	}
-	if (CInputManager::instance().KeyDown(KEY_RETURN))
+	// the list server may still be sending us servers
+	if (listedServers != gameLoop.getListServer().count())
+		fillServerList();
+
+	if (CInputManager::instance().KeyDown(KEY_RETURN) && gameLoop.getListServer().count() > 0)
 	{
 		// put somethign not lame here]
 		trServerInfo	&info = gameLoop.getListServer().info(currentItem);
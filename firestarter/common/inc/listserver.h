@@ -39,11 +39,61 @@ typedef struct
 	int						token;
 }trServerInfo;
 
+typedef enum
+{
+	eListServerNone,
+	eListServerAdd,
+	eListServerUpdate,
+	eListServerRemove,
+	eListServerGet
+}teListServerRequest;
+
+// completion callback, always called from the thread that calls process()
+class CListServerCallback
+{
+public:
+	virtual ~CListServerCallback(){return;}
+	virtual void listServerRequestDone ( teListServerRequest request, bool success ) = 0;
+};
+
+// all transfers run on one shared web thread using a curl multi handle
+// each connection keeps its own curl handle between requests so the
+// HTTP connection to the list server is reused
 class CBaseWebConnectClass
 {
 public:
-	virtual ~CBaseWebConnectClass(){return;}
+	CBaseWebConnectClass();
+	virtual ~CBaseWebConnectClass();
 	virtual size_t writeMemoryCallback(void *ptr, size_t inSize, size_t nmemb, void *data){return 0;}
+
+	void setCallback ( CListServerCallback *cb ) { callback = cb; }
+
+	// true from the time a request is started until process() has finished it
+	bool busy ( void ) { return pending != eListServerNone; }
+
+	// finish any completed request and call the callback, call once per frame
+	virtual void process ( void );
+
+	// block until the current request is processed or timeout seconds have passed
+	// returns the result of the request
+	bool wait ( float timeout );
+
+	// called by the web thread with the lock held
+	void transferDone ( int result );
+	void* getHandle ( void ) { return handle; }
+
+protected:
+	bool startRequest ( teListServerRequest request, const char *page );
+	virtual bool requestDone ( teListServerRequest request, bool transferOK ) = 0;
+
+	void			*handle;
+	std::string		url;
+	CListServerCallback	*callback;
+
+	teListServerRequest	pending;
+	bool			transferComplete;
+	int				transferResult;
+	bool			lastResult;
 };
 
 class CListServerServerConnection : public CBaseWebConnectClass
@@ -52,6 +102,8 @@ public:
 	CListServerServerConnection();
 	virtual ~CListServerServerConnection();
 
+	// these return as soon as the request is queued, info must stay valid until
+	// the request is processed, its token is set when the add completes
 	bool add ( trServerInfo &info );
 	bool update ( trServerInfo &info );
 	bool remove ( trServerInfo &info );
@@ -59,9 +111,13 @@ public:
 	virtual size_t writeMemoryCallback(void *ptr, size_t inSize, size_t nmemb, void *data);
 
 protected:
+	virtual bool requestDone ( teListServerRequest request, bool transferOK );
+
 	void clearPageData ( void );
 	char			*memory;
 	size_t		size;
+
+	trServerInfo	*target;
 };
 
 
@@ -71,18 +127,42 @@ public:
 	CListServerClientConnection();
 	virtual ~CListServerClientConnection();
 
+	// servers show up in the list as they are read during process()
 	bool get ( void );
 	int count ( void );
 	trServerInfo& info ( int item );
 
+	virtual void process ( void );
 	virtual size_t writeMemoryCallback(void *ptr, size_t inSize, size_t nmemb, void *data);
 
 protected:
+	virtual bool requestDone ( teListServerRequest request, bool transferOK );
+
 	void clearPageData ( void );
 
-	bool readNextItem( std::string &item, char** data );
-	char			*memory;
-	size_t		size;
+	// incremental list parser, runs on the web thread
+	void parseListData ( const char *data, size_t len );
+	void parseListItem ( void );
+
+	typedef enum
+	{
+		eParseHeader,
+		eParseItemStart,
+		eParseField,
+		eParseItemEnd,
+		eParseDone
+	}teListParseState;
+
+	teListParseState	parseState;
+	std::string		header;
+	std::string		field;
+	int				fieldIndex;
+	int				expectedItems;
+	int				parsedItems;
+	trServerInfo	parseItem;
+
+	// items parsed by the web thread but not yet moved into the server list
+	std::vector<trServerInfo> incoming;
 
 	std::vector<trServerInfo> serverList;
 };
@@ -36,5 +36,57 @@
 #define _MESSAGE_TIME_PING	 0x5054			//TP
 #define _MESSAGE_WORLD_INFO	 0x4957			//WI
 #define _MESSAGE_CREATE_SHOT	 0x5343			//CS
+#define _MESSAGE_SNAPSHOT	 0x4e53			//SN
+
+// fixed layout messages, packed with PackMessage/UnpackMessage from messageSchema.h
+
+// _MESSAGE_UPDATE from a client about its own player
+struct trClientUpdateMessage
+{
+	enum {messageType = _MESSAGE_UPDATE};
+
+	float	pos[3];
+	float	rot[3];
+	float	vec[3];
+	float	stamp;
+
+	template <class S> void Schema ( S &s ) {s.Field(pos); s.Field(rot); s.Field(vec); s.Field(stamp);}
+};
+
+// _MESSAGE_UPDATE from the server about any player
+struct trPlayerUpdateMessage
+{
+	enum {messageType = _MESSAGE_UPDATE};
+
+	int		playerID;
+	float	pos[3];
+	float	rot[3];
+	float	vec[3];
+	float	stamp;
+
+	template <class S> void Schema ( S &s ) {s.Field(playerID); s.Field(pos); s.Field(rot); s.Field(vec); s.Field(stamp);}
+};
+
+// _MESSAGE_SNAPSHOT, sent by the server every tick with the state of every spawned player.
+// the header is followed by count trSnapshotPlayer records added with AppendMessage
+struct trSnapshotMessage
+{
+	enum {messageType = _MESSAGE_SNAPSHOT};
+
+	float			stamp;			// server time of the tick
+	int				tick;
+	unsigned short	count;
+
+	template <class S> void Schema ( S &s ) {s.Field(stamp); s.Field(tick); s.Field(count);}
+};
+
+struct trSnapshotPlayer
+{
+	unsigned short	playerID;
+	float			pos[3];
+	float			rot[3];
+
+	template <class S> void Schema ( S &s ) {s.Field(playerID); s.Field(pos); s.Field(rot);}
+};
 
 #endif //_MESSAGES_H_
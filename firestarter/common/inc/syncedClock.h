@@ -30,6 +30,19 @@
 #include "Singleton.h"
 #include "timer.h"
 #include <map>
+#include <vector>
+
+// the offset is filtered over the last few pings, the ones that took much longer than
+// the best round trip are thrown out since their delay was probably lopsided
+#define _SYNC_CLOCK_SAMPLES	8
+#define _SYNC_CLOCK_SNAP		0.5f		// errors bigger than this are jumped, not slewed
+#define _SYNC_CLOCK_SLEW		0.05f		// max seconds of correction per second
+
+typedef struct
+{
+	float	offset;
+	float	roundTrip;
+}trClockSample;
 
 class CSyncedClock : public Singleton<CSyncedClock>
 {
@@ -48,8 +61,18 @@ public:
 	float		GetServerPingLoss ( void );
 	float		GetLastPingTime ( void );
 
+	// how many good pings the offset is based on
+	int			GetSyncSamples ( void );
+
 private:
+	void		computeOffset ( void );
+
 	float					serverOffset;
+	float					targetOffset;
+	bool					synced;
+	std::vector<trClockSample>	samples;
+	int						nextSample;
+
 	float					lastPing;
 	std::map<int,float>		syncPingMap;
 	int						sentPings;
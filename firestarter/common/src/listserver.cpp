@@ -24,23 +24,395 @@
 #include <curl/curl.h>
 #include <curl/types.h>
 #include <curl/easy.h>
+#include <curl/multi.h>
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#ifndef _WIN32
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
 
 #include "commandargs.h"
 #include "prefs.h"
 #include "textUtils.h"
 
+#define _LIST_SERVER_CONNECT_TIMEOUT	20
+#define _LIST_SERVER_TIMEOUT			60
+#define _LIST_SERVER_MAX_FIELD			1024
+
 size_t serverWriteMemoryCallback(void *ptr, size_t size, size_t nmemb, void *data)
 {
 	return ((CBaseWebConnectClass*)data)->writeMemoryCallback(ptr,size,nmemb,data);
 }
 
+std::string getListServerBaseURL ( void )
+{
+	CCommandLineArgs	&args = CCommandLineArgs::instance();
+	CPrefsManager &prefs = CPrefsManager::instance();
+
+	// get the base URL
+	std::string serverbaseURL = "firestarter.bakadigital.com/list/";
+
+	if (args.Exists("listserver"))
+		serverbaseURL = args.GetDataS("listserver");
+	else if (prefs.ItemExists("listserver"))
+		serverbaseURL = prefs.GetItemS("listserver");
+
+	return "http://" + serverbaseURL;
+}
+
+// the web thread, owns the multi handle and runs every list server transfer
+// connections hand it their easy handle and are told when the transfer is done
+// it is never destroyed, so a global connection can still cancel its transfer
+// while statics are being torn down at exit, the thread just dies with the app
+class CWebThread
+{
+public:
+	static CWebThread& instance ( void )
+	{
+		static CWebThread	*web = new CWebThread;
+		return *web;
+	}
+
+	void lock ( void ) { SDL_mutexP(mutex); }
+	void unlock ( void ) { SDL_mutexV(mutex); }
+
+	bool start ( CBaseWebConnectClass *connection );
+	void cancel ( CBaseWebConnectClass *connection );
+
+protected:
+	CWebThread();
+
+	static int run ( void *param );
+	void service ( void );
+	void waitForSockets ( void );
+	bool isActive ( CBaseWebConnectClass *connection );
+
+	SDL_Thread	*thread;
+	SDL_mutex	*mutex;
+	CURLM		*multi;
+
+	// curl holds on to these after curl_multi_fdset and reads the select
+	// results out of them on the next perform, so they must outlive the call
+	fd_set		readSet,writeSet,errorSet;
+
+	std::vector<CBaseWebConnectClass*>	queued;
+	std::vector<CBaseWebConnectClass*>	active;
+	std::vector<CBaseWebConnectClass*>	canceled;
+};
+
+CWebThread::CWebThread()
+{
+	thread = NULL;
+	multi = NULL;
+	mutex = SDL_CreateMutex();
+
+	FD_ZERO(&readSet);
+	FD_ZERO(&writeSet);
+	FD_ZERO(&errorSet);
+}
+
+bool CWebThread::start ( CBaseWebConnectClass *connection )
+{
+	if (!mutex)
+		return false;
+
+	lock();
+	queued.push_back(connection);
+	unlock();
+
+	if (!thread)
+	{
+		thread = SDL_CreateThread(run,this);
+		if (!thread)
+		{
+			lock();
+			queued.clear();
+			unlock();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CWebThread::isActive ( CBaseWebConnectClass *connection )
+{
+	for (unsigned int i = 0; i < active.size(); i++)
+	{
+		if (active[i] == connection)
+			return true;
+	}
+	for (unsigned int i = 0; i < canceled.size(); i++)
+	{
+		if (canceled[i] == connection)
+			return true;
+	}
+	return false;
+}
+
+void CWebThread::cancel ( CBaseWebConnectClass *connection )
+{
+	lock();
+	std::vector<CBaseWebConnectClass*>::iterator itr = queued.begin();
+	while (itr != queued.end())
+	{
+		if (*itr == connection)
+			itr = queued.erase(itr);
+		else
+			itr++;
+	}
+
+	bool inTransfer = isActive(connection);
+	if (inTransfer)
+		canceled.push_back(connection);
+	unlock();
+
+	// the web thread may be inside the connection's write callback, so wait
+	// for it to let go of the handle before the connection goes away
+	while (inTransfer && thread)
+	{
+		SDL_Delay(1);
+		lock();
+		inTransfer = isActive(connection);
+		unlock();
+	}
+}
+
+int CWebThread::run ( void *param )
+{
+	CWebThread *web = (CWebThread*)param;
+
+	web->multi = curl_multi_init();
+	if (!web->multi)
+		return -1;
+
+	// runs for as long as the app does
+	for (;;)
+		web->service();
+
+	return 0;
+}
+
+void CWebThread::service ( void )
+{
+	lock();
+	for (unsigned int i = 0; i < canceled.size(); i++)
+	{
+		std::vector<CBaseWebConnectClass*>::iterator itr = active.begin();
+		while (itr != active.end())
+		{
+			if (*itr == canceled[i])
+			{
+				curl_multi_remove_handle(multi,(CURL*)canceled[i]->getHandle());
+				itr = active.erase(itr);
+			}
+			else
+				itr++;
+		}
+	}
+	canceled.clear();
+
+	for (unsigned int i = 0; i < queued.size(); i++)
+	{
+		curl_multi_add_handle(multi,(CURL*)queued[i]->getHandle());
+		active.push_back(queued[i]);
+	}
+	queued.clear();
+	bool idle = active.empty();
+	unlock();
+
+	if (idle)
+	{
+		SDL_Delay(10);
+		return;
+	}
+
+	// the transfers are run without the lock, the write callbacks only touch
+	// connection data the app thread leaves alone while a request is pending
+	int stillRunning = 0;
+	while (curl_multi_perform(multi,&stillRunning) == CURLM_CALL_MULTI_PERFORM)
+		continue;
+
+	int	messagesLeft = 0;
+	CURLMsg *message = curl_multi_info_read(multi,&messagesLeft);
+	while (message)
+	{
+		if (message->msg == CURLMSG_DONE)
+		{
+			CURL *easy = message->easy_handle;
+			CURLcode result = message->data.result;
+
+			curl_multi_remove_handle(multi,easy);
+
+			lock();
+			std::vector<CBaseWebConnectClass*>::iterator itr = active.begin();
+			while (itr != active.end())
+			{
+				if ((*itr)->getHandle() == easy)
+				{
+					(*itr)->transferDone(result);
+					itr = active.erase(itr);
+				}
+				else
+					itr++;
+			}
+			unlock();
+		}
+		message = curl_multi_info_read(multi,&messagesLeft);
+	}
+
+	if (stillRunning)
+		waitForSockets();
+}
+
+void CWebThread::waitForSockets ( void )
+{
+	int maxFD = -1;
+
+	FD_ZERO(&readSet);
+	FD_ZERO(&writeSet);
+	FD_ZERO(&errorSet);
+
+	curl_multi_fdset(multi,&readSet,&writeSet,&errorSet,&maxFD);
+
+	// curl has no socket yet ( name lookup ), just give it a moment
+	if (maxFD < 0)
+	{
+		SDL_Delay(5);
+		return;
+	}
+
+	// keep the wait short so new requests and cancels are picked up quickly
+	struct timeval timeout;
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 10000;
+	select(maxFD+1,&readSet,&writeSet,&errorSet,&timeout);
+}
+
+// base web connection
+CBaseWebConnectClass::CBaseWebConnectClass()
+{
+	handle = NULL;
+	callback = NULL;
+	pending = eListServerNone;
+	transferComplete = false;
+	transferResult = CURLE_OK;
+	lastResult = false;
+}
+
+CBaseWebConnectClass::~CBaseWebConnectClass()
+{
+	// derived classes cancel in their destructors, while the write callback still exists
+	if (busy())
+		CWebThread::instance().cancel(this);
+
+	if (handle)
+		curl_easy_cleanup((CURL*)handle);
+	handle = NULL;
+}
+
+bool CBaseWebConnectClass::startRequest ( teListServerRequest request, const char *page )
+{
+	if (busy())
+		return false;
+
+	if (!handle)
+	{
+		handle = curl_easy_init();
+		if (!handle)
+			return false;
+
+		/* send all data to this function  */
+		curl_easy_setopt((CURL*)handle, CURLOPT_WRITEFUNCTION, serverWriteMemoryCallback);
+		/* we pass our 'chunk' struct to the callback function */
+		curl_easy_setopt((CURL*)handle, CURLOPT_WRITEDATA, (void *)this);
+		// we are not on the main thread, so no alarm() for timeouts
+		curl_easy_setopt((CURL*)handle, CURLOPT_NOSIGNAL, (long)1);
+		curl_easy_setopt((CURL*)handle, CURLOPT_CONNECTTIMEOUT, (long)_LIST_SERVER_CONNECT_TIMEOUT);
+		curl_easy_setopt((CURL*)handle, CURLOPT_TIMEOUT, (long)_LIST_SERVER_TIMEOUT);
+	}
+
+	// curl does not copy the URL, so it lives with the connection
+	url = page;
+	curl_easy_setopt((CURL*)handle, CURLOPT_URL,url.c_str() );
+
+	pending = request;
+	transferComplete = false;
+	transferResult = CURLE_OK;
+
+	if (!CWebThread::instance().start(this))
+	{
+		pending = eListServerNone;
+		return false;
+	}
+	return true;
+}
+
+void CBaseWebConnectClass::transferDone ( int result )
+{
+	transferResult = result;
+	transferComplete = true;
+}
+
+void CBaseWebConnectClass::process ( void )
+{
+	if (!busy())
+		return;
+
+	CWebThread &web = CWebThread::instance();
+
+	web.lock();
+	bool complete = transferComplete;
+	int result = transferResult;
+	web.unlock();
+
+	if (!complete)
+		return;
+
+	teListServerRequest request = pending;
+	pending = eListServerNone;
+	transferComplete = false;
+
+	lastResult = requestDone(request,result == CURLE_OK);
+
+	if (callback)
+		callback->listServerRequestDone(request,lastResult);
+}
+
+bool CBaseWebConnectClass::wait ( float timeout )
+{
+	Uint32 endTime = SDL_GetTicks() + (Uint32)(timeout * 1000.0f);
+
+	while (busy())
+	{
+		process();
+		if (!busy())
+			break;
+
+		if (SDL_GetTicks() > endTime)
+			return false;
+
+		SDL_Delay(5);
+	}
+	return lastResult;
+}
+
+// server stuff
 CListServerServerConnection::CListServerServerConnection()
 {
-	clearPageData();
+	memory = NULL;
+	size = 0;
+	target = NULL;
 }
 
 CListServerServerConnection::~CListServerServerConnection()
 {
+	if (busy())
+		CWebThread::instance().cancel(this);
+	pending = eListServerNone;
 	clearPageData();
 }
 
@@ -54,28 +426,18 @@ void CListServerServerConnection::clearPageData ( void )
 
 bool CListServerServerConnection::add ( trServerInfo &info )
 {
-	CURL *curl;
-	CURLcode res;
-
 	std::string		url;
 	char					temp[512];
 
-	CCommandLineArgs	&args = CCommandLineArgs::instance();
-	CPrefsManager &prefs = CPrefsManager::instance();
+	if (busy())
+		return false;
 
 	// clear out the token as we want to get a new one
 	info.token = -1;
-	// get the base URL
-	std::string serverbaseURL = "firestarter.bakadigital.com/list/";
-
-	if (args.Exists("listserver"))
-		serverbaseURL = args.GetDataS("listserver");
-	else if (prefs.ItemExists("listserver"))
-		serverbaseURL = prefs.GetItemS("listserver");
 
 	// buildup the URL
 
-	url = "http://" + serverbaseURL;// add in the base URL
+	url = getListServerBaseURL();// add in the base URL
 	url += "add.php?"; 
 	url += "servername="+url_encode(info.name);
 	url += "&address="+url_encode(info.address);
@@ -96,58 +458,25 @@ bool CListServerServerConnection::add ( trServerInfo &info )
 	url += temp;
 
 	clearPageData();
+	target = &info;
 
-	curl = curl_easy_init();
-	if(curl)
-	{
-		// set us up the URL
-		curl_easy_setopt(curl, CURLOPT_URL,url.c_str() );
-		/* send all data to this function  */
-		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, serverWriteMemoryCallback);
-		/* we pass our 'chunk' struct to the callback function */
-		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)this);
-		res = curl_easy_perform(curl);
-		/* always cleanup */
-		curl_easy_cleanup(curl);
-	}
-	// parse that shit for the token
-	if (size == 0 || res != CURLE_OK)
-		return false;
-	
-	char * idtag = strstr(memory,"id=");
-	if (!idtag)
-		return false;
-	
-	idtag += 3;
-	info.token = atoi(idtag);
-
-	return info.token != -1;
+	return startRequest(eListServerAdd,url.c_str());
 }
+
 bool CListServerServerConnection::update ( trServerInfo &info )
 {
-	CURL *curl;
-	CURLcode res;
-
 	std::string		url;
 	char					temp[512];
 
-	CCommandLineArgs	&args = CCommandLineArgs::instance();
-	CPrefsManager &prefs = CPrefsManager::instance();
+	if (busy())
+		return false;
 
 	if (info.token == -1)
 		return add(info);
 
-	// get the base URL
-	std::string serverbaseURL = "firestarter.bakadigital.com/list/";
-
-	if (args.Exists("listserver"))
-		serverbaseURL = args.GetDataS("listserver");
-	else if (prefs.ItemExists("listserver"))
-		serverbaseURL = prefs.GetItemS("listserver");
-
 	// buildup the URL
 
-	url = "http://" + serverbaseURL;// add in the base URL
+	url = getListServerBaseURL();// add in the base URL
 	url += "update.php?"; 
 
 	sprintf(temp,"id=%d",info.token);
@@ -170,90 +499,78 @@ bool CListServerServerConnection::update ( trServerInfo &info )
 
 	sprintf(temp,"&currentplayers=%d",info.currentPlayers);
 	url += temp;
-//	url = url_encode(url);
 
 	clearPageData();
+	target = &info;
 
-	curl = curl_easy_init();
-	if(curl)
-	{
-		// set us up the URL
-		curl_easy_setopt(curl, CURLOPT_URL,url.c_str() );
-		/* send all data to this function  */
-		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, serverWriteMemoryCallback);
-		/* we pass our 'chunk' struct to the callback function */
-		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)this);
-		res = curl_easy_perform(curl);
-		/* always cleanup */
-		curl_easy_cleanup(curl);
-	}
-	// parse that shit for the token
-	if (size == 0 || res != CURLE_OK)
-		return false;
-
-	char * tag = strstr(memory,"update processed");
-	if (!tag)
-	{
-		info.token = -1;
-		return false;
-	}
-	return true;
+	return startRequest(eListServerUpdate,url.c_str());
 }
 
 bool CListServerServerConnection::remove ( trServerInfo &info )
 {
-	CURL *curl;
-	CURLcode res;
-
 	std::string		url;
 	char					temp[512];
 
-	CCommandLineArgs	&args = CCommandLineArgs::instance();
-	CPrefsManager &prefs = CPrefsManager::instance();
-
-	// clear out the token as we want to get a new one
-	info.token = -1;
-	// get the base URL
-	std::string serverbaseURL = "firestarter.bakadigital.com/list/";
-
-	if (args.Exists("listserver"))
-		serverbaseURL = args.GetDataS("listserver");
-	else if (prefs.ItemExists("listserver"))
-		serverbaseURL = prefs.GetItemS("listserver");
+	if (busy())
+		return false;
 
 	// buildup the URL
 
-	url = "http://" + serverbaseURL;// add in the base URL
+	url = getListServerBaseURL();// add in the base URL
 	url += "remove.php?"; 
 
-	sprintf(temp,"&id=%d",info.token);
+	sprintf(temp,"id=%d",info.token);
 	url += temp;
-	//url = url_encode(url);
+
+	// the token is gone once the server is removed
+	info.token = -1;
 
 	clearPageData();
+	target = &info;
 
-	curl = curl_easy_init();
-	if(curl)
+	return startRequest(eListServerRemove,url.c_str());
+}
+
+bool CListServerServerConnection::requestDone ( teListServerRequest request, bool transferOK )
+{
+	bool ok = transferOK && size != 0 && memory;
+
+	switch (request)
 	{
-		// set us up the URL
-		curl_easy_setopt(curl, CURLOPT_URL,url.c_str() );
-		/* send all data to this function  */
-		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, serverWriteMemoryCallback);
-		/* we pass our 'chunk' struct to the callback function */
-		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)this);
-		res = curl_easy_perform(curl);
-		/* always cleanup */
-		curl_easy_cleanup(curl);
-	}
-	// parse that shit for the token
-	if (size == 0 || res != CURLE_OK)
-		return false;
+		case eListServerAdd:
+			{
+				// parse that shit for the token
+				char * idtag = ok ? strstr(memory,"id=") : NULL;
+				if (!idtag)
+					return false;
+
+				idtag += 3;
+				if (target)
+					target->token = atoi(idtag);
+
+				return target && target->token != -1;
+			}
+
+		case eListServerUpdate:
+			if (!ok)
+				return false;
 
-	char * tag = strstr(memory,"remove processed");
-	if (!tag)
-		return false;
+			if (!strstr(memory,"update processed"))
+			{
+				// the list server forgot us, the next update will add us back
+				if (target)
+					target->token = -1;
+				return false;
+			}
+			return true;
 
-	return true;
+		case eListServerRemove:
+			return ok && strstr(memory,"remove processed") != NULL;
+
+		default:
+			break;
+	}
+	return false;
 }
 
 size_t CListServerServerConnection::writeMemoryCallback(void *ptr, size_t inSize, size_t nmemb, void *data)
@@ -279,135 +596,55 @@ CListServerClientConnection::CListServerClientConnection()
 
 CListServerClientConnection::~CListServerClientConnection()
 {
-	clearPageData();
-}
-
-bool CListServerClientConnection::readNextItem( std::string &item, char** data )
-{
-	item =**data;
-	(*data)++;
-
-	while (**data != '&')
-	{
-		item +=**data;
-		(*data)++;
-	}
-	return **data != '/0';
+	if (busy())
+		CWebThread::instance().cancel(this);
+	pending = eListServerNone;
 }
 
 bool CListServerClientConnection::get ( void )
 {
-	CURL *curl;
-	CURLcode res;
-
 	std::string		url;
 
-	CCommandLineArgs	&args = CCommandLineArgs::instance();
-	CPrefsManager &prefs = CPrefsManager::instance();
-
-	// get the base URL
-	std::string serverbaseURL = "firestarter.bakadigital.com/list/";
-
-	if (args.Exists("listserver"))
-		serverbaseURL = args.GetDataS("listserver");
-	else if (prefs.ItemExists("listserver"))
-		serverbaseURL = prefs.GetItemS("listserver");
+	if (busy())
+		return false;
 
 	// buildup the URL
 
-	url = "http://" + serverbaseURL;// add in the base URL
+	url = getListServerBaseURL();// add in the base URL
 	url += "listserv.php?"; 
 
 	url += "simpleoutput=1";
 
 	clearPageData();
-
-	curl = curl_easy_init();
-	if(curl)
-	{
-		// set us up the URL
-		curl_easy_setopt(curl, CURLOPT_URL,url.c_str() );
-		/* send all data to this function  */
-		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, serverWriteMemoryCallback);
-		/* we pass our 'chunk' struct to the callback function */
-		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)this);
-		res = curl_easy_perform(curl);
-		/* always cleanup */
-		curl_easy_cleanup(curl);
-	}
-	// parse that shit for the token
-	if (size == 0 || res != CURLE_OK)
-		return false;
-
-	char * tag = strstr(memory,"!beginlist");
-	if (!tag)
-		return false;
+	serverList.clear();
 
-	tag = strstr(tag,"list:");
-	if (!tag)
-		return false;
+	return startRequest(eListServerGet,url.c_str());
+}
 
-	tag += strlen("list:");
+void CListServerClientConnection::process ( void )
+{
+	if (!busy())
+		return;
+
+	// pick up whatever servers have been read so far
+	CWebThread &web = CWebThread::instance();
+	web.lock();
+	for (unsigned int i = 0; i < incoming.size(); i++)
+		serverList.push_back(incoming[i]);
+	incoming.clear();
+	web.unlock();
+
+	CBaseWebConnectClass::process();
+}
 
-	int count = atoi(tag);
-	serverList.clear();
+bool CListServerClientConnection::requestDone ( teListServerRequest request, bool transferOK )
+{
+	// anything parsed after the last process is still waiting
+	for (unsigned int i = 0; i < incoming.size(); i++)
+		serverList.push_back(incoming[i]);
+	incoming.clear();
 
-	for (int i = 0; i < count; i++ )
-	{
-			tag = strstr(tag,"&");
-			if (!tag)
-				return false;
-			tag++;
-
-			trServerInfo info;
-			std::string	temp;
-
-			// get server name
-			readNextItem(temp,&tag);
-			tag++;
-			info.name = temp;
-
-			// get server address
-			readNextItem(temp,&tag);
-			tag++;
-			info.address = temp;
-
-			// get server port
-			readNextItem(temp,&tag);
-			tag++;
-			info.port = atoi(temp.c_str());
-
-			// get server game
-			readNextItem(temp,&tag);
-			tag++;
-			info.game = temp;
-
-			// get server version
-			readNextItem(temp,&tag);
-			tag++;
-			info.version = (float)atof(temp.c_str());
-
-			// get server OS
-			readNextItem(temp,&tag);
-			tag++;
-			info.os = temp;
-
-			// get server max players
-			readNextItem(temp,&tag);
-			tag++;
-			info.maxPlayers = atoi(temp.c_str());
-
-			// get server current players
-			readNextItem(temp,&tag);
-			tag++;
-			info.currentPlayers = atoi(temp.c_str());
-
-			// the '&' at the end
-			tag++;
-
-			serverList.push_back(info);
-	}
-	return true;
+	return transferOK && parseState == eParseDone;
 }
 
 int CListServerClientConnection::count ( void )
@@ -424,20 +661,123 @@ size_t CListServerClientConnection::writeMemoryCallback(void *ptr, size_t inSize
 {
 	size_t realsize = inSize * nmemb;
 
-	memory = (char *)realloc(memory, size + realsize + 1);
-	if (memory)
+	parseListData((const char*)ptr,realsize);
+	return realsize;
+}
+
+// the list is "!beginlist ... list:<count> " followed by one row per server
+// of the form "&name&address&port&game&version&os&maxplayers&currentplayers&& ",
+// each field starts with an '&' and the row ends with "&&" (see listserv.php)
+// it is read as it arrives, so servers show up before the page is done
+void CListServerClientConnection::parseListData ( const char *data, size_t len )
+{
+	if (parseState == eParseHeader)
 	{
-		memcpy(&(memory[size]), ptr, realsize);
-		size += realsize;
-		memory[size] = 0;
+		header.append(data,len);
+
+		std::string::size_type tag = header.find("!beginlist");
+		if (tag != std::string::npos)
+			tag = header.find("list:",tag);
+		if (tag == std::string::npos)
+			return;
+
+		// make sure the whole count has come in
+		std::string::size_type number = tag + strlen("list:");
+		std::string::size_type end = number;
+		while (end < header.size() && header[end] >= '0' && header[end] <= '9')
+			end++;
+		if (end == header.size())
+			return;
+
+		expectedItems = atoi(header.c_str()+number);
+		parseState = expectedItems > 0 ? eParseItemStart : eParseDone;
+
+		// the rest of what we have is list data
+		std::string rest = header.substr(end);
+		header.clear();
+		parseListData(rest.c_str(),rest.size());
+		return;
 	}
-	return realsize;
+
+	for (size_t pos = 0; pos < len && parseState != eParseDone; pos++)
+	{
+		char c = data[pos];
+		if (parseState == eParseItemStart)
+		{
+			// each server starts with an '&', skip the space before it
+			if (c == '&')
+			{
+				parseState = eParseField;
+				fieldIndex = 0;
+				field.clear();
+			}
+		}
+		else if (parseState == eParseItemEnd)
+		{
+			// the first '&' of the "&&" closed the last field, this is the second one
+			if (c == '&')
+				parseState = eParseItemStart;
+		}
+		else if (c == '&')
+			parseListItem();
+		else if (field.size() < _LIST_SERVER_MAX_FIELD)
+			field += c;
+	}
+}
+
+void CListServerClientConnection::parseListItem ( void )
+{
+	switch (fieldIndex)
+	{
+		case 0:
+			parseItem.name = field;
+			break;
+		case 1:
+			parseItem.address = field;
+			break;
+		case 2:
+			parseItem.port = atoi(field.c_str());
+			break;
+		case 3:
+			parseItem.game = field;
+			break;
+		case 4:
+			parseItem.version = (float)atof(field.c_str());
+			break;
+		case 5:
+			parseItem.os = field;
+			break;
+		case 6:
+			parseItem.maxPlayers = atoi(field.c_str());
+			break;
+		case 7:
+			parseItem.currentPlayers = atoi(field.c_str());
+			break;
+	}
+	field.clear();
+	fieldIndex++;
+
+	if (fieldIndex < 8)
+		return;
+
+	parseItem.token = -1;
+
+	CWebThread &web = CWebThread::instance();
+	web.lock();
+	incoming.push_back(parseItem);
+	web.unlock();
+
+	parsedItems++;
+	parseState = parsedItems < expectedItems ? eParseItemEnd : eParseDone;
 }
 
 void CListServerClientConnection::clearPageData ( void )
 {
-	if (memory)
-		free (memory);
-	memory = NULL;
-	size = 0;
+	parseState = eParseHeader;
+	header.clear();
+	field.clear();
+	fieldIndex = 0;
+	expectedItems = 0;
+	parsedItems = 0;
+	incoming.clear();
 }
\ No newline at end of file
@@ -21,6 +21,8 @@
 */
 
 #include "syncedClock.h"
+#include <algorithm>
+#include <math.h>
 
 template <>
 CSyncedClock* Singleton<CSyncedClock>::_instance = (CSyncedClock*)0;
@@ -38,6 +40,9 @@ CSyncedClock::CSyncedClock():timer(CTimer::instance())
 
 	sentPings = 0;
 	serverOffset = 0;
+	targetOffset = 0;
+	synced = false;
+	nextSample = 0;
 	lastPing = 0;
 }
 
@@ -54,6 +59,17 @@ void CSyncedClock::Init()
 void CSyncedClock::Update()
 {
 	timer.Update();
+
+	// walk the offset over to the new one slowly so time never jumps backwards
+	float error = targetOffset - serverOffset;
+	float maxStep = (float)timer.GetFrameTime() * _SYNC_CLOCK_SLEW;
+
+	if (error > maxStep)
+		error = maxStep;
+	else if (error < -maxStep)
+		error = -maxStep;
+
+	serverOffset += error;
 }
 
 float CSyncedClock::GetTime()
@@ -83,14 +99,53 @@ void CSyncedClock::ReturnSyncPing ( int ping, float value )
 	if (itr == syncPingMap.end())
 		return;
 
-	float delta = (now - itr->second) * 0.5f;
-	float serverNow = value + delta;
+	trClockSample	sample;
+	sample.roundTrip = now - itr->second;
+	sample.offset = (value + sample.roundTrip * 0.5f) - now;
 
-	serverOffset = serverNow - now;
-	lastPing = delta;
+	lastPing = sample.roundTrip * 0.5f;
 
 	// clear the ping
 	syncPingMap.erase(itr);
+
+	if ((int)samples.size() < _SYNC_CLOCK_SAMPLES)
+		samples.push_back(sample);
+	else
+		samples[nextSample] = sample;
+	nextSample = (nextSample + 1) % _SYNC_CLOCK_SAMPLES;
+
+	computeOffset();
+}
+
+void CSyncedClock::computeOffset ( void )
+{
+	if (!samples.size())
+		return;
+
+	float bestTrip = samples[0].roundTrip;
+	for (unsigned int i = 1; i < samples.size(); i++)
+	{
+		if (samples[i].roundTrip < bestTrip)
+			bestTrip = samples[i].roundTrip;
+	}
+
+	// only trust the pings that came back about as fast as the best one
+	float maxTrip = bestTrip * 2.0f + 0.01f;
+
+	std::vector<float>	offsets;
+	for (unsigned int i = 0; i < samples.size(); i++)
+	{
+		if (samples[i].roundTrip <= maxTrip)
+			offsets.push_back(samples[i].offset);
+	}
+
+	// take the median so one odd ping can't drag us around
+	std::sort(offsets.begin(),offsets.end());
+	targetOffset = offsets[offsets.size()/2];
+
+	if (!synced || fabs(targetOffset - serverOffset) > _SYNC_CLOCK_SNAP)
+		serverOffset = targetOffset;
+	synced = true;
 }
 
 float CSyncedClock::GetServerPingLoss ( void )
@@ -103,4 +158,9 @@ float CSyncedClock::GetLastPingTime ( void )
 	return lastPing;
 }
 
+int CSyncedClock::GetSyncSamples ( void )
+{
+	return (int)samples.size();
+}
+
 
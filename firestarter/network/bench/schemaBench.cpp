@@ -0,0 +1,169 @@
+/* Project24
+ * Copyright (c) 2002 - 2003 Jeffrey Myers
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named license.txt that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+// offline benchmark for fixed layout messages.
+// packs and unpacks a player update with PackMessage/UnpackMessage and with the same
+// fields through a CDataChunk, and checks the schema bytes match the Add calls.
+// usage: schemabench [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+
+#include "networking.h"
+#include "messageSchema.h"
+#include "messages.h"
+
+static void fillUpdate ( trPlayerUpdateMessage &update, int i )
+{
+	update.playerID = i & 0xff;
+	for (int j = 0; j < 3; j++)
+	{
+		update.pos[j] = (float)(i+j) * 0.5f;
+		update.rot[j] = (float)j * 0.25f;
+		update.vec[j] = (float)(i-j) * 0.125f;
+	}
+	update.stamp = (float)i * 0.01f;
+}
+
+static bool sameUpdate ( trPlayerUpdateMessage &a, trPlayerUpdateMessage &b )
+{
+	return a.playerID == b.playerID && !memcmp(a.pos,b.pos,sizeof(a.pos)) && !memcmp(a.rot,b.rot,sizeof(a.rot))
+		&& !memcmp(a.vec,b.vec,sizeof(a.vec)) && a.stamp == b.stamp;
+}
+
+// the schema has to put the same bytes on the wire as the Add calls it replaces
+static bool checkWire ( void )
+{
+	bool ok = true;
+	for (int i = 0; i < 256; i++)
+	{
+		trPlayerUpdateMessage	update, readBack;
+		fillUpdate(update,i);
+
+		CNetworkMessage	packed;
+		PackMessage(packed,update);
+
+		CNetworkMessage	added;
+		added.SetType(_MESSAGE_UPDATE);
+		added.AddI(update.playerID);
+		added.AddV(update.pos);
+		added.AddV(update.rot);
+		added.AddV(update.vec);
+		added.AddF(update.stamp);
+
+		unsigned int size = packed.GetSizeRaw();
+		if (size != added.GetSizeRaw())
+		{
+			ok = false;
+			continue;
+		}
+
+		unsigned char *a = (unsigned char*)malloc(size);
+		unsigned char *b = (unsigned char*)malloc(size);
+		packed.GetDataMem(a);
+		added.GetDataMem(b);
+		if (memcmp(a,b,size))
+			ok = false;
+		free(a);
+		free(b);
+
+		packed.ResetRead();
+		if (!UnpackMessage(packed,readBack) || !sameUpdate(update,readBack))
+			ok = false;
+	}
+	return ok;
+}
+
+static float benchSchema ( int iterations, float &check )
+{
+	CNetworkMessage			message;
+	trPlayerUpdateMessage	update, readBack;
+
+	unsigned int start = SDL_GetTicks();
+	for (int i = 0; i < iterations; i++)
+	{
+		fillUpdate(update,i);
+		PackMessage(message,update);
+		message.ResetRead();
+		UnpackMessage(message,readBack);
+		check += readBack.stamp;
+	}
+	return (float)(SDL_GetTicks() - start) / 1000.0f;
+}
+
+static float benchChunk ( int iterations, float &check )
+{
+	CNetworkMessage			message;
+	trPlayerUpdateMessage	update, readBack;
+
+	unsigned int start = SDL_GetTicks();
+	for (int i = 0; i < iterations; i++)
+	{
+		fillUpdate(update,i);
+
+		CDataChunk	chunk;
+		chunk.SetType(_MESSAGE_UPDATE);
+		chunk.AddI(update.playerID);
+		chunk.AddV(update.pos);
+		chunk.AddV(update.rot);
+		chunk.AddV(update.vec);
+		chunk.AddF(update.stamp);
+
+		message.SetType(_MESSAGE_UPDATE);
+		message.AddChunk(chunk);
+		message.ResetRead();
+
+		CDataChunk	received;
+		message.ReadChunk(received);
+		readBack.playerID = received.ReadI();
+		received.ReadV(readBack.pos);
+		received.ReadV(readBack.rot);
+		received.ReadV(readBack.vec);
+		readBack.stamp = received.ReadF();
+		check += readBack.stamp;
+	}
+	return (float)(SDL_GetTicks() - start) / 1000.0f;
+}
+
+int main ( int argc, char *argv[] )
+{
+	int iterations = 1000000;
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+	if (iterations < 1)
+	{
+		printf("usage: %s [iterations]\n",argv[0]);
+		return 1;
+	}
+
+	InitNetwork();
+
+	bool wireOK = checkWire();
+
+	float schemaCheck = 0, chunkCheck = 0;
+	float chunkTime = benchChunk(iterations,chunkCheck);
+	float schemaTime = benchSchema(iterations,schemaCheck);
+
+	printf("%d player updates packed and unpacked\n",iterations);
+	printf("  CDataChunk: %.3f seconds (%.0f ns each)\n",chunkTime,chunkTime * 1.0e9f / iterations);
+	printf("  schema:     %.3f seconds (%.0f ns each)\n",schemaTime,schemaTime * 1.0e9f / iterations);
+	if (schemaTime > 0)
+		printf("  speedup:    %.2fx\n",chunkTime / schemaTime);
+	printf("schema bytes %s the Add calls\n",wireOK ? "match" : "DO NOT match");
+	if (schemaCheck != chunkCheck)
+		printf("unpacked values DO NOT match\n");
+
+	FreeNetwork();
+	return (wireOK && schemaCheck == chunkCheck) ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/* Project24
+ * Copyright (c) 2002 - 2003 Jeffrey Myers
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named license.txt that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef _MESSAGE_SCHEMA_H_
+#define _MESSAGE_SCHEMA_H_
+
+#include "networking.h"
+
+// packing for messages with a fixed layout.
+// a layout is a struct with a messageType enum and a Schema method that lists its fields in wire order:
+//
+//	struct trExampleMessage
+//	{
+//		enum {messageType = _MESSAGE_EXAMPLE};
+//		unsigned int	id;
+//		float			pos[3];
+//		template <class S> void Schema ( S &s ) { s.Field(id); s.Field(pos); }
+//	};
+//
+// the fields go on the wire just like the matching CNetworkMessage Add calls would put them,
+// with no type tags and no allocations, so code using Add/Read can still talk to them.
+// fields can be bool, char, short, int, float, or fixed arrays of those.
+// CDataChunk is still the thing to use for layouts that are not known up front.
+
+// adds up the wire size of a layout, everything is inline so this folds to a constant
+class CSchemaSizer
+{
+public:
+	CSchemaSizer() {size = 0;}
+
+	void Field ( bool &v ) {size += 1;}
+	void Field ( char &v ) {size += 1;}
+	void Field ( unsigned char &v ) {size += 1;}
+	void Field ( short &v ) {size += 2;}
+	void Field ( unsigned short &v ) {size += 2;}
+	void Field ( int &v ) {size += 4;}
+	void Field ( unsigned int &v ) {size += 4;}
+	void Field ( float &v ) {size += 4;}
+
+	template <class T, int N>
+	void Field ( T (&v)[N] ) {for (int i = 0; i < N; i++) Field(v[i]);}
+
+	unsigned int size;
+};
+
+class CSchemaWriter
+{
+public:
+	CSchemaWriter( unsigned char *data ) {pData = data;}
+
+	void Field ( bool &v ) {*pData++ = v ? 1 : 0;}
+	void Field ( char &v ) {*pData++ = (unsigned char)v;}
+	void Field ( unsigned char &v ) {*pData++ = v;}
+	void Field ( short &v ) {WriteInt16(pData,v); pData += 2;}
+	void Field ( unsigned short &v ) {WriteInt16(pData,v); pData += 2;}
+	void Field ( int &v ) {WriteInt32(pData,v); pData += 4;}
+	void Field ( unsigned int &v ) {WriteInt32(pData,(int)v); pData += 4;}
+	void Field ( float &v ) {WriteFloat32(pData,v); pData += 4;}
+
+	template <class T, int N>
+	void Field ( T (&v)[N] ) {for (int i = 0; i < N; i++) Field(v[i]);}
+
+	unsigned char	*pData;
+};
+
+class CSchemaReader
+{
+public:
+	CSchemaReader( unsigned char *data ) {pData = data;}
+
+	void Field ( bool &v ) {v = *pData++ != 0;}
+	void Field ( char &v ) {v = (char)*pData++;}
+	void Field ( unsigned char &v ) {v = *pData++;}
+	void Field ( short &v ) {v = (short)ReadInt16(pData); pData += 2;}
+	void Field ( unsigned short &v ) {v = (unsigned short)ReadInt16(pData); pData += 2;}
+	void Field ( int &v ) {v = ReadInt32(pData); pData += 4;}
+	void Field ( unsigned int &v ) {v = (unsigned int)ReadInt32(pData); pData += 4;}
+	void Field ( float &v ) {v = ReadFloat32(pData); pData += 4;}
+
+	template <class T, int N>
+	void Field ( T (&v)[N] ) {for (int i = 0; i < N; i++) Field(v[i]);}
+
+	unsigned char	*pData;
+};
+
+template <class T>
+inline unsigned int GetMessageSize ( T &layout )
+{
+	CSchemaSizer	sizer;
+	layout.Schema(sizer);
+	return sizer.size;
+}
+
+// sets the message type and appends the layout in one pass
+template <class T>
+inline void PackMessage ( CNetworkMessage &message, T &layout )
+{
+	unsigned int size = GetMessageSize(layout);
+
+	message.SetType(T::messageType);
+	unsigned char *pData = (unsigned char*)message.AddSpace(size);
+	if (!pData)
+		return;
+
+	CSchemaWriter	writer(pData);
+	layout.Schema(writer);
+}
+
+// appends the layout after whatever is already in the message, for messages
+// made of a fixed header followed by a run of fixed records
+template <class T>
+inline void AppendMessage ( CNetworkMessage &message, T &layout )
+{
+	unsigned char *pData = (unsigned char*)message.AddSpace(GetMessageSize(layout));
+	if (!pData)
+		return;
+
+	CSchemaWriter	writer(pData);
+	layout.Schema(writer);
+}
+
+// reads the layout from the current read position,
+// returns false and leaves the layout alone if the message is too short.
+template <class T>
+inline bool UnpackMessage ( CNetworkMessage &message, T &layout )
+{
+	unsigned char *pData = (unsigned char*)message.ReadSpace(GetMessageSize(layout));
+	if (!pData)
+		return false;
+
+	CSchemaReader	reader(pData);
+	layout.Schema(reader);
+	return true;
+}
+
+#endif//_MESSAGE_SCHEMA_H_
@@ -35,6 +35,18 @@ typedef struct
    unsigned short port;
 } trNetAddress;
 
+// traffic counters for a server or client, times are in milliseconds.
+// the receive delay is how long a message waited between arriving and being handed to the
+// message processor. with a network thread it is measured, when polling it is estimated from
+// the time between ProcessMessages calls.
+typedef struct
+{
+	unsigned int	messagesIn;
+	unsigned int	messagesOut;
+	double			totalReceiveDelay;
+	unsigned int	maxReceiveDelay;
+} trNetStats;
+
 typedef enum
 {
 	eUnknown,
@@ -119,6 +131,11 @@ public:
 	void* GetPeer (void);
 	void SetPeer ( void *peer);
 
+	// the server or client network thread that owns this peer, if any.
+	// an app should never need to call this.
+	void* GetService (void);
+	void SetService ( void *service);
+
 	// the address of the connection
 	trNetAddress GetAddress ( void ) {return address;}
 	void SetAddress (trNetAddress & addy) {address = addy;}
@@ -139,6 +156,7 @@ private:
 // read methods will not start past the end of data
 // add methods will automaticly resize the data.
 // if needed, there are raw functions to get/set the pure data.
+// buffers grow geometricly and are recycled from a per thread pool.
 class  CNetworkMessage
 {
 public:
@@ -146,11 +164,26 @@ public:
 	CNetworkMessage(const CNetworkMessage& message);
 	~CNetworkMessage();
 	CNetworkMessage& operator = (const CNetworkMessage& message);
+#if __cplusplus >= 201103L
+	CNetworkMessage(CNetworkMessage&& message);
+	CNetworkMessage& operator = (CNetworkMessage&& message);
+#endif
+
+	// trade data with another message, nothing is copied.
+	void Swap ( CNetworkMessage &message );
+
+	// make room for at least this much data so a large message does not regrow as it is built
+	void Reserve ( unsigned int iSize );
 	
 	// send this message to a peer;
-	// will dupe the data, and posibly break into chuncks on send.
+	// the first send hands the buffer to the transport without a copy, later sends
+	// to other peers share it. adding data after a send starts a new buffer.
 	void Send ( CNetworkPeer &peer, bool relyable );
 
+	// the transport layer packet for this message, built on the first call.
+	// users should not call.
+	void* GetPacket ( bool relyable );
+
 	// type is 2 bytes, ether as a short, or 2 chars.
 	void SetType ( unsigned short type );
 	void SetType ( const char *type );
@@ -180,6 +213,9 @@ public:
 	void AddV ( float data[3] );	
 	void AddN ( unsigned int size, void *data );	
 	void AddChunk ( CDataChunk &chunk );
+	// grows the data by size bytes and returns where they start, for writing in place.
+	// the pointer is good until the next add or send.
+	void* AddSpace ( unsigned int size );
 
 	// sets the data read counter to the begining ( default )
 	void ResetRead ( void );
@@ -200,6 +236,8 @@ public:
 	void ReadV ( float data[3] );
 	void ReadN ( unsigned int size, void *data );	
 	void ReadChunk ( CDataChunk &chunk );	
+	// returns the next size bytes for reading in place and skips them, NULL if there are not that many left.
+	void* ReadSpace ( unsigned int size );
 
 	// resize the data to this size, will maintain as much data as it can, will truncate at new length if data is now smaller
 	void SetDataSize ( int iSize );
@@ -209,7 +247,18 @@ public:
 
 private:
 	struct trNetMessageInfo;
+	struct trNetMessagePool;
 	trNetMessageInfo	*info;
+
+	static trNetMessagePool& GetPool ( void );
+	static trNetMessageInfo* NewInfo ( void );
+	static void FreeInfo ( trNetMessageInfo *oldInfo );
+	static void ReleasePacket ( trNetMessageInfo *packetInfo );
+
+	// make sure the buffer is ours and holds at least rawSize bytes ( including the type )
+	unsigned char* Grow ( unsigned int rawSize );
+	// grow the data by size bytes, and return where they start
+	unsigned char* Append ( unsigned int size );
 };
 
 class  CNetworkMessageProcessor
@@ -232,14 +281,22 @@ public:
 	void Start ( int iClients, int iMaxUp, int iMaxDown, int iPort );
 	void Stop ( void );
 
+	// service the connection from its own thread, set before Start.
+	// ProcessMessages still has to be called to get the messages, but it
+	// no longer waits on the network.
+	void SetThreaded ( bool threaded );
+
 	void SetMesageHandaler ( CNetworkMessageProcessor *messageProcessor );
 
-	// if we can go multi-thread, we don't need this
+	// calls the message handaler for everything that came in since the last call
 	void ProcessMessages ( void );
 
 	void KickUser ( CNetworkPeer &peer );
 	void FlushUsers ( void );
 
+	const trNetStats& GetStats ( void );
+	void ResetStats ( void );
+
 private:
 	struct trNetServerInfo;
 	trNetServerInfo	*info;
@@ -258,11 +315,17 @@ public:
 
 	bool Connected ( void );
 
+	// service the connection from its own thread, set before Connect.
+	void SetThreaded ( bool threaded );
+
 	void SetMesageHandaler ( CNetworkMessageProcessor *messageProcessor );
 
-	// if we can go multi-thread, we don't need this
+	// calls the message handaler for everything that came in since the last call
 	void ProcessMessages ( void );
 
+	const trNetStats& GetStats ( void );
+	void ResetStats ( void );
+
 	CNetworkPeer& GetServerPeer ( void ) {return server;}
 
 private:
@@ -19,9 +19,13 @@
 #include <set>
 #include <map>
 #include <vector>
+#include <deque>
 
 #include "Networking.h"
 #include "enet/enet.h"
+#include "enet/memory.h"
+#include <SDL.h>
+#include <SDL_thread.h>
 
 // enet inits
 int  iInitCount = 0;
@@ -568,7 +572,7 @@ unsigned int CDataChunk::NetReadData( void *data )
 			}
 			case eVector:
 			{
-				item.type = eFloat;
+				item.type = eVector;
 				item.offset = (int)info->data.size();
 				info->items.push_back(item);
 
@@ -720,97 +724,647 @@ void CDataChunk::NextElement ( void )
 }
 
 
+//---------------------network service-----------------------------
+
+// a server or client can hand its enet host to a thread that services it all the time.
+// the thread and the game trade events through two rings with one writer and one reader
+// each, so neither side ever blocks on a lock. neither side waits on the other ether,
+// the thread stops reading the network while incoming is full, and game sends that
+// don't fit in outgoing wait in an overflow list on the game side.
+
+#define _SERVICE_QUEUE_SIZE	1024	// must be a power of 2
+#define _SERVICE_WAIT		1		// ms the thread waits on the socket before checking for sends
+#define _SERVICE_OVERFLOW	8192	// game items held back before unreliable sends get dropped
+
+#ifdef _WIN32
+#define _MEMORY_BARRIER() { LONG barrier; InterlockedExchange(&barrier,0); }
+#else
+#define _MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+typedef enum
+{
+	eServiceConnect,
+	eServiceReceive,
+	eServiceDisconnect,
+	eServiceSend,
+	eServiceKick,
+	eServiceFlush
+}teServiceItemType;
+
+typedef struct
+{
+	teServiceItemType	type;
+	ENetPeer			*peer;
+	ENetPacket			*packet;
+	unsigned int		time;
+}trServiceItem;
+
+class CServiceQueue
+{
+public:
+	CServiceQueue()
+	{
+		head = tail = 0;
+	}
+
+	// only the writing thread may call this
+	bool Push ( const trServiceItem &item )
+	{
+		unsigned int end = tail;
+		if (end - head >= _SERVICE_QUEUE_SIZE)
+			return false;
+
+		items[end & (_SERVICE_QUEUE_SIZE-1)] = item;
+		_MEMORY_BARRIER();
+		tail = end+1;
+		return true;
+	}
+
+	// only the reading thread may call this
+	bool Pop ( trServiceItem &item )
+	{
+		unsigned int start = head;
+		if (start == tail)
+			return false;
+
+		_MEMORY_BARRIER();
+		item = items[start & (_SERVICE_QUEUE_SIZE-1)];
+		_MEMORY_BARRIER();
+		head = start+1;
+		return true;
+	}
+
+private:
+	trServiceItem			items[_SERVICE_QUEUE_SIZE];
+	volatile unsigned int	head;
+	volatile unsigned int	tail;
+};
+
+typedef struct
+{
+	ENetHost		*host;
+	SDL_Thread		*thread;
+	volatile bool	running;
+
+	CServiceQueue	incoming;	// written by the thread
+	CServiceQueue	outgoing;	// written by the game
+
+	std::deque<trServiceItem>	overflow;	// game items that did not fit in outgoing yet
+
+	trNetStats		stats;
+	unsigned int	lastProcessTime;
+}trNetService;
+
+// hands the game's overflow to the thread, in order, as far as there is room
+static void ServiceRunOverflow ( trNetService &service )
+{
+	while (!service.overflow.empty() && service.outgoing.Push(service.overflow.front()))
+		service.overflow.pop_front();
+}
+
+// the game never waits on the thread, if the thread is behind the item waits for the next
+// push or ProcessMessages call. if it is far behind, unreliable sends are lost like they
+// would be on a congested link, everything else is kept.
+static void ServicePush ( trNetService &service, trServiceItem &item )
+{
+	ServiceRunOverflow(service);
+	if (service.overflow.empty() && service.outgoing.Push(item))
+		return;
+
+	if (service.overflow.size() >= _SERVICE_OVERFLOW && item.type == eServiceSend && !(item.packet->flags & ENET_PACKET_FLAG_RELIABLE))
+	{
+		enet_packet_destroy(item.packet);
+		return;
+	}
+	service.overflow.push_back(item);
+}
+
+static void ServiceRunItem ( trNetService &service, trServiceItem &item )
+{
+	switch(item.type)
+	{
+		case eServiceSend:
+			enet_peer_send(item.peer,0,item.packet);
+			if (item.packet->referenceCount == 0)
+				enet_packet_destroy(item.packet);
+			break;
+
+		case eServiceKick:
+			enet_peer_disconnect(item.peer);
+			break;
+
+		case eServiceFlush:
+			enet_host_flush(service.host);
+			break;
+
+		default:
+			break;
+	}
+}
+
+static void ServiceRunOutgoing ( trNetService &service )
+{
+	trServiceItem	item;
+
+	while (service.outgoing.Pop(item))
+		ServiceRunItem(service,item);
+}
+
+static int ServiceThread ( void *param )
+{
+	trNetService	&service = *(trNetService*)param;
+	ENetEvent		event;
+	trServiceItem	held;		// an event that did not fit in incoming
+	bool			holding = false;
+
+	while (service.running)
+	{
+		ServiceRunOutgoing(service);
+
+		// the game is behind, leave the network alone till it makes room. what it
+		// sends still goes out so it is never stuck waiting on us.
+		if (holding)
+		{
+			if (!service.incoming.Push(held))
+			{
+				enet_host_flush(service.host);
+				SDL_Delay(_SERVICE_WAIT);
+				continue;
+			}
+			holding = false;
+		}
+
+		int result = enet_host_service(service.host,&event,_SERVICE_WAIT);
+		while (result > 0)
+		{
+			trServiceItem	item;
+			item.peer = event.peer;
+			item.packet = event.packet;
+			item.time = SDL_GetTicks();
+
+			switch(event.type)
+			{
+				case ENET_EVENT_TYPE_CONNECT:
+					item.type = eServiceConnect;
+					break;
+				case ENET_EVENT_TYPE_RECEIVE:
+					item.type = eServiceReceive;
+					break;
+				default:
+					item.type = eServiceDisconnect;
+					break;
+			}
+
+			if (!service.incoming.Push(item))
+			{
+				held = item;
+				holding = true;
+				break;
+			}
+
+			result = enet_host_service(service.host,&event,0);
+		}
+	}
+
+	if (holding && held.packet)
+		enet_packet_destroy(held.packet);
+	return 0;
+}
+
+static void ServiceInit ( trNetService &service )
+{
+	service.host = NULL;
+	service.thread = NULL;
+	service.running = false;
+	service.lastProcessTime = 0;
+	memset(&service.stats,0,sizeof(trNetStats));
+}
+
+static void ServiceStart ( trNetService &service, ENetHost *host, bool threaded )
+{
+	service.host = host;
+	service.lastProcessTime = SDL_GetTicks();
+
+	if (!threaded || !host)
+		return;
+
+	service.running = true;
+	service.thread = SDL_CreateThread(ServiceThread,&service);
+	if (!service.thread)
+		service.running = false;
+}
+
+// stops the thread, after this the game thread owns the host again
+static void ServiceStop ( trNetService &service )
+{
+	if (!service.thread)
+		return;
+
+	service.running = false;
+	SDL_WaitThread(service.thread,NULL);
+	service.thread = NULL;
+
+	// anything the game queued still goes out, anything that came in is dropped
+	ServiceRunOutgoing(service);
+	while (!service.overflow.empty())
+	{
+		ServiceRunItem(service,service.overflow.front());
+		service.overflow.pop_front();
+	}
+
+	trServiceItem	item;
+	while (service.incoming.Pop(item))
+	{
+		if (item.packet)
+			enet_packet_destroy(item.packet);
+	}
+}
+
+// queue or send, depending on who owns the host
+static void ServiceSend ( trNetService *service, ENetPeer *peer, ENetPacket *packet )
+{
+	if (!service || !service->thread)
+	{
+		enet_peer_send(peer,0,packet);
+		return;
+	}
+
+	trServiceItem	item;
+	item.type = eServiceSend;
+	item.peer = peer;
+	item.packet = packet;
+	item.time = SDL_GetTicks();
+	ServicePush(*service,item);
+}
+
+static void ServiceQueue ( trNetService &service, teServiceItemType type, ENetPeer *peer )
+{
+	trServiceItem	item;
+	item.type = type;
+	item.peer = peer;
+	item.packet = NULL;
+	item.time = SDL_GetTicks();
+	ServicePush(service,item);
+}
+
+// collects the next event for ProcessMessages, from the thread or from enet directly.
+// the time is when the event came off the network, as best we know.
+static bool ServiceNextEvent ( trNetService &service, trServiceItem &item )
+{
+	if (service.thread)
+		return service.incoming.Pop(item);
+
+	if (!service.host)
+		return false;
+
+	ENetEvent	event;
+	if (enet_host_service(service.host,&event,0) <= 0)
+		return false;
+
+	item.peer = event.peer;
+	item.packet = event.packet;
+
+	// we don't know when it really arrived, on average it's been waiting half a frame
+	unsigned int now = SDL_GetTicks();
+	item.time = now - (now - service.lastProcessTime)/2;
+
+	switch(event.type)
+	{
+		case ENET_EVENT_TYPE_CONNECT:
+			item.type = eServiceConnect;
+			break;
+		case ENET_EVENT_TYPE_RECEIVE:
+			item.type = eServiceReceive;
+			break;
+		default:
+			item.type = eServiceDisconnect;
+			break;
+	}
+	return true;
+}
+
+static void ServiceCountReceive ( trNetService &service, trServiceItem &item )
+{
+	unsigned int delay = SDL_GetTicks() - item.time;
+
+	service.stats.messagesIn++;
+	service.stats.totalReceiveDelay += delay;
+	if (delay > service.stats.maxReceiveDelay)
+		service.stats.maxReceiveDelay = delay;
+}
+
+
 //---------------------net message-----------------------------
 
+// message buffers grow geometricly, and are recycled through a small per thread pool,
+// so once a thread has warmed up building a message does not touch the heap.
+#define _MESSAGE_MIN_CAPACITY		64
+#define _MESSAGE_POOL_SIZE			64
+#define _MESSAGE_POOL_MAX_CAPACITY	4096
+
+#ifdef _WIN32
+#define _THREAD_LOCAL __declspec(thread)
+#else
+#define _THREAD_LOCAL __thread
+#endif
+
 struct CNetworkMessage::trNetMessageInfo
 {
-	unsigned int	dataSize;
-	void			*data;
+	unsigned int	dataSize;	// bytes used, including the 2 byte type
+	unsigned int	capacity;	// bytes allocated
+	unsigned char	*data;
 	unsigned short	type;
 	unsigned int	current;
+
+	// once the message is sent, the buffer belongs to this packet.
+	// we hold one reference so we can send it again and keep reading from it.
+	ENetPacket		*packet;
+
+	trNetMessageInfo *nextFree;
 };
 
+struct CNetworkMessage::trNetMessagePool
+{
+	trNetMessageInfo	*head;
+	int					count;
+};
+
+CNetworkMessage::trNetMessagePool& CNetworkMessage::GetPool ( void )
+{
+	static _THREAD_LOCAL trNetMessagePool pool = {NULL,0};
+	return pool;
+}
+
+CNetworkMessage::trNetMessageInfo* CNetworkMessage::NewInfo ( void )
+{
+	trNetMessagePool &pool = GetPool();
+
+	trNetMessageInfo *newInfo = pool.head;
+	if (newInfo)
+	{
+		pool.head = newInfo->nextFree;
+		pool.count--;
+	}
+	else
+	{
+		newInfo = new trNetMessageInfo;
+		newInfo->data = NULL;
+		newInfo->capacity = 0;
+		newInfo->packet = NULL;
+	}
+
+	newInfo->nextFree = NULL;
+	newInfo->dataSize = 0;
+	newInfo->type = 0;
+	newInfo->current = 2;
+	return newInfo;
+}
+
+void CNetworkMessage::FreeInfo ( trNetMessageInfo *oldInfo )
+{
+	if (!oldInfo)
+		return;
+
+	if (oldInfo->packet)
+	{
+		// the packet owns the buffer
+		ReleasePacket(oldInfo);
+		oldInfo->data = NULL;
+		oldInfo->capacity = 0;
+	}
+
+	trNetMessagePool &pool = GetPool();
+
+	// don't hang on to big buffers, or too many of them
+	if (oldInfo->capacity > _MESSAGE_POOL_MAX_CAPACITY || pool.count >= _MESSAGE_POOL_SIZE)
+	{
+		if (oldInfo->data)
+			free(oldInfo->data);
+		oldInfo->data = NULL;
+		oldInfo->capacity = 0;
+	}
+
+	if (pool.count >= _MESSAGE_POOL_SIZE)
+	{
+		delete(oldInfo);
+		return;
+	}
+
+	oldInfo->nextFree = pool.head;
+	pool.head = oldInfo;
+	pool.count++;
+}
+
+void CNetworkMessage::ReleasePacket ( trNetMessageInfo *packetInfo )
+{
+	ENetPacket *packet = packetInfo->packet;
+	if (!packet)
+		return;
+
+	packetInfo->packet = NULL;
+	if (--packet->referenceCount == 0)
+		enet_packet_destroy(packet);
+}
+
+unsigned char* CNetworkMessage::Grow ( unsigned int rawSize )
+{
+	if (info->packet)
+	{
+		// enet may still be sending our old buffer, so write into a new one
+		unsigned int newCapacity = info->capacity;
+		if (newCapacity < rawSize)
+			newCapacity = rawSize;
+
+		unsigned char *newData = (unsigned char*)malloc(newCapacity);
+		if (!newData)
+			return NULL;
+
+		memcpy(newData,info->data,info->dataSize);
+		ReleasePacket(info);
+		info->data = newData;
+		info->capacity = newCapacity;
+	}
+
+	if (rawSize > info->capacity)
+	{
+		unsigned int newCapacity = info->capacity*2;
+		if (newCapacity < _MESSAGE_MIN_CAPACITY)
+			newCapacity = _MESSAGE_MIN_CAPACITY;
+		if (newCapacity < rawSize)
+			newCapacity = rawSize;
+
+		unsigned char *newData = (unsigned char*)realloc(info->data,newCapacity);
+		if (!newData)
+			return NULL;
+
+		info->data = newData;
+		info->capacity = newCapacity;
+	}
+	return info->data;
+}
+
+unsigned char* CNetworkMessage::Append ( unsigned int size )
+{
+	if (!Grow(info->dataSize+size))
+		return NULL;
+
+	unsigned char *pData = info->data + info->dataSize;
+	info->dataSize += size;
+	return pData;
+}
+
 CNetworkMessage::CNetworkMessage()
 {
-	info = new trNetMessageInfo;
-	info->data = NULL;
+	info = NewInfo();
 	ClearData();
 }
 
 CNetworkMessage::CNetworkMessage(const CNetworkMessage& message)
 {
-	info = new trNetMessageInfo;
-	info->type = message.info->type;
-	info->current = message.info->current;
-
-	info->dataSize = message.info->dataSize;
-	info->data = malloc(message.info->dataSize);
-	memcpy(info->data,message.info->data,info->dataSize+2);
+	info = NewInfo();
+	*this = message;
 }
 
 CNetworkMessage& CNetworkMessage::operator = (const CNetworkMessage& message)
 {
+	if (&message == this)
+		return *this;
+
+	if (info->packet)
+	{
+		ReleasePacket(info);
+		info->data = NULL;
+		info->capacity = 0;
+	}
+
+	info->dataSize = 0;
+	if (Grow(message.info->dataSize))
+	{
+		memcpy(info->data,message.info->data,message.info->dataSize);
+		info->dataSize = message.info->dataSize;
+	}
+
 	info->type = message.info->type;
 	info->current = message.info->current;
+	return *this;
+}
 
-	if (info->data)
-		free (info->data);
-	info->dataSize = message.info->dataSize;
-	info->data = malloc(message.info->dataSize);
-	memcpy(info->data,message.info->data,info->dataSize+2);
+#if __cplusplus >= 201103L
+CNetworkMessage::CNetworkMessage(CNetworkMessage&& message)
+{
+	info = NewInfo();
+	ClearData();
+	Swap(message);
+}
+
+CNetworkMessage& CNetworkMessage::operator = (CNetworkMessage&& message)
+{
+	Swap(message);
 	return *this;
 }
+#endif
 
 CNetworkMessage::~CNetworkMessage()
 {
-	if (info->data)
-		free(info->data);
-	info->data = NULL;
-	info->dataSize = -1;
-	if (info)
-		delete(info);
+	FreeInfo(info);
+	info = NULL;
+}
+
+void CNetworkMessage::Swap ( CNetworkMessage &message )
+{
+	trNetMessageInfo *temp = info;
+	info = message.info;
+	message.info = temp;
+}
+
+void CNetworkMessage::Reserve ( unsigned int iSize )
+{
+	Grow(iSize+2);
 }
 
 void CNetworkMessage::SetDataSize ( int iSize )
 {
-	void	*newData = malloc(iSize+2);
-	if (!newData)
+	unsigned int rawSize = iSize+2;
+	if (!Grow(rawSize))
 		return;
 
-	memset(newData,0,iSize+2);
+	if (rawSize > info->dataSize)
+		memset(info->data+info->dataSize,0,rawSize-info->dataSize);
 
-	int copySize = info->dataSize;
-	if (copySize >= iSize+2)
-		copySize = iSize+2;
-	
-	memcpy(newData,info->data,copySize+2);
-
-	free(info->data);
-	info->data = newData;
-	info->dataSize = iSize+2;
+	info->dataSize = rawSize;
 }
 
 void CNetworkMessage::ClearData ( void )
 {
-	if (info->data)
-		free(info->data);
-	info->data = malloc(2);
-	memset(info->data,0,2);
+	if (info->packet)
+	{
+		// the old buffer went out with the packet, start a fresh one
+		ReleasePacket(info);
+		info->data = NULL;
+		info->capacity = 0;
+	}
+
+	info->dataSize = 0;
+	unsigned char *pData = Append(2);
+	if (pData)
+		memset(pData,0,2);
 	info->type = 0;
-	info->dataSize = 2;
 	ResetRead();
 }
 
-void CNetworkMessage::Send ( CNetworkPeer &peer, bool relyable )
+static enet_uint32 PacketFlags ( bool relyable )
 {
 	enet_uint32	flags = 0;
 	if(relyable)
 		flags |=ENET_PACKET_FLAG_RELIABLE;
+	return flags;
+}
+
+void* CNetworkMessage::GetPacket ( bool relyable )
+{
+	enet_uint32	flags = PacketFlags(relyable);
+
+	if (info->packet)
+	{
+		// enet marks fragmented packets reliable once they are queued, so only
+		// share the packet if it is still going out the way this send asked for
+		if ((info->packet->flags & ENET_PACKET_FLAG_RELIABLE) == flags)
+			return info->packet;
+
+		// the buffer is already out with other flags, this send needs its own copy
+		return enet_packet_create(info->data,info->dataSize,flags);
+	}
 
-	ENetPacket		*packet = enet_packet_create(info->data,info->dataSize,flags);
+	// wrap our buffer, enet will free it when the last reference goes away
+	ENetPacket	*packet = (ENetPacket*)enet_malloc(sizeof(ENetPacket));
+	packet->referenceCount = 1;
+	packet->flags = flags;
+	packet->data = info->data;
+	packet->dataLength = info->dataSize;
 
-	ENetPeer *enetpeer = (ENetPeer*) peer.GetPeer();
-	enet_peer_send(enetpeer,0,packet);
+	info->packet = packet;
+	return packet;
+}
+
+void CNetworkMessage::Send ( CNetworkPeer &peer, bool relyable )
+{
+	trNetService	*service = (trNetService*)peer.GetService();
+	ENetPacket		*packet = NULL;
+
+	if (service && service->thread)
+	{
+		// the network thread owns the reference counts of anything it sends,
+		// so it gets a packet of its own
+		packet = enet_packet_create(info->data,info->dataSize,PacketFlags(relyable));
+	}
+	else
+		packet = (ENetPacket*)GetPacket(relyable);
+
+	if (service)
+		service->stats.messagesOut++;
+
+	ServiceSend(service,(ENetPeer*)peer.GetPeer(),packet);
 }
 
 void CNetworkMessage::SetType ( unsigned short type )
@@ -840,11 +1394,7 @@ void CNetworkMessage::SetDataFromPacket( void *packet )
 	if (!packet)
 		return;
 
-	SetDataSize((int)((ENetPacket*)packet)->dataLength-2);
-
-	memcpy(info->data,((ENetPacket*)packet)->data,((ENetPacket*)packet)->dataLength);
-
-	info->type = ReadInt16(info->data);
+	SetDataFromMem(((ENetPacket*)packet)->data,(unsigned int)((ENetPacket*)packet)->dataLength);
 }
 
 // raw data IO
@@ -865,89 +1415,101 @@ void CNetworkMessage::GetDataMem( void *packet )
 void CNetworkMessage::SetDataFromMem( void *packet, unsigned int size )
 {
 	// this asumes that the type is in the data
-	if (!packet)
+	if (!packet || size < 2)
+		return;
+
+	ClearData();
+	info->dataSize = 0;
+	unsigned char *pData = Append(size);
+	if (!pData)
 		return;
 
-	SetDataSize(size-2);
-	memcpy(info->data,packet,size);
+	memcpy(pData,packet,size);
 	info->type = ReadInt16(info->data);
 }
 
 	// variable data pack stuff
 void CNetworkMessage::AddB ( bool data )
 {
-	SetDataSize(GetSize()+1);
-	memcpy((char*)(info->data)+info->dataSize-1,&data,1);
+	unsigned char *pData = Append(1);
+	if (pData)
+		*pData = data;
 }
 
 void CNetworkMessage::AddC ( unsigned char data )
 {
-	SetDataSize(GetSize()+1);
-	memcpy((char*)(info->data)+info->dataSize-1,&data,1);
+	unsigned char *pData = Append(1);
+	if (pData)
+		*pData = data;
 }
 
 void CNetworkMessage::AddStr ( const char *data )
 {
-	int iLen = GetSize();
-
 	int stringLen = (int)strlen((char*)data)+1;
-	SetDataSize(iLen+stringLen);
-	memcpy((char*)(info->data)+iLen+2,data,stringLen);
+	unsigned char *pData = Append(stringLen);
+	if (pData)
+		memcpy(pData,data,stringLen);
 }
 
 void CNetworkMessage::AddS ( unsigned short data )
 {
-	int iLen = GetSize();
-	SetDataSize(iLen+2);
-	WriteInt16((char*)(info->data)+iLen+2,data);
+	unsigned char *pData = Append(2);
+	if (pData)
+		WriteInt16(pData,data);
 }
 
 void CNetworkMessage::AddI ( unsigned int data )
 {
-	int iLen = GetSize();
-
-	SetDataSize(iLen+4);
-	WriteInt32((char*)(info->data)+iLen+2,data);
+	unsigned char *pData = Append(4);
+	if (pData)
+		WriteInt32(pData,data);
 }
 	
 void CNetworkMessage::AddF ( float data )
 {
-	int iLen = GetSize();
-
-	SetDataSize(iLen+4);
-	WriteFloat32((char*)(info->data)+iLen+2,data);
+	unsigned char *pData = Append(4);
+	if (pData)
+		WriteFloat32(pData,data);
 }
 	
 void CNetworkMessage::AddV ( float data[3] )
 {
-	int iLen = GetSize();
+	unsigned char *pData = Append(12);
+	if (!pData)
+		return;
 
-	SetDataSize(iLen+12);
-	WriteFloat32((char*)(info->data)+iLen+2,data[0]);
-	WriteFloat32((char*)(info->data)+iLen+4+2,data[1]);
-	WriteFloat32((char*)(info->data)+iLen+8+2,data[2]);
+	WriteFloat32(pData,data[0]);
+	WriteFloat32(pData+4,data[1]);
+	WriteFloat32(pData+8,data[2]);
 }
 	
 void CNetworkMessage::AddN ( unsigned int size, void *data )
 {
-	int iLen = GetSize();
-
-	SetDataSize(iLen+size);
-	memcpy((char*)(info->data)+iLen+2,data,size);
+	unsigned char *pData = Append(size);
+	if (pData)
+		memcpy(pData,data,size);
 }
 	
 void CNetworkMessage::AddChunk ( CDataChunk &chunk )
 {
+	// write the chunk straight into our buffer
 	unsigned int size = chunk.NetWriteData(NULL);
-	void *data = malloc(size);
-	chunk.NetWriteData(data);
-	AddN(size,data);
-	free(data);
+	if (size == (unsigned int)-1)
+		return;
+
+	unsigned char *pData = Append(size);
+	if (pData)
+		chunk.NetWriteData(pData);
+}
+
+void* CNetworkMessage::AddSpace ( unsigned int size )
+{
+	return Append(size);
 }
 
 bool CNetworkMessage::MoreToRead ( void )
 {
-	return (info->current < info->dataSize+2);
+	return (info->current < info->dataSize);
 }
 
 void CNetworkMessage::ResetRead ( void )
@@ -957,15 +1519,17 @@ void CNetworkMessage::ResetRead ( void )
 
 unsigned long CNetworkMessage::DataLeft ( void )
 {
-	return info->current - info->dataSize+2; 
+	if (info->current >= info->dataSize)
+		return 0;
+	return info->dataSize - info->current; 
 }
 
 bool CNetworkMessage::ReadB ( void )
 {
-	if (info->current+1 > info->dataSize+2)
+	if (info->current+1 > info->dataSize)
 		return false;
 
-	bool data = ((char*)(info->data))[info->current] != 0;
+	bool data = info->data[info->current] != 0;
 
 	info->current++;
 
@@ -974,10 +1538,10 @@ bool CNetworkMessage::ReadB ( void )
 
 unsigned char CNetworkMessage::ReadC ( void )
 {
-	if (info->current+1 > info->dataSize+2)
+	if (info->current+1 > info->dataSize)
 		return 0;
 
-	unsigned char data = ((char*)(info->data))[info->current];
+	unsigned char data = info->data[info->current];
 
 	info->current++;
 
@@ -986,40 +1550,40 @@ unsigned char CNetworkMessage::ReadC ( void )
 
 const char* CNetworkMessage::ReadStr ( void )
 {
-	if (info->current+1 > info->dataSize+2)
+	if (info->current+1 > info->dataSize)
 		return NULL;
 	
-	char *str = (char*)(&((char*)info->data)[info->current]);
+	char *str = (char*)(&info->data[info->current]);
 	info->current+= (int)strlen(str)+1;
 	return str;
 }
 
 unsigned short CNetworkMessage::ReadS ( void )
 {
-	if (info->current+2 > info->dataSize+2)
+	if (info->current+2 > info->dataSize)
 		return 0;
 
-	unsigned short data = ReadInt16(&((char*)info->data)[info->current]);
+	unsigned short data = ReadInt16(&info->data[info->current]);
 	info->current+= 2;
 	return data;
 }
 
 unsigned int CNetworkMessage::ReadI ( void )
 {
-	if (info->current+4 > info->dataSize+2)
+	if (info->current+4 > info->dataSize)
 		return 0;
 
-	unsigned int data = ReadInt32(&((char*)info->data)[info->current]);
+	unsigned int data = ReadInt32(&info->data[info->current]);
 	info->current+= 4;
 	return data;
 }
 	
 float CNetworkMessage::ReadF ( void )
 {
-	if (info->current+4 > info->dataSize+2)
+	if (info->current+4 > info->dataSize)
 		return 0.0f;
 
-	float data = ReadFloat32(&((char*)info->data)[info->current]);
+	float data = ReadFloat32(&info->data[info->current]);
 	info->current+= 4;
 	return data;
 }
@@ -1033,24 +1597,34 @@ void CNetworkMessage::ReadV ( float data[3] )
 
 void CNetworkMessage::ReadN ( unsigned int size, void *data )
 {
-	if (info->current+size > info->dataSize+2)
+	if (info->current+size > info->dataSize)
 		return;
 
-	memcpy(data,&((char*)info->data)[info->current],size);
+	memcpy(data,&info->data[info->current],size);
 	info->current+= size;
 }
 
+void* CNetworkMessage::ReadSpace ( unsigned int size )
+{
+	if (info->current+size > info->dataSize)
+		return NULL;
+
+	void *data = &info->data[info->current];
+	info->current+= size;
+	return data;
+}
+
 void CNetworkMessage::ReadChunk ( CDataChunk &chunk )
 {
 	// make sure there is at least a header and a size
-	if (info->current+6 > info->dataSize+2)
+	if (info->current+6 > info->dataSize)
 		return;
 
 	// make sure the size is not over the data
-	if ( ReadInt32(&((char*)info->data)[info->current+2]) +info->current < info->dataSize+2 )
+	if ( ReadInt32(&info->data[info->current+2]) +info->current > info->dataSize )
 		return;
 
-	unsigned int size = chunk.NetReadData(&((char*)info->data)[info->current]);
+	unsigned int size = chunk.NetReadData(&info->data[info->current]);
 	info->current+= size;
 }
 
@@ -1062,6 +1636,7 @@ void CNetworkMessage::ReadChunk ( CDataChunk &chunk )
 struct CNetworkPeer::trNetPeerInfo
 {
 	ENetPeer	*peer;
+	void		*service;
 	void		*param;
 	char		dns[_DNS_STRING_LEN];
 };
@@ -1088,6 +1663,7 @@ CNetworkPeer::CNetworkPeer()
 
 	info = new trNetPeerInfo;
 	info->peer = NULL;
+	info->service = NULL;
 	info->param = NULL;
 }
 
@@ -1117,6 +1693,16 @@ void CNetworkPeer::SetPeer ( void *peer)
 	info->peer = (ENetPeer*)peer;
 }
 
+void* CNetworkPeer::GetService (void)
+{
+	return info->service;
+}
+
+void CNetworkPeer::SetService ( void *service)
+{
+	info->service = service;
+}
+
 const char* CNetworkPeer::GetDNSName ( void )
 {
 	enet_address_get_host((ENetAddress*)&address,info->dns,_DNS_STRING_LEN);
@@ -1130,14 +1716,16 @@ typedef std::map<ENetPeer*, CNetworkPeer> tvPeerMap;
 struct CNetworkServer::trNetServerInfo
 {
 	tvPeerMap	peerMap;
-	ENetHost *	host;
+	trNetService service;
+	bool		threaded;
 	CNetworkMessageProcessor *messageProcessor;
 };
 
 CNetworkServer::CNetworkServer()
 {
 	info = new trNetServerInfo;
-	info->host = NULL;
+	ServiceInit(info->service);
+	info->threaded = false;
 	info->messageProcessor = NULL;
 }
 
@@ -1156,17 +1744,23 @@ void CNetworkServer::Start ( int iClients, int iMaxUp, int iMaxDown, int iPort )
 
 	addy.host = ENET_HOST_ANY;
 	addy.port = (unsigned short)iPort;
-	info->host = enet_host_create(&addy,iClients,iMaxUp,iMaxDown);
-
+	ServiceStart(info->service,enet_host_create(&addy,iClients,iMaxUp,iMaxDown),info->threaded);
 }
+
 void CNetworkServer::Stop( void )
 {
-	if (!info->host)
+	if (!info->service.host)
 		return;
 
-	enet_host_flush(info->host);
-	enet_host_destroy(info->host);
-	info->host = NULL;
+	ServiceStop(info->service);
+	enet_host_flush(info->service.host);
+	enet_host_destroy(info->service.host);
+	info->service.host = NULL;
+}
+
+void CNetworkServer::SetThreaded ( bool threaded )
+{
+	info->threaded = threaded;
 }
 
 void CNetworkServer::SetMesageHandaler ( CNetworkMessageProcessor *messageProcessor )
@@ -1176,17 +1770,16 @@ void CNetworkServer::SetMesageHandaler ( CNetworkMessageProcessor *messageProces
 
 void CNetworkServer::ProcessMessages ( void )
 {
-	if (!info->host)
+	if (!info->service.host)
 		return;
 
-	ENetEvent	event;
-	unsigned int time = 0;
+	trServiceItem	event;
 
-	while(info->host && (enet_host_service(info->host,&event,time) >0))
+	while(info->service.host && ServiceNextEvent(info->service,event))
 	{
 		switch(event.type)
 		{
-			case ENET_EVENT_TYPE_CONNECT:
+			case eServiceConnect:
 			{
 				tvPeerMap::iterator itr = info->peerMap.find(event.peer);
 
@@ -1200,17 +1793,20 @@ void CNetworkServer::ProcessMessages ( void )
 
 				CNetworkPeer peer;
 				peer.SetPeer(event.peer);
+				peer.SetService(&info->service);
 				info->peerMap[event.peer] = peer;
 				
 				if (info->messageProcessor)
 					info->messageProcessor->OnConnect(info->peerMap[event.peer]);
 			}// we continue just in case there is some data with the connect message, then we bust that out into a message
 
-			case ENET_EVENT_TYPE_RECEIVE:
+			case eServiceReceive:
 			{
 				if(!event.packet || event.packet->dataLength <2)
 					break;
 
+				ServiceCountReceive(info->service,event);
+
 				CNetworkMessage	message;
 				message.SetDataFromPacket(event.packet);
 							
@@ -1219,7 +1815,8 @@ void CNetworkServer::ProcessMessages ( void )
 			}
 			break;
 
-			case ENET_EVENT_TYPE_DISCONNECT:
+			default:
+			{
 				if (info->messageProcessor)
 					info->messageProcessor->OnDisconnect(info->peerMap[event.peer]);
 
@@ -1228,10 +1825,15 @@ void CNetworkServer::ProcessMessages ( void )
 
 				if (itr != info->peerMap.end())
 					info->peerMap.erase(itr);
-
+			}
 			break;
 		}
+
+		if (event.packet)
+			enet_packet_destroy(event.packet);
 	}
+	ServiceRunOverflow(info->service);
+	info->service.lastProcessTime = SDL_GetTicks();
 }
 
 void CNetworkServer::KickUser ( CNetworkPeer &peer )
@@ -1240,7 +1842,10 @@ void CNetworkServer::KickUser ( CNetworkPeer &peer )
 	if (itr != info->peerMap.end())
 		info->peerMap.erase(itr);
 
-	enet_peer_disconnect((ENetPeer*)peer.GetPeer());
+	if (info->service.thread)
+		ServiceQueue(info->service,eServiceKick,(ENetPeer*)peer.GetPeer());
+	else
+		enet_peer_disconnect((ENetPeer*)peer.GetPeer());
 }
 
 void CNetworkServer::FlushUsers ( void )
@@ -1249,26 +1854,45 @@ void CNetworkServer::FlushUsers ( void )
 
 	while (itr != info->peerMap.end())
 	{
-		enet_peer_disconnect((ENetPeer*)itr->second.GetPeer());
+		if (info->service.thread)
+			ServiceQueue(info->service,eServiceKick,(ENetPeer*)itr->second.GetPeer());
+		else
+			enet_peer_disconnect((ENetPeer*)itr->second.GetPeer());
 		itr++;
 	}
-	enet_host_flush(info->host);
+
+	if (info->service.thread)
+		ServiceQueue(info->service,eServiceFlush,NULL);
+	else if (info->service.host)
+		enet_host_flush(info->service.host);
 
 	info->peerMap.clear();
 }
 
+const trNetStats& CNetworkServer::GetStats ( void )
+{
+	return info->service.stats;
+}
+
+void CNetworkServer::ResetStats ( void )
+{
+	memset(&info->service.stats,0,sizeof(trNetStats));
+}
+
 
 // _---------------------------------------------client-------------------------------
 struct CNetworkClient::trNetClientInfo
 {
-	ENetHost *	host;
+	trNetService service;
+	bool		threaded;
 	CNetworkMessageProcessor *messageProcessor;
 };
 
 CNetworkClient::CNetworkClient()
 {
 	info = new trNetClientInfo;
-	info->host = NULL;
+	ServiceInit(info->service);
+	info->threaded = false;
 	info->messageProcessor = NULL;
 }
 
@@ -1284,10 +1908,12 @@ CNetworkClient::~CNetworkClient()
 void CNetworkClient::Connect ( trNetAddress & host )
 {
 	Disconect();
-	info->host = enet_host_create(NULL,1,0,0);
-	ENetPeer *peer = enet_host_connect(info->host,(ENetAddress*)&host,1);
+	ENetHost *enetHost = enet_host_create(NULL,1,0,0);
+	ENetPeer *peer = enet_host_connect(enetHost,(ENetAddress*)&host,1);
 
 	server.SetPeer(peer);
+	server.SetService(&info->service);
+	ServiceStart(info->service,enetHost,info->threaded);
 }
 
 void CNetworkClient::Connect ( const char * host, int port )
@@ -1303,22 +1929,28 @@ void CNetworkClient::Connect ( const char * host, int port )
 
 bool CNetworkClient::Connected ( void )
 {
-	return (info->host != NULL) && (server.GetPeer()!=NULL);
+	return (info->service.host != NULL) && (server.GetPeer()!=NULL);
 }
 
 
 void CNetworkClient::Disconect ( void )
 {
-	if (!info->host)
+	if (!info->service.host)
 		return;
 
-	enet_host_flush(info->host);
+	ServiceStop(info->service);
+	enet_host_flush(info->service.host);
 	enet_peer_disconnect((ENetPeer*)server.GetPeer());
-	enet_host_destroy(info->host);
-	info->host = NULL;
+	enet_host_destroy(info->service.host);
+	info->service.host = NULL;
 	server.SetPeer(NULL);
 }
 
+void CNetworkClient::SetThreaded ( bool threaded )
+{
+	info->threaded = threaded;
+}
+
 void CNetworkClient::SetMesageHandaler ( CNetworkMessageProcessor *messageProcessor )
 {
 	info->messageProcessor = messageProcessor;
@@ -1326,28 +1958,29 @@ void CNetworkClient::SetMesageHandaler ( CNetworkMessageProcessor *messageProces
 
 void CNetworkClient::ProcessMessages ( void )
 {
-	if (!info->host)
+	if (!info->service.host)
 		return;
 
-	ENetEvent	event;
-	unsigned int time = 0;
+	trServiceItem	event;
 
-	while(info->host && (enet_host_service(info->host,&event,time) >0))
+	while(info->service.host && ServiceNextEvent(info->service,event))
 	{
 		if (event.peer == server.GetPeer())
 		{
 			switch(event.type)
 			{
-				case ENET_EVENT_TYPE_CONNECT:
+				case eServiceConnect:
 				{
 					if (info->messageProcessor)
 						info->messageProcessor->OnConnect(server);
 				}
-				case ENET_EVENT_TYPE_RECEIVE:
+				case eServiceReceive:
 				{
 					if(!event.packet || event.packet->dataLength <2)
 						break;
 
+					ServiceCountReceive(info->service,event);
+
 					CNetworkMessage	message;
 					message.SetDataFromPacket(event.packet);
 					
@@ -1356,13 +1989,29 @@ void CNetworkClient::ProcessMessages ( void )
 				}
 				break;
 
-				case ENET_EVENT_TYPE_DISCONNECT:
+				default:
 					if (info->messageProcessor)
 						info->messageProcessor->OnDisconnect(server);
+					if (event.packet)
+						enet_packet_destroy(event.packet);
 					Disconect();
-				break;
+				continue;
 			}
 		}
+
+		if (event.packet)
+			enet_packet_destroy(event.packet);
 	}
+	ServiceRunOverflow(info->service);
+	info->service.lastProcessTime = SDL_GetTicks();
 }
 
+const trNetStats& CNetworkClient::GetStats ( void )
+{
+	return info->service.stats;
+}
+
+void CNetworkClient::ResetStats ( void )
+{
+	memset(&info->service.stats,0,sizeof(trNetStats));
+}
@@ -21,6 +21,10 @@
 
 class CRobotPlayer;
 
+// the world runs at a fixed rate and every tick goes out to the clients as one snapshot
+#define _DEFAULT_TICK_RATE		20.0f
+#define _MAX_TICKS_PER_THINK	5
+
 typedef struct 
 {
 	bool							player;
@@ -42,18 +46,17 @@ public:
 	virtual ~CRobotPlayer();
 
 	virtual void init ( const char* name, const char* config, trPlayerInfo *info );
-	virtual bool think ( void );
+	virtual void think ( float step );
 	virtual bool message ( CNetworkMessage &message );
 
 protected:
 	trPlayerInfo *playerInfo;
-	float lastUpdateTime;
 };
 
 class CTestGameServer : public CBaseServerGame
 {
 	public:
-		CTestGameServer(){return;}
+		CTestGameServer(){tickStep = 1.0f/_DEFAULT_TICK_RATE; lastTickTime = 0; tick = 0;}
 		virtual	~CTestGameServer(){return;}
 
 		virtual void init ( void );
@@ -74,13 +77,18 @@ class CTestGameServer : public CBaseServerGame
 
 		// game code
 		void spawnPlayer ( int playerID );
+		void simulate ( float step );
 
 		// message senders
 		void sendClientInfo ( int playerID );
-		void sendUpdate ( int playerID );
+		void sendSnapshot ( void );
 		void sendClockPing ( int playerID, int pingID ); 
 
 		CTestWorld	world;
+
+		float		tickStep;
+		double		lastTickTime;
+		int			tick;
 };
 
 #endif //_TEST_GAME_H_
\ No newline at end of file
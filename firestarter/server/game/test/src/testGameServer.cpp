@@ -14,7 +14,9 @@
 #include "firestarterd.h"
 
 #include "messages.h"
+#include "messageSchema.h"
 #include "commandargs.h"
+#include "prefs.h"
 
 void CTestGameServer::init ( void )
 {
@@ -36,35 +38,70 @@ void CTestGameServer::init ( void )
 		logOut("loading default world","CTestGameServer::init",eLogLevel1);
 		world.initDefaultWorld();
 	}
+
+	CPrefsManager	&prefs = CPrefsManager::instance();
+
+	float tickRate = _DEFAULT_TICK_RATE;
+	if (args.Exists("tickrate"))
+		tickRate = args.GetDataF("tickrate");
+	else if (prefs.ItemExists("tickrate"))
+		tickRate = prefs.GetItemF("tickrate");
+
+	if (tickRate <= 0)
+		tickRate = _DEFAULT_TICK_RATE;
+
+	tickStep = 1.0f/tickRate;
+	lastTickTime = CTimer::instance().GetTime();
+	tick = 0;
 }
 
 bool CTestGameServer::think ( void )
+{
+	double now = CTimer::instance().GetTime();
+
+	// step the world in fixed ticks no matter how often we get called
+	int steps = 0;
+	while (now - lastTickTime >= tickStep && steps < _MAX_TICKS_PER_THINK)
+	{
+		lastTickTime += tickStep;
+		simulate(tickStep);
+		tick++;
+		steps++;
+	}
+
+	// if we fell way behind, drop the time rather than trying to catch up
+	if (now - lastTickTime >= tickStep)
+		lastTickTime = now;
+
+	// one snapshot per think, even if it took a few ticks to catch up
+	if (steps)
+		sendSnapshot();
+
+	return false;
+}
+
+void CTestGameServer::simulate ( float step )
 {
 	std::map<int,trPlayerInfo>::iterator players = users.begin();
 
 	while (players != users.end())
 	{
-		if (players->second.bot)
+		trPlayerInfo	&info = players->second;
+		if (info.bot)
+			info.bot->think(step);
+		else if (info.player)
 		{
-			if(players->second.bot->think())	// let the bot think, if it needs an update then let it FLY
-			{
-				CNetworkMessage message;
-				message.SetType(_MESSAGE_UPDATE);
-				message.AddI(players->first);
-				message.AddV(players->second.pos);
-				message.AddV(players->second.rot);
-				message.AddV(players->second.vec);
-				message.AddF(players->second.lastStamp);
-				sendToAllBut(message,players->first,false);
+			// dead reckon the clients between their updates
+			info.pos[0] += info.vec[0]*step;
+			info.pos[1] += info.vec[1]*step;
+			info.pos[2] += info.vec[2]*step;
 
-				char temp[512];
-				sprintf(temp,"update for bot ID %d for %f %f %f",players->first,players->second.pos[0],players->second.pos[1],players->second.pos[2]);
-				logOut(temp,"CTestGameServer::think ",eLogLevel5);
-			}
+			if (info.pos[2] < 0)
+				info.pos[2] = 0;
 		}
+		info.lastStamp = (float)lastTickTime;
 		players++;
 	}
-	return false;
 }
 
 void CTestGameServer::sendToAllBut ( CNetworkMessage &message, int player, bool relyable )
@@ -103,22 +140,45 @@ void CTestGameServer::sendClientInfo ( int playerID )
 	sendToAllBut(message,playerID,true);
 }
 
-void CTestGameServer::sendUpdate ( int playerID )
+void CTestGameServer::sendSnapshot ( void )
 {
-	CNetworkMessage message;
+	trSnapshotMessage	snapshot;
+	snapshot.stamp = (float)lastTickTime;
+	snapshot.tick = tick;
+	snapshot.count = 0;
 
-	std::map<int,trPlayerInfo>::iterator itr = users.find(playerID);
-	if (itr == users.end())
+	std::map<int,trPlayerInfo>::iterator itr = users.begin();
+	while (itr != users.end())
+	{
+		if (itr->second.player || itr->second.bot)
+			snapshot.count++;
+		itr++;
+	}
+
+	if (!snapshot.count)
 		return;
 
-	message.SetType(_MESSAGE_UPDATE);
-	message.AddI(playerID);
-	message.AddV(itr->second.pos);
-	message.AddV(itr->second.rot);
-	message.AddV(itr->second.vec);
-	message.AddF(itr->second.lastStamp);
+	trSnapshotPlayer	player;
 
-	sendToAllBut(message,playerID,false);
+	CNetworkMessage message;
+	message.Reserve(GetMessageSize(snapshot) + snapshot.count * GetMessageSize(player));
+	PackMessage(message,snapshot);
+
+	itr = users.begin();
+	while (itr != users.end())
+	{
+		if (itr->second.player || itr->second.bot)
+		{
+			player.playerID = (unsigned short)itr->first;
+			memcpy(player.pos,itr->second.pos,sizeof(float)*3);
+			memcpy(player.rot,itr->second.rot,sizeof(float)*3);
+			AppendMessage(message,player);
+		}
+		itr++;
+	}
+
+	// snapshots are sent unreliable, the next tick replaces a lost one anyway
+	sendToAllBut(message,-1,false);
 }
 
 void CTestGameServer::sendClockPing ( int playerID, int pingID )
@@ -180,19 +240,28 @@ bool CTestGameServer::message ( int playerID, CNetworkPeer &peer, CNetworkMessag
 
 		case _MESSAGE_UPDATE: //UD
 			logOut("receve _MESSAGE_UPDATE","CTestGameServer::message",eLogLevel5);
-			if (itr->second.player)
+			trClientUpdateMessage	update;
+			if (itr->second.player && UnpackMessage(message,update))
 			{
-				message.ReadV(itr->second.pos);
-				message.ReadV(itr->second.rot);
-				message.ReadV(itr->second.vec);
-				message.ReadV(itr->second.vec);
-				itr->second.lastStamp = message.ReadF();
+				memcpy(itr->second.pos,update.pos,sizeof(float)*3);
+				memcpy(itr->second.rot,update.rot,sizeof(float)*3);
+				memcpy(itr->second.vec,update.vec,sizeof(float)*3);
+
+				// the stamp is synced time, so bring the update up to our last tick
+				float age = (float)lastTickTime - update.stamp;
+				if (age > 0 && age < 0.5f)
+				{
+					itr->second.pos[0] += itr->second.vec[0]*age;
+					itr->second.pos[1] += itr->second.vec[1]*age;
+					itr->second.pos[2] += itr->second.vec[2]*age;
+				}
+				itr->second.lastStamp = (float)lastTickTime;
 
 				char temp[512];
 				sprintf(temp,"update from ID %d for %f %f %f",playerID,itr->second.pos[0],itr->second.pos[1],itr->second.pos[2]);
 				logOut(temp,"CTestGameServer::message",eLogLevel5);
 				
-				sendUpdate(playerID);
+				// it goes out with the next snapshot
 			}
 			break;
 
@@ -445,7 +514,6 @@ void CTestGameServer::spawnPlayer ( int playerID )
 CRobotPlayer::CRobotPlayer()
 {
 	playerInfo = NULL;
-	lastUpdateTime = -1;
 }
 
 CRobotPlayer::~CRobotPlayer()
@@ -461,19 +529,21 @@ void CRobotPlayer::init ( const char* name, const char* config, trPlayerInfo *in
 		playerInfo->material = "ht8_red";
 		playerInfo->mesh = "ht8.mesh";
 	}
-	lastUpdateTime = (float)CTimer::instance().GetTime();
 }
 
-bool CRobotPlayer::think ( void )
+void CRobotPlayer::think ( float step )
 {
 	if (!playerInfo)
-		return false;
+		return;
 
 	// some constants
 	float grav = -10.0f;
+	float spin = 30.0f;
 
 	// just make it spin
-	playerInfo->rot[2] += 0.5f;
+	playerInfo->rot[2] += spin*step;
+	if (playerInfo->rot[2] >= 360.0f)
+		playerInfo->rot[2] -= 360.0f;
 
 	// make em fall if they are all up high
 	if (playerInfo->pos[2] > 0)
@@ -485,23 +555,12 @@ bool CRobotPlayer::think ( void )
 		playerInfo->vec[2] = 0;
 
 	// apply bot physics
-	float updateTime = (float)CTimer::instance().GetFrameTime();
-	playerInfo->pos[0] += playerInfo->vec[0]*updateTime;
-	playerInfo->pos[1] += playerInfo->vec[1]*updateTime;
-	playerInfo->pos[2] += playerInfo->vec[2]*updateTime;
+	playerInfo->pos[0] += playerInfo->vec[0]*step;
+	playerInfo->pos[1] += playerInfo->vec[1]*step;
+	playerInfo->pos[2] += playerInfo->vec[2]*step;
 
-	playerInfo->lastStamp = (float)CTimer::instance().GetTime();
 	if (playerInfo->pos[2] < 0 )
 		playerInfo->pos[2] = 0;
-
-	float botUpdateTime = 1.0f/0.5f;
-	if (CTimer::instance().GetTime() - lastUpdateTime > botUpdateTime )
-	{
-		lastUpdateTime = (float)CTimer::instance().GetTime();
-		return true;
-	}
-	else
-		return false;
 }
 
 bool CRobotPlayer::message ( CNetworkMessage &message )
@@ -50,6 +50,12 @@ protected:
 	tmNetUserMap		users;
 	int							lastID;
 
+	// how often the network counters are logged, 0 for never
+	float						statsLogTime;
+	double					lastStatsLog;
+
+	void logStats ( void );
+
 	CBaseServerGame	*game;
 };
 
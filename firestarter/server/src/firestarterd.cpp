@@ -41,6 +41,15 @@ eLogLevel	eCurrentLogLevel = eLogLevel1;
 
 bool eventCycle ( void );
 
+// list server requests run in the background, this reports how they went
+class CListServerLogger : public CListServerCallback
+{
+public:
+	virtual void listServerRequestDone ( teListServerRequest request, bool success );
+};
+
+CListServerLogger	listServerLogger;
+
 //logings
 int errorOut ( const char * error, const char* place, int ret )
 {
@@ -119,11 +128,47 @@ bool getServerInfo ( void )
 	return true;
 }
 
+void CListServerLogger::listServerRequestDone ( teListServerRequest request, bool success )
+{
+	switch (request)
+	{
+		case eListServerAdd:
+			if (success)
+				logOut("List server add processed","listServerRequestDone",eLogLevel3);
+			else
+				errorOut("list server connection error","serverListServerConnection.Add(serverInfo)",0);
+			break;
+
+		case eListServerUpdate:
+			if (success)
+				logOut("list server update complete","listServerRequestDone",eLogLevel2);
+			else
+				errorOut("list server connection error","serverListServerConnection.Update(serverInfo)",0);
+			break;
+
+		case eListServerRemove:
+			if (success)
+				logOut("list server remove completed","listServerRequestDone",eLogLevel3);
+			else
+				errorOut("list server connection error","serverListServerConnection.Remove(serverInfo)",0);
+			break;
+
+		default:
+			break;
+	}
+}
+
 bool updateListServ ( void )
 {
 	if (!registerAsPublic)
 		return false;
-	
+
+	serverListServerConnection.process();
+
+	// don't stack up updates if the list server is slow
+	if (serverListServerConnection.busy())
+		return false;
+
 	if (lastListServerUpdate + listServerUpdateTime < CTimer::instance().GetTime())
 	{
 		logOut("list server update sent","updateListServ",eLogLevel1);
@@ -133,8 +178,6 @@ bool updateListServ ( void )
 		if (!serverListServerConnection.update(serverInfo))
 			return errorOut("list server connection error","serverListServerConnection.Update(serverInfo)") != 0;
 
-		logOut("list server update complete","updateListServ",eLogLevel2);
-
 		lastListServerUpdate = (float)CTimer::instance().GetTime();
 	}
 	return false;
@@ -191,9 +234,9 @@ int main (int argc, char **argv)
 	if (registerAsPublic)
 	{
 		logOut("Contacting list server","main",eLogLevel2);
+		serverListServerConnection.setCallback(&listServerLogger);
 		if (!serverListServerConnection.add(serverInfo))
 			return errorOut("list server connection error","serverListServerConnection.Add(serverInfo)");
-		logOut("List server add processed","main",eLogLevel3);
 	}
 	bool	done = false;
 	while (!done)
@@ -208,10 +251,13 @@ int main (int argc, char **argv)
 
 	if (registerAsPublic)
 	{
+		// let any update in flight finish, then wait on the remove so we are off the list before we exit
+		serverListServerConnection.wait(5.0f);
+
 		logOut("list server remove sent","main",eLogLevel2);
 		if (!serverListServerConnection.remove(serverInfo))
-			return errorOut("list server connection error","serverListServerConnection.Add(serverInfo)");
-		logOut("list server remove completed","main",eLogLevel3);
+			return errorOut("list server connection error","serverListServerConnection.Remove(serverInfo)");
+		serverListServerConnection.wait(5.0f);
 	}
 
 	serverListener.kill();
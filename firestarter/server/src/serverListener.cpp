@@ -23,12 +23,16 @@
 #include "serverListener.h"
 #include "firestarterd.h"
 #include "commandargs.h"
+#include "prefs.h"
+#include "timer.h"
 
 CServerListener::CServerListener()
 {
 	InitNetwork();
 	lastID = 0;
 	game = NULL;;
+	statsLogTime = 0;
+	lastStatsLog = 0;
 }
 
 CServerListener::~CServerListener()
@@ -46,11 +50,22 @@ bool CServerListener::init ( const char* gameType, int port, int maxListens )
 
 	game->init();
 
+	CCommandLineArgs	&args = CCommandLineArgs::instance();
+
 	server.SetMesageHandaler(this);
+	server.SetThreaded(args.Exists("netthread"));
 	server.Start(maxListens,-1,-1,port);
 
+	// log the network counters every so often
+	if (args.Exists("netstats"))
+		statsLogTime = args.GetDataF("netstats");
+	else if (CPrefsManager::instance().ItemExists("netstats"))
+		statsLogTime = CPrefsManager::instance().GetItemF("netstats");
+	else
+		statsLogTime = 60;
+	lastStatsLog = CTimer::instance().GetTime();
+
 	// add some bots
-	CCommandLineArgs	&args = CCommandLineArgs::instance();
 	if (args.Exists("robots"))
 	{
 		int bots = args.GetDataI("robots");
@@ -73,6 +88,10 @@ int CServerListener::getCurrentPlayers ( void )
 bool CServerListener::update ( void )
 {
 	server.ProcessMessages();
+
+	if (statsLogTime > 0 && CTimer::instance().GetTime() - lastStatsLog > statsLogTime)
+		logStats();
+
 	if (!game)
 		return true;
 
@@ -88,6 +107,22 @@ void CServerListener::kill ( void )
 	server.Stop();
 }
 
+void CServerListener::logStats ( void )
+{
+	const trNetStats &stats = server.GetStats();
+
+	double averageDelay = 0;
+	if (stats.messagesIn)
+		averageDelay = stats.totalReceiveDelay/stats.messagesIn;
+
+	char temp[512];
+	sprintf(temp,"network: %u messages in, %u out, receive delay %.1fms average %ums max",stats.messagesIn,stats.messagesOut,averageDelay,stats.maxReceiveDelay);
+	logOut(temp,"CServerListener::logStats",eLogLevel2);
+
+	server.ResetStats();
+	lastStatsLog = CTimer::instance().GetTime();
+}
+
 void CServerListener::OnConnect ( CNetworkPeer &peer )
 {
 	tmNetUserMap::iterator itr = users.find(&peer);
@@ -26,6 +26,7 @@ DetailSettings::DetailSettings() {
   geomorphDuration = 0.3;
   minTesselationErrorSquared = 0.5;
   maxTesselationErrorSquared = 0.6;
+  maxSplitTrianglesPerFrame = 2000;
 }
 
 
@@ -32,6 +32,11 @@ class DetailSettings {
   /* Minimum and maximum preferred tesselation error, in pixels, squared */
   float minTesselationErrorSquared;
   float maxTesselationErrorSquared;
+
+  /* Most triangles a surface may add by splitting in one refinement job (at most
+   * one job starts per frame), zero for no limit
+   */
+  int maxSplitTrianglesPerFrame;
 };
 
 #endif /* _H_DETAILSETTINGS */
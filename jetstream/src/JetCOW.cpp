@@ -33,6 +33,9 @@ class JetCOWDBException : public std::exception {
   JetCOWDBException(JetCOW *cow, DbException &e) throw() {
     s = "JetCOW database error on file " + cow->getFilename() + ": " + e.what();
   }
+  JetCOWDBException(JetCOW *cow, const char *str) throw() {
+    s = "JetCOW database error on file " + cow->getFilename() + ": " + str;
+  }
   ~JetCOWDBException() throw() {};
   virtual const char *what(void) const throw() {
     return s.c_str();
@@ -60,6 +63,13 @@ JetCOW::JetCOW(const char *filename, bool readOnly, bool create, Uint32 cacheSiz
   parent = NULL;
   this->filename = filename;
   this->readOnly = readOnly;
+  cacheLock = SDL_CreateMutex();
+  cacheBytes = 0;
+  cacheLimit = cacheSize;
+  writerCond = SDL_CreateCond();
+  writer = NULL;
+  writerBusy = false;
+  writerExit = false;
 
   try {
     dbp = new Db(NULL,0);
@@ -71,6 +81,8 @@ JetCOW::JetCOW(const char *filename, bool readOnly, bool create, Uint32 cacheSiz
   catch (DbException &e) {
     throw JetCOWDBException(this, e);
   }
+  if (!create)
+    preload(cacheSize);
 
   /* The header is a dictionary fixed at ID 0 */
   header = (JetCOWDictionary*) checkout("JetCOWDictionary",0);
@@ -102,6 +114,7 @@ JetCOW::~JetCOW() {
   if (parent)
     delete parent;
   header->unref();
+  stopWriter();
   dbp->close(0);
   if (objectInstances.size()) {
     std::map<Sint32,JetCOWObject*>::iterator i;
@@ -109,6 +122,8 @@ JetCOW::~JetCOW() {
     for (i=objectInstances.begin();i!=objectInstances.end();i++)
       printf("  %s(%d)\n", i->second->type.c_str(), i->second->id);
   }
+  SDL_DestroyCond(writerCond);
+  SDL_DestroyMutex(cacheLock);
 }
 
 /* Commit all open object instances, and flush the database to disk */
@@ -116,7 +131,17 @@ void JetCOW::flush(void) {
   std::map<Sint32,JetCOWObject*>::iterator i;
   for (i=objectInstances.begin();i!=objectInstances.end();i++)
     i->second->commit();
-  dbp->sync(0);
+  queueWrites();
+  waitForWriter();
+  throwWriterError();
+}
+
+void JetCOW::checkpoint(void) {
+  std::map<Sint32,JetCOWObject*>::iterator i;
+  for (i=objectInstances.begin();i!=objectInstances.end();i++)
+    i->second->commit();
+  queueWrites();
+  throwWriterError();
 }
 
 
@@ -146,38 +171,255 @@ const std::string &JetCOW::getFilename(void) const {
   return filename;
 }
 
-void JetCOW::put(Sint32 id, Dbt &value) {
+/* Read the database in key order into the value cache, stopping once
+ * maxBytes have been loaded. One sequential pass touches each page once,
+ * where checking out a scene object by object seeks all over the file.
+ */
+void JetCOW::preload(Uint32 maxBytes) {
+  Dbc *cursor;
+  Uint32 loaded = 0;
+
   try {
-    Dbt key;
-    id = jet_htonl(id);
-    key = Dbt(&id, sizeof(id));
-    dbp->put(NULL, &key, &value, 0);
+    Dbt key, value;
+    key.set_flags(DB_DBT_MALLOC);
+    value.set_flags(DB_DBT_MALLOC);
+    dbp->cursor(NULL, &cursor, 0);
+
+    while (loaded < maxBytes && cursor->get(&key, &value, DB_NEXT) == 0) {
+      if (key.get_size() == sizeof(s32n)) {
+	Sint32 id = jet_ntohl(*(s32n*) key.get_data());
+	cacheValue(id, std::string((char*) value.get_data(), value.get_size()), true);
+	loaded += value.get_size();
+      }
+      free(key.get_data());
+      free(value.get_data());
+    }
+    cursor->close();
   }
   catch (DbException &e) {
     throw JetCOWDBException(this, e);
   }
 }
 
-void JetCOW::get(Sint32 id, Dbt &value) {
+/* Store a value in the cache and make it the most recently used.
+ * If 'replace' is false an existing value is left alone. cacheLock must be held.
+ */
+void JetCOW::cacheValue(Sint32 id, const std::string &value, bool replace) {
+  std::map<Sint32,CacheEntry>::iterator i = valueCache.find(id);
+
+  if (i == valueCache.end()) {
+    CacheEntry &entry = valueCache[id];
+    entry.value = value;
+    cacheLRU.push_front(id);
+    entry.lru = cacheLRU.begin();
+    cacheBytes += value.size();
+    return;
+  }
+
+  if (replace) {
+    cacheBytes += value.size();
+    cacheBytes -= i->second.value.size();
+    i->second.value = value;
+  }
+  cacheLRU.splice(cacheLRU.begin(), cacheLRU, i->second.lru);
+}
+
+/* Bring the cache back under its limit by dropping clean values. With 'flush'
+ * the dirty values are handed to the writer and waited for first, so they
+ * become clean too. Nothing is dropped while a batch is still on its way to
+ * the database, since the batch may hold the only other copy of a value.
+ */
+void JetCOW::trimCache(bool flush) {
+  if (flush) {
+    queueWrites();
+    waitForWriter();
+  }
+
+  SDL_LockMutex(cacheLock);
+  if (writerBusy || !writeQueue.empty()) {
+    SDL_UnlockMutex(cacheLock);
+    return;
+  }
+
+  std::list<Sint32>::iterator i = cacheLRU.end();
+  while (cacheBytes > cacheLimit / 4 * 3 && i != cacheLRU.begin()) {
+    i--;
+    if (dirtyIDs.count(*i))
+      continue;
+
+    std::map<Sint32,CacheEntry>::iterator entry = valueCache.find(*i);
+    cacheBytes -= entry->second.value.size();
+    valueCache.erase(entry);
+    i = cacheLRU.erase(i);
+  }
+  SDL_UnlockMutex(cacheLock);
+}
+
+/* Values only go to the cache here. Read-only JetCOWs keep them in memory,
+ * everything else writes them out at the next flush() or checkpoint().
+ * Either way they stay dirty, so trimCache() can't drop them.
+ */
+void JetCOW::put(Sint32 id, const std::string &value) {
+  SDL_LockMutex(cacheLock);
+  cacheValue(id, value, true);
+  dirtyIDs.insert(id);
+  bool full = cacheBytes > cacheLimit;
+  SDL_UnlockMutex(cacheLock);
+
+  if (full)
+    trimCache(true);
+}
+
+void JetCOW::get(Sint32 id, std::string &value) {
+  SDL_LockMutex(cacheLock);
+  std::map<Sint32,CacheEntry>::iterator i = valueCache.find(id);
+  if (i != valueCache.end()) {
+    value = i->second.value;
+    cacheLRU.splice(cacheLRU.begin(), cacheLRU, i->second.lru);
+    SDL_UnlockMutex(cacheLock);
+    return;
+  }
+  SDL_UnlockMutex(cacheLock);
+
   try {
-    Dbt key;
-    id = jet_htonl(id);
-    key = Dbt(&id, sizeof(id));
-    dbp->get(NULL, &key, &value, 0);
+    Dbt key, data;
+    s32n n = jet_htonl(id);
+    key = Dbt(&n, sizeof(n));
+    data.set_flags(DB_DBT_MALLOC);
+    dbp->get(NULL, &key, &data, 0);
 
     /* If the returned value is NULL, the key didn't exist. If we're not the root JetCOW,
      * we recursively pass this request on to the parent. Otherwise, it's an error.
      */
-    if (!value.get_data()) {
-      if (parent)
+    if (!data.get_data()) {
+      if (parent) {
 	parent->get(id,value);
-      else
-	throw JetCOWFormatException(this, "Attempt to retrieve a nonexistant key");
+	return;
+      }
+      throw JetCOWFormatException(this, "Attempt to retrieve a nonexistant key");
     }
+
+    value = std::string((char*) data.get_data(), data.get_size());
+    free(data.get_data());
   }
   catch (DbException &e) {
     throw JetCOWDBException(this, e);
   }
+
+  /* Don't replace anything another thread put while we were reading */
+  SDL_LockMutex(cacheLock);
+  cacheValue(id, value, false);
+  bool full = cacheBytes > cacheLimit;
+  SDL_UnlockMutex(cacheLock);
+
+  if (full)
+    trimCache(false);
+}
+
+/* Hand everything committed since the last call to the writer thread as one batch.
+ * A batch that's still waiting just absorbs the newer values.
+ */
+void JetCOW::queueWrites(void) {
+  SDL_LockMutex(cacheLock);
+  if (dirtyIDs.empty() || readOnly) {
+    SDL_UnlockMutex(cacheLock);
+    return;
+  }
+  for (std::set<Sint32>::iterator i=dirtyIDs.begin(); i!=dirtyIDs.end(); i++)
+    writeQueue[*i] = valueCache[*i].value;
+  dirtyIDs.clear();
+
+  if (!writer)
+    writer = SDL_CreateThread(writerThread, this);
+  if (writer) {
+    SDL_CondBroadcast(writerCond);
+    SDL_UnlockMutex(cacheLock);
+    return;
+  }
+
+  /* No thread, write it here */
+  std::map<Sint32,std::string> batch;
+  batch.swap(writeQueue);
+  SDL_UnlockMutex(cacheLock);
+  writeBatch(batch);
+}
+
+void JetCOW::waitForWriter(void) {
+  SDL_LockMutex(cacheLock);
+  while (writer && (writerBusy || !writeQueue.empty()))
+    SDL_CondWait(writerCond, cacheLock);
+  SDL_UnlockMutex(cacheLock);
+}
+
+void JetCOW::throwWriterError(void) {
+  SDL_LockMutex(cacheLock);
+  std::string error = writerError;
+  writerError = "";
+  SDL_UnlockMutex(cacheLock);
+  if (error.size())
+    throw JetCOWDBException(this, error.c_str());
+}
+
+/* Write out anything left and shut down the writer thread */
+void JetCOW::stopWriter(void) {
+  queueWrites();
+  SDL_LockMutex(cacheLock);
+  writerExit = true;
+  SDL_CondBroadcast(writerCond);
+  SDL_UnlockMutex(cacheLock);
+  if (writer)
+    SDL_WaitThread(writer, NULL);
+  writer = NULL;
+
+  if (writerError.size())
+    printf("Warning - JetCOW %s: %s\n", filename.c_str(), writerError.c_str());
+}
+
+/* Put a batch in key order and sync once at the end. This usually runs on
+ * the writer thread, so errors are saved for throwWriterError().
+ */
+void JetCOW::writeBatch(std::map<Sint32,std::string> &batch) {
+  try {
+    for (std::map<Sint32,std::string>::iterator i=batch.begin(); i!=batch.end(); i++) {
+      s32n n = jet_htonl(i->first);
+      Dbt key(&n, sizeof(n));
+      Dbt value((void*) i->second.data(), i->second.size());
+      dbp->put(NULL, &key, &value, 0);
+    }
+    dbp->sync(0);
+  }
+  catch (DbException &e) {
+    SDL_LockMutex(cacheLock);
+    writerError = e.what();
+    SDL_UnlockMutex(cacheLock);
+  }
+}
+
+int JetCOW::writerThread(void *cow) {
+  ((JetCOW*) cow)->writerLoop();
+  return 0;
+}
+
+void JetCOW::writerLoop(void) {
+  SDL_LockMutex(cacheLock);
+  while (1) {
+    while (writeQueue.empty() && !writerExit)
+      SDL_CondWait(writerCond, cacheLock);
+    if (writeQueue.empty())
+      break;
+
+    std::map<Sint32,std::string> batch;
+    batch.swap(writeQueue);
+    writerBusy = true;
+    SDL_UnlockMutex(cacheLock);
+
+    writeBatch(batch);
+
+    SDL_LockMutex(cacheLock);
+    writerBusy = false;
+    SDL_CondBroadcast(writerCond);
+  }
+  SDL_UnlockMutex(cacheLock);
 }
 
 void JetCOWObject::ref(void) {
@@ -214,28 +456,23 @@ JetCOWObject::JetCOWObject(JetCOW *cow, Sint32 id, const char *type) {
 JetCOWObject::~JetCOWObject() {}
 
 void JetCOWObject::put(std::string &buffer) {
-  std::string s = type + '\0' + buffer;
-  Dbt value((void*) s.c_str(),s.size());
-  cow->put(id, value);
+  cow->put(id, type + '\0' + buffer);
 }
 
 void JetCOWObject::get(std::string &buffer, int minSize) {
-  Uint8 *valueData;
-  Dbt value;
-  value.set_flags(DB_DBT_MALLOC);
+  std::string value;
   cow->get(id, value);
-  valueData = (Uint8*) value.get_data();
 
   /* Extract the type as a C string from the beginning of the buffer,
    * so it stops at the null.
    */
-  type = std::string((char*) value.get_data());
+  type = std::string(value.c_str());
+  if (type.size() >= value.size())
+    throw JetCOWFormatException(cow, "Object has no type string");
 
   /* Extract the data right after the null and to the end of the buffer */
-  buffer =  std::string(((char *) value.get_data()) + type.size() + 1,
-			value.get_size() - type.size() - 1);
+  buffer = value.substr(type.size() + 1);
 
-  free(value.get_data());
   if (buffer.size() < minSize)
     throw JetCOWFormatException(cow, "Buffer size in object is smaller than expected");
 }
@@ -252,6 +489,22 @@ void JetCOWObject::commit(void) {
   /* Nothing to save */
 }
 
+/* Store a value, returning true if that changed anything. Saving cached values
+ * on every getAttr() would otherwise make every dictionary dirty at each commit.
+ */
+template <class T>
+static bool setValue(std::map<std::string,T> &values, const char *name, const T &value) {
+  typename std::map<std::string,T>::iterator i = values.find(name);
+  if (i == values.end()) {
+    values.insert(std::pair<std::string,T>(name, value));
+    return true;
+  }
+  if (i->second == value)
+    return false;
+  i->second = value;
+  return true;
+}
+
 JetCOWDictionary::JetCOWDictionary(JetCOW *cow, Sint32 id, const char *type) : JetCOWObject(cow,id,type) {
   if (id>0)
     revert();
@@ -338,50 +591,50 @@ void JetCOWDictionary::delAttr(char *name) {
 
 void JetCOWDictionary::setAttrProtected(char *name, int value) {
   lock();
-  intValues[name] = value;
-  dirty = true;
+  if (setValue(intValues, name, (Sint32) value))
+    dirty = true;
   unlock();
 }
 
 void JetCOWDictionary::setAttrProtected(char *name, Uint32 value) {
   lock();
-  intValues[name] = value;
-  dirty = true;
+  if (setValue(intValues, name, (Sint32) value))
+    dirty = true;
   unlock();
 }
 
 void JetCOWDictionary::setAttrProtected(char *name, char *value) {
   lock();
-  stringValues[name] = value;
-  dirty = true;
+  if (setValue(stringValues, name, std::string(value)))
+    dirty = true;
   unlock();
 }
 
 void JetCOWDictionary::setAttrProtected(char *name, const char *value) {
   lock();
-  stringValues[name] = value;
-  dirty = true;
+  if (setValue(stringValues, name, std::string(value)))
+    dirty = true;
   unlock();
 }
 
 void JetCOWDictionary::setAttrProtected(char *name, float value) {
   lock();
-  floatValues[name] = value;
-  dirty = true;
+  if (setValue(floatValues, name, (float) value))
+    dirty = true;
   unlock();
 }
 
 void JetCOWDictionary::setAttrProtected(char *name, double value) {
   lock();
-  floatValues[name] = value;
-  dirty = true;
+  if (setValue(floatValues, name, (float) value))
+    dirty = true;
   unlock();
 }
 
 void JetCOWDictionary::setAttrProtected(char *name, std::string &value) {
   lock();
-  stringValues[name] = value;
-  dirty = true;
+  if (setValue(stringValues, name, value))
+    dirty = true;
   unlock();
 }
 
@@ -411,12 +664,12 @@ float JetCOWDictionary::getAttrFloatProtected(char *name) {
 
 void JetCOWDictionary::delAttrProtected(char *name) {
   lock();
-  if (stringValues.count(name))
-    stringValues.erase(name);
-  if (intValues.count(name))
-    intValues.erase(name);
-  if (floatValues.count(name))
-    floatValues.erase(name);
+  if (stringValues.erase(name))
+    dirty = true;
+  if (intValues.erase(name))
+    dirty = true;
+  if (floatValues.erase(name))
+    dirty = true;
   unlock();
 }
 
@@ -437,6 +690,14 @@ void JetCOWDictionary::revert(void) {
   Uint8 *data;
   Uint32 dataSize;
   get(buffer);
+
+  /* Our values already came from this page */
+  if (!dirty && buffer == loadedPage) {
+    unlock();
+    loadCachedValues();
+    return;
+  }
+
   data = (Uint8*) buffer.c_str();
   dataSize = buffer.size();
 
@@ -478,7 +739,7 @@ void JetCOWDictionary::revert(void) {
 	throw JetCOWFormatException(cow, "Incomplete integer value in dictionary");
       }
 
-      setAttr(key, jet_ntohl(*(s32n*)data));
+      setAttrProtected(key, (int) jet_ntohl(*(s32n*)data));
       data += sizeof(s32n);
       dataSize -= sizeof(s32n);
     }
@@ -497,7 +758,7 @@ void JetCOWDictionary::revert(void) {
 	unlock();
 	throw JetCOWFormatException(cow, "Incomplete string value in dictionary");
       }
-      setAttr(key, stringvalue);
+      setAttrProtected(key, stringvalue);
     }
       break;
 
@@ -507,7 +768,7 @@ void JetCOWDictionary::revert(void) {
 	unlock();
 	throw JetCOWFormatException(cow, "Incomplete floating point value in dictionary");
       }
-      setAttr(key, *(float*)data);
+      setAttrProtected(key, *(float*)data);
       data += sizeof(float);
       dataSize -= sizeof(float);
     }
@@ -520,13 +781,14 @@ void JetCOWDictionary::revert(void) {
     }    
   }
 
+  loadedPage = buffer;
   dirty = false;
   unlock();
 
   loadCachedValues();
 }
 
-void JetCOWDictionary::addKeyHeader(std::string &page, std::string key, char type) {
+void JetCOWDictionary::addKeyHeader(std::string &page, const std::string &key, char type) {
   page += key;
   page += '\0';
   page += type;
@@ -546,18 +808,14 @@ void JetCOWDictionary::commit(void) {
   /* Int values */
   for (std::map<std::string,Sint32>::iterator i = intValues.begin(); i!=intValues.end(); i++) {
     u32n n = htonl(i->second);
-    char *bytes = (char*) &n;
     addKeyHeader(page, i->first, 'i');
-    for (int j=0;j<sizeof(u32n);j++)
-      page += bytes[j];
+    page.append((char*) &n, sizeof(u32n));
   }
 
   /* Float values */
   for (std::map<std::string,float>::iterator i = floatValues.begin(); i!=floatValues.end(); i++) {
-    char *bytes = (char*) &i->second;
     addKeyHeader(page, i->first, 'f');
-    for (int j=0;j<sizeof(float);j++)
-      page += bytes[j];
+    page.append((char*) &i->second, sizeof(float));
   }
 
   /* string values */
@@ -568,6 +826,7 @@ void JetCOWDictionary::commit(void) {
   }
 
   put(page);
+  loadedPage = page;
   dirty = false;
   unlock();
 }
@@ -664,6 +923,10 @@ void JetCOWVector::revert(void) {
   Uint8 *data;
   Uint32 dataSize;
   get(buffer);
+  if (!dirty && buffer == loadedPage) {
+    unlock();
+    return;
+  }
   data = (Uint8*) buffer.c_str();
   dataSize = buffer.size();
   
@@ -674,6 +937,7 @@ void JetCOWVector::revert(void) {
     dataSize -= sizeof(u32n);
   }
   
+  loadedPage = buffer;
   dirty = false;
   unlock();
 }
@@ -686,12 +950,11 @@ void JetCOWVector::commit(void) {
   
   for (i=vec.begin(); i!=vec.end(); i++) {
     u32n n = jet_htonl((*i)->id);
-    char *bytes = (char*) &n;
-    for (int j=0;j<sizeof(u32n);j++)
-      page += bytes[j];
+    page.append((char*) &n, sizeof(u32n));
   }
   
   put(page);
+  loadedPage = page;
   dirty = false;
   unlock();
 }
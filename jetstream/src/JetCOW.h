@@ -25,13 +25,14 @@
 
 #include <string>
 #include <map>
+#include <set>
+#include <list>
 #include <exception>
 #include <vector>
 #include "Util.h"
 #include "Mutex.h"
 
 class Db;
-class Dbt;
 class JetCOWObject;
 class JetCOWDictionary;
 class SceneNode;
@@ -57,6 +58,12 @@ class Scene;
  *   "Generation"        - The number of times this JetCOW has been forked
  *   "ParentFilename"    - Path and filename of the parent JetCOW if Generation > 0
  *   "ParentVersion"     - The contentVersion of the parent JetCOW if Generation > 0
+ *
+ * Writes are cached: committing an object only stores its new value in memory, and
+ * the database sees it when the JetCOW is flushed or checkpointed. When an existing
+ * file is opened, up to cacheSize bytes of it are read into the same cache in one
+ * sequential pass, so checking out a scene doesn't seek through the B-tree for
+ * every node. The cache never holds much more than cacheSize bytes; see valueCache.
  */
 class JetCOW {
   friend class JetCOWObject;
@@ -95,6 +102,11 @@ class JetCOW {
   /* Commit all open object instances, and flush the database to disk */
   virtual void flush(void);
 
+  /* Commit all open object instances and return right away, leaving a background
+   * thread to write them to the database. Use this to save while animating.
+   */
+  void checkpoint(void);
+
   JetCOWDictionary *getHeader(void);
 
  private:
@@ -105,9 +117,48 @@ class JetCOW {
   JetCOW *parent;
   std::map<Sint32,JetCOWObject*> objectInstances;
 
-  /* For the JetCOWObject's use: */
-  void put(Sint32 id, Dbt &value);
-  void get(Sint32 id, Dbt &value);
+  /* The latest value of every object we've read or written, and the IDs
+   * that haven't been written to the database yet. Protected by cacheLock.
+   *
+   * The values are limited to cacheLimit bytes, the cacheSize given to the
+   * constructor. When a put() or get() goes over, the least recently used
+   * clean values are dropped until the cache is back under 3/4 of the limit,
+   * and put() flushes the dirty values first so they can go too. Dropped
+   * values are read from the database again if they're needed. Values
+   * committed to a read-only JetCOW are never dropped, they only exist here.
+   */
+  struct CacheEntry {
+    std::string value;
+    std::list<Sint32>::iterator lru;
+  };
+  std::map<Sint32,CacheEntry> valueCache;
+  std::list<Sint32> cacheLRU;    /* Most recently used first */
+  Uint32 cacheBytes, cacheLimit;
+  std::set<Sint32> dirtyIDs;
+  SDL_mutex *cacheLock;
+
+  /* Batches for the background writer, also protected by cacheLock */
+  std::map<Sint32,std::string> writeQueue;
+  SDL_Thread *writer;
+  SDL_cond *writerCond;
+  bool writerBusy;
+  bool writerExit;
+  std::string writerError;
+
+  void preload(Uint32 maxBytes);
+  void cacheValue(Sint32 id, const std::string &value, bool replace);
+  void trimCache(bool flush);
+  void queueWrites(void);
+  void waitForWriter(void);
+  void throwWriterError(void);
+  void stopWriter(void);
+  void writeBatch(std::map<Sint32,std::string> &batch);
+  static int writerThread(void *cow);
+  void writerLoop(void);
+
+  /* For the JetCOWObject's use. Values include the object type string. */
+  void put(Sint32 id, const std::string &value);
+  void get(Sint32 id, std::string &value);
 };
 
 
@@ -206,10 +257,15 @@ class JetCOWDictionary : public JetCOWObject, public Mutex {
   void delAttrProtected(char *name);
  
  private:
-  void addKeyHeader(std::string &page, std::string key, char type);
+  void addKeyHeader(std::string &page, const std::string &key, char type);
   std::map<std::string,Sint32> intValues;            /* Stored here in host byte order */
   std::map<std::string,std::string> stringValues;
   std::map<std::string,float> floatValues;
+
+  /* The page the values above were last loaded from or committed to. While
+   * we're not dirty, reverting to the same page doesn't need to decode it again.
+   */
+  std::string loadedPage;
 };
 
 
@@ -227,6 +283,7 @@ class JetCOWVector : public JetCOWObject, private Mutex {
 
  private:
   void clearAndUnref(void);
+  std::string loadedPage;
 };
 
 #endif /* _H_JETCOW */
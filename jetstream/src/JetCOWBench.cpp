@@ -0,0 +1,182 @@
+/*
+ * JetCOWBench.cpp - Offline benchmark for JetCOW scene load and commit
+ *
+ * Copyright (C) 2002-2004 Micah Dowty and David Trowbridge
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ * 
+ */
+
+/* Builds a scene-like file of dictionaries, then times reopening and
+ * checking it out, flushing and checkpointing frames where some of the
+ * nodes moved, and doing all that again with a cache much smaller than
+ * the scene. Every value read back is checked against what was written.
+ *
+ * usage: cowbench [file] [nodes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+#include "JetCOW.h"
+
+#define BENCH_FRAMES       20
+#define BENCH_SMALL_CACHE  (64*1024)
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static float nodePosition(int node, int frame) {
+  return node * 0.25f + frame;
+}
+
+static void moveNode(JetCOWDictionary *d, int node, int frame) {
+  d->setAttr("X", nodePosition(node, frame));
+  d->setAttr("Frame", frame);
+}
+
+/* Create the file, one dictionary per node with a few typical attributes */
+static void createScene(const char *filename, int nodes, std::vector<Sint32> &ids) {
+  JetCOW *cow = new JetCOW(filename, false, true);
+  char name[32];
+
+  ids.clear();
+  for (int i=0; i<nodes; i++) {
+    JetCOWDictionary *d = cow->newDict("JetCOWDictionary");
+    sprintf(name, "node%d", i);
+    d->setAttr("Name", name);
+    d->setAttr("Y", 1.0f);
+    d->setAttr("Z", -1.0f);
+    d->setAttr("Visible", 1);
+    moveNode(d, i, 0);
+    ids.push_back(d->id);
+    d->unref();
+  }
+  cow->flush();
+  delete cow;
+}
+
+static void checkout(JetCOW *cow, std::vector<Sint32> &ids, std::vector<JetCOWDictionary*> &dicts) {
+  dicts.clear();
+  for (unsigned int i=0; i<ids.size(); i++)
+    dicts.push_back(cow->checkoutDict(ids[i]));
+}
+
+static void release(std::vector<JetCOWDictionary*> &dicts) {
+  for (unsigned int i=0; i<dicts.size(); i++)
+    dicts[i]->unref();
+  dicts.clear();
+}
+
+/* Count the nodes that don't have the values the last frame wrote */
+static int verify(std::vector<JetCOWDictionary*> &dicts, std::vector<int> &frames) {
+  int errors = 0;
+  for (unsigned int i=0; i<dicts.size(); i++) {
+    if (dicts[i]->getAttrInt("Frame") != frames[i] ||
+	dicts[i]->getAttrFloat("X") != nodePosition(i, frames[i]))
+      errors++;
+  }
+  return errors;
+}
+
+/* Move every tenth node, starting at a different one each frame, and
+ * return the average time spent in flush() or checkpoint().
+ */
+static double runFrames(JetCOW *cow, std::vector<JetCOWDictionary*> &dicts,
+			std::vector<int> &frames, int firstFrame, bool checkpoint) {
+  double total = 0;
+  for (int f=firstFrame; f<firstFrame+BENCH_FRAMES; f++) {
+    for (unsigned int i=f%10; i<dicts.size(); i+=10) {
+      moveNode(dicts[i], i, f);
+      frames[i] = f;
+    }
+    double start = now();
+    if (checkpoint)
+      cow->checkpoint();
+    else
+      cow->flush();
+    total += now() - start;
+  }
+  return total / BENCH_FRAMES;
+}
+
+/* Reopen, check out and verify the whole scene, then run frames over it */
+static int runScene(const char *filename, std::vector<Sint32> &ids, std::vector<int> &frames,
+		    Uint32 cacheSize, int &firstFrame) {
+  std::vector<JetCOWDictionary*> dicts;
+  int errors;
+
+  double start = now();
+  JetCOW *cow = new JetCOW(filename, false, false, cacheSize);
+  checkout(cow, ids, dicts);
+  double loadTime = now() - start;
+  errors = verify(dicts, frames);
+
+  double flushTime = runFrames(cow, dicts, frames, firstFrame, false);
+  firstFrame += BENCH_FRAMES;
+  double checkpointTime = runFrames(cow, dicts, frames, firstFrame, true);
+  firstFrame += BENCH_FRAMES;
+
+  release(dicts);
+  delete cow;
+
+  /* Everything must have made it to disk */
+  cow = new JetCOW(filename, true, false, cacheSize);
+  checkout(cow, ids, dicts);
+  errors += verify(dicts, frames);
+  release(dicts);
+  delete cow;
+
+  printf("  %8d byte cache: load %7.1f ms, flush/frame %6.2f ms, checkpoint/frame %6.2f ms\n",
+	 cacheSize, loadTime * 1000, flushTime * 1000, checkpointTime * 1000);
+  return errors;
+}
+
+int main(int argc, char **argv) {
+  const char *filename = argc > 1 ? argv[1] : "cowbench.db";
+  int nodes = argc > 2 ? atoi(argv[2]) : 6000;
+  if (nodes < 1) {
+    printf("usage: %s [file] [nodes]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<Sint32> ids;
+  std::vector<int> frames(nodes, 0);
+  int firstFrame = 1, errors = 0;
+
+  try {
+    double start = now();
+    createScene(filename, nodes, ids);
+    printf("%d nodes, created and flushed in %.1f ms\n", nodes, (now() - start) * 1000);
+
+    errors += runScene(filename, ids, frames, 4*1024*1024, firstFrame);
+    errors += runScene(filename, ids, frames, BENCH_SMALL_CACHE, firstFrame);
+  }
+  catch (std::exception &e) {
+    printf("%s\n", e.what());
+    return 1;
+  }
+
+  if (errors)
+    printf("%d nodes DID NOT read back what was written\n", errors);
+  remove(filename);
+  return errors ? 1 : 0;
+}
+
+/* The End */
@@ -20,12 +20,16 @@
  */
 
 #include "Mutex.h"
+#include <stdlib.h>
 
 Mutex::Mutex() {
   mutex = SDL_CreateMutex();
+  cond = NULL;
 }
 
 Mutex::~Mutex() {
+  if (cond)
+    SDL_DestroyCond(cond);
   SDL_DestroyMutex(mutex);
 }
 
@@ -37,5 +41,17 @@ void Mutex::unlock(void) const {
   SDL_mutexV(mutex);
 }
 
+void Mutex::wait(void) const {
+  /* Only ever touched with the mutex held, so lazy creation is safe */
+  if (!cond)
+    cond = SDL_CreateCond();
+  SDL_CondWait(cond, mutex);
+}
+
+void Mutex::broadcast(void) const {
+  if (cond)
+    SDL_CondBroadcast(cond);
+}
+
 
 /* The End */
@@ -34,8 +34,18 @@ class Mutex {
   void lock(void) const;
   void unlock(void) const;
 
+  /* A condition variable that goes with the mutex. wait() must be called
+   * with the mutex locked; it unlocks while sleeping and relocks before
+   * returning. broadcast() wakes every waiter.
+   */
+  void wait(void) const;
+  void broadcast(void) const;
+
  private:
   SDL_mutex *mutex;
+
+  /* Created the first time someone waits, most mutexes never need one */
+  mutable SDL_cond *cond;
 };
 
 #endif /* _H_MUTEX */
@@ -26,6 +26,10 @@
 #include "Noise.h"
 #include "Util.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 void PerlinNoise3::set(int seed, int octaves, float persistence, int logTableSize) {
   gradTable = std::vector<Vector3>(1<<logTableSize);
@@ -278,6 +282,200 @@ Vector3 PerlinNoise3::getGradient(const Vector3 &point) {
   return result;
 }
 
+void PerlinNoise3::getValues(const Vector3 *points, float *values, int count) {
+  getValuesAndGradients(points, values, NULL, count);
+}
+
+void PerlinNoise3::getValuesAndGradients(const Vector3 *points, float *values,
+                                         Vector3 *gradients, int count) {
+  int i;
+
+  for (i=0; i<count; i++) {
+    values[i] = 0;
+    if (gradients)
+      gradients[i].zero();
+  }
+
+#ifdef __SSE2__
+  /* Groups of four go through the SSE2 path, one point per lane. A short
+   * group at the end is padded out by repeating its last point, since
+   * a split only generates three new vertices.
+   */
+  for (i=0; i<count; i+=4) {
+    const Vector3 *p = points+i;
+    float *v = values+i;
+    Vector3 *g = gradients ? gradients+i : NULL;
+    Vector3 padPoints[4], padGradients[4];
+    float padValues[4];
+    int n = count-i < 4 ? count-i : 4;
+
+    if (n < 4) {
+      for (int k=0; k<4; k++) {
+        padPoints[k] = points[i + (k<n ? k : n-1)];
+        padValues[k] = 0;
+        padGradients[k].zero();
+      }
+      p = padPoints;
+      v = padValues;
+      g = gradients ? padGradients : NULL;
+    }
+
+    float fundamental = 1;
+    float amplitude = 1;
+    for (int o=0; o<octaves; o++) {
+      smoothNoiseBatch4(p, fundamental, amplitude, v, g);
+      fundamental *= 2;
+      amplitude *= persistence;
+    }
+
+    if (n < 4) {
+      for (int k=0; k<n; k++) {
+        values[i+k] = padValues[k];
+        if (gradients)
+          gradients[i+k] = padGradients[k];
+      }
+    }
+  }
+#else
+  for (i=0; i<count; i++) {
+    float fundamental = 1;
+    float amplitude = 1;
+
+    for (int o=0; o<octaves; o++) {
+      Vector3 p = points[i] * fundamental;
+      values[i] += smoothNoise3(p) * amplitude;
+      if (gradients)
+        gradients[i] += smoothNoiseGradient3(p) * amplitude;
+      fundamental *= 2;
+      amplitude *= persistence;
+    }
+  }
+#endif
+}
+
+#ifdef __SSE2__
+/* One octave of smoothNoise3 and smoothNoiseGradient3 for four points,
+ * accumulated into values and gradients. The arithmetic is done in the same
+ * order as the scalar versions so the results match them. That includes the
+ * smoothing derivative, which smoothNoiseGradient3 calculates from r0 for all
+ * three axes.
+ */
+void PerlinNoise3::smoothNoiseBatch4(const Vector3 *points, float scale, float amplitude,
+                                     float *values, Vector3 *gradients) {
+  /* Corner order is 000, 001, 010, 011, 100, 101, 110, 111 (x,y,z) */
+  static const int cornerOffset[8] = {
+    0, 127, 95, 95+127, 1, 1+127, 1+95, 1+95+127,
+  };
+  __m128 gx[8], gy[8], gz[8], i[8];
+  __m128 vscale = _mm_set1_ps(scale);
+  __m128 one = _mm_set1_ps(1.0f);
+
+  __m128 px = _mm_mul_ps(_mm_set_ps(points[3][0], points[2][0], points[1][0], points[0][0]), vscale);
+  __m128 py = _mm_mul_ps(_mm_set_ps(points[3][1], points[2][1], points[1][1], points[0][1]), vscale);
+  __m128 pz = _mm_mul_ps(_mm_set_ps(points[3][2], points[2][2], points[1][2], points[0][2]), vscale);
+
+  /* floor(), by truncating then stepping down where that rounded up */
+  __m128i ix = _mm_cvttps_epi32(px);
+  __m128i iy = _mm_cvttps_epi32(py);
+  __m128i iz = _mm_cvttps_epi32(pz);
+  ix = _mm_add_epi32(ix, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(ix), px)));
+  iy = _mm_add_epi32(iy, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(iy), py)));
+  iz = _mm_add_epi32(iz, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(iz), pz)));
+
+  /* Table index of the 000 corner, x + y*95 + z*127 without a 32-bit multiply */
+  __m128i base = _mm_add_epi32(ix, _mm_sub_epi32(_mm_sub_epi32(_mm_slli_epi32(iy,7), _mm_slli_epi32(iy,5)), iy));
+  base = _mm_add_epi32(base, _mm_sub_epi32(_mm_slli_epi32(iz,7), iz));
+  int b[4];
+  _mm_storeu_si128((__m128i*) b, base);
+
+  /* Vectors from the grid points to the points we're evaluating */
+  __m128 vx0 = _mm_sub_ps(px, _mm_cvtepi32_ps(ix));
+  __m128 vy0 = _mm_sub_ps(py, _mm_cvtepi32_ps(iy));
+  __m128 vz0 = _mm_sub_ps(pz, _mm_cvtepi32_ps(iz));
+  __m128 vx1 = _mm_sub_ps(px, _mm_add_ps(_mm_cvtepi32_ps(ix), one));
+  __m128 vy1 = _mm_sub_ps(py, _mm_add_ps(_mm_cvtepi32_ps(iy), one));
+  __m128 vz1 = _mm_sub_ps(pz, _mm_add_ps(_mm_cvtepi32_ps(iz), one));
+
+  /* Gather the gradients and take the dot products */
+  for (int c=0; c<8; c++) {
+    const float *g0 = gradTable[(b[0] + cornerOffset[c]) & tableMask].get();
+    const float *g1 = gradTable[(b[1] + cornerOffset[c]) & tableMask].get();
+    const float *g2 = gradTable[(b[2] + cornerOffset[c]) & tableMask].get();
+    const float *g3 = gradTable[(b[3] + cornerOffset[c]) & tableMask].get();
+    gx[c] = _mm_set_ps(g3[0], g2[0], g1[0], g0[0]);
+    gy[c] = _mm_set_ps(g3[1], g2[1], g1[1], g0[1]);
+    gz[c] = _mm_set_ps(g3[2], g2[2], g1[2], g0[2]);
+
+    __m128 vx = (c & 4) ? vx1 : vx0;
+    __m128 vy = (c & 2) ? vy1 : vy0;
+    __m128 vz = (c & 1) ? vz1 : vz0;
+    i[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(gx[c],vx), _mm_mul_ps(gy[c],vy)), _mm_mul_ps(gz[c],vz));
+  }
+
+  /* Cubic interpolation in three dimensions */
+  __m128 two = _mm_set1_ps(2.0f);
+  __m128 three = _mm_set1_ps(3.0f);
+  __m128 s0 = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(three,vx0),vx0), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(two,vx0),vx0),vx0));
+  __m128 s1 = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(three,vy0),vy0), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(two,vy0),vy0),vy0));
+  __m128 s2 = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(three,vz0),vz0), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(two,vz0),vz0),vz0));
+
+#define LERP(a, b, s) _mm_add_ps(a, _mm_mul_ps(s, _mm_sub_ps(b, a)))
+  __m128 ax00 = LERP(i[0], i[4], s0);
+  __m128 ax01 = LERP(i[1], i[5], s0);
+  __m128 ax10 = LERP(i[2], i[6], s0);
+  __m128 ax11 = LERP(i[3], i[7], s0);
+  __m128 ay0  = LERP(ax00, ax10, s1);
+  __m128 ay1  = LERP(ax01, ax11, s1);
+  __m128 az   = LERP(ay0, ay1, s2);
+
+  __m128 vamp = _mm_set1_ps(amplitude);
+  _mm_storeu_ps(values, _mm_add_ps(_mm_loadu_ps(values), _mm_mul_ps(az, vamp)));
+
+  if (!gradients)
+    return;
+
+  /* Derivative of the smoothing polynomial, the terms that are multiplied
+   * by a zero derivative in smoothNoiseGradient3 are left out.
+   */
+  __m128 ds = _mm_mul_ps(_mm_set1_ps(6.0f), _mm_sub_ps(vx0, _mm_mul_ps(vx0,vx0)));
+
+  /* Partial derivative with respect to x */
+  __m128 ax00_dx = _mm_add_ps(_mm_add_ps(gx[0], _mm_mul_ps(ds, _mm_sub_ps(i[4],i[0]))), _mm_mul_ps(s0, _mm_sub_ps(gx[4],gx[0])));
+  __m128 ax01_dx = _mm_add_ps(_mm_add_ps(gx[1], _mm_mul_ps(ds, _mm_sub_ps(i[5],i[1]))), _mm_mul_ps(s0, _mm_sub_ps(gx[5],gx[1])));
+  __m128 ax10_dx = _mm_add_ps(_mm_add_ps(gx[2], _mm_mul_ps(ds, _mm_sub_ps(i[6],i[2]))), _mm_mul_ps(s0, _mm_sub_ps(gx[6],gx[2])));
+  __m128 ax11_dx = _mm_add_ps(_mm_add_ps(gx[3], _mm_mul_ps(ds, _mm_sub_ps(i[7],i[3]))), _mm_mul_ps(s0, _mm_sub_ps(gx[7],gx[3])));
+  __m128 ay0_dx  = LERP(ax00_dx, ax10_dx, s1);
+  __m128 ay1_dx  = LERP(ax01_dx, ax11_dx, s1);
+  __m128 rx      = LERP(ay0_dx, ay1_dx, s2);
+
+  /* Partial derivative with respect to y */
+  __m128 ax00_dy = LERP(gy[0], gy[4], s0);
+  __m128 ax01_dy = LERP(gy[1], gy[5], s0);
+  __m128 ax10_dy = LERP(gy[2], gy[6], s0);
+  __m128 ax11_dy = LERP(gy[3], gy[7], s0);
+  __m128 ay0_dy  = _mm_add_ps(LERP(ax00_dy, ax10_dy, s1), _mm_mul_ps(ds, _mm_sub_ps(ax10,ax00)));
+  __m128 ay1_dy  = _mm_add_ps(LERP(ax01_dy, ax11_dy, s1), _mm_mul_ps(ds, _mm_sub_ps(ax11,ax01)));
+  __m128 ry      = LERP(ay0_dy, ay1_dy, s2);
+
+  /* Partial derivative with respect to z */
+  __m128 ax00_dz = LERP(gz[0], gz[4], s0);
+  __m128 ax01_dz = LERP(gz[1], gz[5], s0);
+  __m128 ax10_dz = LERP(gz[2], gz[6], s0);
+  __m128 ax11_dz = LERP(gz[3], gz[7], s0);
+  __m128 ay0_dz  = LERP(ax00_dz, ax10_dz, s1);
+  __m128 ay1_dz  = LERP(ax01_dz, ax11_dz, s1);
+  __m128 rz      = _mm_add_ps(LERP(ay0_dz, ay1_dz, s2), _mm_mul_ps(ds, _mm_sub_ps(ay1,ay0)));
+#undef LERP
+
+  float gxOut[4], gyOut[4], gzOut[4];
+  _mm_storeu_ps(gxOut, _mm_mul_ps(rx, vamp));
+  _mm_storeu_ps(gyOut, _mm_mul_ps(ry, vamp));
+  _mm_storeu_ps(gzOut, _mm_mul_ps(rz, vamp));
+  for (int k=0; k<4; k++)
+    gradients[k] += Vector3(gxOut[k], gyOut[k], gzOut[k]);
+}
+#endif /* __SSE2__ */
+
 
 /* The End */
 
@@ -35,6 +35,16 @@ class PerlinNoise3 {
   float getValue(const Vector3 &point);
   Vector3 getGradient(const Vector3 &point);
 
+  /* Batched versions of the above, for 'count' points at once.
+   * These give the same results as getValue and getGradient, but share
+   * the lattice lookups between the value and gradient and evaluate
+   * four points at a time with SSE2 when it's available.
+   * 'gradients' may be NULL if only the values are needed.
+   */
+  void getValues(const Vector3 *points, float *values, int count);
+  void getValuesAndGradients(const Vector3 *points, float *values,
+                             Vector3 *gradients, int count);
+
   float persistence;
   int octaves;
   int seed;
@@ -47,6 +57,8 @@ class PerlinNoise3 {
   inline Vector3 &tableNoise3(int x, int y, int z);
   inline float smoothNoise3(const Vector3 &point);
   inline Vector3 smoothNoiseGradient3(const Vector3 &point);
+  void smoothNoiseBatch4(const Vector3 *points, float scale, float amplitude,
+                         float *values, Vector3 *gradients);
 };
 
 #endif /* _H_NOISE */
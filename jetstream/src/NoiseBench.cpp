@@ -0,0 +1,137 @@
+/*
+ * NoiseBench.cpp - Offline benchmark for batched Perlin noise
+ *
+ * Copyright (C) 2002-2004 Micah Dowty and David Trowbridge
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ * 
+ */
+
+/* Runs the noise the way PerlinDisplacement does during surface splits,
+ * once through getValue/getGradient per point and once through
+ * getValuesAndGradients in split-sized batches, and checks that both
+ * paths agree.
+ *
+ * usage: noisebench [points] [octaves]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include "Noise.h"
+
+/* The largest difference we accept between the scalar and batched
+ * paths. With -ffast-math the two can round differently.
+ */
+#define NOISE_TOLERANCE 1e-3
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* Midpoints on a displaced sphere, like the ones a SphereGenerator
+ * hands to PerlinDisplacement, scaled by a typical fundamental.
+ */
+static void makePoints(Vector3 *points, int count) {
+  srand(1234);
+  for (int i=0; i<count; i++) {
+    Vector3 p(rand()/(float)RAND_MAX - 0.5f,
+              rand()/(float)RAND_MAX - 0.5f,
+              rand()/(float)RAND_MAX - 0.5f);
+    if (p.length() < 0.001f)
+      p.set(1,0,0);
+    p.normalize();
+    points[i] = p * 4.0f;
+  }
+}
+
+/* Time the batched path in groups of 'batch' points */
+static double runBatched(PerlinNoise3 &noise, Vector3 *points, float *values,
+                         Vector3 *grads, int count, int batch) {
+  double start = now();
+  for (int i=0; i<count; i+=batch) {
+    int n = count-i < batch ? count-i : batch;
+    noise.getValuesAndGradients(points+i, values+i, grads+i, n);
+  }
+  return now() - start;
+}
+
+static float maxError(float *values, Vector3 *grads, float *refValues,
+                      Vector3 *refGrads, int count) {
+  float err = 0;
+  for (int i=0; i<count; i++) {
+    float e = fabs(values[i] - refValues[i]);
+    if (e > err) err = e;
+    e = (grads[i] - refGrads[i]).length();
+    if (e > err) err = e;
+  }
+  return err;
+}
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 200000;
+  int octaves = argc > 2 ? atoi(argv[2]) : 6;
+  if (count < 1 || octaves < 1) {
+    printf("usage: %s [points] [octaves]\n", argv[0]);
+    return 1;
+  }
+
+  PerlinNoise3 noise;
+  noise.set(42, octaves, 0.5);
+
+  Vector3 *points = new Vector3[count];
+  Vector3 *refGrads = new Vector3[count];
+  Vector3 *grads = new Vector3[count];
+  float *refValues = new float[count];
+  float *values = new float[count];
+  makePoints(points, count);
+
+  double start = now();
+  for (int i=0; i<count; i++) {
+    refValues[i] = noise.getValue(points[i]);
+    refGrads[i] = noise.getGradient(points[i]);
+  }
+  double scalarTime = now() - start;
+
+  /* A split generates at most three midpoints at once */
+  double splitTime = runBatched(noise, points, values, grads, count, 3);
+  float splitError = maxError(values, grads, refValues, refGrads, count);
+
+  double wideTime = runBatched(noise, points, values, grads, count, 16);
+  float wideError = maxError(values, grads, refValues, refGrads, count);
+
+  printf("%d points, %d octaves\n", count, octaves);
+  printf("  getValue + getGradient:     %7.1f ns/point\n", scalarTime * 1e9 / count);
+  printf("  batched, 3 point splits:    %7.1f ns/point (%.2fx), max error %g\n",
+         splitTime * 1e9 / count, scalarTime / splitTime, splitError);
+  printf("  batched, 16 point batches:  %7.1f ns/point (%.2fx), max error %g\n",
+         wideTime * 1e9 / count, scalarTime / wideTime, wideError);
+
+  bool ok = splitError <= NOISE_TOLERANCE && wideError <= NOISE_TOLERANCE;
+  if (!ok)
+    printf("batched noise DOES NOT match the scalar path\n");
+
+  delete[] points;
+  delete[] refGrads;
+  delete[] grads;
+  delete[] refValues;
+  delete[] values;
+  return ok ? 0 : 1;
+}
+
+/* The End */
@@ -0,0 +1,132 @@
+/*
+ * ParticleBench.cpp - Offline benchmark for the particle system
+ *
+ * Copyright (C) 2002-2004 Micah Dowty and David Trowbridge
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ * 
+ */
+
+/* Keeps a particle system full with a point emitter and a linear force,
+ * and times animate() and draw() per frame at 10k and 100k particles.
+ * Drawing needs a GL context, so this opens a small SDL window.
+ *
+ * usage: particlebench [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <SDL/SDL.h>
+#include "JetCOW.h"
+#include "ParticleSystem.h"
+
+#define BENCH_FILE "particlebench.db"
+#define BENCH_DT   (1.0f / 60.0f)
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* Live particles must be packed at the front and none of them may be dead */
+static bool checkParticles(ParticleSystem *ps) {
+  if (ps->count < 0 || ps->count > ps->size)
+    return false;
+  for (int i=0; i<ps->count; i++)
+    if (ps->ttl[i] <= 0.0f)
+      return false;
+  return true;
+}
+
+static bool runSystem(JetCOW *cow, int particles, int frames) {
+  ParticleSystem *ps = (ParticleSystem*) cow->newSceneNode("ParticleSystem");
+  ps->setAttr("Size", particles);
+
+  /* Emit just fast enough to keep the system full */
+  ParticleEmitterPoint emitter;
+  emitter.direction[2] = 1;
+  emitter.angle = 0.5f;
+  emitter.minSpeed = 1;
+  emitter.maxSpeed = 2;
+  emitter.minTTL = 1;
+  emitter.maxTTL = 2;
+  emitter.rate = particles / 1.5f;
+  emitter.colorStart[0] = emitter.colorStart[3] = 1;
+  emitter.colorEnd[1] = emitter.colorEnd[3] = 1;
+  ps->attach(&emitter);
+
+  ParticleAffectorLinearForce gravity;
+  gravity.force[2] = -9.8f;
+  ps->attach(&gravity);
+
+  /* Fill it up before timing */
+  for (int i=0; i<120; i++)
+    ps->animate(BENCH_DT);
+
+  double animateTime = 0, drawTime = 0;
+  bool ok = true;
+  for (int i=0; i<frames; i++) {
+    double start = now();
+    ps->animate(BENCH_DT);
+    double mid = now();
+    ps->draw();
+    glFinish();
+    drawTime += now() - mid;
+    animateTime += mid - start;
+    ok = ok && checkParticles(ps);
+  }
+
+  printf("  %6d particles (%6d live): animate %7.3f ms, draw %7.3f ms per frame\n",
+	 particles, ps->count, animateTime * 1000 / frames, drawTime * 1000 / frames);
+
+  ps->unref();
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 300;
+  if (frames < 1) {
+    printf("usage: %s [frames]\n", argv[0]);
+    return 1;
+  }
+
+  if (SDL_Init(SDL_INIT_VIDEO) < 0 || !SDL_SetVideoMode(256, 256, 0, SDL_OPENGL)) {
+    printf("Can't open a GL window: %s\n", SDL_GetError());
+    return 1;
+  }
+
+  bool ok = true;
+  try {
+    JetCOW *cow = new JetCOW(BENCH_FILE, false, true);
+    printf("%d frames\n", frames);
+    ok = runSystem(cow, 10000, frames) && ok;
+    ok = runSystem(cow, 100000, frames) && ok;
+    delete cow;
+  }
+  catch (std::exception &e) {
+    printf("%s\n", e.what());
+    ok = false;
+  }
+  remove(BENCH_FILE);
+  SDL_Quit();
+
+  if (!ok)
+    printf("particle arrays DID NOT stay packed\n");
+  return ok ? 0 : 1;
+}
+
+/* The End */
@@ -53,9 +53,9 @@ ParticleEmitter::~ParticleEmitter() {
 
 void ParticleEmitter::create(ParticleSystem *system, float time) {
   int numParticles = createConstantEmissionCount(time);
-  Particle *p;
-  for(int i = 0; (i < numParticles) && (system->findEmptySlot(p)); i++) {
-    createParticle(p);
+  int slot;
+  for(int i = 0; (i < numParticles) && ((slot = system->newParticle()) >= 0); i++) {
+    createParticle(system, slot);
   }
 }
 
@@ -105,29 +105,6 @@ void ParticleEmitter::createColor(GLfloat color[4]) {
     color[3] = colorStart[3];
 }
 
-void ParticleEmitter::createColorSame(GLfloat color1[4], GLfloat color2[4], GLfloat color3[4]) {
-  // red
-  if(colorStart[0] != colorEnd[0])
-    color1[0] = color2[0] = color3[0] = colorStart[0] + (rand01() * (colorEnd[0] - colorStart[0]));
-  else
-    color1[0] = color2[0] = color3[0] = colorStart[0];
-  // green
-  if(colorStart[1] != colorEnd[1])
-    color1[1] = color2[1] = color3[1] = colorStart[1] + (rand01() * (colorEnd[1] - colorStart[1]));
-  else
-    color1[1] = color2[1] = color3[1] = colorStart[1];
-  // blue
-  if(colorStart[2] != colorEnd[2])
-    color1[2] = color2[2] = color3[2] = colorStart[2] + (rand01() * (colorEnd[2] - colorStart[2]));
-  else
-    color1[2] = color2[2] = color3[2] = colorStart[2];
-  // alpha
-  if(colorStart[3] != colorEnd[3])
-    color1[3] = color2[3] = color3[3] = colorStart[3] + (rand01() * (colorEnd[3] - colorStart[3]));
-  else
-    color1[3] = color2[3] = color3[3] = colorStart[3];
-}
-
 void ParticleEmitter::createTTL(GLfloat &ttl) {
   if(minTTL != maxTTL)
     ttl = minTTL + (rand01() * (maxTTL - minTTL));
@@ -146,7 +123,8 @@ unsigned short ParticleEmitter::createConstantEmissionCount(float time) {
 }
 
 ParticleSystem::ParticleSystem(JetCOW *cow, Sint32 id, const char *type) : SceneNode(cow,id,type) {
-  particles = NULL;
+  particleData = NULL;
+  count = 0;
   size = 0;
 
   if (id<0) {
@@ -171,14 +149,31 @@ void ParticleSystem::loadCachedValues(void) {
 
  if (newSize != size) {
    size = newSize;
-   if (particles)
-     delete [] particles;
+   count = 0;
+   if (particleData)
+     delete [] particleData;
    if (size) {
-     particles = new Particle[size];
-     bzero(particles, sizeof(Particle) * size);
+     particleData = new GLfloat[size * numComponents];
+     bzero(particleData, sizeof(GLfloat) * size * numComponents);
    }
    else
-     particles = NULL;
+     particleData = NULL;
+
+   GLfloat *component = particleData;
+   for (int i=0; i<3; i++, component += size)
+     position[i] = component;
+   for (int i=0; i<3; i++, component += size)
+     velocity[i] = component;
+   for (int i=0; i<4; i++, component += size)
+     color[i] = component;
+   ttl = component;
+   component += size;
+   particleSize = component;
+
+   /* Allocate all the billboard vertices now, so drawing never resizes the buffer */
+   billboards = VertexBuffer<BufferedVertex>();
+   for (int i=0; i<size*3; i++)
+     billboards.alloc();
  }
 
  std::string billboardMethodStr = getAttrStrProtected("BillboardMethod");
@@ -203,8 +198,8 @@ void ParticleSystem::saveCachedValues(void) {
 }
 
 ParticleSystem::~ParticleSystem() {
-  if (particles)
-    delete [] particles;
+  if (particleData)
+    delete [] particleData;
 }
 
 void ParticleSystem::animate(float dt) {
@@ -218,29 +213,36 @@ void ParticleSystem::animate(float dt) {
   for(; it != emitters.end(); it++)
     (*it)->create(this, dt);
   }
-  for(int i = 0; i < size; i++) {
-    if(particles[i].alive != 0.0f) {
-      particles[i].ttl -= dt;
-      if(particles[i].ttl <= 0.0f)
-	bzero(&particles[i], sizeof(Particle));
-    }
-    if(particles[i].alive != 0.0f) {
-      Vector3 poschange(particles[i].velocity); poschange *= dt;
-      Vector3 position(particles[i].position); position += poschange;
-      position.fillGL(particles[i].position);
-    }
+
+  GLfloat *t = ttl;
+  for(int i = 0; i < count; i++)
+    t[i] -= dt;
+  for(int i = 0; i < count;) {
+    if(t[i] <= 0.0f)
+      killParticle(i);
+    else
+      i++;
+  }
+
+  for(int j = 0; j < 3; j++) {
+    GLfloat *p = position[j];
+    const GLfloat *v = velocity[j];
+    for(int i = 0; i < count; i++)
+      p[i] += v[i] * dt;
   }
 }
 
 void ParticleSystem::draw() {
+  if (!count)
+    return;
   recalculatePolygons();
 
   glEnable(GL_COLOR_MATERIAL);
   glDisable(GL_LIGHTING);
   glDisable(GL_TEXTURE_2D);
   glDisable(GL_CULL_FACE);
-  glInterleavedArrays(GL_T2F_C4F_N3F_V3F, sizeof(Particle) / 3, particles);
-  glDrawArrays(GL_TRIANGLES, 0, size * 3);
+  billboards.bind();
+  glDrawArrays(GL_TRIANGLES, 0, count * 3);
   glDisable(GL_COLOR_MATERIAL);
 }
 
@@ -252,14 +254,29 @@ void ParticleSystem::attach(ParticleEmitter *emitter) {
   emitters.push_back(emitter);
 }
 
-bool ParticleSystem::findEmptySlot(Particle *&p) {
-  for(int i = 0; i < size; i++) {
-    if(particles[i].alive == 0.0f) {
-      p = &(particles[i]);
-      return true;
-    }
+int ParticleSystem::newParticle() {
+  if(count >= size)
+    return -1;
+  return count++;
+}
+
+void ParticleSystem::setParticle(int i, const GLfloat position[3], const GLfloat velocity[3],
+				 const GLfloat color[4], GLfloat ttl, GLfloat particleSize) {
+  for(int j = 0; j < 3; j++) {
+    this->position[j][i] = position[j];
+    this->velocity[j][i] = velocity[j];
   }
-  return false;
+  for(int j = 0; j < 4; j++)
+    this->color[j][i] = color[j];
+  this->ttl[i] = ttl;
+  this->particleSize[i] = particleSize;
+}
+
+/* Move the last live particle into this slot */
+void ParticleSystem::killParticle(int i) {
+  count--;
+  for(GLfloat *component = particleData; component < particleData + size * numComponents; component += size)
+    component[i] = component[count];
 }
 
 void ParticleSystem::recalculatePolygons() {
@@ -285,19 +302,28 @@ void ParticleSystem::recalculatePolygons() {
       std::cerr << "ERROR - billboarding method unset\n";
       exit(1);
   }
-  Vector3 t1, t2, t3, v1, v2, v3;
-  t1 = (-right * 0.866f) - (up * 0.5f);
-  t2 = (right * 0.866f) - (up * 0.5f);
-  t3 = up;
-  for(int i = 0; i < size; i++) {
-    if(particles[i].alive != 0.0f) {
-      Vector3 p(particles[i].position);
-      v1 = (-(right * particles[i].size) * 0.866f) - ((up * particles[i].size) * 0.5f) + p;
-      v2 = ((right * particles[i].size) * 0.866f) - ((up * particles[i].size) * 0.5f) + p;
-      v3 = (up * particles[i].size) + p;
-      v1.fillGL(particles[i].vertex1);
-      v2.fillGL(particles[i].vertex2);
-      v3.fillGL(particles[i].vertex3);
+
+  /* Corner offsets for a unit triangle, scaled by each particle's size */
+  Vector3 c1 = (right * 0.866f) - (up * 0.5f);
+  Vector3 c2 = (right * -0.866f) - (up * 0.5f);
+  Vector3 c3 = up;
+  const GLfloat *px = position[0], *py = position[1], *pz = position[2];
+  const GLfloat *cr = color[0], *cg = color[1], *cb = color[2], *ca = color[3];
+
+  for(int i = 0; i < count; i++) {
+    /* Load everything first, the compiler can't tell the arrays and the buffer apart */
+    float x = px[i], y = py[i], z = pz[i], s = particleSize[i];
+    float r = cr[i], g = cg[i], b = cb[i], a = ca[i];
+    BufferedVertex *v = &billboards[i*3];
+
+    v[0].vertex.set(x + c1[0]*s, y + c1[1]*s, z + c1[2]*s);
+    v[1].vertex.set(x + c2[0]*s, y + c2[1]*s, z + c2[2]*s);
+    v[2].vertex.set(x + c3[0]*s, y + c3[1]*s, z + c3[2]*s);
+    for(int j = 0; j < 3; j++) {
+      v[j].color[0] = r;
+      v[j].color[1] = g;
+      v[j].color[2] = b;
+      v[j].color[3] = a;
     }
   }
 }
@@ -308,17 +334,17 @@ ParticleEmitterPoint::ParticleEmitterPoint() {
 ParticleEmitterPoint::~ParticleEmitterPoint() {
 }
 
-void ParticleEmitterPoint::createParticle(Particle *p) {
-  createPosition(p->position);
-  createVelocity(p->velocity);
-  createColorSame(p->color1, p->color2, p->color3);
-  createTTL(p->ttl);
-  p->alive = 1.0f;
-  p->size = 0.1f;
+void ParticleEmitterPoint::createParticle(ParticleSystem *system, int i) {
+  GLfloat position[3], velocity[3], color[4], ttl;
+  createPosition(position);
+  createVelocity(velocity);
+  createColor(color);
+  createTTL(ttl);
+  system->setParticle(i, position, velocity, color, ttl, 0.1f);
 }
   
 ParticleAffectorLinearForce::ParticleAffectorLinearForce() {
-  force[0] = force[1] = force[2];
+  force[0] = force[1] = force[2] = 0;
 }
 
 ParticleAffectorLinearForce::~ParticleAffectorLinearForce() {
@@ -329,10 +355,10 @@ void ParticleAffectorLinearForce::affect(ParticleSystem *system, float time) {
   dv[0] = force[0] * time;
   dv[1] = force[1] * time;
   dv[2] = force[2] * time;
-  for(int i = 0; i < system->size; i++) {
-    system->particles[i].velocity[0] += dv[0];
-    system->particles[i].velocity[1] += dv[1];
-    system->particles[i].velocity[2] += dv[2];
+  for(int j = 0; j < 3; j++) {
+    GLfloat *v = system->velocity[j];
+    for(int i = 0; i < system->count; i++)
+      v[i] += dv[j];
   }
 }
 
@@ -25,36 +25,15 @@
 #include "Util.h"
 #include "Scene.h"
 #include "Vector.h"
+#include "VertexBuffer.h"
 #include <GL/gl.h>
 #include <vector>
 
 class ParticleSystem;
 
-struct Particle {
-  // this structure is designed to be tightly packed in an array
-  // for use with the vertex/color/texcoord array functions.
-
-  GLfloat	texcoord1[2];
-  GLfloat	color1[4];
-  GLfloat	normal1[3];
-  GLfloat	vertex1[3];
-  GLfloat	position[3];
-
-  GLfloat	texcoord2[2];
-  GLfloat	color2[4];
-  GLfloat	normal2[3];
-  GLfloat	vertex2[3];
-  GLfloat	velocity[3];
-
-  GLfloat	texcoord3[2];
-  GLfloat	color3[4];
-  GLfloat	normal3[3];
-  GLfloat	vertex3[3];
-  GLfloat	alive;			// floats make the best bools
-  GLfloat	ttl;
-  GLfloat	size;
-} STRUCT_PACK;
-
+/* Affectors get the whole system at once, and should work on one
+ * component array at a time over the live particles so the loops vectorize.
+ */
 class ParticleAffector {
   public:
     				ParticleAffector();
@@ -83,11 +62,10 @@ class ParticleEmitter {
     float			colorEnd[4];
 
   protected:
-    virtual void		createParticle(Particle *p) = 0;
+    virtual void		createParticle(ParticleSystem *system, int i) = 0;
     void			createPosition(GLfloat position[3]);
     void			createVelocity(GLfloat velocity[3]);
     void			createColor(GLfloat color[4]);
-    void			createColorSame(GLfloat color1[4], GLfloat color2[4], GLfloat color3[4]);
     void			createTTL(GLfloat &ttl);
     unsigned short		createConstantEmissionCount(float time);
 
@@ -102,14 +80,26 @@ class ParticleSystem : public SceneNode {
     void			attach(ParticleAffector *affector);
     void			attach(ParticleEmitter *emitter);
 
-    bool			findEmptySlot(Particle *&p);
+    /* Returns the slot for a new particle, or -1 if the system is full */
+    int				newParticle();
+    void			setParticle(int i, const GLfloat position[3], const GLfloat velocity[3],
+					    const GLfloat color[4], GLfloat ttl, GLfloat particleSize);
 
     /* Attributes:
      *     Size            - Number of particles 
      *     BillboardMethod - A string, "Spherical" or "Cylindrical"
      */
 
-    Particle			*particles;
+    /* Particles are stored with one array per component. Live particles are
+     * packed into the first 'count' slots, and the rest up to 'size' are free;
+     * when a particle dies the last live one is moved into its slot.
+     */
+    GLfloat			*position[3];
+    GLfloat			*velocity[3];
+    GLfloat			*color[4];
+    GLfloat			*ttl;
+    GLfloat			*particleSize;
+    int				count;
     int				size;        /* Read-only, the size can be changed
 					      * by setting the "Size" attribute */
 
@@ -123,6 +113,14 @@ class ParticleSystem : public SceneNode {
     std::vector<ParticleAffector*>	affectors;
     std::vector<ParticleEmitter*>	emitters;
 
+    /* All the component arrays live in one allocation */
+    GLfloat			*particleData;
+    enum {numComponents = 12};
+    void			killParticle(int i);
+
+    /* Three vertices per particle, written by recalculatePolygons() */
+    VertexBuffer<BufferedVertex>	billboards;
+
     void			recalculatePolygons();
 
     enum {Spherical, Cylindrical}	billboardmethod;
@@ -134,7 +132,7 @@ class ParticleEmitterPoint : public ParticleEmitter {
     virtual			~ParticleEmitterPoint();
 
   protected:
-    virtual void		createParticle(Particle *p);
+    virtual void		createParticle(ParticleSystem *system, int i);
 };
 
 class ParticleAffectorLinearForce : public ParticleAffector {
@@ -71,17 +71,33 @@ void PerlinDisplacement::saveCachedValues(void) {
 }
 
 void PerlinDisplacement::f(SurfacePoint &p, SurfaceQuadtreeNode *qn) {
-  Vector3 oldVertex = p.vertex;
-  Vector3 param = oldVertex * fundamental;
-  float noiseValue = noise.getValue(param);
+  Vector3 param = p.vertex * fundamental;
+  displace(p, noise.getValue(param), noise.getGradient(param));
+}
+
+/* Same as f(), but the noise for all the points is evaluated in one batch */
+void PerlinDisplacement::fArray(SurfacePoint **points, int count, SurfaceQuadtreeNode *qn) {
+  Vector3 params[16], grads[16];
+  float values[16];
+
+  for (int i=0; i<count; i+=16) {
+    int n = count-i < 16 ? count-i : 16;
+
+    for (int j=0; j<n; j++)
+      params[j] = points[i+j]->vertex * fundamental;
+    noise.getValuesAndGradients(params, values, grads, n);
+    for (int j=0; j<n; j++)
+      displace(*points[i+j], values[j], grads[j]);
+  }
+}
 
+void PerlinDisplacement::displace(SurfacePoint &p, float noiseValue, const Vector3 &grad) {
   p.vertex += p.normal * (noiseValue * amplitude);
 
   /* The gradient of the noise function is perpendicular to an isosurface
    * in the noise field through the original vertex. We can use this to
-   * calculate the final normal of our surface:
+   * calculate the final normal of our surface.
    */
-  Vector3 grad = noise.getGradient(param);
 
   /* Get two vectors perpendicular to the original normal */
   Vector3 n1 = p.normal;
@@ -33,6 +33,7 @@ class PerlinDisplacement : public SurfaceModifier {
   virtual void generateBoundingSphere(Vector3 &center, float &radius);
   virtual void updateBounds(SurfaceQuadtreeNode *n, Surface *s);
   virtual void f(SurfacePoint &p, SurfaceQuadtreeNode *qn);
+  virtual void fArray(SurfacePoint **points, int count, SurfaceQuadtreeNode *qn);
 
   /* Dictionary keys: 
    *    Fundamental  - Fundamental frequency of the noise
@@ -48,6 +49,8 @@ class PerlinDisplacement : public SurfaceModifier {
   virtual void saveCachedValues(void);  
 
  protected:
+  void displace(SurfacePoint &p, float noiseValue, const Vector3 &grad);
+
   PerlinNoise3 noise;
   float amplitude, fundamental;
 };
@@ -49,6 +49,7 @@ BOOST_PYTHON_MODULE(JetEngine)
     .def_readwrite("geomorphDuration", &DetailSettings::geomorphDuration)
     .def_readwrite("minTesselationErrorSquared", &DetailSettings::minTesselationErrorSquared)
     .def_readwrite("maxTesselationErrorSquared", &DetailSettings::maxTesselationErrorSquared)
+    .def_readwrite("maxSplitTrianglesPerFrame", &DetailSettings::maxSplitTrianglesPerFrame)
     ;
 
   class_<Engine>("Engine")
@@ -83,6 +84,7 @@ BOOST_PYTHON_MODULE(JetEngine)
     .def_readwrite("rtjpeg", &VideoRecorder::rtjpeg)
     .def_readwrite("lzo", &VideoRecorder::lzo)
     .def_readwrite("rgb", &VideoRecorder::rgb)
+    .def_readwrite("throttle", &VideoRecorder::throttle)
     ;
 
 
@@ -137,6 +139,7 @@ BOOST_PYTHON_MODULE(JetEngine)
     .def(init<const char *,bool,bool,Uint32>())
     .def(init<const char *,bool,bool,Uint32,Uint32>())
     .def("flush", &JetCOW::flush)
+    .def("checkpoint", &JetCOW::checkpoint)
     .def("fork", &JetCOW::fork,
 	 return_value_policy<reference_existing_object>())
     .def("getHeader", &JetCOW::getHeader,
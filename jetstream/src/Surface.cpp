@@ -67,6 +67,14 @@
 //#define SURFACE_SPLIT_ONLY		/* Reset the mesh each frame */
 //#define DEBUG_NORMALS      		/* Show vertex normals */
 #define DISABLE_GEOMORPHING		/* Don't geomorph when splitting and merging */
+//#define DISABLE_REFINEMENT_THREAD	/* Split and merge on the render thread */
+
+/* The debug drawing walks the quadtrees and makes GL calls from addTriangles(),
+ * so it can't have them changing on another thread.
+ */
+#if defined(DEBUG_RENDERING) || defined(DEBUG_NORMALS)
+#define DISABLE_REFINEMENT_THREAD
+#endif
 
 
 #include "Engine.h"
@@ -132,9 +140,7 @@ void SurfacePoint::morphReset(void) {
   morphBackwards = false;
 }
 
-bool SurfacePoint::morph(float dt) {
-  float duration = Engine::getInstance()->detail.geomorphDuration;
-
+bool SurfacePoint::morph(float dt, float duration) {
   if (duration > 0) {
     morphWeight += dt / duration;
     if (morphWeight > 1)
@@ -186,12 +192,91 @@ bool SurfaceEdge::operator < (const SurfaceEdge &v) const {
 }
 
 
+/***************************************************************** Node heap ***/
+
+SurfaceNodeHeap::SurfaceNodeHeap(bool maxFirst_) {
+  maxFirst = maxFirst_;
+}
+
+void SurfaceNodeHeap::push(SurfaceQuadtreeNode *n) {
+  n->heap = this;
+  nodes.push_back(n);
+  n->heapIndex = nodes.size() - 1;
+  siftUp(n->heapIndex);
+}
+
+void SurfaceNodeHeap::remove(SurfaceQuadtreeNode *n) {
+  int i = n->heapIndex;
+  assert(n->heap == this);
+  assert(nodes[i] == n);
+
+  SurfaceQuadtreeNode *last = nodes.back();
+  nodes.pop_back();
+  n->heap = NULL;
+
+  /* Move the last node into the hole, it may need to go either direction */
+  if (last != n) {
+    place(i, last);
+    siftUp(i);
+    siftDown(last->heapIndex);
+  }
+}
+
+void SurfaceNodeHeap::clear(void) {
+  for (std::vector<SurfaceQuadtreeNode*>::iterator i=nodes.begin(); i!=nodes.end(); i++)
+    (*i)->heap = NULL;
+  nodes.clear();
+}
+
+void SurfaceNodeHeap::rebuild(void) {
+  for (int i=(int) nodes.size()/2 - 1; i>=0; i--)
+    siftDown(i);
+}
+
+void SurfaceNodeHeap::place(int i, SurfaceQuadtreeNode *n) {
+  nodes[i] = n;
+  n->heapIndex = i;
+}
+
+void SurfaceNodeHeap::siftUp(int i) {
+  SurfaceQuadtreeNode *n = nodes[i];
+  while (i > 0) {
+    int parent = (i-1) / 2;
+    if (!before(n, nodes[parent]))
+      break;
+    place(i, nodes[parent]);
+    i = parent;
+  }
+  place(i, n);
+}
+
+void SurfaceNodeHeap::siftDown(int i) {
+  int count = nodes.size();
+  SurfaceQuadtreeNode *n = nodes[i];
+  while (1) {
+    int child = i*2 + 1;
+    if (child >= count)
+      break;
+    if (child+1 < count && before(nodes[child+1], nodes[child]))
+      child++;
+    if (!before(nodes[child], n))
+      break;
+    place(i, nodes[child]);
+    i = child;
+  }
+  place(i, n);
+}
+
+
 /***************************************************************** Quadtree node ***/
 
 SurfaceQuadtreeNode::SurfaceQuadtreeNode() {
   memset(&vertices, 0, sizeof(vertices));
   memset(&neighbors, 0, sizeof(neighbors));
   memset(&children, 0, sizeof(children));
+  heap = NULL;
+  heapIndex = 0;
+  priority = 0;
   depth = 0;
 }
 
@@ -217,7 +302,9 @@ SurfaceQuadtreeNode::SurfaceQuadtreeNode(VertexBuffer<SurfacePoint> &vbuffer,
 
   memset(&neighbors, 0, sizeof(neighbors));
   memset(&children, 0, sizeof(children));
-  list = NULL;
+  heap = NULL;
+  heapIndex = 0;
+  priority = 0;
   unsplittable = false;
   culled = false;
   parent = NULL;
@@ -231,7 +318,9 @@ SurfaceQuadtreeNode::SurfaceQuadtreeNode(SurfaceQuadtreeNode *parent_,
   vertices[c] = c_;
   memset(&neighbors, 0, sizeof(neighbors));
   memset(&children, 0, sizeof(children));
-  list = NULL;
+  heap = NULL;
+  heapIndex = 0;
+  priority = 0;
   parent = parent_;
   culled = false;
   unsplittable = false;
@@ -247,7 +336,7 @@ const SurfaceQuadtreeNode::sideInfoStruct SurfaceQuadtreeNode::sideInfo[3] = {
   { c,a },
 };
 
-void SurfaceQuadtreeNode::draw(Surface *s) {
+void SurfaceQuadtreeNode::addTriangles(Surface *s) {
   unsigned int t[6];
 
   /* Fix T-vertices on the following sides: */
@@ -262,7 +351,7 @@ void SurfaceQuadtreeNode::draw(Surface *s) {
 	t[3] = vertices[b];
 	t[4] = neighbors[bc].n->children[sideInfo[neighbors[bc].side].v1]->vertices[sideInfo[neighbors[bc].side].v2];
 	t[5] = vertices[c];
-	s->vbuffer.draw(GL_TRIANGLE_FAN, t, 6);
+	s->addFan(t, 6);
       }
       else {
 	/* ab, bc */
@@ -271,7 +360,7 @@ void SurfaceQuadtreeNode::draw(Surface *s) {
 	t[2] = neighbors[bc].n->children[sideInfo[neighbors[bc].side].v1]->vertices[sideInfo[neighbors[bc].side].v2];
 	t[3] = vertices[c];
 	t[4] = vertices[a];
-	s->vbuffer.draw(GL_TRIANGLE_FAN, t, 5);
+	s->addFan(t, 5);
       }
     }
     else {
@@ -282,7 +371,7 @@ void SurfaceQuadtreeNode::draw(Surface *s) {
 	t[2] = vertices[c];
 	t[3] = neighbors[ca].n->children[sideInfo[neighbors[ca].side].v1]->vertices[sideInfo[neighbors[ca].side].v2];
 	t[4] = vertices[a];
-	s->vbuffer.draw(GL_TRIANGLE_FAN, t, 5);
+	s->addFan(t, 5);
       }
       else {
 	/* ab */
@@ -290,7 +379,7 @@ void SurfaceQuadtreeNode::draw(Surface *s) {
 	t[1] = vertices[a];
 	t[2] = neighbors[ab].n->children[sideInfo[neighbors[ab].side].v1]->vertices[sideInfo[neighbors[ab].side].v2];
 	t[3] = vertices[b];
-	s->vbuffer.draw(GL_TRIANGLE_FAN, t, 4);
+	s->addFan(t, 4);
       }
     }
   }
@@ -303,7 +392,7 @@ void SurfaceQuadtreeNode::draw(Surface *s) {
 	t[2] = neighbors[ca].n->children[sideInfo[neighbors[ca].side].v1]->vertices[sideInfo[neighbors[ca].side].v2];
 	t[3] = vertices[a];
 	t[4] = vertices[b];
-	s->vbuffer.draw(GL_TRIANGLE_FAN, t, 5);
+	s->addFan(t, 5);
       }
       else {
 	/* bc */
@@ -311,7 +400,7 @@ void SurfaceQuadtreeNode::draw(Surface *s) {
 	t[1] = vertices[b];
 	t[2] = neighbors[bc].n->children[sideInfo[neighbors[bc].side].v1]->vertices[sideInfo[neighbors[bc].side].v2];
 	t[3] = vertices[c];
-	s->vbuffer.draw(GL_TRIANGLE_FAN, t, 4);
+	s->addFan(t, 4);
       }
     }
     else {
@@ -321,11 +410,11 @@ void SurfaceQuadtreeNode::draw(Surface *s) {
 	t[1] = vertices[c];
 	t[2] = neighbors[ca].n->children[sideInfo[neighbors[ca].side].v1]->vertices[sideInfo[neighbors[ca].side].v2];
 	t[3] = vertices[a];
-	s->vbuffer.draw(GL_TRIANGLE_FAN, t, 4);
+	s->addFan(t, 4);
       }
       else {
 	/* (none) */
-	s->vbuffer.draw(GL_TRIANGLES, vertices, 3);
+	s->addFan(vertices, 3);
       }
     }
   }
@@ -476,24 +565,50 @@ void SurfaceQuadtreeNode::split(Surface *s) {
   }
 
   /* Acquire midpoint vertices for each side */
+  bool generated[3];
+  int numGenerated = 0;
   for (int i=ab; i<=ca; i++) {
-    if (neighbors[i].n && neighbors[i].n->children[sideInfo[neighbors[i].side].v1]) {
+    generated[i] = !(neighbors[i].n && neighbors[i].n->children[sideInfo[neighbors[i].side].v1]);
+    if (!generated[i]) {
       /* This midpoint already exists in our neighbor's children, create a reference to it */
       midpoints[i] = neighbors[i].n->children[sideInfo[neighbors[i].side].v1]->vertices[sideInfo[neighbors[i].side].v2];
       s->vbuffer.ref(midpoints[i]);
     }
     else {
-      /* Generate a new midpoint */
       midpoints[i] = s->vbuffer.alloc();
-      SurfacePoint &p = s->vbuffer[midpoints[i]];
+      numGenerated++;
+    }
+  }
+
+  /* Generate all the new midpoints in one call, so the generator can share
+   * work between them. This has to wait until the allocs are done, since
+   * they can move the vertex buffer.
+   */
+  SurfacePoint current1[3], current2[3];
+  if (numGenerated) {
+    SurfacePoint *from1[3], *from2[3], *to[3];
+    int n = 0;
 
-      SurfacePoint current1 = s->vbuffer[vertices[sideInfo[i].v1]];
-      SurfacePoint current2 = s->vbuffer[vertices[sideInfo[i].v2]];
+    for (int i=ab; i<=ca; i++) {
+      if (!generated[i])
+	continue;
+      current1[i] = s->vbuffer[vertices[sideInfo[i].v1]];
+      current2[i] = s->vbuffer[vertices[sideInfo[i].v2]];
 
       /* This should be using 'parameter' rather than the vertex's position, so we
        * don't want to give it surfaceInterpolation.
        */
-      s->generator->generateMidpoint(current1, current2, p, this);
+      from1[n] = &current1[i];
+      from2[n] = &current2[i];
+      to[n] = &s->vbuffer[midpoints[i]];
+      n++;
+    }
+    s->generator->generateMidpoints(from1, from2, to, n, this);
+  }
+
+  for (int i=ab; i<=ca; i++) {
+    if (generated[i]) {
+      SurfacePoint &p = s->vbuffer[midpoints[i]];
 
       if (s->enableGeomorphing && !culled) {
 	/* We use geomorphing to cover up the appearance of new vertices.
@@ -503,7 +618,7 @@ void SurfaceQuadtreeNode::split(Surface *s) {
 	 * we just calculated a midpoint for.
 	 */
 	p.surfaceInterpolation = p;
-	p.interpolate(current1, current2, 0.5);
+	p.interpolate(current1[i], current2[i], 0.5);
 	p.linearInterpolation = p;
 	p.morphWeight = 0.0;
 	p.morphBackwards = false;
@@ -734,20 +849,17 @@ void SurfaceQuadtreeNode::mergeEnqueue(Surface *s) {
     enqueue(s->MergeAbove);
 }
 
-void SurfaceQuadtreeNode::enqueue(std::list<SurfaceQuadtreeNode*> &l) {
-  //  DBG("this=%p in list %p\n",this,&l);
+void SurfaceQuadtreeNode::enqueue(SurfaceNodeHeap &h) {
+  //  DBG("this=%p in heap %p\n",this,&h);
 
   assert(isEnqueued() == false);
-  l.push_front(this);
-  iter = l.begin();
-  list = &l;
+  h.push(this);
 }
 
 void SurfaceQuadtreeNode::dequeue(void) {
-  //  DBG("this=%p from list %p\n",this,list);
+  //  DBG("this=%p from heap %p\n",this,heap);
   assert(isEnqueued() == true);
-  list->erase(iter);
-  list = NULL;
+  heap->remove(this);
 }
 
 void SurfaceQuadtreeNode::enqueueMergeBelow(Surface *s) {
@@ -771,10 +883,10 @@ bool SurfaceQuadtreeNode::isLeaf() {
 }
 
 bool SurfaceQuadtreeNode::isEnqueued() {
-  if (list) {
-    assert(*iter == this);
+  if (heap) {
+    assert((*heap)[heapIndex] == this);
   }
-  return list != NULL;
+  return heap != NULL;
 }
 
 bool SurfaceQuadtreeNode::isMergable() {
@@ -799,7 +911,7 @@ bool SurfaceQuadtreeNode::isMergable() {
 }
 
 void SurfaceQuadtreeNode::cull(Surface *s) {
-  ViewingFrustum *frustum = ViewingFrustum::getInstance();
+  ViewingFrustum *frustum = &s->refineFrustum;
 
   switch (s->boundingSphere.frustumCode) {
 
@@ -867,7 +979,7 @@ float SurfaceQuadtreeNode::getPriority(Surface *s) {
   /* Update culling, culled triangles should always merge if they can */
   cull(s);
   if (culled || unsplittable)
-    return -1;
+    return priority = -1;
 
   /* The goal of this priority function is to limit the apparent error in the
    * final rendering. This method computes the thickness of the triangle's
@@ -880,7 +992,7 @@ float SurfaceQuadtreeNode::getPriority(Surface *s) {
    *       resulting errorSquared value.
    */
 
-  ViewingFrustum *frustum = ViewingFrustum::getInstance();
+  ViewingFrustum *frustum = &s->refineFrustum;
   const int *viewport = frustum->getViewport();
   Vector3 front = frustum->getModelview() * (centroid + planeNormal * bounds.front);
   Vector3 back  = frustum->getModelview() * (centroid - planeNormal * bounds.back);
@@ -890,14 +1002,20 @@ float SurfaceQuadtreeNode::getPriority(Surface *s) {
 
   /* FIXME: kludge to work around infinite subdivision bug */
   if (depth > 6)
-    return -1;
+    return priority = -1;
 
+  /* Outside the error margins, scale the priority by how far out we are so
+   * the heaps can split the worst triangles first. Merge priorities are
+   * in [-1,0), split priorities are anything above zero.
+   */
   float errorSquared = (pfront - pback).length2();
-  if (errorSquared < Engine::getInstance()->detail.minTesselationErrorSquared)
-    return -1;
-  if (errorSquared > Engine::getInstance()->detail.maxTesselationErrorSquared)
-    return 1;
-  return 0;
+  float minError = s->refineDetail.minTesselationErrorSquared;
+  float maxError = s->refineDetail.maxTesselationErrorSquared;
+  if (errorSquared < minError)
+    return priority = errorSquared / minError - 1;
+  if (errorSquared > maxError)
+    return priority = errorSquared / maxError - 1;
+  return priority = 0;
 }
 
 
@@ -912,7 +1030,6 @@ void Surface::reset() {
   prepareMesh();
   generator->generateBoundingSphere(boundingSphere.center, boundingSphere.radius);
   numTriangles = trees.size();
-  seedInvalidated = false;
 
   /* Clear the diamond stacks */
   SplitAbove.clear();
@@ -931,31 +1048,35 @@ void Surface::reset() {
 }
 
 void Surface::reprioritize() {
-  std::list<SurfaceQuadtreeNode*>::iterator i;
-  SurfaceQuadtreeNode *j;
-
-  /* Pass through SplitBelow, requeue in SplitAbove if necessary */
-  for (i=SplitBelow.begin(); i!=SplitBelow.end();) {
-    if ((*i)->getPriority(this) > 0) {
-      j = *i;
-      i++;
-      j->dequeue();
-      j->enqueue(SplitAbove);
-    }
-    else
-      i++;
+  SurfaceQuadtreeNode *n;
+
+  /* Anything the triangle budget left in SplitAbove goes back to be reconsidered */
+  while (!SplitAbove.empty()) {
+    n = SplitAbove.top();
+    n->dequeue();
+    n->enqueue(SplitBelow);
   }
 
-  /* Pass through MergeAbove, requeue in MergeBelow if necessary */
-  for (i=MergeAbove.begin(); i!=MergeAbove.end();) {
-    if ((*i)->getPriority(this) < 0) {
-      j = *i;
-      i++;
-      j->dequeue();
-      j->enqueueMergeBelow(this);
-    }
-    else
-      i++;
+  /* Refresh priorities in SplitBelow, and move everything that
+   * needs splitting into SplitAbove, highest priority first.
+   */
+  for (int i=0; i<SplitBelow.size(); i++)
+    SplitBelow[i]->getPriority(this);
+  SplitBelow.rebuild();
+  while (!SplitBelow.empty() && SplitBelow.top()->priority > 0) {
+    n = SplitBelow.top();
+    n->dequeue();
+    n->enqueue(SplitAbove);
+  }
+
+  /* Same for MergeAbove, moving nodes to MergeBelow lowest priority first */
+  for (int i=0; i<MergeAbove.size(); i++)
+    MergeAbove[i]->getPriority(this);
+  MergeAbove.rebuild();
+  while (!MergeAbove.empty() && MergeAbove.top()->priority < 0) {
+    n = MergeAbove.top();
+    n->dequeue();
+    n->enqueueMergeBelow(this);
   }
 }
 
@@ -966,39 +1087,52 @@ void Surface::draw() {
   for (i=trees.begin();i!=trees.end();i++)
     i->drawDebug(this);
 #else
-  /* Draw the nodes in SplitBelow */
-  std::list<SurfaceQuadtreeNode*>::iterator i;
-  vbuffer.bind();
+  /* Draw what the last finished refinement job built. The quadtrees and
+   * vbuffer may be changing on the refinement thread, so leave them alone.
+   */
+  drawBuffers[frontBuffer].bind();
   generator->push();
-  for (i=SplitBelow.begin();i!=SplitBelow.end();i++)
-    if (!(*i)->culled)
-      (*i)->draw(this);
+  drawBuffers[frontBuffer].draw();
   generator->pop();
 #endif
+}
 
-#ifdef DEBUG_FILE
-  static long t = SDL_GetTicks();
-  if (SDL_GetTicks() > t+1000) {
-    t = SDL_GetTicks();
-    DBG("-- Surface stats --\n"
-	"  Triangles: %d\n"
-	" SplitAbove: %d\n"
-	" MergeAbove: %d\n"
-	" SplitBelow: %d\n"
-	" MergeBelow: %d\n"
-	"    vbuffer: %.2f%% utilization (%d used / %d allocated)\n"
-	"\n", numTriangles, 
-	SplitAbove.size(), MergeAbove.size(), 
-	SplitBelow.size(), MergeBelow.size(),
-	vbuffer.utilization(), vbuffer.size(), vbuffer.allocatedSize());
+void SurfaceDrawBuffer::bind(void) {
+  if (!vertices.empty())
+    glInterleavedArrays(GL_T2F_C4F_N3F_V3F, sizeof(BufferedVertex), &vertices[0]);
+}
+
+void SurfaceDrawBuffer::draw(void) {
+  if (!indices.empty())
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, &indices[0]);
+}
+
+void Surface::addFan(const unsigned int *fan, int count) {
+  std::vector<unsigned int> &indices = fillBuffer->indices;
+
+  /* Split the fan into separate triangles, keeping its winding */
+  for (int i=1; i<count-1; i++) {
+    indices.push_back(fan[0]);
+    indices.push_back(fan[i]);
+    indices.push_back(fan[i+1]);
   }
-#endif
 }
 
 void Surface::animate(float dt) {
   if (!generator)
     return;
 
+  /* Pick up the last refinement job. If it's still running, keep drawing the
+   * old buffer rather than stall the frame, and give the time to the next job.
+   */
+  if (!finishRefinement(false)) {
+    pendingDt += dt;
+    return;
+  }
+  dt += pendingDt;
+  pendingDt = 0;
+
+  /* Nothing is refining now, so the generator can be animated */
   generator->animate(dt);
 
   if (Engine::getInstance()->frustumLock)
@@ -1019,8 +1153,107 @@ void Surface::animate(float dt) {
   /* Order here is important, we don't want the testDirty to short-circuit */
   seedInvalidated = generator->testDirty() || seedInvalidated;
 
+  startRefinement(dt);
+}
+
+void Surface::startRefinement(float dt) {
+  /* Everything the job needs from the render thread is copied here,
+   * including the frustum while this node's matrix is current.
+   */
+  refineFrustum = ViewingFrustum::getInstance()->snapshot();
+  refineDetail = Engine::getInstance()->detail;
+  refineDt = dt;
+  refineRebuild = seedInvalidated;
+  seedInvalidated = false;
+  fillBuffer = &drawBuffers[!frontBuffer];
+
+#ifndef DISABLE_REFINEMENT_THREAD
+  if (!refineThread)
+    refineThread = SDL_CreateThread(refineThreadMain, this);
+
+  if (refineThread) {
+    refineLock.lock();
+    refineQueued = true;
+    refineDone = false;
+    refineLock.broadcast();
+    refineLock.unlock();
+    refining = true;
+    return;
+  }
+#endif
+
+  /* No refinement thread, do the job here and show it right away */
+  refine();
+  frontBuffer = !frontBuffer;
+}
+
+bool Surface::finishRefinement(bool block) {
+  if (!refining)
+    return true;
+
+  /* Swap the finished buffer to the front under the lock, so the worker's
+   * writes to it are complete and visible before we draw it.
+   */
+  refineLock.lock();
+  while (block && !refineDone)
+    refineLock.wait();
+  bool done = refineDone;
+  if (done) {
+    frontBuffer = !frontBuffer;
+    refineDone = false;
+  }
+  refineLock.unlock();
+
+  if (done)
+    refining = false;
+  return done;
+}
+
+void Surface::stopRefinementThread(void) {
+  if (!refineThread)
+    return;
+
+  finishRefinement(true);
+
+  refineLock.lock();
+  refineExit = true;
+  refineLock.broadcast();
+  refineLock.unlock();
+
+  SDL_WaitThread(refineThread, NULL);
+  refineThread = NULL;
+}
+
+int Surface::refineThreadMain(void *self) {
+  ((Surface*) self)->refineLoop();
+  return 0;
+}
+
+void Surface::refineLoop(void) {
+  refineLock.lock();
+  while (1) {
+    while (!refineQueued && !refineExit)
+      refineLock.wait();
+    if (refineExit)
+      break;
+    refineQueued = false;
+    refineLock.unlock();
+
+    refine();
+
+    refineLock.lock();
+    refineDone = true;
+    refineLock.broadcast();
+  }
+  refineLock.unlock();
+}
+
+void Surface::refine(void) {
+  /* Attribute changes to the generator wait until we're done with it */
+  generator->lockGenerator();
+
   /* Regenerate our seed mesh (all top-level SurfaceQuadtreeNodes) if needed */
-  if (seedInvalidated) {
+  if (refineRebuild) {
     reset();
     enableGeomorphing = false;
   }
@@ -1033,14 +1266,18 @@ void Surface::animate(float dt) {
   }
 
   /* Test our surface's bounding sphere, used for optimizing quadtree node cull tests */
-  boundingSphere.frustumCode = ViewingFrustum::getInstance()->
-    cullSphere(boundingSphere.center, boundingSphere.radius);
+  boundingSphere.frustumCode = refineFrustum.cullSphere(boundingSphere.center, boundingSphere.radius);
   
   reprioritize();
 
-  /* split all splittable triangles */
-  while (!SplitAbove.empty())
-    SplitAbove.front()->split(this);
+  /* Split triangles in priority order. Outside of a reset, stop once this frame's
+   * triangle budget is used up, the rest stay drawn at their current detail and
+   * get another chance next frame.
+   */
+  int budget = refineDetail.maxSplitTrianglesPerFrame;
+  int triangleLimit = numTriangles + budget;
+  while (!SplitAbove.empty() && (refineRebuild || budget <= 0 || numTriangles < triangleLimit))
+    SplitAbove.top()->split(this);
  
   /* morphing for vertices we generated in splitting */
   for (std::list<int>::iterator i=splitMorphVertices.begin(); i!=splitMorphVertices.end();) {
@@ -1049,34 +1286,89 @@ void Surface::animate(float dt) {
     j = i;
     i++;
 
-    if (v.morph(dt)) {
+    if (v.morph(refineDt, refineDetail.geomorphDuration)) {
       /* Done */
       vbuffer.unref(*j);
       splitMorphVertices.erase(j);
     }
   }
 
-  /* For all mergable triangles... */
-  for (std::list<SurfaceQuadtreeNode*>::iterator i=MergeBelow.begin(); i!=MergeBelow.end();) {
+  /* For all mergable triangles... Merging modifies MergeBelow, so work from a copy
+   * and skip anything that has been dequeued along the way.
+   */
+  std::vector<SurfaceQuadtreeNode*> merging;
+  for (int i=0; i<MergeBelow.size(); i++)
+    merging.push_back(MergeBelow[i]);
+  for (std::vector<SurfaceQuadtreeNode*>::iterator i=merging.begin(); i!=merging.end(); i++) {
     SurfaceQuadtreeNode *n = *i;
-    i++;
+    if (n->heap != &MergeBelow)
+      continue;
 
     /* Morph the three midpoint vertices */
-    if (vbuffer[n->children[SurfaceQuadtreeNode::a]->vertices[SurfaceQuadtreeNode::b]].morph(dt) &&
-	vbuffer[n->children[SurfaceQuadtreeNode::b]->vertices[SurfaceQuadtreeNode::c]].morph(dt) &&
-	vbuffer[n->children[SurfaceQuadtreeNode::c]->vertices[SurfaceQuadtreeNode::a]].morph(dt)) {
+    float duration = refineDetail.geomorphDuration;
+    if (vbuffer[n->children[SurfaceQuadtreeNode::a]->vertices[SurfaceQuadtreeNode::b]].morph(refineDt, duration) &&
+	vbuffer[n->children[SurfaceQuadtreeNode::b]->vertices[SurfaceQuadtreeNode::c]].morph(refineDt, duration) &&
+	vbuffer[n->children[SurfaceQuadtreeNode::c]->vertices[SurfaceQuadtreeNode::a]].morph(refineDt, duration)) {
 
       /* Done morphing, merge it */
       n->mergeBottomHalf(this);
     }
   }
+
+  /* Build the next draw buffer from the leaves in SplitBelow, plus any SplitAbove
+   * leaves the triangle budget didn't get to. Leaves culled against this job's
+   * frustum go in too, since the buffer stays on screen while the camera keeps
+   * moving and the next job catches up.
+   */
+  fillBuffer->indices.clear();
+  for (int i=0; i<SplitBelow.size(); i++)
+    SplitBelow[i]->addTriangles(this);
+  for (int i=0; i<SplitAbove.size(); i++)
+    SplitAbove[i]->addTriangles(this);
+
+  fillBuffer->vertices.resize(vbuffer.allocatedSize());
+  for (int i=0; i<vbuffer.allocatedSize(); i++)
+    fillBuffer->vertices[i] = vbuffer[i];
+
+  generator->unlockGenerator();
+
+#ifdef DEBUG_FILE
+  static long t = SDL_GetTicks();
+  if (SDL_GetTicks() > t+1000) {
+    t = SDL_GetTicks();
+    DBG("-- Surface stats --\n"
+	"  Triangles: %d\n"
+	" SplitAbove: %d\n"
+	" MergeAbove: %d\n"
+	" SplitBelow: %d\n"
+	" MergeBelow: %d\n"
+	"    vbuffer: %.2f%% utilization (%d used / %d allocated)\n"
+	"\n", numTriangles, 
+	SplitAbove.size(), MergeAbove.size(), 
+	SplitBelow.size(), MergeBelow.size(),
+	vbuffer.utilization(), vbuffer.size(), vbuffer.allocatedSize());
+  }
+#endif
 }
 
-Surface::Surface(JetCOW *cow, Sint32 id, const char *type) : TransformedSceneNode(cow,id,type) {
+Surface::Surface(JetCOW *cow, Sint32 id, const char *type) :
+  TransformedSceneNode(cow,id,type),
+  SplitAbove(true), MergeAbove(false), SplitBelow(true), MergeBelow(false),
+  refineFrustum(*ViewingFrustum::getInstance()) {
   seedInvalidated = true;
   numTriangles = 0;
   generator = NULL;
   enableGeomorphing = false;
+  refineThread = NULL;
+  refining = false;
+  refineQueued = false;
+  refineDone = false;
+  refineExit = false;
+  refineDt = 0;
+  refineRebuild = false;
+  pendingDt = 0;
+  frontBuffer = 0;
+  fillBuffer = &drawBuffers[1];
   DBG("In surface constructor\n");
   /* Set reasonable defaults if this is a new object */
   if (id<0) {
@@ -1085,6 +1377,7 @@ Surface::Surface(JetCOW *cow, Sint32 id, const char *type) : TransformedSceneNod
 }
 
 Surface::~Surface() {
+  stopRefinementThread();
   for (std::vector<SurfaceQuadtreeNode>::iterator i=trees.begin(); i!=trees.end(); i++)
     delTree(*i);
   if (generator)
@@ -1100,6 +1393,9 @@ void Surface::loadCachedValues(void) {
   int genId = getAttrIntProtected("Generator");
   DBG("Loading cached values, genId is %d\n", genId);
   if (!generator || generator->id != genId) {
+    /* The refinement thread may still be using the old one */
+    finishRefinement(true);
+
     if (generator)
       generator->unref();
     if (genId)
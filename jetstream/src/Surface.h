@@ -36,6 +36,8 @@
 #include "Scene.h"
 #include "ViewingFrustum.h"
 #include "SurfaceGenerator.h"
+#include "DetailSettings.h"
+#include "Mutex.h"
 #include <vector>
 #include <map>
 #include <list>
@@ -84,8 +86,10 @@ class SurfacePoint : public BufferedVertex {
    */
   void morphReset(void);
 
-  /* Perform geomorphing for one frame, returns true when done */
-  bool morph(float dt);
+  /* Perform geomorphing for one frame of a morph lasting 'duration' seconds,
+   * returns true when done
+   */
+  bool morph(float dt, float duration);
 
   /* The SurfaceGenerator should store the parameter it uses to generate the
    * surface here, so it won't get confused when Surfacemodifiers change
@@ -121,6 +125,68 @@ struct BoundingPrism {
 };
 
 
+/* One complete set of geometry ready to draw. The refinement thread fills one
+ * of these while the render thread draws from the other.
+ */
+class SurfaceDrawBuffer {
+ public:
+  /* Just the GL_T2F_C4F_N3F_V3F part of each SurfacePoint, indexed like the vbuffer */
+  std::vector<BufferedVertex> vertices;
+  std::vector<unsigned int> indices;
+
+  void bind(void);
+  void draw(void);
+};
+
+
+/***************************************************************** Node heap ***/
+
+class SurfaceQuadtreeNode;
+
+/* A binary heap of quadtree nodes, keyed on the priority each node cached
+ * during its last getPriority(). Nodes track their own heap and position,
+ * so they can be removed from anywhere in O(log n).
+ */
+class SurfaceNodeHeap {
+ public:
+  /* If maxFirst is true the highest priority is on top, otherwise the lowest */
+  SurfaceNodeHeap(bool maxFirst);
+
+  void push(SurfaceQuadtreeNode *n);
+  void remove(SurfaceQuadtreeNode *n);
+  void clear(void);
+
+  /* Restore heap order after the nodes' priorities were changed in place */
+  void rebuild(void);
+
+  SurfaceQuadtreeNode *top(void) {
+    return nodes.front();
+  }
+
+  /* Access in heap order, for passes over every node */
+  SurfaceQuadtreeNode *operator [] (int index) {
+    return nodes[index];
+  }
+
+  int size(void) {
+    return nodes.size();
+  }
+
+  bool empty(void) {
+    return nodes.empty();
+  }
+
+ private:
+  inline bool before(SurfaceQuadtreeNode *a, SurfaceQuadtreeNode *b);
+  void place(int index, SurfaceQuadtreeNode *n);
+  void siftUp(int index);
+  void siftDown(int index);
+
+  std::vector<SurfaceQuadtreeNode*> nodes;
+  bool maxFirst;
+};
+
+
 /***************************************************************** Quadtree node ***/
 
 /* One triangle in a Quadtree.
@@ -136,7 +202,7 @@ class SurfaceQuadtreeNode {
   SurfaceQuadtreeNode(SurfaceQuadtreeNode *parent,
 		      unsigned int a, unsigned int b, unsigned int c);
 
-  void enqueue(std::list<SurfaceQuadtreeNode*> &l);
+  void enqueue(SurfaceNodeHeap &h);
   void dequeue(void);
 
   /* Enqueue in MergeBelow and initialize geomorphing */
@@ -167,8 +233,11 @@ class SurfaceQuadtreeNode {
    * current detail relative to the desired detail. Positive numbers indicate
    * the node should be split, negative indicates it should merge.
    *
-   * Note: This uses the current OpenGL projection and modelview matrix, since
-   *       it is assumed it will be called at draw-time for the surface.
+   * The magnitude grows with the distance from the error margins, and
+   * the result is also stored in 'priority' to key the surface's heaps.
+   *
+   * Note: This uses the surface's refineFrustum, a snapshot of the OpenGL
+   *       projection and modelview matrix taken when the refinement job started.
    */
   float getPriority(Surface *s);
 
@@ -177,13 +246,13 @@ class SurfaceQuadtreeNode {
    */
   void updateGeometry(Surface *s);
 
-  /* Draw this subtree in the current OpenGL context */
-  void draw(Surface *s);
+  /* Append this leaf's triangles, with T-vertices fixed, to the surface's fill buffer */
+  void addTriangles(Surface *s);
 
   /* Draw a graphical representation of the surface's quadtrees, suitable for debugging */
   void drawDebug(Surface *s);
 
-  /* Cull this node against the current frustum, update the 'culled' flag.
+  /* Cull this node against the surface's refineFrustum, update the 'culled' flag.
    * The triangle should only be culled if it is backfacing or it's completely outside
    * the frustum. The entire bounding prism should be used, not just the triangle itself.
    */
@@ -261,11 +330,18 @@ class SurfaceQuadtreeNode {
 
   SurfaceQuadtreeNode *parent;
   
-  /* If isEnqueued is true, this points to the triangle's enqueued location */
-  std::list<SurfaceQuadtreeNode*>::iterator iter;
-  std::list<SurfaceQuadtreeNode*> *list;
+  /* If isEnqueued is true, this is the heap we're in and our index in it */
+  SurfaceNodeHeap *heap;
+  int heapIndex;
+
+  /* Result of the last getPriority() */
+  float priority;
 };
 
+inline bool SurfaceNodeHeap::before(SurfaceQuadtreeNode *a, SurfaceQuadtreeNode *b) {
+  return maxFirst ? (a->priority > b->priority) : (a->priority < b->priority);
+}
+
 
 /***************************************************************** Surface class ***/
 
@@ -286,7 +362,9 @@ class Surface : public TransformedSceneNode {
   virtual void loadCachedValues(void);
   virtual void saveCachedValues(void);  
 
-  /* Vertex buffer */
+  /* Vertex buffer. Owned by the refinement thread while a job is running,
+   * the render thread draws from drawBuffers instead.
+   */
   VertexBuffer<SurfacePoint> vbuffer;
 
   /* Updated by SurfaceQuadtreeNode */
@@ -321,9 +399,45 @@ class Surface : public TransformedSceneNode {
   /* List of vertices being morphed due to splitting */
   std::list<int> splitMorphVertices;
 
-  /* Diamond algorithm */
-  std::list<SurfaceQuadtreeNode*> SplitAbove, MergeAbove;
-  std::list<SurfaceQuadtreeNode*> SplitBelow, MergeBelow;
+  /* Diamond algorithm. SplitAbove and SplitBelow keep the highest priority
+   * on top, MergeAbove and MergeBelow the lowest.
+   */
+  SurfaceNodeHeap SplitAbove, MergeAbove;
+  SurfaceNodeHeap SplitBelow, MergeBelow;
+
+  /* Refinement (reprioritizing, splitting, merging and building the next
+   * draw buffer) runs as one job per frame on refineThread. While a job is
+   * out, the worker owns the quadtrees, heaps and vbuffer, and the render
+   * thread only draws from drawBuffers[frontBuffer]. Finished jobs are picked
+   * up at the start of animate(), which swaps the buffers and starts the next.
+   */
+  static int refineThreadMain(void *self);
+  void refineLoop(void);
+  void refine(void);
+  void startRefinement(float dt);
+  bool finishRefinement(bool block);
+  void stopRefinementThread(void);
+
+  SDL_Thread *refineThread;
+  bool refining;                 /* A job is out, only used on the render thread */
+
+  /* refineLock protects these and the hand-off of drawBuffers */
+  Mutex refineLock;
+  bool refineQueued, refineDone, refineExit;
+
+  /* Inputs to the job in flight, sampled on the render thread when it starts */
+  ViewingFrustum refineFrustum;
+  DetailSettings refineDetail;
+  float refineDt;
+  bool refineRebuild;
+
+  /* Time that passed while a job was still running, handed to the next one */
+  float pendingDt;
+
+  SurfaceDrawBuffer drawBuffers[2];
+  int frontBuffer;
+  SurfaceDrawBuffer *fillBuffer;
+  void addFan(const unsigned int *fan, int count);
 };
 
 #endif /* _H_SURFACE */
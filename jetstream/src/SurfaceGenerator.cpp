@@ -38,6 +38,12 @@ void SurfaceGenerator::generateMidpoint(SurfacePoint &a, SurfacePoint &b, Surfac
   midpoint.interpolate(a,b,0.5);
 }
 
+void SurfaceGenerator::generateMidpoints(SurfacePoint **a, SurfacePoint **b, SurfacePoint **midpoints,
+					 int count, SurfaceQuadtreeNode *qn) {
+  for (int i=0; i<count; i++)
+    generateMidpoint(*a[i], *b[i], *midpoints[i], qn);
+}
+
 void SurfaceGenerator::updateBounds(SurfaceQuadtreeNode *n, Surface *s) {
   n->bounds.front = 0.0;
   n->bounds.back  = 0.0;
@@ -50,6 +56,14 @@ bool SurfaceGenerator::testDirty(void) {
   return d;
 }
 
+void SurfaceGenerator::lockGenerator(void) {
+  lock();
+}
+
+void SurfaceGenerator::unlockGenerator(void) {
+  unlock();
+}
+
 /* Push and pop opengl settings for drawing */
 void SurfaceModifier::push(void) {
   parent->push();
@@ -91,6 +105,14 @@ void SurfaceModifier::generateMidpoint(SurfacePoint &a, SurfacePoint &b, Surface
   midpoint.morphReset();
 }
 
+void SurfaceModifier::generateMidpoints(SurfacePoint **a, SurfacePoint **b, SurfacePoint **midpoints,
+					int count, SurfaceQuadtreeNode *qn) {
+  parent->generateMidpoints(a,b,midpoints,count,qn);
+  fArray(midpoints, count, qn);
+  for (int i=0; i<count; i++)
+    midpoints[i]->morphReset();
+}
+
 SurfaceModifier::SurfaceModifier(JetCOW *cow, Sint32 id,  const char *type)
   : SurfaceGenerator(cow,id,type) {
   parent = NULL;
@@ -127,6 +149,11 @@ SurfaceModifier::~SurfaceModifier() {
 
 void SurfaceModifier::f(SurfacePoint &p, SurfaceQuadtreeNode *qn) {}
 
+void SurfaceModifier::fArray(SurfacePoint **points, int count, SurfaceQuadtreeNode *qn) {
+  for (int i=0; i<count; i++)
+    f(*points[i], qn);
+}
+
 /* Test the dirty flag of this and the parent, and unset it if it's set */
 bool SurfaceModifier::testDirty(void) {
   /* Don't do this in one line, since we don't want short-circuit logic */
@@ -135,4 +162,16 @@ bool SurfaceModifier::testDirty(void) {
   return a || b;
 }
 
+void SurfaceModifier::lockGenerator(void) {
+  lock();
+  if (parent)
+    parent->lockGenerator();
+}
+
+void SurfaceModifier::unlockGenerator(void) {
+  if (parent)
+    parent->unlockGenerator();
+  unlock();
+}
+
 /* The End */
@@ -55,6 +55,13 @@ class SurfaceGenerator : public JetCOWDictionary {
    */
   virtual void generateMidpoint(SurfacePoint &a, SurfacePoint &b, SurfacePoint &midpoint, 
 				SurfaceQuadtreeNode *qn);
+
+  /* Generate several midpoints at once, midpoints[i] is between a[i] and b[i].
+   * Default calls generateMidpoint for each. Override this if the work
+   * can be shared between points.
+   */
+  virtual void generateMidpoints(SurfacePoint **a, SurfacePoint **b, SurfacePoint **midpoints,
+				 int count, SurfaceQuadtreeNode *qn);
   
   /* generate a bounding sphere for the surface */
   virtual void generateBoundingSphere(Vector3 &center, float &radius) = 0;
@@ -72,6 +79,12 @@ class SurfaceGenerator : public JetCOWDictionary {
   /* Test the dirty flag, and unset it if it's set */
   virtual bool testDirty(void);
 
+  /* Lock this generator and every generator it builds on. A Surface holds this
+   * while it refines on its worker thread, so attribute changes wait for it.
+   */
+  virtual void lockGenerator(void);
+  virtual void unlockGenerator(void);
+
   SurfaceGenerator(JetCOW *cow, Sint32 id,  const char *type="SurfaceGenerator");
 
   bool dirty;
@@ -95,11 +108,18 @@ class SurfaceModifier : public SurfaceGenerator {
    */
   virtual void f(SurfacePoint &p, SurfaceQuadtreeNode *qn);
 
+  /* f() for an array of points, used by generateMidpoints.
+   * Default calls f() for each point.
+   */
+  virtual void fArray(SurfacePoint **points, int count, SurfaceQuadtreeNode *qn);
+
   /* The implementations of these functions call the parent, then pass the result through f() */
   virtual void generateSeedMesh(std::vector<SurfaceQuadtreeNode> &mesh,
 				VertexBuffer<SurfacePoint> &vbuffer);
   virtual void generateMidpoint(SurfacePoint &a, SurfacePoint &b, SurfacePoint &midpoint, 
 				SurfaceQuadtreeNode *qn);
+  virtual void generateMidpoints(SurfacePoint **a, SurfacePoint **b, SurfacePoint **midpoints,
+				 int count, SurfaceQuadtreeNode *qn);
 
   /* This just calls the parent. If you are modifying any 
    * geometry this should probably be overridden by the subclass.
@@ -120,6 +140,9 @@ class SurfaceModifier : public SurfaceGenerator {
   /* Test the dirty flag of this and the parent, and unset it if it's set */
   virtual bool testDirty(void);
 
+  virtual void lockGenerator(void);
+  virtual void unlockGenerator(void);
+
  protected:
   SurfaceGenerator *parent;
 };
@@ -20,17 +20,52 @@
  */
 
 #include "VideoRecorder.h"
+#include <string.h>
+#include <stdio.h>
+#include <exception>
 
 /* Necessary for our use of gl_feedback() below */
 extern "C" {
 #include <pgserver/common.h>
 #include <pgserver/video.h>
 #include <pgserver/gl.h>
+#include <SDL/SDL.h>
 }
 
+/* GL_ARB_pixel_buffer_object, looked up at runtime */
+#ifndef GL_PIXEL_PACK_BUFFER_ARB
+#define GL_PIXEL_PACK_BUFFER_ARB 0x88EB
+#endif
+#ifndef GL_STREAM_READ_ARB
+#define GL_STREAM_READ_ARB       0x88E1
+#endif
+#ifndef GL_READ_ONLY_ARB
+#define GL_READ_ONLY_ARB         0x88B8
+#endif
+
+typedef void   (*glGenBuffersARB_t)(GLsizei n, GLuint *buffers);
+typedef void   (*glDeleteBuffersARB_t)(GLsizei n, const GLuint *buffers);
+typedef void   (*glBindBufferARB_t)(GLenum target, GLuint buffer);
+typedef void   (*glBufferDataARB_t)(GLenum target, long size, const GLvoid *data, GLenum usage);
+typedef void * (*glMapBufferARB_t)(GLenum target, GLenum access);
+typedef GLboolean (*glUnmapBufferARB_t)(GLenum target);
+
+static glGenBuffersARB_t    pglGenBuffersARB;
+static glDeleteBuffersARB_t pglDeleteBuffersARB;
+static glBindBufferARB_t    pglBindBufferARB;
+static glBufferDataARB_t    pglBufferDataARB;
+static glMapBufferARB_t     pglMapBufferARB;
+static glUnmapBufferARB_t   pglUnmapBufferARB;
+
+
 VideoRecorder::VideoRecorder() {
   running = false;
   writer = NULL;
+  encoder = NULL;
+  usePBO = false;
+  pboHead = pboCount = 0;
+  allocatedBuffers = 0;
+  encoderExit = encoderFailed = false;
 
   /* Default attributes */
   width = 512;
@@ -40,6 +75,7 @@ VideoRecorder::VideoRecorder() {
   rtjpeg = 1;
   lzo = 1;
   rgb = 0;
+  throttle = 0;
   filename = "snapshot.nuv";
 
   /* Main loop handler */
@@ -51,7 +87,7 @@ VideoRecorder::VideoRecorder() {
 VideoRecorder::~VideoRecorder() {
   delete mainHandler;
   if (writer)
-    delete writer;
+    stopWriter();
 }
 
 void VideoRecorder::start(void) {
@@ -65,12 +101,8 @@ void VideoRecorder::stop(void) {
 void VideoRecorder::mainloopIteration(void) {
   if (running) {
     /* Create the writer if it doesn't exist */
-    if (!writer) {
-      writer = new NuppelWriter(width,height,filename.c_str(),framerate,quality,rtjpeg,lzo,rgb);
-      
-      Engine::getInstance()->throttleFrameRate = true;
-      Engine::getInstance()->targetFrameRate = writer->frameRate;
-    }
+    if (!writer)
+      startWriter();
 
     /* If we're capturing to a video smaller than our screen,
      * use the gl_feedback function in PicoGUI's OpenGL driver to scale it down.
@@ -78,6 +110,7 @@ void VideoRecorder::mainloopIteration(void) {
      * then in the current OpenGL matrix projects it back onto the backbuffer with optional
      * mipmap biasing. This is useful for blurs, pixelization, scaling, and a lot of other
      * neat effects.
+     * This is done every frame, not just the ones we capture, so the display doesn't flicker.
      */
     int viewport[4];
     glGetIntegerv(GL_VIEWPORT,viewport);
@@ -95,20 +128,27 @@ void VideoRecorder::mainloopIteration(void) {
       gl_frame_cleanup();
     }
 
-    /* Grab the current backbuffer contents */
-    glReadBuffer(GL_BACK);
-    glReadPixels(0,viewport[3]-writer->height,
-		 writer->width,writer->height,
-		 GL_RGB,GL_UNSIGNED_BYTE,writer->frameBuffer);
-    writer->writeFrame();
+    /* When throttled the engine is already running at our frame rate,
+     * otherwise sample the frames that fall on our frame rate.
+     */
+    Uint32 now = SDL_GetTicks();
+    if (throttle || (Sint32)(now - nextCaptureTicks) >= 0) {
+      capture(now);
+
+      captureRemainder += 1000.0f / writer->frameRate;
+      Uint32 step = (Uint32) captureRemainder;
+      captureRemainder -= step;
+      nextCaptureTicks += step;
+
+      /* Don't try to catch up if we fell far behind */
+      if ((Sint32)(now - nextCaptureTicks) >= 0)
+	nextCaptureTicks = now + step;
+    }
   }
   else {
     /* Destroy the writer if it still exists */
-    if (writer) {
-      delete writer;
-      writer = NULL;
-      Engine::getInstance()->throttleFrameRate = false;
-    }
+    if (writer)
+      stopWriter();
   }
 }
 
@@ -116,4 +156,213 @@ int VideoRecorder::isRunning(void) {
   return running;
 }
 
+void VideoRecorder::startWriter(void) {
+  writer = new NuppelWriter(width,height,filename.c_str(),framerate,quality,rtjpeg,lzo,rgb);
+
+  if (throttle) {
+    Engine::getInstance()->throttleFrameRate = true;
+    Engine::getInstance()->targetFrameRate = writer->frameRate;
+  }
+  nextCaptureTicks = SDL_GetTicks();
+  captureRemainder = 0;
+
+  usePBO = initPBO();
+  pboHead = pboCount = 0;
+
+  encoderExit = encoderFailed = false;
+  encoder = SDL_CreateThread(encoderThread, this);
+}
+
+void VideoRecorder::stopWriter(void) {
+  /* Collect the frames still in flight, oldest first */
+  while (pboCount > 0)
+    collectPBO((pboHead + VIDEORECORDER_PBOS - pboCount) % VIDEORECORDER_PBOS);
+  if (usePBO)
+    pglDeleteBuffersARB(VIDEORECORDER_PBOS, pbo);
+  usePBO = false;
+
+  /* Let the encoder finish what's queued */
+  queueLock.lock();
+  encoderExit = true;
+  queueLock.broadcast();
+  queueLock.unlock();
+  if (encoder)
+    SDL_WaitThread(encoder, NULL);
+  encoder = NULL;
+
+  for (unsigned int i=0; i<freeBuffers.size(); i++)
+    delete[] freeBuffers[i];
+  freeBuffers.clear();
+  allocatedBuffers = 0;
+
+  delete writer;
+  writer = NULL;
+  Engine::getInstance()->throttleFrameRate = false;
+}
+
+bool VideoRecorder::initPBO(void) {
+  const char *extensions = (const char *) glGetString(GL_EXTENSIONS);
+  if (!extensions || !strstr(extensions, "GL_ARB_pixel_buffer_object"))
+    return false;
+
+  pglGenBuffersARB    = (glGenBuffersARB_t)    SDL_GL_GetProcAddress("glGenBuffersARB");
+  pglDeleteBuffersARB = (glDeleteBuffersARB_t) SDL_GL_GetProcAddress("glDeleteBuffersARB");
+  pglBindBufferARB    = (glBindBufferARB_t)    SDL_GL_GetProcAddress("glBindBufferARB");
+  pglBufferDataARB    = (glBufferDataARB_t)    SDL_GL_GetProcAddress("glBufferDataARB");
+  pglMapBufferARB     = (glMapBufferARB_t)     SDL_GL_GetProcAddress("glMapBufferARB");
+  pglUnmapBufferARB   = (glUnmapBufferARB_t)   SDL_GL_GetProcAddress("glUnmapBufferARB");
+  if (!pglGenBuffersARB || !pglDeleteBuffersARB || !pglBindBufferARB ||
+      !pglBufferDataARB || !pglMapBufferARB || !pglUnmapBufferARB)
+    return false;
+
+  pglGenBuffersARB(VIDEORECORDER_PBOS, pbo);
+  for (int i=0; i<VIDEORECORDER_PBOS; i++) {
+    pglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, pbo[i]);
+    pglBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, writer->bufferSize, NULL, GL_STREAM_READ_ARB);
+  }
+  pglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+  return true;
+}
+
+/* Grab the current backbuffer contents */
+void VideoRecorder::capture(Uint32 ticks) {
+  int viewport[4];
+  glGetIntegerv(GL_VIEWPORT,viewport);
+
+  /* The writer wants tightly packed rows */
+  GLint alignment;
+  glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadBuffer(GL_BACK);
+
+  if (usePBO) {
+    /* Make room in the ring by handing the oldest frame to the encoder */
+    if (pboCount == VIDEORECORDER_PBOS)
+      collectPBO(pboHead);
+
+    /* Start an asynchronous read into the next buffer */
+    pglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, pbo[pboHead]);
+    glReadPixels(0,viewport[3]-writer->height,
+		 writer->width,writer->height,
+		 GL_RGB,GL_UNSIGNED_BYTE,(GLvoid*) 0);
+    pglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+    pboTicks[pboHead] = ticks;
+    pboHead = (pboHead + 1) % VIDEORECORDER_PBOS;
+    pboCount++;
+  }
+  else {
+    /* No PBOs, this read stalls but the encoding still happens elsewhere */
+    unsigned char *pixels = getBuffer();
+    glReadPixels(0,viewport[3]-writer->height,
+		 writer->width,writer->height,
+		 GL_RGB,GL_UNSIGNED_BYTE,pixels);
+    queueFrame(pixels, ticks);
+  }
+
+  glPixelStorei(GL_PACK_ALIGNMENT, alignment);
+}
+
+/* Map a finished pixel buffer and queue its contents for the encoder */
+void VideoRecorder::collectPBO(int slot) {
+  unsigned char *pixels = getBuffer();
+
+  pglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, pbo[slot]);
+  void *mapped = pglMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+  if (mapped) {
+    memcpy(pixels, mapped, writer->bufferSize);
+    pglUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+  }
+  pglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+  pboCount--;
+
+  if (mapped)
+    queueFrame(pixels, pboTicks[slot]);
+  else {
+    queueLock.lock();
+    freeBuffers.push_back(pixels);
+    queueLock.unlock();
+  }
+}
+
+/* Get an empty frame buffer, waiting for the encoder if it's too far behind */
+unsigned char *VideoRecorder::getBuffer(void) {
+  unsigned char *pixels = NULL;
+
+  queueLock.lock();
+  while (freeBuffers.empty() && allocatedBuffers >= VIDEORECORDER_MAX_QUEUE)
+    queueLock.wait();
+  if (freeBuffers.empty()) {
+    allocatedBuffers++;
+  }
+  else {
+    pixels = freeBuffers.back();
+    freeBuffers.pop_back();
+  }
+  queueLock.unlock();
+
+  if (!pixels)
+    pixels = new unsigned char[writer->bufferSize];
+  return pixels;
+}
+
+void VideoRecorder::queueFrame(unsigned char *pixels, Uint32 ticks) {
+  Frame frame;
+
+  /* If we couldn't get a thread, do it the slow way */
+  if (!encoder) {
+    if (!encoderFailed)
+      writer->writeFrame(pixels, ticks);
+    queueLock.lock();
+    freeBuffers.push_back(pixels);
+    queueLock.unlock();
+    return;
+  }
+
+  frame.pixels = pixels;
+  frame.ticks = ticks;
+
+  queueLock.lock();
+  encodeQueue.push_back(frame);
+  queueLock.broadcast();
+  queueLock.unlock();
+}
+
+int VideoRecorder::encoderThread(void *self) {
+  ((VideoRecorder*) self)->encoderLoop();
+  return 0;
+}
+
+/* Compress and write frames in the order they were captured. The writer
+ * keeps state between frames, so there's only ever one of these.
+ */
+void VideoRecorder::encoderLoop(void) {
+  queueLock.lock();
+  while (1) {
+    while (encodeQueue.empty() && !encoderExit)
+      queueLock.wait();
+    if (encodeQueue.empty())
+      break;
+
+    Frame frame = encodeQueue.front();
+    encodeQueue.pop_front();
+    queueLock.unlock();
+
+    if (!encoderFailed) {
+      try {
+	writer->writeFrame(frame.pixels, frame.ticks);
+      }
+      catch (std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	encoderFailed = true;
+      }
+    }
+
+    queueLock.lock();
+    freeBuffers.push_back(frame.pixels);
+    queueLock.broadcast();
+  }
+  queueLock.unlock();
+}
+
 /* The End */
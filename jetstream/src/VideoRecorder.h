@@ -24,7 +24,24 @@
 
 #include "nuppelvideo/NuppelWriter.h"
 #include "Engine.h"
+#include "Mutex.h"
 #include <string>
+#include <deque>
+#include <vector>
+#include <GL/gl.h>
+
+extern "C" {
+#include <SDL/SDL_thread.h>
+}
+
+/* Number of pixel buffer objects in the readback ring. A frame is read
+ * back into one and mapped when the ring comes back around to it,
+ * VIDEORECORDER_PBOS captures later, by which time the transfer has finished.
+ */
+#define VIDEORECORDER_PBOS      3
+
+/* Most frames waiting for the encoder thread before capturing blocks */
+#define VIDEORECORDER_MAX_QUEUE 8
 
 class VideoRecorder {
  public:
@@ -43,11 +60,49 @@ class VideoRecorder {
   float quality;
   int rtjpeg, lzo, rgb;    /* These should be bool, but Boost.Python was having trouble with it */
 
+  /* Nonzero to lock the engine to the capture frame rate, capturing every frame
+   * with a fixed timestep. Otherwise the engine runs freely and frames are
+   * sampled at the capture rate.
+   */
+  int throttle;
+
  private:
   MainLoopHandler<VideoRecorder> *mainHandler;
   void mainloopIteration(void);
   NuppelWriter *writer;
   bool running;
+
+  void startWriter(void);
+  void stopWriter(void);
+  void capture(Uint32 ticks);
+  Uint32 nextCaptureTicks;
+  float captureRemainder;
+
+  /* Asynchronous readback through GL_ARB_pixel_buffer_object, if we have it */
+  bool initPBO(void);
+  void collectPBO(int slot);
+  bool usePBO;
+  GLuint pbo[VIDEORECORDER_PBOS];
+  Uint32 pboTicks[VIDEORECORDER_PBOS];
+  int pboHead, pboCount;
+
+  /* Captured frames go to the encoder thread, which owns the writer while it runs.
+   * Everything below is protected by queueLock.
+   */
+  struct Frame {
+    unsigned char *pixels;
+    Uint32 ticks;
+  };
+  static int encoderThread(void *self);
+  void encoderLoop(void);
+  unsigned char *getBuffer(void);
+  void queueFrame(unsigned char *pixels, Uint32 ticks);
+  SDL_Thread *encoder;
+  Mutex queueLock;
+  std::deque<Frame> encodeQueue;
+  std::vector<unsigned char*> freeBuffers;
+  int allocatedBuffers;
+  bool encoderExit, encoderFailed;
 };
 
 #endif /* _H_VIDEORECORDER */
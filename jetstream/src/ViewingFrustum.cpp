@@ -101,6 +101,12 @@ void ViewingFrustum::calculate(void) {
   dirty = false;
 }
 
+ViewingFrustum ViewingFrustum::snapshot(void) {
+  /* calculate() is a no-op on the copy, since it's never invalidated */
+  calculate();
+  return *this;
+}
+
 ViewingFrustum *ViewingFrustum::getInstance(void) {
   if (!instance)
     instance = new ViewingFrustum();
@@ -34,6 +34,11 @@ class ViewingFrustum {
    * modified. Its speed penalty is negligible if you call it multiple times between drawings.
    */
   void invalidate();
+
+  /* A copy of the frustum as it is right now. The copy keeps these matrices
+   * when OpenGL's change, so it can be used away from the render thread.
+   */
+  ViewingFrustum snapshot(void);
   
   /* Return the current OpenGL matrices */
   const Matrix4x4 &getModelview(void);
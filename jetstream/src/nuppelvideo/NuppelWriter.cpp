@@ -154,6 +154,10 @@ NuppelWriter::~NuppelWriter() {
 }
 
 void NuppelWriter::writeFrame(void) {
+  writeFrame(frameBuffer, SDL_GetTicks());
+}
+
+void NuppelWriter::writeFrame(unsigned char *rgbFrame, unsigned long ticks) {
   rtframeheader frameh;
   lzo_uint lzoSize;
   unsigned char *currentBuffer;
@@ -177,19 +181,19 @@ void NuppelWriter::writeFrame(void) {
   memset(&frameh, 0, sizeof(frameh));
   frameh.frametype = 'V';
   frameh.keyframe = frameofgop;
-  frameh.timecode = SDL_GetTicks() - startTime;
+  frameh.timecode = ticks - startTime;
 
   if (rgb) {
     /* Nonstandard: uncompressed bottom-up RGB24 */
     frameh.comptype = 'R';
-    currentBuffer = frameBuffer;
+    currentBuffer = rgbFrame;
     currentBufferSize = bufferSize;
   }
   else {
     /* Convert from RGB to YUV420. This routine has also
      * been modified to flip the video vertically.
      */
-    RGB2YUV420(width, height, frameBuffer, yuvBuffer, yuvTmp1, yuvTmp2);
+    RGB2YUV420(width, height, rgbFrame, yuvBuffer, yuvTmp1, yuvTmp2);
     currentBuffer = yuvBuffer;
     currentBufferSize = width*height+(width*height/2);
     frameh.comptype = '0';
@@ -42,6 +42,11 @@ class NuppelWriter {
 
   void writeFrame(void);
 
+  /* Compress and write a frame in the same format as frameBuffer,
+   * timestamped with the SDL_GetTicks() value it was captured at.
+   */
+  void writeFrame(unsigned char *rgbFrame, unsigned long ticks);
+
   /* This buffer is true color, 3 bytes per pixel, packed in RGB order,
    * scanned from bottom to top. It is compatible with glReadPixels.
    */
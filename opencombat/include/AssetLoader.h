@@ -0,0 +1,105 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * AssetLoader:
+ *	Runs media decoding jobs on background threads.
+ *
+ * A job reads and decodes one file into memory.  Whatever has to
+ * happen on the main thread afterwards (a texture upload, resampling
+ * a sound to the output rate) is up to the owner of the job, which
+ * checks isDone() or calls wait() and then deletes the job itself.
+ *
+ * Only the main thread may queue, wait for or cancel jobs.  Without
+ * thread support (or before start()) queue() simply runs the job.
+ */
+
+#ifndef	BZF_ASSET_LOADER_H
+#define	BZF_ASSET_LOADER_H
+
+#include "common.h"
+#include <deque>
+#include "Singleton.h"
+
+class AssetJob {
+  public:
+			AssetJob();
+    virtual		~AssetJob();
+
+    /** Read and decode the asset.  This runs on a loader thread, so it
+	must not touch GL, BZDB or anything else the main thread owns. */
+    virtual void	load() = 0;
+
+  private:
+    friend class AssetLoader;
+    friend class AssetLoaderThread;
+    enum State { Idle, Queued, Loading, Done };
+    State		state;
+};
+
+class AssetLoader : public Singleton<AssetLoader> {
+  public:
+    /** Start the loader threads.  numThreads <= 0 picks a count from
+	the number of processors. */
+    void		start(int numThreads = 0);
+    /** Stop the loader threads.  Jobs that haven't started are dropped
+	and have to be queued again. */
+    void		stop();
+    int			getNumThreads() const;
+
+    /** Hand a job to the loader threads. */
+    void		queue(AssetJob*);
+    /** True once the job's load() has returned. */
+    bool		isDone(AssetJob*);
+    /** Block until the job is done.  A job no thread has picked up yet
+	is run right here instead of waiting its turn. */
+    void		wait(AssetJob*);
+    /** Drop the job if it hasn't started, otherwise wait for it.
+	Either way it may be deleted afterwards. */
+    void		cancel(AssetJob*);
+
+    /** Jobs loaded so far. */
+    int			getNumLoaded() const;
+    /** Seconds the main thread has spent blocked in wait(). */
+    float		getWaitTime() const;
+
+  protected:
+    friend class Singleton<AssetLoader>;
+    friend class AssetLoaderThread;
+
+  private:
+			AssetLoader();
+			AssetLoader(const AssetLoader&);
+    AssetLoader&	operator=(const AssetLoader&);
+			~AssetLoader();
+
+    bool		nextJob(AssetJob*&);
+    void		runJob(AssetJob*);
+    void		removeJob(AssetJob*);
+
+  private:
+    std::deque<AssetJob*> jobs;
+    int			numThreads;
+    bool		quitting;
+    int			numLoaded;
+    float		waitTime;
+};
+
+#endif // BZF_ASSET_LOADER_H
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
@@ -0,0 +1,61 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * AudioMixer:
+ *	Block kernels for the sound effect mixer.
+ *
+ * Buffers are interleaved stereo floats (left in even, right in odd)
+ * scaled to the range of a short.  Each kernel works on a whole block
+ * so the per-sample work is just the arithmetic;  SSE2 is used where
+ * the compiler has it.
+ */
+
+#ifndef	BZF_AUDIO_MIXER_H
+#define	BZF_AUDIO_MIXER_H
+
+#include "common.h"
+
+/* number of frames a change in gain is faded over */
+const int		AudioFadeFrames = 8;
+
+/* add frames of src into dst.  the gain fades from (fromLeft, fromRight)
+ * to (toLeft, toRight) over the first AudioFadeFrames frames (or the
+ * whole block, if it is shorter) and then holds. */
+void			audioMixStereo(float* dst, const float* src,
+				long frames,
+				float fromLeft, float fromRight,
+				float toLeft, float toRight);
+
+/* lerp the mono samples in src into stereo dst, one read position per
+ * ear, each advancing by step per frame.  positions that reach length
+ * wrap around if loop is true, otherwise the block ends after that
+ * frame.  returns the number of frames written and leaves the positions
+ * where the next block should start. */
+long			audioResampleMono(float* dst, const float* src,
+				long frames,
+				double* leftPos, double* rightPos,
+				double step, double length, bool loop);
+
+/* convert samples to 16 bits, clamping to +/-32767 */
+void			audioConvertToShort(short* dst, const float* src,
+				long samples);
+
+#endif // BZF_AUDIO_MIXER_H
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
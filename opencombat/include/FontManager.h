@@ -29,6 +29,43 @@ typedef std::map<int, TextureFont*> FontSizeMap;
 typedef std::vector<FontSizeMap>    FontFaceList;
 typedef std::map<std::string, int>  FontFaceMap;
 
+// a piece of a string that is drawn with one set of ANSI attributes
+typedef struct {
+  GLfloat color[3];	// negative means use the current color
+  bool	  blink;
+  bool	  underline;
+  int	  first;	// range of vertices in the layout
+  int	  count;
+  float	  x;		// where the run starts and how wide it is
+  float	  width;
+} TextRun;
+
+// a string already split on its ANSI codes and turned into glyph quads
+typedef struct {
+  TextureFont*		font;
+  std::vector<GLfloat>	verts;		// GL_T2F_V3F, relative to the string origin
+  std::vector<TextRun>	runs;
+  bool			colored;	// some run sets its own color
+  bool			underlined;
+} TextLayout;
+
+struct TextLayoutKey {
+  int	      faceID;
+  float	      size;
+  std::string text;
+
+  bool operator < (const TextLayoutKey &key) const {
+    if (faceID != key.faceID)
+      return faceID < key.faceID;
+    if (size != key.size)
+      return size < key.size;
+    return text < key.text;
+  }
+};
+
+typedef std::map<TextLayoutKey, TextLayout>	    TextLayoutMap;
+typedef std::map<TextureFont*, std::vector<GLfloat> > TextBatchMap;
+
 class FontManager : public Singleton<FontManager> {
 public:
   FontManager();
@@ -36,6 +73,10 @@ public:
 
   void loadAll(std::string dir);
 
+  // fonts are built the first time they're drawn; this starts decoding
+  // the textures for every size of a face ahead of that
+  void preload(std::string faceName);
+
   void rebuild(void);
 
   int getFaceID(std::string faceName);
@@ -43,8 +84,14 @@ public:
   int getNumFaces(void);
   const char* getFaceName(int faceID);
 
-  void drawString(float x, float y, float z, int faceID, float size, std::string text);
-  void drawString(float x, float y, float z, std::string face, float size, std::string text);
+  void drawString(float x, float y, float z, int faceID, float size, const std::string &text);
+  void drawString(float x, float y, float z, std::string face, float size, const std::string &text);
+
+  // between these, drawString only queues the text and flushBatch draws
+  // all of it with one call per font texture.  everything queued must
+  // share the modelview and projection that are current at the flush.
+  void beginBatch(void);
+  void flushBatch(void);
 
   float getStrLength(int faceID, float size, std::string text);
   float getStrLength(std::string face, float size, std::string text);
@@ -60,8 +107,25 @@ protected:
 private:
   void		getBlinkColor(const GLfloat* color, GLfloat* blinkColor) const;
   TextureFont*	getClosestSize(int faceID, float size);
+
+  const TextLayout* getLayout(int faceID, float size, const std::string &text);
+  void		buildLayout(TextLayout &layout, float scale, const std::string &text);
+  void		getRunColor(const TextRun &run, GLfloat *color) const;
+  void		drawLayout(const TextLayout &layout, float x, float y, float z);
+  void		batchLayout(const TextLayout &layout, float x, float y, float z);
+  void		clearLayouts(void);
+
+  static void	underlineCallback(const std::string &name, void *data);
+
   FontFaceMap	faceNames;
   FontFaceList  fontFaces;
+
+  TextLayoutMap	layouts;
+  GLfloat	underlineColor[3];
+
+  bool		batching;
+  TextBatchMap	batchGlyphs;	// t2f c4f v3f per font
+  std::vector<GLfloat> batchLines; // c4f v3f
 };
 
 #endif //_FONT_MANAGER_H_
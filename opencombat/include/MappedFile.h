@@ -0,0 +1,67 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * MappedFile:
+ *	A whole file mapped read-only into memory.
+ *
+ * Where the platform can map files the pages come straight from the
+ * file cache;  otherwise the file is read into a buffer once.  Either
+ * way the data stays valid until close() or the object is destroyed,
+ * and may be read from any thread in the meantime.
+ */
+
+#ifndef	BZF_MAPPED_FILE_H
+#define	BZF_MAPPED_FILE_H
+
+#include "common.h"
+#include <string>
+
+class MappedFile {
+  public:
+			MappedFile();
+			~MappedFile();
+
+    /** Map the named file, closing whatever was open before.  Returns
+	false if the file can't be opened.  An empty file opens fine
+	but has no data. */
+    bool		open(const std::string& filename);
+    void		close();
+
+    bool		isOpen() const;
+    const char*		getData() const;
+    size_t		getSize() const;
+
+  private:
+			MappedFile(const MappedFile&);
+    MappedFile&		operator=(const MappedFile&);
+
+  private:
+    const char*		data;
+    size_t		size;
+    bool		opened;
+    bool		mapped;
+#if defined(_WIN32)
+    void*		file;
+    void*		mapping;
+#endif
+};
+
+#endif // BZF_MAPPED_FILE_H
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
@@ -21,6 +21,7 @@
 // demands on the system.
 // #define HALF_RATE_AUDIO
 
+class ImageFile;
 
 /** This class is a base class for media files, which can be image files or
     audio files. */
@@ -35,6 +36,22 @@ public:
   static unsigned char* readImage(const std::string& filename,
 				  int* width, int* height);
 
+  /** Open an image file and read its header, trying each supported
+      format, and get the image size from it.  Returns NULL if no
+      format recognizes the file.  Reading the pixels with
+      readImage(ImageFile*, ...) only touches the file itself, so
+      that part can be done on another thread. */
+  static ImageFile* openImage(const std::string& filename,
+			      int* width, int* height);
+
+  /** Read an image opened by openImage() the same way readImage()
+      does, then close it. */
+  static unsigned char* readImage(ImageFile* file,
+				  int* width, int* height);
+
+  /** Close an image opened by openImage() without reading it. */
+  static void closeImage(ImageFile* file);
+
   // read a sound file.  use delete[] to release the returned
   // audio.  returns NULL on failure.  sounds are stored
   // left/right.
@@ -18,6 +18,7 @@
 #define	BZF_TANK_SCENE_NODE_H
 
 #include "common.h"
+#include <vector>
 #include "SceneNode.h"
 
 // prototypes for tank geo
@@ -40,6 +41,12 @@ void buildLowLTread ( void );
 void buildLowRTread ( void );
 void buildLowBarrel ( void );
 
+// the builders above describe the parts with these.  rather than
+// going to GL they're collected into the shared tank geometry.
+void doBegin(GLenum mode);
+void doEnd();
+void doTexCoord2f(GLfloat s, GLfloat t);
+
 class TankSceneNode;
 class OpenGLTexture;
 
@@ -119,7 +126,12 @@ class TankSceneNode : public SceneNode {
 
     static void		setMaxLOD(int maxLevel);
 
+    // forget the tanks batched for the last frame.  call before
+    // collecting render nodes.
+    static void		clearBatches();
+
   protected:
+    class TankBatchNode;
     class TankRenderNode : public RenderNode {
       public:
 	enum Style {
@@ -131,12 +143,18 @@ class TankSceneNode : public SceneNode {
 			lastStyle
 	};
 
-			TankRenderNode(const TankSceneNode*);
+			TankRenderNode(const TankSceneNode*, int lod);
 			~TankRenderNode();
 	void		setShadow();
 	void		sortOrder(bool above, bool towards);
 	void		render();
 	const GLfloat*	getPosition() { return sceneNode->getSphere(); }
+
+	// draw with the geometry already bound and nothing special
+	// going on (not exploding, clipped or sorted).  no lights.
+	void		renderBatched();
+	// the world positions and colors of the turret lights
+	void		getLights(GLfloat pos[3][3]) const;
       protected:
 	enum Part {
 			Body = 0,
@@ -146,82 +164,48 @@ class TankSceneNode : public SceneNode {
 			RightTread
 	};
 
-	virtual GLuint	getParts(Style) = 0;
-	virtual void	freeParts() = 0;
+	void		prepare();
 	void		renderParts();
 	void		renderPart(Part);
 	void		renderLights();
-	void		prepStyle(Style);
-	void		doVertex3f(GLfloat x, GLfloat y, GLfloat z);
-	void		doNormal3f(GLfloat x, GLfloat y, GLfloat z);
-      private:
-	void		doInitContext();
-	static void	initContext(void*);
       protected:
 	const TankSceneNode* sceneNode;
+	int		lod;
+	const GLint*	parts;		// first, count per part
 	const GLfloat*	color;
 	GLfloat		alpha;
 	bool		isShadow;
 	bool		above;
 	bool		towards;
 	bool		isExploding;
+	bool		withLights;
 	GLfloat		explodeFraction;
 	GLfloat		vel[5][2];
 	GLfloat		spin[5][4];
-	GLuint		base;
 	static const GLfloat	centerOfGravity[][3];	// of parts
-	static GLfloat		vertexScale[3];
-	static GLfloat		normalScale[3];
-    };
-    class LowTankRenderNode : public TankRenderNode {
-      public:
-			LowTankRenderNode(const TankSceneNode*);
-			~LowTankRenderNode();
-      protected:
-	GLuint		getParts(Style);
-	void		freeParts();
-	void		makeBody();
-	void		makeBarrel();
-	void		makeTurret();
-	void		makeLeftTread();
-	void		makeRightTread();
-      private:
-	static GLuint	parts[lastStyle];
-	friend class TankSceneNode;
+	static const GLfloat	lights[3][6];		// color, position
+	friend class TankBatchNode;
     };
-    class MedTankRenderNode : public TankRenderNode {
+    friend class TankRenderNode;
+
+    // all the plain tanks of one level of detail, drawn in one go
+    class TankBatchNode : public RenderNode {
       public:
-			MedTankRenderNode(const TankSceneNode*);
-			~MedTankRenderNode();
-      protected:
-	GLuint		getParts(Style);
-	void		freeParts();
-	void		makeBody();
-	void		makeBarrel();
-	void		makeTurret();
-	void		makeLeftTread();
-	void		makeRightTread();
+			TankBatchNode(int lod, bool shadow);
+			~TankBatchNode();
+	void		clear();
+	bool		isEmpty() const { return tanks.empty(); }
+	void		add(const TankSceneNode*);
+	void		render();
+	const GLfloat*	getPosition() { return tanks[0]->getSphere(); }
       private:
-	static GLuint	parts[lastStyle];
-	friend class TankSceneNode;
-    };
-    class HighTankRenderNode : public TankRenderNode {
-      public:
-			HighTankRenderNode(const TankSceneNode*);
-			~HighTankRenderNode();
-      protected:
-	GLuint		getParts(Style);
-	void		freeParts();
-	void		makeBody();
-	void		makeBarrel();
-	void		makeTurret();
-	void		makeLeftTread();
-	void		makeRightTread();
+	TankRenderNode&	getNode(const TankSceneNode*) const;
       private:
-	static GLuint	parts[lastStyle];
-	friend class TankSceneNode;
+	int		lod;
+	bool		shadow;
+	std::vector<const TankSceneNode*> tanks;
     };
-    friend class TankRenderNode;
+    friend class TankBatchNode;
 
   private:
     GLfloat		azimuth, elevation;
@@ -236,13 +220,17 @@ class TankSceneNode : public SceneNode {
     TankRenderNode::Style style;
     OpenGLGState	gstate;
     OpenGLGState	lightsGState;
-    LowTankRenderNode	lowRenderNode;
-    MedTankRenderNode	medRenderNode;
-    HighTankRenderNode	highRenderNode;
-    LowTankRenderNode	shadowRenderNode;
+    TankRenderNode	lowRenderNode;
+    TankRenderNode	medRenderNode;
+    TankRenderNode	highRenderNode;
+    TankRenderNode	shadowRenderNode;
 
     static int			maxLevel;
     static const int		numLOD;
+    static TankBatchNode	lowBatch;
+    static TankBatchNode	medBatch;
+    static TankBatchNode	highBatch;
+    static TankBatchNode	shadowBatch;
 };
 
 extern float curVertScale[3]; /// for the really lame #def
@@ -47,8 +47,19 @@ public:
 
   void build(void);
 
+  // start decoding the texture in the background
+  void preload(void);
+
   void drawString(float scale, GLfloat color[3], const char *str);
 
+  // append the glyph quads for str to verts as GL_T2F_V3F vertices,
+  // starting at (x, y), and return how many vertices were added
+  int addString(float x, float y, float scale, const char *str,
+		std::vector<GLfloat> &verts);
+
+  // set the font state and bind its texture, false if it can't be drawn
+  bool setState(void);
+
   float getStrLength(float scale, const char *str);
 
   void free(void);
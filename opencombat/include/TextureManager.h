@@ -36,6 +36,7 @@ typedef  struct
 }ImageInfo;
 
 class TextureManager;
+class TextureJob;
 
 struct ProcTextureInit
 {
@@ -47,12 +48,29 @@ struct ProcTextureInit
 
 typedef std::map<std::string, ImageInfo> TextureNameMap;
 typedef std::map<int, ImageInfo*> TextureIDMap;
+typedef std::map<std::string, TextureJob*> TextureJobMap;
 
 class TextureManager : public Singleton<TextureManager>
 {
 public:
   int getTextureID( const char* name, bool reportFail = true );
   int addTexture( const char*, OpenGLTexture *texture  );
+
+  // like getTextureID() but doesn't wait for the image to be decoded;
+  // until update() uploads it the id draws a plain placeholder.  the
+  // size is right straight away but hasAlpha isn't known until then.
+  int requestTexture( const char* name, bool reportFail = true );
+
+  // start decoding a texture on the loader threads so it's ready
+  // by the time somebody asks for it
+  void preload( const char* name );
+
+  // upload textures that have finished decoding, stopping once maxTime
+  // seconds have gone by.  returns how many are still outstanding.
+  int update( float maxTime );
+
+  // seconds spent creating textures from decoded images
+  float getUploadTime() const;
   
   bool bind ( int id );
   bool bind ( const char* name );
@@ -73,11 +91,16 @@ private:
   ~TextureManager();
 
   OpenGLTexture* loadTexture( FileTextureInit &init, bool reportFail = true  );
+  TextureJob*    startTexture( const std::string &name );
+  int            finishTexture( const std::string &name, bool reportFail );
 
   int            lastImageID;
   int            lastBoundID;
   TextureIDMap   textureIDs;
   TextureNameMap textureNames;
+  TextureJobMap  pendingJobs;
+  OpenGLTexture* placeholder;
+  float          uploadTime;
 };
 
 #endif//_TEXTURE_MANAGER_H
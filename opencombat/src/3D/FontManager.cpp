@@ -27,6 +27,10 @@
 #define BLINK_DEPTH	(0.5f)
 #define BLINK_RATE	(0.25f)
 
+// throw the layout cache away once it holds this many strings, so text
+// that changes every frame (times, scores) can't grow it without bound
+#define MAX_TEXT_LAYOUTS (1024)
+
 // initialize the singleton
 template <>
 FontManager* Singleton<FontManager>::_instance = (FontManager*)0;
@@ -73,6 +77,10 @@ FontManager::FontManager() : Singleton<FontManager>()
 {
   faceNames.clear();
   fontFaces.clear();
+  batching = false;
+
+  underlineCallback("underlineColor", this);
+  BZDB.addCallback("underlineColor", underlineCallback, this);
 }
 
 FontManager::~FontManager()
@@ -93,23 +101,43 @@ FontManager::~FontManager()
 
 void FontManager::rebuild(void)	// rebuild all the lists
 {
+  clearLayouts();
+
+  // each font rebuilds itself when it's next drawn, so the ones that
+  // are never used don't cost anything
   FontFaceList::iterator faceItr = fontFaces.begin();
 
   while (faceItr != fontFaces.end()) {
     FontSizeMap::iterator itr = faceItr->begin();
     while (itr != faceItr->end()) {
-      itr->second->build();
+      itr->second->free();
       itr++;
     }
     faceItr++;
   }
 }
 
+void FontManager::preload(std::string faceName)
+{
+  int faceID = getFaceID(faceName);
+  if (faceID < 0)
+    return;
+
+  FontSizeMap::iterator itr = fontFaces[faceID].begin();
+  while (itr != fontFaces[faceID].end()) {
+    itr->second->preload();
+    itr++;
+  }
+}
+
 void FontManager::loadAll(std::string directory)
 {
   if (directory.size() == 0)
     return;
 
+  // new sizes can change which font a layout should use
+  clearLayouts();
+
   OSFile file;
 
   OSDir dir(directory.c_str());
@@ -199,7 +227,7 @@ const char* FontManager::getFaceName(int faceID)
   return fontFaces[faceID].begin()->second->getFaceName();
 }
 
-void FontManager::drawString(float x, float y, float z, int faceID, float size, std::string text)
+void FontManager::drawString(float x, float y, float z, int faceID, float size, const std::string &text)
 {
   if (text.size() == 0)
     return;
@@ -209,155 +237,372 @@ void FontManager::drawString(float x, float y, float z, int faceID, float size,
     return;
   }
 
+  const TextLayout *layout = getLayout(faceID, size, text);
+  if (!layout)
+    return;
+
+  if (batching)
+    batchLayout(*layout, x, y, z);
+  else
+    drawLayout(*layout, x, y, z);
+}
+
+void FontManager::drawString(float x, float y, float z, std::string face, float size, const std::string &text)
+{
+  drawString(x, y, z, getFaceID(face), size, text);
+}
+
+void FontManager::beginBatch(void)
+{
+  batching = true;
+}
+
+void FontManager::flushBatch(void)
+{
+  batching = false;
+
+  GLfloat color[4];
+  glGetFloatv(GL_CURRENT_COLOR, color);
+  GLboolean depthMask;
+  glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+  glDepthMask(0);
+
+  // all the glyphs that use the same texture go out in one draw
+  glNormal3f(0, 0, 1);
+  const GLsizei glyphStride = 9 * sizeof(GLfloat);
+  TextBatchMap::iterator itr = batchGlyphs.begin();
+  while (itr != batchGlyphs.end()) {
+    std::vector<GLfloat> &verts = itr->second;
+    if (verts.size() > 0 && itr->first->setState()) {
+      glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+      glEnableClientState(GL_COLOR_ARRAY);
+      glEnableClientState(GL_VERTEX_ARRAY);
+      glTexCoordPointer(2, GL_FLOAT, glyphStride, &verts[0]);
+      glColorPointer(4, GL_FLOAT, glyphStride, &verts[2]);
+      glVertexPointer(3, GL_FLOAT, glyphStride, &verts[6]);
+      glDrawArrays(GL_QUADS, 0, (GLsizei)verts.size() / 9);
+      glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+      glDisableClientState(GL_COLOR_ARRAY);
+      glDisableClientState(GL_VERTEX_ARRAY);
+    }
+    // keep the storage around for the next frame
+    verts.clear();
+    itr++;
+  }
+
+  // then every underline
+  if (batchLines.size() > 0) {
+    OpenGLGState::resetState();
+    const GLsizei lineStride = 7 * sizeof(GLfloat);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glColorPointer(4, GL_FLOAT, lineStride, &batchLines[0]);
+    glVertexPointer(3, GL_FLOAT, lineStride, &batchLines[4]);
+    glDrawArrays(GL_LINES, 0, (GLsizei)batchLines.size() / 7);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    batchLines.clear();
+  }
+
+  glDepthMask(depthMask);
+  glColor4fv(color);
+}
+
+const TextLayout* FontManager::getLayout(int faceID, float size, const std::string &text)
+{
+  TextLayoutKey key;
+  key.faceID = faceID;
+  key.size = size;
+  key.text = text;
+
+  TextLayoutMap::iterator itr = layouts.find(key);
+  if (itr != layouts.end())
+    return &itr->second;
+
   TextureFont* pFont = getClosestSize(faceID, size);
 
   if (!pFont)
-    return;
+    return NULL;
 
-  float scale = size / (float)pFont->getSize();
+  if (layouts.size() >= MAX_TEXT_LAYOUTS)
+    layouts.clear();
+
+  TextLayout &layout = layouts[key];
+  layout.font = pFont;
+  buildLayout(layout, size / (float)pFont->getSize(), text);
+  return &layout;
+}
 
-  /* 
+void FontManager::buildLayout(TextLayout &layout, float scale, const std::string &text)
+{
+  /*
    * Colorize text based on ANSI codes embedded in it
-   * Break the text every time an ANSI code
-   * is encountered and do a separate pFont->drawString code for
-   * each segment, with the appropriate color parameter
+   * Break the text every time an ANSI code is encountered and
+   * lay out each segment as its own run, with the color and
+   * attributes in effect at that point
    */
 
+  layout.colored = false;
+  layout.underlined = false;
+
   // sane defaults
   bool bright = true;
-  bool blink = false;	  //FIXME: blinking
-  bool underline = false; //FIXME: underline
+  bool blink = false;
+  bool underline = false;
   // negatives are invalid, we use them to signal "no change"
-  GLfloat color[3] = {-1.0f, -1.0f, -1.0f}; 
-
-  // set underline color
-  const char* uColor = BZDB.get("underlineColor").c_str();
-  GLfloat underlineColor[3] = {-1.0f, -1.0f, -1.0f};
-  if (strcasecmp(uColor, "text") == 0) {
-    // use the initialized color, no change
-  } else if (strcasecmp(uColor, "cyan") == 0) {
-    underlineColor[0] = BrightColors[CyanColor][0];
-    underlineColor[1] = BrightColors[CyanColor][1];
-    underlineColor[2] = BrightColors[CyanColor][2];
-  } else if (strcasecmp(uColor, "grey") == 0) {
-    underlineColor[0] = BrightColors[GreyColor][0];
-    underlineColor[1] = BrightColors[GreyColor][1];
-    underlineColor[2] = BrightColors[GreyColor][2];
-  }
+  GLfloat color[3] = {-1.0f, -1.0f, -1.0f};
+
+  float x = 0;
+  std::string::size_type start = 0;
+  while (start <= text.size()) {
+    std::string::size_type code = text.find("\033[", start);
+    std::string::size_type end = (code == std::string::npos) ? text.size() : code;
+
+    // lay out the text up to the code
+    if (end > start) {
+      const std::string segment = text.substr(start, end - start);
+      const float width = layout.font->getStrLength(scale, segment.c_str());
+      const int first = (int)layout.verts.size() / 5;
+      const int count = layout.font->addString(x, 0, scale, segment.c_str(), layout.verts);
+
+      // runs that look the same can be drawn together
+      TextRun *last = layout.runs.size() > 0 ? &layout.runs.back() : NULL;
+      if (last && last->blink == blink && last->underline == underline &&
+	  last->color[0] == color[0] && last->color[1] == color[1] &&
+	  last->color[2] == color[2]) {
+	last->count += count;
+	last->width = x + width - last->x;
+      } else {
+	TextRun run;
+	run.color[0] = color[0];
+	run.color[1] = color[1];
+	run.color[2] = color[2];
+	run.blink = blink;
+	run.underline = underline;
+	run.first = first;
+	run.count = count;
+	run.x = x;
+	run.width = width;
+	layout.runs.push_back(run);
+      }
 
-  /*
-   * ANSI code interpretation is somewhat limited, we only accept values
-   * which have been defined in AnsiCodes.h
-   */
+      if (color[0] >= 0)
+	layout.colored = true;
+      if (underline)
+	layout.underlined = true;
 
-  bool doneLastSection = false;
-  int startSend = 0;
-  int endSend = (int)text.find("\033[", startSend);
-  std::string tmpText;
-  bool tookCareOfANSICode = false;
-  float width = 0;
-  // run at least once
-  if (endSend == -1) {
-    endSend = (int)text.size();
-    doneLastSection = true;
-  }
-  // split string into parts based on the embedded ANSI codes, render each separately
-  // there has got to be a faster way to do this
-  while (endSend >= 0) {
-    // blink the text, if desired
-    if (blink)
-      getBlinkColor(color, color);
-    // render text
-    if (endSend - startSend > 0) {
-      tmpText = text.substr(startSend, (endSend - startSend));
-      // get substr width, we may need it a couple times
-      width = getStrLength(faceID, size, tmpText);
-      glPushMatrix();
-      glTranslatef(x, y, z);
-      GLboolean depthMask;
-      glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
-      glDepthMask(0);
-      pFont->drawString(scale, color, tmpText.c_str());
-      if (underline) {
-	OpenGLGState::resetState();  // FIXME - full reset required?
-	if (underlineColor[0] >= 0)
-	  glColor3fv(underlineColor);
-	// still have a translated matrix, these coordinates are
-	// with respect to the string just drawn
-	glBegin(GL_LINES);
-	glVertex2f(0, -1.0f);
-	glVertex2f(width, -1.0f);
-	glEnd();
-      }
-      glDepthMask(depthMask);
-      glPopMatrix();
-      // x transform for next substr
+      // x offset for next segment
       x += width;
     }
-    if (!doneLastSection) {
-      startSend = (int)text.find("m", endSend) + 1;
+
+    if (code == std::string::npos)
+      break;
+
+    std::string::size_type codeEnd = text.find("m", code);
+    if (codeEnd == std::string::npos) {
+      DEBUG2("Unterminated ANSI code in %s\n", text.c_str());
+      break;
     }
-    // we stopped sending text at an ANSI code, find out what it is and do something about it
-    if (endSend != (int)text.size()) {
-      tookCareOfANSICode = false;
-      tmpText = text.substr(endSend, (text.find("m", endSend) - endSend) + 1);
-      // colors
-      for (int i = 0; i < 8; i++) {
-	if (tmpText == ColorStrings[i]) {
-	  if (bright) {
-	    color[0] = BrightColors[i][0];
-	    color[1] = BrightColors[i][1];
-	    color[2] = BrightColors[i][2];
-	  } else {
-	    color[0] = DimColors[i][0];
-	    color[1] = DimColors[i][1];
-	    color[2] = DimColors[i][2];
-	  }
-	  tookCareOfANSICode = true;
-	  break;
-	}
-      }
-      // didn't find a matching color
-      if (!tookCareOfANSICode) {
-	// settings other than color
-	if (tmpText == ANSI_STR_RESET) {
-	  bright = true;
-	  blink = false;
-	  underline = false;
-	  color[0] = BrightColors[WhiteColor][0];
-	  color[1] = BrightColors[WhiteColor][1];
-	  color[2] = BrightColors[WhiteColor][2];
-	} else if (tmpText == ANSI_STR_RESET_FINAL) {
-	  bright = false;
-	  blink = false;
-	  underline = false;
-	  color[0] = DimColors[WhiteColor][0];
-	  color[1] = DimColors[WhiteColor][1];
-	  color[2] = DimColors[WhiteColor][2];
-	} else if (tmpText == ANSI_STR_BRIGHT) {
-	  bright = true;
-	} else if (tmpText == ANSI_STR_DIM) {
-	  bright = false;
-	} else if (tmpText == ANSI_STR_UNDERLINE) {
-	  underline = !underline;
-	} else if (tmpText == ANSI_STR_BLINK) {
-	  blink = !blink;
+
+    /*
+     * ANSI code interpretation is somewhat limited, we only accept values
+     * which have been defined in AnsiCodes.h
+     */
+    const std::string ansiCode = text.substr(code, codeEnd - code + 1);
+    bool tookCareOfANSICode = false;
+    // colors
+    for (int i = 0; i < 8; i++) {
+      if (ansiCode == ColorStrings[i]) {
+	if (bright) {
+	  color[0] = BrightColors[i][0];
+	  color[1] = BrightColors[i][1];
+	  color[2] = BrightColors[i][2];
 	} else {
-	  DEBUG2("ANSI Code %s not supported\n", tmpText.c_str());
+	  color[0] = DimColors[i][0];
+	  color[1] = DimColors[i][1];
+	  color[2] = DimColors[i][2];
 	}
+	tookCareOfANSICode = true;
+	break;
       }
     }
-    endSend = (int)text.find("\033[", startSend);
-    if ((endSend == -1) && !doneLastSection) {
-      endSend = (int)text.size();
-      doneLastSection = true;
+    // didn't find a matching color
+    if (!tookCareOfANSICode) {
+      // settings other than color
+      if (ansiCode == ANSI_STR_RESET) {
+	bright = true;
+	blink = false;
+	underline = false;
+	color[0] = BrightColors[WhiteColor][0];
+	color[1] = BrightColors[WhiteColor][1];
+	color[2] = BrightColors[WhiteColor][2];
+      } else if (ansiCode == ANSI_STR_RESET_FINAL) {
+	bright = false;
+	blink = false;
+	underline = false;
+	color[0] = DimColors[WhiteColor][0];
+	color[1] = DimColors[WhiteColor][1];
+	color[2] = DimColors[WhiteColor][2];
+      } else if (ansiCode == ANSI_STR_BRIGHT) {
+	bright = true;
+      } else if (ansiCode == ANSI_STR_DIM) {
+	bright = false;
+      } else if (ansiCode == ANSI_STR_UNDERLINE) {
+	underline = !underline;
+      } else if (ansiCode == ANSI_STR_BLINK) {
+	blink = !blink;
+      } else {
+	DEBUG2("ANSI Code %s not supported\n", ansiCode.c_str());
+      }
     }
+
+    start = codeEnd + 1;
   }
 }
 
-void FontManager::drawString(float x, float y, float z, std::string face, float size, std::string text)
+void FontManager::getRunColor(const TextRun &run, GLfloat *color) const
 {
-  drawString(x, y, z, getFaceID(face), size, text);
+  if (run.blink)
+    getBlinkColor(run.color, color);
+  else {
+    color[0] = run.color[0];
+    color[1] = run.color[1];
+    color[2] = run.color[2];
+  }
+}
+
+void FontManager::drawLayout(const TextLayout &layout, float x, float y, float z)
+{
+  glPushMatrix();
+  glTranslatef(x, y, z);
+  GLboolean depthMask;
+  glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+  glDepthMask(0);
+
+  GLfloat color[3];
+  int i;
+  if (layout.verts.size() > 0 && layout.font->setState()) {
+    glInterleavedArrays(GL_T2F_V3F, 0, &layout.verts[0]);
+    glNormal3f(0, 0, 1);
+    for (i = 0; i < (int)layout.runs.size(); i++) {
+      const TextRun &run = layout.runs[i];
+      if (run.count == 0)
+	continue;
+      if (run.color[0] >= 0) {
+	getRunColor(run, color);
+	glColor3fv(color);
+      }
+      glDrawArrays(GL_QUADS, run.first, run.count);
+    }
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+  }
+
+  if (layout.underlined) {
+    OpenGLGState::resetState();
+    glBegin(GL_LINES);
+    for (i = 0; i < (int)layout.runs.size(); i++) {
+      const TextRun &run = layout.runs[i];
+      if (!run.underline)
+	continue;
+      if (underlineColor[0] >= 0) {
+	glColor3fv(underlineColor);
+      } else if (run.color[0] >= 0) {
+	getRunColor(run, color);
+	glColor3fv(color);
+      }
+      // coordinates are with respect to the string origin
+      glVertex2f(run.x, -1.0f);
+      glVertex2f(run.x + run.width, -1.0f);
+    }
+    glEnd();
+  }
+
+  // colored text has always left the color at white
+  if (layout.colored)
+    glColor4f(1, 1, 1, 1);
+
+  glDepthMask(depthMask);
+  glPopMatrix();
+}
+
+void FontManager::batchLayout(const TextLayout &layout, float x, float y, float z)
+{
+  // uncolored runs take whatever color the caller has set
+  GLfloat current[4];
+  glGetFloatv(GL_CURRENT_COLOR, current);
+
+  std::vector<GLfloat> &glyphs = batchGlyphs[layout.font];
+  GLfloat color[4];
+  for (int i = 0; i < (int)layout.runs.size(); i++) {
+    const TextRun &run = layout.runs[i];
+    if (run.color[0] >= 0) {
+      getRunColor(run, color);
+      color[3] = 1.0f;
+    } else {
+      color[0] = current[0];
+      color[1] = current[1];
+      color[2] = current[2];
+      color[3] = current[3];
+    }
+
+    const GLfloat *src = run.count > 0 ? &layout.verts[run.first * 5] : NULL;
+    for (int j = 0; j < run.count; j++, src += 5) {
+      glyphs.push_back(src[0]);
+      glyphs.push_back(src[1]);
+      glyphs.push_back(color[0]);
+      glyphs.push_back(color[1]);
+      glyphs.push_back(color[2]);
+      glyphs.push_back(color[3]);
+      glyphs.push_back(x + src[2]);
+      glyphs.push_back(y + src[3]);
+      glyphs.push_back(z + src[4]);
+    }
+
+    if (run.underline) {
+      const GLfloat *lineColor = underlineColor[0] >= 0 ? underlineColor : color;
+      for (int j = 0; j < 2; j++) {
+	batchLines.push_back(lineColor[0]);
+	batchLines.push_back(lineColor[1]);
+	batchLines.push_back(lineColor[2]);
+	batchLines.push_back(color[3]);
+	batchLines.push_back(x + run.x + (j ? run.width : 0));
+	batchLines.push_back(y - 1.0f);
+	batchLines.push_back(z);
+      }
+    }
+  }
+
+  // leave the color the same as drawing right away would have
+  if (layout.colored)
+    glColor4f(1, 1, 1, 1);
+}
+
+void FontManager::clearLayouts(void)
+{
+  layouts.clear();
+}
+
+void FontManager::underlineCallback(const std::string &, void *data)
+{
+  FontManager *fm = (FontManager*)data;
+
+  // set underline color
+  const std::string uColor = BZDB.get("underlineColor");
+  fm->underlineColor[0] = -1.0f;
+  fm->underlineColor[1] = -1.0f;
+  fm->underlineColor[2] = -1.0f;
+  if (strcasecmp(uColor.c_str(), "text") == 0) {
+    // use the text color, no change
+  } else if (strcasecmp(uColor.c_str(), "cyan") == 0) {
+    fm->underlineColor[0] = BrightColors[CyanColor][0];
+    fm->underlineColor[1] = BrightColors[CyanColor][1];
+    fm->underlineColor[2] = BrightColors[CyanColor][2];
+  } else if (strcasecmp(uColor.c_str(), "grey") == 0) {
+    fm->underlineColor[0] = BrightColors[GreyColor][0];
+    fm->underlineColor[1] = BrightColors[GreyColor][1];
+    fm->underlineColor[2] = BrightColors[GreyColor][2];
+  }
 }
 
 float FontManager::getStrLength(int faceID, float size, std::string text)
@@ -406,6 +651,8 @@ float FontManager::getStrHeight(std::string face, float size, std::string text)
 
 void FontManager::unloadAll(void)
 {
+  clearLayouts();
+
   FontFaceList::iterator faceItr = fontFaces.begin();
 
   while (faceItr != fontFaces.end()) {
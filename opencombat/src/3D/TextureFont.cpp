@@ -148,9 +148,9 @@ bool TextureFont::load(OSFile &file)
   // now get the texture name
   texture = faceName;
 
-  // now wack off the extension;
-  if (extension)
-    faceName.erase(faceName.size() - sizeof(extension), faceName.size());
+  // now wack off the extension and its dot
+  const size_t extensionSize = strlen(extension) + 1;
+  faceName.erase(faceName.size() - extensionSize, faceName.size());
 
   temp = strrchr(faceName.c_str(), '_');
 
@@ -161,8 +161,7 @@ bool TextureFont::load(OSFile &file)
 
   // faceName.erase(faceName.size()-sizeof(temp),faceName.size());
   
-  if (extension)
-    texture.erase(texture.size() - sizeof(extension), texture.size());
+  texture.erase(texture.size() - extensionSize, texture.size());
 
   return (numberOfCharacters > 0);
 }
@@ -172,6 +171,16 @@ void TextureFont::build(void)
   preLoadLists();
 }
 
+void TextureFont::preload(void)
+{
+  if (texture.size() < 1)
+    return;
+
+  TextureManager &tm = TextureManager::instance();
+  std::string textureAndDir = "fonts/" + texture;
+  tm.preload(textureAndDir.c_str());
+}
+
 void TextureFont::preLoadLists(void)
 {
   if (texture.size() < 1) {
@@ -278,21 +287,98 @@ void TextureFont::free(void)
   textureID = -1;
 }
 
-void TextureFont::drawString(float scale, GLfloat color[3], const char *str)
+bool TextureFont::setState(void)
 {
-  if (!str)
-    return;
-
   if (textureID == -1)
     preLoadLists();
 
   if (textureID == -1)
-    return;
+    return false;
 
   gstate.setState();
 
   TextureManager &tm = TextureManager::instance();
-  if (!tm.bind(textureID))
+  return tm.bind(textureID);
+}
+
+static inline void addVertex(std::vector<GLfloat> &verts, float s, float t, float x, float y)
+{
+  verts.push_back(s);
+  verts.push_back(t);
+  verts.push_back(x);
+  verts.push_back(y);
+  verts.push_back(0);
+}
+
+int TextureFont::addString(float x, float y, float scale, const char *str,
+			   std::vector<GLfloat> &verts)
+{
+  if (!str)
+    return 0;
+
+  const int start = (int)verts.size();
+
+  // same walk as drawString, but the pen is tracked here instead of in
+  // the modelview matrix so the quads can go out in one batch
+  float penX = 0;
+  float penY = 0;
+  int len = (int)strlen(str);
+  int charToUse = 0;
+  int lastCharacter = 0;
+  for (int i = 0; i < len; i++) {
+    if (str[i] == '\n') {	// newline, get back to the intial X and push down
+      penX = 0;
+      penY -= (float)textureZStep;
+    } else {
+      lastCharacter = charToUse;
+      if ((str[i] < 32) || (str[i] < 9))
+	charToUse = 32;
+      else if (str[i] > numberOfCharacters + 32)
+	charToUse = 32;
+      else
+	charToUse = str[i];
+
+      charToUse -= 32;
+
+      const trFontMetrics &metrics = fontMetrics[charToUse];
+      if (charToUse == 0) {
+	if (i == 0)
+	  penX += (float)metrics.initialDist + (float)metrics.charWidth + (float)metrics.whiteSpaceDist;
+	else
+	  penX += (float)fontMetrics[lastCharacter].whiteSpaceDist + (float)metrics.whiteSpaceDist + metrics.initialDist + (float)metrics.charWidth;
+      } else if (charToUse < numberOfCharacters) {	// no list, so drawString skips it too
+	float fFontY = (float)metrics.endY - metrics.startY;
+	float fFontX = (float)metrics.endX - metrics.startX;
+
+	float s0 = (float)metrics.startX / (float)textureXSize;
+	float s1 = (float)metrics.endX / (float)textureXSize;
+	float t0 = 1.0f - (float)metrics.startY / (float)textureYSize;
+	float t1 = 1.0f - (float)metrics.endY / (float)textureYSize;
+
+	float x0 = x + (penX + (float)metrics.initialDist) * scale;
+	float x1 = x0 + fFontX * scale;
+	float y0 = y + penY * scale;
+	float y1 = y0 + fFontY * scale;
+
+	addVertex(verts, s0, t0, x0, y1);
+	addVertex(verts, s0, t1, x0, y0);
+	addVertex(verts, s1, t1, x1, y0);
+	addVertex(verts, s1, t0, x1, y1);
+
+	penX += (float)metrics.initialDist + fFontX;
+      }
+    }
+  }
+
+  return ((int)verts.size() - start) / 5;
+}
+
+void TextureFont::drawString(float scale, GLfloat color[3], const char *str)
+{
+  if (!str)
+    return;
+
+  if (!setState())
     return;
 
   if (color[0] >= 0)
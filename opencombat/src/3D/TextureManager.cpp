@@ -20,6 +20,8 @@
 #include "global.h"
 #include "MediaFile.h"
 #include "ErrorHandler.h"
+#include "AssetLoader.h"
+#include "TimeKeeper.h"
 
 /*const int NO_VARIANT = (-1); */
 
@@ -32,6 +34,31 @@ static int noiseProc(ProcTextureInit &init);
 
 ProcTextureInit procLoader[1];
 
+// decodes one image on a loader thread.  the file is opened (and its
+// header read) on the main thread so a missing file is known at once.
+class TextureJob : public AssetJob {
+public:
+  TextureJob(ImageFile *_file, int _width, int _height)
+    : file(_file), image(NULL), width(_width), height(_height) {}
+  ~TextureJob()
+  {
+    MediaFile::closeImage(file);
+    delete[] image;
+  }
+
+  void load()
+  {
+    int dx, dy;
+    image = MediaFile::readImage(file, &dx, &dy);
+    file = NULL;
+  }
+
+  ImageFile     *file;
+  unsigned char *image;
+  int           width;
+  int           height;
+};
+
 TextureManager::TextureManager()
 {
   // fill out the standard proc textures
@@ -41,8 +68,18 @@ TextureManager::TextureManager()
 
   lastImageID = -1;
   lastBoundID = -1;
+  uploadTime = 0.0f;
 
   int i, numTextures;
+
+  // requested textures show this until their image is ready
+  unsigned char grey[4 * 4];
+  for (i = 0; i < 4 * 4; i += 4) {
+    grey[i+0] = grey[i+1] = grey[i+2] = 0x80;
+    grey[i+3] = 0xff;
+  }
+  placeholder = new OpenGLTexture(2, 2, grey, OpenGLTexture::Nearest, true);
+
   numTextures = countof(procLoader);
   for (i = 0; i < numTextures; i++) {
     procLoader[i].manager = this;
@@ -52,15 +89,24 @@ TextureManager::TextureManager()
 
 TextureManager::~TextureManager()
 {
+  // drop whatever is still being decoded
+  AssetLoader &loader = AssetLoader::instance();
+  for (TextureJobMap::iterator job = pendingJobs.begin(); job != pendingJobs.end(); ++job) {
+    loader.cancel(job->second);
+    delete job->second;
+  }
+  pendingJobs.clear();
+
   // we are done remove all textures
   for (TextureNameMap::iterator it = textureNames.begin(); it != textureNames.end(); ++it) {
     ImageInfo &tex = it->second;
-    if (tex.texture != NULL) {
+    if (tex.texture != NULL && tex.texture != placeholder) {
       delete tex.texture;
     }
   }
   textureNames.clear();
   textureIDs.clear();
+  delete placeholder;
 }
 
 int TextureManager::getTextureID( const char* name, bool reportFail )
@@ -71,6 +117,14 @@ int TextureManager::getTextureID( const char* name, bool reportFail )
   }
 
   std::string texName = name;
+  // if it's being decoded in the background finish it now
+  if (pendingJobs.find(texName) != pendingJobs.end()) {
+    int id = finishTexture(texName, reportFail);
+    if (id < 0)
+      DEBUG2("Image not found or unloadable: %s\n", name);
+    return id;
+  }
+
   // see if we have the texture
   TextureNameMap::iterator it = textureNames.find(texName);
   if (it != textureNames.end()) {
@@ -90,6 +144,93 @@ int TextureManager::getTextureID( const char* name, bool reportFail )
   return -1;
 }
 
+int TextureManager::requestTexture( const char* name, bool reportFail )
+{
+  if (!name)
+    return getTextureID(name, reportFail);
+
+  std::string texName = name;
+  TextureNameMap::iterator it = textureNames.find(texName);
+  if (it != textureNames.end())
+    return it->second.id;
+
+  TextureJobMap::iterator job = pendingJobs.find(texName);
+  if (job == pendingJobs.end()) {
+    TextureJob *newJob = startTexture(texName);
+    if (!newJob) {
+      if (reportFail) {
+	std::vector<std::string> args;
+	args.push_back(texName);
+	printError("cannot load texture: {1}", &args);
+      }
+      DEBUG2("Image not found or unloadable: %s\n", name);
+      return -1;
+    }
+    job = pendingJobs.find(texName);
+  }
+
+  // hand out an id now and swap the real texture in under it later
+  ImageInfo info;
+  info.name = texName;
+  info.texture = placeholder;
+  info.id = ++lastImageID;
+  info.alpha = false;
+  info.x = job->second->width;
+  info.y = job->second->height;
+
+  textureNames[texName] = info;
+  textureIDs[info.id] = &textureNames[texName];
+
+  DEBUG4("Requested texture %s: id %d\n", name, info.id);
+
+  return info.id;
+}
+
+void TextureManager::preload( const char* name )
+{
+  if (!name)
+    return;
+
+  std::string texName = name;
+  if (textureNames.find(texName) != textureNames.end() ||
+      pendingJobs.find(texName) != pendingJobs.end())
+    return;
+
+  // a missing file is reported when somebody actually asks for it
+  startTexture(texName);
+}
+
+int TextureManager::update( float maxTime )
+{
+  if (pendingJobs.empty())
+    return 0;
+
+  AssetLoader &loader = AssetLoader::instance();
+  TimeKeeper start = TimeKeeper::getCurrent();
+
+  TextureJobMap::iterator it = pendingJobs.begin();
+  while (it != pendingJobs.end()) {
+    if (!loader.isDone(it->second)) {
+      ++it;
+      continue;
+    }
+    // finishing erases the entry
+    const std::string name = it->first;
+    ++it;
+    finishTexture(name, true);
+
+    if (TimeKeeper::getCurrent() - start > maxTime)
+      break;
+  }
+
+  return (int)pendingJobs.size();
+}
+
+float TextureManager::getUploadTime() const
+{
+  return uploadTime;
+}
+
 bool TextureManager::bind ( int id )
 {
   TextureIDMap::iterator it = textureIDs.find(id);
@@ -164,11 +305,20 @@ int TextureManager::addTexture( const char* name, OpenGLTexture *texture )
 
   // if the texture already exists kill it
   // this is why IDs are way better than objects for this stuff
+  // a new texture beats one that's still being decoded
+  TextureJobMap::iterator job = pendingJobs.find(name);
+  if (job != pendingJobs.end()) {
+    AssetLoader::instance().cancel(job->second);
+    delete job->second;
+    pendingJobs.erase(job);
+  }
+
   TextureNameMap::iterator it = textureNames.find(name);
   if (it != textureNames.end()) {
    DEBUG3("Texture %s already exists, overwriting\n", name);
    textureIDs.erase(textureIDs.find(it->second.id));
-   delete it->second.texture;
+   if (it->second.texture != placeholder)
+     delete it->second.texture;
   }
   ImageInfo info;
   info.name = name;
@@ -222,6 +372,78 @@ OpenGLTexture* TextureManager::loadTexture(FileTextureInit &init, bool reportFai
   return texture;
 }
 
+TextureJob* TextureManager::startTexture(const std::string &name)
+{
+  // same search as loadTexture()
+  int width, height;
+  ImageFile *file = NULL;
+  if (BZDB.isSet("altImageDir")) {
+    std::string nameToTry = BZDB.get("altImageDir");
+#ifdef WIN32
+    nameToTry += '\\';
+#else
+    nameToTry += '/';
+#endif
+    nameToTry += name;
+    file = MediaFile::openImage(nameToTry, &width, &height);
+  }
+  if (!file)
+    file = MediaFile::openImage(name, &width, &height);
+  if (!file)
+    return NULL;
+
+  TextureJob *job = new TextureJob(file, width, height);
+  pendingJobs[name] = job;
+  AssetLoader::instance().queue(job);
+  return job;
+}
+
+int TextureManager::finishTexture(const std::string &name, bool reportFail)
+{
+  TextureJobMap::iterator it = pendingJobs.find(name);
+  TextureJob *job = it->second;
+  pendingJobs.erase(it);
+
+  // normally it's done already and this doesn't block
+  AssetLoader::instance().wait(job);
+
+  TimeKeeper start = TimeKeeper::getCurrent();
+
+  OpenGLTexture *texture = NULL;
+  if (job->image) {
+    texture = new OpenGLTexture(job->width, job->height, job->image,
+				OpenGLTexture::LinearMipmapLinear, true);
+  } else if (reportFail) {
+    std::vector<std::string> args;
+    args.push_back(name);
+    printError("cannot load texture: {1}", &args);
+  }
+  delete job;
+
+  int id = -1;
+  TextureNameMap::iterator entry = textureNames.find(name);
+  if (entry == textureNames.end()) {
+    if (texture)
+      id = addTexture(name.c_str(), texture);
+  } else {
+    // swap the image in under the id the placeholder was handed out with
+    ImageInfo &info = entry->second;
+    id = info.id;
+    if (texture) {
+      info.texture = texture;
+      info.alpha = texture->hasAlpha();
+      info.x = texture->getWidth();
+      info.y = texture->getHeight();
+      if (lastBoundID == id)
+	lastBoundID = -1;
+      DEBUG4("Finished texture %s: id %d\n", name.c_str(), id);
+    }
+  }
+
+  uploadTime += TimeKeeper::getCurrent() - start;
+  return id;
+}
+
 int TextureManager::newTexture(const char* name, int x, int y, unsigned char* data, OpenGLTexture::Filter filter, bool repeat, int format)
 {
   return addTexture(name, new OpenGLTexture(x, y, data, filter, repeat, format));
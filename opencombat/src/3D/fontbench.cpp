@@ -0,0 +1,433 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * fontbench:
+ *	Offline benchmark for the FontManager text layout cache.  Draws a
+ *	scoreboard-sized HUD frame of plain, colored and underlined strings
+ *	three ways: split on its ANSI codes and drawn glyph by glyph through
+ *	the display lists every call, as FontManager used to, then through
+ *	the layout cache one string at a time, then batched.  Each string
+ *	is captured in GL feedback mode to check that all three draw the
+ *	same primitives, then the frames are timed.
+ *
+ *	usage: fontbench [data directory] [frames]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "common.h"
+#include "bzfgl.h"
+#include "bzfSDL.h"
+#include "AnsiCodes.h"
+#include "FontManager.h"
+#include "OpenGLGState.h"
+#include "OSFile.h"
+#include "StateDatabase.h"
+#include "TextureFont.h"
+#include "TimeKeeper.h"
+
+const int		WindowWidth = 640;
+const int		WindowHeight = 480;
+const int		FrameStrings = 45;
+const int		FeedbackSize = 1 << 20;
+
+// what the client code expects from bzflag
+int			debugLevel = 0;
+
+typedef struct {
+  const char*		face;
+  int			fileSize;	/* the font getClosestSize picks */
+  float			drawSize;
+  int			faceID;
+  TextureFont*		font;
+} BenchFont;
+
+static BenchFont	fonts[] = {
+  { "LuxiMono",		16, 14.0f, -1, NULL },
+  { "TogaSansBold",	16, 16.0f, -1, NULL },
+  { "VeraMonoBold",	12, 12.0f, -1, NULL }
+};
+const int		NumFonts = sizeof(fonts) / sizeof(fonts[0]);
+
+typedef std::vector<GLfloat> Primitive;
+
+/*
+ * drawString as it was, minus blinking, which the script doesn't use
+ */
+
+static GLfloat		BrightColors[8][3] = {
+  {1.0f,1.0f,0.0f}, // yellow
+  {1.0f,0.0f,0.0f}, // red
+  {0.0f,1.0f,0.0f}, // green
+  {0.1f,0.2f,1.0f}, // blue
+  {1.0f,0.0f,1.0f}, // purple
+  {1.0f,1.0f,1.0f}, // white
+  {0.5f,0.5f,0.5f}, // grey
+  {0.0f,1.0f,1.0f}  // cyan
+};
+static GLfloat		DimColors[8][3] = {
+  {0.7f,0.7f,0.0f}, // yellow
+  {0.7f,0.0f,0.0f}, // red
+  {0.0f,0.7f,0.0f}, // green
+  {0.1f,0.1f,0.7f}, // blue
+  {0.7f,0.0f,0.7f}, // purple
+  {0.7f,0.7f,0.7f}, // white
+  {0.0f,0.0f,0.0f}, // black
+  {0.0f,0.7f,0.7f}  // cyan
+};
+
+static void		oldDrawString(float x, float y, float z,
+				      const BenchFont& bench,
+				      const std::string& text)
+{
+  if (text.size() == 0)
+    return;
+
+  TextureFont* pFont = bench.font;
+  float scale = bench.drawSize / (float)pFont->getSize();
+
+  bool bright = true;
+  bool underline = false;
+  GLfloat color[3] = {-1.0f, -1.0f, -1.0f};
+
+  // set underline color, looked up every call
+  const char* uColor = BZDB.get("underlineColor").c_str();
+  GLfloat underlineColor[3] = {-1.0f, -1.0f, -1.0f};
+  if (strcasecmp(uColor, "cyan") == 0) {
+    underlineColor[0] = BrightColors[CyanColor][0];
+    underlineColor[1] = BrightColors[CyanColor][1];
+    underlineColor[2] = BrightColors[CyanColor][2];
+  } else if (strcasecmp(uColor, "grey") == 0) {
+    underlineColor[0] = BrightColors[GreyColor][0];
+    underlineColor[1] = BrightColors[GreyColor][1];
+    underlineColor[2] = BrightColors[GreyColor][2];
+  }
+
+  bool doneLastSection = false;
+  int startSend = 0;
+  int endSend = (int)text.find("\033[", startSend);
+  std::string tmpText;
+  bool tookCareOfANSICode = false;
+  float width = 0;
+  if (endSend == -1) {
+    endSend = (int)text.size();
+    doneLastSection = true;
+  }
+  while (endSend >= 0) {
+    if (endSend - startSend > 0) {
+      tmpText = text.substr(startSend, (endSend - startSend));
+      width = pFont->getStrLength(scale, tmpText.c_str());
+      glPushMatrix();
+      glTranslatef(x, y, z);
+      GLboolean depthMask;
+      glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+      glDepthMask(0);
+      pFont->drawString(scale, color, tmpText.c_str());
+      if (underline) {
+	OpenGLGState::resetState();
+	if (underlineColor[0] >= 0)
+	  glColor3fv(underlineColor);
+	glBegin(GL_LINES);
+	glVertex2f(0, -1.0f);
+	glVertex2f(width, -1.0f);
+	glEnd();
+      }
+      glDepthMask(depthMask);
+      glPopMatrix();
+      x += width;
+    }
+    if (!doneLastSection) {
+      startSend = (int)text.find("m", endSend) + 1;
+    }
+    if (endSend != (int)text.size()) {
+      tookCareOfANSICode = false;
+      tmpText = text.substr(endSend, (text.find("m", endSend) - endSend) + 1);
+      for (int i = 0; i < 8; i++) {
+	if (tmpText == ColorStrings[i]) {
+	  if (bright) {
+	    color[0] = BrightColors[i][0];
+	    color[1] = BrightColors[i][1];
+	    color[2] = BrightColors[i][2];
+	  } else {
+	    color[0] = DimColors[i][0];
+	    color[1] = DimColors[i][1];
+	    color[2] = DimColors[i][2];
+	  }
+	  tookCareOfANSICode = true;
+	  break;
+	}
+      }
+      if (!tookCareOfANSICode) {
+	if (tmpText == ANSI_STR_RESET) {
+	  bright = true;
+	  underline = false;
+	  color[0] = BrightColors[WhiteColor][0];
+	  color[1] = BrightColors[WhiteColor][1];
+	  color[2] = BrightColors[WhiteColor][2];
+	} else if (tmpText == ANSI_STR_RESET_FINAL) {
+	  bright = false;
+	  underline = false;
+	  color[0] = DimColors[WhiteColor][0];
+	  color[1] = DimColors[WhiteColor][1];
+	  color[2] = DimColors[WhiteColor][2];
+	} else if (tmpText == ANSI_STR_BRIGHT) {
+	  bright = true;
+	} else if (tmpText == ANSI_STR_DIM) {
+	  bright = false;
+	} else if (tmpText == ANSI_STR_UNDERLINE) {
+	  underline = !underline;
+	}
+      }
+    }
+    endSend = (int)text.find("\033[", startSend);
+    if ((endSend == -1) && !doneLastSection) {
+      endSend = (int)text.size();
+      doneLastSection = true;
+    }
+  }
+}
+
+/*
+ * the script
+ */
+
+static std::vector<std::string>	makeStrings()
+{
+  std::vector<std::string> strings;
+  strings.push_back("Score: 12 (3-4)[0]");
+  strings.push_back("  leading spaces and a\ttab");
+  strings.push_back(std::string(ANSI_STR_FG_RED) + "Red Team" +
+		    ANSI_STR_RESET + " 4 wins");
+  strings.push_back(std::string(ANSI_STR_FG_GREEN) + "lagger" +
+		    ANSI_STR_FG_CYAN + " [12] " + ANSI_STR_FG_WHITE +
+		    "12 frags, 3 teamkills");
+  strings.push_back(std::string("plain then ") + ANSI_STR_FG_CYAN + "cyan " +
+		    ANSI_STR_UNDERLINE + "underlined" + ANSI_STR_UNDERLINE +
+		    " not");
+  strings.push_back(std::string(ANSI_STR_DIM) + ANSI_STR_FG_YELLOW +
+		    "dim yellow\nsecond line");
+  strings.push_back(std::string(ANSI_STR_FG_BLUE) + "Blue Team: " +
+		    ANSI_STR_UNDERLINE + ANSI_STR_FG_MAGENTA + "flag~carrier" +
+		    ANSI_STR_RESET_FINAL + " {}|<>");
+  return strings;
+}
+
+enum DrawMode { OldDraw, CachedDraw, BatchedDraw };
+
+static void		drawFrame(DrawMode mode, int frame,
+				  const std::vector<std::string>& strings)
+{
+  FontManager& fm = FontManager::instance();
+  char clock[32];
+
+  if (mode == BatchedDraw)
+    fm.beginBatch();
+  for (int i = 0; i < FrameStrings; i++) {
+    const BenchFont& font = fonts[i % NumFonts];
+    const float x = 10.0f + (float)(i % 3) * 200.0f;
+    const float y = (float)WindowHeight - 30.0f - (float)(i / 3) * 28.0f;
+    glColor3f(0.25f, 0.5f, 0.75f);
+    // the first few change every frame, like clocks and scores do
+    std::string text;
+    if (i < 5) {
+      sprintf(clock, "%d:%02d.%d", frame / 600, (frame / 10) % 60, i);
+      text = clock;
+    } else {
+      text = strings[i % strings.size()];
+    }
+    if (mode == OldDraw)
+      oldDrawString(x, y, 0.0f, font, text);
+    else
+      fm.drawString(x, y, 0.0f, font.faceID, font.drawSize, text);
+  }
+  if (mode == BatchedDraw)
+    fm.flushBatch();
+}
+
+static double		timeFrames(DrawMode mode, int frames,
+				   const std::vector<std::string>& strings)
+{
+  glFinish();
+  TimeKeeper start = TimeKeeper::getCurrent();
+  for (int f = 0; f < frames; f++) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawFrame(mode, f, strings);
+    glFinish();
+  }
+  return TimeKeeper::getCurrent() - start;
+}
+
+/*
+ * feedback capture.  the paths draw the same primitives in different
+ * orders, so each is rounded and sorted before they're compared.
+ */
+
+static GLfloat		feedback[FeedbackSize];
+
+static std::vector<Primitive>	capture(DrawMode mode, const BenchFont& font,
+					const std::string& text)
+{
+  FontManager& fm = FontManager::instance();
+
+  glFeedbackBuffer(FeedbackSize, GL_3D_COLOR_TEXTURE, feedback);
+  glRenderMode(GL_FEEDBACK);
+  glColor3f(0.25f, 0.5f, 0.75f);
+  if (mode == OldDraw) {
+    oldDrawString(20.0f, 200.0f, 0.0f, font, text);
+  } else {
+    if (mode == BatchedDraw)
+      fm.beginBatch();
+    fm.drawString(20.0f, 200.0f, 0.0f, font.faceID, font.drawSize, text);
+    if (mode == BatchedDraw)
+      fm.flushBatch();
+  }
+  const int size = glRenderMode(GL_RENDER);
+
+  // a vertex is x, y, z, rgba and strq
+  const int vertexSize = 11;
+  std::vector<Primitive> prims;
+  for (int n = 0; n < size; ) {
+    const int token = (int)feedback[n++];
+    int vertices = 0;
+    if (token == GL_POLYGON_TOKEN)
+      vertices = (int)feedback[n++];
+    else if (token == GL_LINE_TOKEN || token == GL_LINE_RESET_TOKEN)
+      vertices = 2;
+    else if (token == GL_PASS_THROUGH_TOKEN)
+      n++;
+    else
+      vertices = 1;
+
+    // underlines are drawn untextured, so whatever texture coordinate
+    // the glyphs left behind doesn't matter
+    const bool textured = (token == GL_POLYGON_TOKEN);
+    Primitive prim;
+    prim.push_back(textured ? 0.0f : 1.0f);
+    for (int v = 0; v < vertices * vertexSize; v++, n++) {
+      if (textured || v % vertexSize < 7)
+	prim.push_back(floorf(feedback[n] * 100.0f + 0.5f) / 100.0f);
+    }
+    if (vertices > 0)
+      prims.push_back(prim);
+  }
+  std::sort(prims.begin(), prims.end());
+  return prims;
+}
+
+static bool		samePrimitives(const std::vector<Primitive>& a,
+				       const std::vector<Primitive>& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].size() != b[i].size())
+      return false;
+    for (size_t j = 0; j < a[i].size(); j++)
+      if (fabsf(a[i][j] - b[i][j]) > 0.02f)
+	return false;
+  }
+  return true;
+}
+
+int			main(int argc, char** argv)
+{
+  const std::string dataDir = (argc > 1) ? argv[1] : "data";
+  const int frames = (argc > 2) ? atoi(argv[2]) : 2000;
+
+  if (SDL_Init(SDL_INIT_VIDEO) == -1 ||
+      !SDL_SetVideoMode(WindowWidth, WindowHeight, 0, SDL_OPENGL)) {
+    printf("cannot open a window: %s\n", SDL_GetError());
+    return 1;
+  }
+  glViewport(0, 0, WindowWidth, WindowHeight);
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  glOrtho(0.0, WindowWidth, 0.0, WindowHeight, -1.0, 1.0);
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+  OpenGLGState::init();
+
+  // a fixed underline color, "text" changed on purpose with the cache
+  BZDB.set("directory", dataDir);
+  BZDB.set("underlineColor", "cyan");
+  FontManager& fm = FontManager::instance();
+  fm.loadAll(dataDir + "/fonts");
+
+  int i;
+  for (i = 0; i < NumFonts; i++) {
+    char name[256];
+    sprintf(name, "%s/fonts/%s_%d.fmt", dataDir.c_str(),
+	    fonts[i].face, fonts[i].fileSize);
+    OSFile file(name);
+    fonts[i].font = new TextureFont;
+    fonts[i].faceID = fm.getFaceID(fonts[i].face);
+    if (!fonts[i].font->load(file) || fonts[i].faceID < 0) {
+      printf("cannot load font %s\n", name);
+      return 1;
+    }
+  }
+
+  // every string in every font, drawn alone
+  const std::vector<std::string> strings = makeStrings();
+  int checked = 0, differ = 0;
+  for (i = 0; i < NumFonts; i++) {
+    for (size_t s = 0; s < strings.size(); s++) {
+      const std::vector<Primitive> oldPrims = capture(OldDraw, fonts[i], strings[s]);
+      const std::vector<Primitive> cachedPrims = capture(CachedDraw, fonts[i], strings[s]);
+      const std::vector<Primitive> batchedPrims = capture(BatchedDraw, fonts[i], strings[s]);
+      if (oldPrims.size() == 0 ||
+	  !samePrimitives(oldPrims, cachedPrims) ||
+	  !samePrimitives(oldPrims, batchedPrims)) {
+	printf("%s %g: string %d differs (%d, %d and %d primitives)\n",
+	       fonts[i].face, fonts[i].drawSize, (int)s, (int)oldPrims.size(),
+	       (int)cachedPrims.size(), (int)batchedPrims.size());
+	differ++;
+      }
+      checked++;
+    }
+  }
+
+  // warm up the display lists, textures and layout cache
+  timeFrames(OldDraw, 10, strings);
+  timeFrames(BatchedDraw, 10, strings);
+
+  const double oldTime = timeFrames(OldDraw, frames, strings);
+  const double cachedTime = timeFrames(CachedDraw, frames, strings);
+  const double batchedTime = timeFrames(BatchedDraw, frames, strings);
+
+  printf("%d frames of %d strings, %s\n", frames, FrameStrings,
+	 (const char*)glGetString(GL_RENDERER));
+  printf("display lists: %8.1f usec/frame\n", oldTime / frames * 1.0e6);
+  printf("layout cache:  %8.1f usec/frame (%.2fx)\n",
+	 cachedTime / frames * 1.0e6, oldTime / cachedTime);
+  printf("batched:       %8.1f usec/frame (%.2fx)\n",
+	 batchedTime / frames * 1.0e6, oldTime / batchedTime);
+  printf("%d of %d strings differ\n", differ, checked);
+
+  for (i = 0; i < NumFonts; i++)
+    delete fonts[i].font;
+  SDL_Quit();
+  return (differ > 0) ? 1 : 0;
+}
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
@@ -0,0 +1,376 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifdef _MSC_VER
+#pragma warning( 4: 4786 )
+#endif
+
+#include "AssetLoader.h"
+#include "TimeKeeper.h"
+#include "bzfio.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#define	ASSET_LOADER_THREADS
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#include <unistd.h>
+#define	ASSET_LOADER_THREADS
+#endif
+
+// never start more threads than this.  decoding is mostly memory and
+// disk bound, a few threads are enough to keep both busy.
+static const int	MaxLoaderThreads = 4;
+
+//
+// the lock and signals shared by the loader threads.  there's only
+// ever one loader so they live here rather than in the class.
+//
+
+#if defined(_WIN32)
+
+static CRITICAL_SECTION	jobLock;
+static HANDLE		jobQueued;	// semaphore, one count per job
+static HANDLE		jobFinished;	// manual reset, main thread resets
+static HANDLE		threads[MaxLoaderThreads];
+
+static void		lockJobs()	{ EnterCriticalSection(&jobLock); }
+static void		unlockJobs()	{ LeaveCriticalSection(&jobLock); }
+
+static DWORD WINAPI	loaderThread(LPVOID self);
+
+#elif defined(HAVE_PTHREAD)
+
+static pthread_mutex_t	jobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	jobQueued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	jobFinished = PTHREAD_COND_INITIALIZER;
+static pthread_t	threads[MaxLoaderThreads];
+
+static void		lockJobs()	{ pthread_mutex_lock(&jobLock); }
+static void		unlockJobs()	{ pthread_mutex_unlock(&jobLock); }
+
+static void*		loaderThread(void* self);
+
+#else
+
+static void		lockJobs()	{ }
+static void		unlockJobs()	{ }
+
+#endif
+
+//
+// AssetJob
+//
+
+AssetJob::AssetJob() : state(Idle)
+{
+  // do nothing
+}
+
+AssetJob::~AssetJob()
+{
+  // do nothing
+}
+
+//
+// AssetLoader
+//
+
+// initialize the singleton
+template <>
+AssetLoader* Singleton<AssetLoader>::_instance = (AssetLoader*)0;
+
+AssetLoader::AssetLoader() : numThreads(0), quitting(false),
+				numLoaded(0), waitTime(0.0f)
+{
+#if defined(_WIN32)
+  InitializeCriticalSection(&jobLock);
+  jobQueued = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+  jobFinished = CreateEvent(NULL, TRUE, FALSE, NULL);
+#endif
+}
+
+AssetLoader::~AssetLoader()
+{
+  stop();
+#if defined(_WIN32)
+  CloseHandle(jobFinished);
+  CloseHandle(jobQueued);
+  DeleteCriticalSection(&jobLock);
+#endif
+}
+
+void			AssetLoader::start(int count)
+{
+  if (numThreads > 0)
+    return;
+
+  if (count <= 0) {
+    // leave a processor for the game itself
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    count = (int)info.dwNumberOfProcessors - 1;
+#elif defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+#endif
+    if (count < 1)
+      count = 1;
+  }
+  if (count > MaxLoaderThreads)
+    count = MaxLoaderThreads;
+
+#ifdef ASSET_LOADER_THREADS
+  quitting = false;
+  for (int i = 0; i < count; i++) {
+#if defined(_WIN32)
+    DWORD id;
+    threads[i] = CreateThread(NULL, 0, loaderThread, this, 0, &id);
+    if (threads[i] == NULL)
+      break;
+#else
+    if (pthread_create(&threads[i], NULL, loaderThread, this) != 0)
+      break;
+#endif
+    numThreads++;
+  }
+  if (numThreads < count)
+    DEBUG1("Started %d of %d asset loader threads\n", numThreads, count);
+#endif
+}
+
+void			AssetLoader::stop()
+{
+#ifdef ASSET_LOADER_THREADS
+  if (numThreads == 0)
+    return;
+
+  lockJobs();
+  quitting = true;
+#if defined(_WIN32)
+  ReleaseSemaphore(jobQueued, numThreads, NULL);
+#else
+  pthread_cond_broadcast(&jobQueued);
+#endif
+  unlockJobs();
+
+  for (int i = 0; i < numThreads; i++) {
+#if defined(_WIN32)
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+#else
+    pthread_join(threads[i], NULL);
+#endif
+  }
+  numThreads = 0;
+  quitting = false;
+#endif
+
+  // whatever didn't get started goes back to its owner
+  while (!jobs.empty()) {
+    jobs.front()->state = AssetJob::Idle;
+    jobs.pop_front();
+  }
+}
+
+int			AssetLoader::getNumThreads() const
+{
+  return numThreads;
+}
+
+void			AssetLoader::queue(AssetJob* job)
+{
+  if (!job || job->state == AssetJob::Queued ||
+      job->state == AssetJob::Loading)
+    return;
+
+  if (numThreads == 0) {
+    runJob(job);
+    return;
+  }
+
+  lockJobs();
+  job->state = AssetJob::Queued;
+  jobs.push_back(job);
+#if defined(_WIN32)
+  ReleaseSemaphore(jobQueued, 1, NULL);
+#elif defined(HAVE_PTHREAD)
+  pthread_cond_signal(&jobQueued);
+#endif
+  unlockJobs();
+}
+
+bool			AssetLoader::isDone(AssetJob* job)
+{
+  lockJobs();
+  const bool done = (job->state == AssetJob::Done);
+  unlockJobs();
+  return done;
+}
+
+void			AssetLoader::wait(AssetJob* job)
+{
+  TimeKeeper start = TimeKeeper::getCurrent();
+
+  lockJobs();
+  if (job->state == AssetJob::Queued) {
+    // nobody's on it yet so don't wait behind the rest of the queue
+    removeJob(job);
+    unlockJobs();
+    runJob(job);
+  } else if (job->state == AssetJob::Idle) {
+    unlockJobs();
+    runJob(job);
+  } else {
+    while (job->state != AssetJob::Done) {
+#if defined(_WIN32)
+      ResetEvent(jobFinished);
+      unlockJobs();
+      WaitForSingleObject(jobFinished, INFINITE);
+      lockJobs();
+#elif defined(HAVE_PTHREAD)
+      pthread_cond_wait(&jobFinished, &jobLock);
+#endif
+    }
+    unlockJobs();
+  }
+
+  waitTime += TimeKeeper::getCurrent() - start;
+}
+
+void			AssetLoader::cancel(AssetJob* job)
+{
+  lockJobs();
+  if (job->state == AssetJob::Queued) {
+    removeJob(job);
+    job->state = AssetJob::Idle;
+  }
+  const bool loading = (job->state == AssetJob::Loading);
+  unlockJobs();
+
+  if (loading)
+    wait(job);
+}
+
+int			AssetLoader::getNumLoaded() const
+{
+  return numLoaded;
+}
+
+float			AssetLoader::getWaitTime() const
+{
+  return waitTime;
+}
+
+void			AssetLoader::runJob(AssetJob* job)
+{
+  // runs on the main thread, so nothing else can see the job
+  job->state = AssetJob::Loading;
+  job->load();
+  lockJobs();
+  job->state = AssetJob::Done;
+  numLoaded++;
+  unlockJobs();
+}
+
+void			AssetLoader::removeJob(AssetJob* job)
+{
+  // caller holds the lock.  the thread that would have taken the job
+  // finds the queue empty and goes back to sleep.
+  for (std::deque<AssetJob*>::iterator it = jobs.begin();
+       it != jobs.end(); ++it) {
+    if (*it == job) {
+      jobs.erase(it);
+      break;
+    }
+  }
+}
+
+bool			AssetLoader::nextJob(AssetJob*& job)
+{
+  // caller holds the lock.  returns false when the thread should exit.
+#if defined(_WIN32)
+  unlockJobs();
+  WaitForSingleObject(jobQueued, INFINITE);
+  lockJobs();
+  if (quitting)
+    return false;
+  if (jobs.empty()) {
+    job = NULL;
+    return true;
+  }
+#elif defined(HAVE_PTHREAD)
+  while (jobs.empty() && !quitting)
+    pthread_cond_wait(&jobQueued, &jobLock);
+  if (quitting)
+    return false;
+#endif
+  job = jobs.front();
+  jobs.pop_front();
+  job->state = AssetJob::Loading;
+  return true;
+}
+
+//
+// AssetLoaderThread
+//
+
+class AssetLoaderThread {
+  public:
+    static void		run(AssetLoader*);
+};
+
+void			AssetLoaderThread::run(AssetLoader* loader)
+{
+  AssetJob* job;
+
+  lockJobs();
+  while (loader->nextJob(job)) {
+    if (job == NULL)
+      continue;
+    unlockJobs();
+
+    job->load();
+
+    lockJobs();
+    job->state = AssetJob::Done;
+    loader->numLoaded++;
+#if defined(_WIN32)
+    SetEvent(jobFinished);
+#elif defined(HAVE_PTHREAD)
+    pthread_cond_broadcast(&jobFinished);
+#endif
+  }
+  unlockJobs();
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI	loaderThread(LPVOID self)
+{
+  AssetLoaderThread::run((AssetLoader*)self);
+  return 0;
+}
+#elif defined(HAVE_PTHREAD)
+static void*		loaderThread(void* self)
+{
+  AssetLoaderThread::run((AssetLoader*)self);
+  return NULL;
+}
+#endif
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
@@ -0,0 +1,155 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <math.h>
+#include "common.h"
+#include "AudioMixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define	AUDIO_MIXER_SSE2
+#include <emmintrin.h>
+#endif
+
+/* fade in/out table.  the values are the ones the mixer has always
+ * used:  a quarter sine over the fade, one entry per frame. */
+static float		fadeIn[AudioFadeFrames];
+static float		fadeOut[AudioFadeFrames];
+
+static class FadeTable {
+  public:
+    FadeTable()
+    {
+      for (int i = 0; i < AudioFadeFrames; i++) {
+	fadeIn[i] = sinf(M_PI / 2.0f * (float)(2 * i) /
+			 (float)(2 * AudioFadeFrames - 2));
+	fadeOut[i] = 1.0f - fadeIn[i];
+      }
+    }
+} fadeTable;
+
+void			audioMixStereo(float* dst, const float* src,
+				long frames,
+				float fromLeft, float fromRight,
+				float toLeft, float toRight)
+{
+  long n = 0;
+
+  // the fade is done a frame at a time.  a block shorter than the fade
+  // squeezes the whole fade into what it has.
+  if (frames < AudioFadeFrames) {
+    const long numSamples = 2 * frames;
+    for (; n < frames; n++) {
+      const int fs = (int(2 * AudioFadeFrames * float(2 * n) /
+			  float(numSamples)) & ~1) >> 1;
+      dst[2*n] += src[2*n] * (fadeIn[fs] * toLeft + fadeOut[fs] * fromLeft);
+      dst[2*n+1] += src[2*n+1] * (fadeIn[fs] * toRight + fadeOut[fs] * fromRight);
+    }
+    return;
+  }
+  for (; n < AudioFadeFrames; n++) {
+    dst[2*n] += src[2*n] * (fadeIn[n] * toLeft + fadeOut[n] * fromLeft);
+    dst[2*n+1] += src[2*n+1] * (fadeIn[n] * toRight + fadeOut[n] * fromRight);
+  }
+
+  // then a constant gain for the rest of the block
+  float* d = dst + 2 * n;
+  const float* s = src + 2 * n;
+  long left = frames - n;
+#ifdef AUDIO_MIXER_SSE2
+  const __m128 gain = _mm_set_ps(toRight, toLeft, toRight, toLeft);
+  for (; left >= 4; left -= 4, d += 8, s += 8) {
+    _mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d),
+				_mm_mul_ps(_mm_loadu_ps(s), gain)));
+    _mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4),
+				    _mm_mul_ps(_mm_loadu_ps(s + 4), gain)));
+  }
+#endif
+  for (; left > 0; left--, d += 2, s += 2) {
+    d[0] += s[0] * toLeft;
+    d[1] += s[1] * toRight;
+  }
+}
+
+long			audioResampleMono(float* dst, const float* src,
+				long frames,
+				double* leftPos, double* rightPos,
+				double step, double length, bool loop)
+{
+  double posL = *leftPos;
+  double posR = *rightPos;
+
+  long n = 0;
+  while (n < frames) {
+    // get sample position (to subsample resolution).  an ear can be a
+    // little before the start, in the silent margin, so the fraction
+    // comes from the floor while the index is truncated, as it always was.
+    const long nmL = (long)posL;
+    const long nmR = (long)posR;
+    double floorL = (double)nmL;
+    double floorR = (double)nmR;
+    if (floorL > posL) floorL -= 1.0;
+    if (floorR > posR) floorR -= 1.0;
+    const float fracL = (float)(posL - floorL);
+    const float fracR = (float)(posR - floorR);
+
+    // get sample (lerp closest two samples)
+    dst[2*n] = (1.0f - fracL) * src[nmL] + fracL * src[nmL+1];
+    dst[2*n+1] = (1.0f - fracR) * src[nmR] + fracR * src[nmR+1];
+    n++;
+
+    // next sample
+    posL += step;
+    posR += step;
+    if (loop) {
+      if (posL >= length) posL -= length;
+      if (posR >= length) posR -= length;
+    }
+    else if (posL >= length || posR >= length) {
+      break;
+    }
+  }
+
+  *leftPos = posL;
+  *rightPos = posR;
+  return n;
+}
+
+void			audioConvertToShort(short* dst, const float* src,
+				long samples)
+{
+  long n = 0;
+#ifdef AUDIO_MIXER_SSE2
+  // clamp first so the conversion matches the scalar loop exactly;
+  // packs would saturate to -32768 rather than -32767
+  const __m128 lo = _mm_set1_ps(-32767.0f);
+  const __m128 hi = _mm_set1_ps(32767.0f);
+  for (; n + 8 <= samples; n += 8) {
+    __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + n), lo), hi);
+    __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + n + 4), lo), hi);
+    _mm_storeu_si128((__m128i*)(dst + n),
+		     _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+  }
+#endif
+  for (; n < samples; n++) {
+    if (src[n] < -32767.0f) dst[n] = -32767;
+    else if (src[n] > 32767.0f) dst[n] = 32767;
+    else dst[n] = short(src[n]);
+  }
+}
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
@@ -0,0 +1,154 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "MappedFile.h"
+#include <stdio.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(HAVE_MMAP)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(NULL), size(0), opened(false), mapped(false)
+#if defined(_WIN32)
+				, file(INVALID_HANDLE_VALUE), mapping(NULL)
+#endif
+{
+  // do nothing
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+bool			MappedFile::open(const std::string& filename)
+{
+  close();
+
+#if defined(_WIN32)
+  HANDLE hFile = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+			    NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+  file = hFile;
+  opened = true;
+  size = (size_t)GetFileSize(hFile, NULL);
+  if (size == 0)
+    return true;
+  mapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping != NULL) {
+    data = (const char*)MapViewOfFile((HANDLE)mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data != NULL) {
+      mapped = true;
+      return true;
+    }
+    CloseHandle((HANDLE)mapping);
+    mapping = NULL;
+  }
+#elif defined(HAVE_MMAP)
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+  opened = true;
+  size = (size_t)info.st_size;
+  if (size == 0) {
+    ::close(fd);
+    return true;
+  }
+  void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr != MAP_FAILED) {
+    data = (const char*)addr;
+    mapped = true;
+    return true;
+  }
+#endif
+
+  // no mapping, so read the whole thing
+  FILE* f = fopen(filename.c_str(), "rb");
+  if (f == NULL) {
+    close();
+    return false;
+  }
+  opened = true;
+  fseek(f, 0, SEEK_END);
+  const long length = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  size = 0;
+  if (length > 0) {
+    char* buffer = new char[length];
+    size = fread(buffer, 1, (size_t)length, f);
+    data = buffer;
+  }
+  fclose(f);
+  return true;
+}
+
+void			MappedFile::close()
+{
+  if (mapped) {
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+#elif defined(HAVE_MMAP)
+    munmap((void*)data, size);
+#endif
+  } else {
+    delete[] data;
+  }
+#if defined(_WIN32)
+  if (mapping != NULL)
+    CloseHandle((HANDLE)mapping);
+  if (file != INVALID_HANDLE_VALUE)
+    CloseHandle((HANDLE)file);
+  mapping = NULL;
+  file = INVALID_HANDLE_VALUE;
+#endif
+  data = NULL;
+  size = 0;
+  opened = false;
+  mapped = false;
+}
+
+bool			MappedFile::isOpen() const
+{
+  return opened;
+}
+
+const char*		MappedFile::getData() const
+{
+  return data;
+}
+
+size_t			MappedFile::getSize() const
+{
+  return size;
+}
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
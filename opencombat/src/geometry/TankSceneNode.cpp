@@ -9,7 +9,6 @@
  * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
  * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
  */
-#define _NO_LIST_ID 0xffffffff
 
 #include <stdlib.h>
 #include <math.h>
@@ -26,9 +25,84 @@
 float curVertScale[3] = {1,1,1}; /// for the really lame #def
 float curNormScale[3] = {1,1,1}; /// for the really lame #def
 
+//
+// tank geometry capture
+//
+// the model builders describe each part with immediate mode style
+// calls.  while a part is being built these collect its vertices
+// (T2F_N3F_V3F) and turn every primitive into plain triangles.
+//
+
+static const int		captureStride = 8;
+static std::vector<GLfloat>*	captureTarget = NULL;
+static std::vector<GLfloat>	capturePrim;
+static GLenum			captureMode = GL_TRIANGLES;
+static GLfloat			captureTexCoord[2] = { 0.0f, 0.0f };
+static GLfloat			captureNormal[3] = { 0.0f, 0.0f, 1.0f };
+
+static void captureVertex(int i)
+{
+  const GLfloat* v = &capturePrim[i * captureStride];
+  captureTarget->insert(captureTarget->end(), v, v + captureStride);
+}
+
+void doBegin(GLenum mode)
+{
+  captureMode = mode;
+  capturePrim.clear();
+}
+
+void doEnd()
+{
+  if (captureTarget == NULL)
+    return;
+
+  const int count = (int)capturePrim.size() / captureStride;
+  int i;
+  switch (captureMode) {
+    case GL_TRIANGLES:
+      for (i = 0; i + 2 < count; i += 3) {
+	captureVertex(i);
+	captureVertex(i + 1);
+	captureVertex(i + 2);
+      }
+      break;
+
+    case GL_TRIANGLE_STRIP:
+      // every other triangle is flipped to keep the winding
+      for (i = 0; i + 2 < count; i++) {
+	captureVertex(i + (i & 1));
+	captureVertex(i + 1 - (i & 1));
+	captureVertex(i + 2);
+      }
+      break;
+
+    case GL_TRIANGLE_FAN:
+    case GL_POLYGON:
+      for (i = 1; i + 1 < count; i++) {
+	captureVertex(0);
+	captureVertex(i);
+	captureVertex(i + 1);
+      }
+      break;
+  }
+  capturePrim.clear();
+}
+
+void doTexCoord2f(GLfloat s, GLfloat t)
+{
+  captureTexCoord[0] = s;
+  captureTexCoord[1] = t;
+}
+
 void doVertex3f(GLfloat x, GLfloat y, GLfloat z)
 {
-  glVertex3f(x * curVertScale[0], y * curVertScale[1], z * curVertScale[2]);
+  const GLfloat v[captureStride] = {
+    captureTexCoord[0], captureTexCoord[1],
+    captureNormal[0], captureNormal[1], captureNormal[2],
+    x * curVertScale[0], y * curVertScale[1], z * curVertScale[2]
+  };
+  capturePrim.insert(capturePrim.end(), v, v + captureStride);
 }
 
 void doNormal3f(GLfloat x, GLfloat y, GLfloat z)
@@ -40,9 +114,40 @@ void doNormal3f(GLfloat x, GLfloat y, GLfloat z)
     y *= curNormScale[1] / d;
     z *= curNormScale[2] / d;
   }
-  glNormal3f(x, y, z);
+  captureNormal[0] = x;
+  captureNormal[1] = y;
+  captureNormal[2] = z;
 }
 
+//
+// TankGeometry
+//
+// every part of every style at each level of detail, generated once
+// into one vertex array per level.  these are plain client arrays
+// rather than display lists so they outlive the GL context.  the
+// styles are regenerated when their size factors change.
+//
+
+class TankGeometry {
+  public:
+    enum { NumLOD = 3, NumStyles = 5, NumParts = 5 };
+
+    // the first vertex and vertex count of each part
+    static const GLint*	getParts(int lod, int style);
+    static void		bind(int lod);
+    static void		unbind();
+    static void		clear();
+
+  private:
+    static void		build(int lod, int style);
+
+  private:
+    typedef void	(*Builder)(void);
+    static const Builder builders[NumLOD][NumParts];
+    static std::vector<GLfloat> vertices[NumLOD];
+    static GLint	parts[NumLOD][NumStyles][NumParts][2];
+    static bool		built[NumLOD][NumStyles];
+};
 
 class TankFactors
 {
@@ -71,6 +176,7 @@ public:
 	     styleFactors[4][0] = BZDB.eval(StateDatabase::BZDB_THIEFTINYFACTOR);
 	     styleFactors[4][1] = styleFactors[4][0];
 	  }
+	  TankGeometry::clear();
        }
 
        //Modifiers for Normal, Obese. Tiny, Thin, Thief
@@ -86,10 +192,75 @@ GLfloat TankFactors::styleFactors[5][3] = {
 			{ 1.0f, 1.0f, 1.0f }
 		};
 
+// in the order of TankRenderNode::Part
+const TankGeometry::Builder TankGeometry::builders[NumLOD][NumParts] = {
+  { buildLowBody, buildLowBarrel, buildLowTurret,
+    buildLowLTread, buildLowRTread },
+  { buildMedBody, buildMedBarrel, buildMedTurret,
+    buildMedLTread, buildMedRTread },
+  { buildHighBody, buildHighBarrel, buildHighTurret,
+    buildHighLTread, buildHighRTread }
+};
+std::vector<GLfloat>	TankGeometry::vertices[NumLOD];
+GLint			TankGeometry::parts[NumLOD][NumStyles][NumParts][2];
+bool			TankGeometry::built[NumLOD][NumStyles];
+
+const GLint*		TankGeometry::getParts(int lod, int style)
+{
+  if (!built[lod][style])
+    build(lod, style);
+  return parts[lod][style][0];
+}
+
+void			TankGeometry::bind(int lod)
+{
+  // don't build anything between this and drawing, it'd move the array
+  glInterleavedArrays(GL_T2F_N3F_V3F, 0, &vertices[lod][0]);
+}
+
+void			TankGeometry::unbind()
+{
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void			TankGeometry::clear()
+{
+  for (int lod = 0; lod < NumLOD; lod++) {
+    vertices[lod].clear();
+    for (int style = 0; style < NumStyles; style++)
+      built[lod][style] = false;
+  }
+}
+
+void			TankGeometry::build(int lod, int style)
+{
+  const GLfloat* factors = TankFactors::styleFactors[style];
+  for (int i = 0; i < 3; i++) {
+    curVertScale[i] = factors[i];
+    curNormScale[i] = (factors[i] == 0.0f ? 0.0f : 1.0f / factors[i]);
+  }
+
+  captureTarget = &vertices[lod];
+  for (int part = 0; part < NumParts; part++) {
+    const GLint first = (GLint)captureTarget->size() / captureStride;
+    builders[lod][part]();
+    parts[lod][style][part][0] = first;
+    parts[lod][style][part][1] = (GLint)captureTarget->size() / captureStride - first;
+  }
+  captureTarget = NULL;
+  built[lod][style] = true;
+}
+
 // parts: body, turret, barrel, left tread, right tread
 
 const int		TankSceneNode::numLOD = 3;
 int			TankSceneNode::maxLevel = numLOD;
+TankSceneNode::TankBatchNode	TankSceneNode::lowBatch(0, false);
+TankSceneNode::TankBatchNode	TankSceneNode::medBatch(1, false);
+TankSceneNode::TankBatchNode	TankSceneNode::highBatch(2, false);
+TankSceneNode::TankBatchNode	TankSceneNode::shadowBatch(0, true);
 
 TankSceneNode::TankSceneNode(const GLfloat pos[3], const GLfloat forward[3]) :
 				useOverride(false),
@@ -97,10 +268,10 @@ TankSceneNode::TankSceneNode(const GLfloat pos[3], const GLfloat forward[3]) :
 				invisible(false),
 				clip(false),
 				style(TankRenderNode::Normal),
-				lowRenderNode(this),
-				medRenderNode(this),
-				highRenderNode(this),
-				shadowRenderNode(this)
+				lowRenderNode(this, 0),
+				medRenderNode(this, 1),
+				highRenderNode(this, 2),
+				shadowRenderNode(this, 0)
 {
   // setup style factors (BZDB isn't set up at global init time
 
@@ -195,17 +366,35 @@ void			TankSceneNode::addRenderNodes(
 
   // pick level of detail
   TankRenderNode* node;
+  TankBatchNode* batch;
   const GLfloat* sphere = getSphere();
   const ViewFrustum& view = renderer.getViewFrustum();
   const float size = sphere[3] * view.getAreaFactor() /
 					getDistance(view.getEye());
-  if (maxLevel == -1)
+  if (maxLevel == -1) {
     node = &highRenderNode;
-  else if (maxLevel > 2 && size > 55.0f)
+    batch = &highBatch;
+  }
+  else if (maxLevel > 2 && size > 55.0f) {
     node = &highRenderNode;
-  else if (maxLevel > 1 && size > 25.0f)
+    batch = &highBatch;
+  }
+  else if (maxLevel > 1 && size > 25.0f) {
     node = &medRenderNode;
-  else node = &lowRenderNode;
+    batch = &medBatch;
+  }
+  else {
+    node = &lowRenderNode;
+    batch = &lowBatch;
+  }
+
+  // plain tanks are drawn together with the others of the same level
+  if (!sort && !transparent && !clip && explodeFraction == 0.0f) {
+    if (batch->isEmpty())
+      renderer.addRenderNode(batch, &gstate);
+    batch->add(this);
+    return;
+  }
 
   // if drawing in sorted order then decide which order
   if (sort || transparent) {
@@ -228,6 +417,12 @@ void			TankSceneNode::addShadowNodes(
 				SceneRenderer& renderer)
 {
   if (invisible) return;
+  if (!clip && explodeFraction == 0.0f) {
+    if (shadowBatch.isEmpty())
+      renderer.addShadowNode(&shadowBatch);
+    shadowBatch.add(this);
+    return;
+  }
   renderer.addShadowNode(&shadowRenderNode);
 }
 
@@ -300,6 +495,14 @@ void			TankSceneNode::setMaxLOD(int _maxLevel)
   maxLevel = _maxLevel;
 }
 
+void			TankSceneNode::clearBatches()
+{
+  lowBatch.clear();
+  medBatch.clear();
+  highBatch.clear();
+  shadowBatch.clear();
+}
+
 //
 // TankIDLSceneNode
 //
@@ -542,12 +745,16 @@ const GLfloat		TankSceneNode::TankRenderNode::centerOfGravity[][3] = {
 				{ 0.000f,  0.7f, 0.5f * 0.68f },// left tread
 				{ 0.000f, -0.7f, 0.5f * 0.68f }	// right tread
 			};
-GLfloat			TankSceneNode::TankRenderNode::vertexScale[3];
-GLfloat			TankSceneNode::TankRenderNode::normalScale[3];
+const GLfloat		TankSceneNode::TankRenderNode::lights[3][6] = {
+				{ 1.0f, 1.0f, 1.0f, -1.53f,  0.00f, 2.1f },
+				{ 1.0f, 0.0f, 0.0f,  0.10f,  0.75f, 2.1f },
+				{ 0.0f, 1.0f, 0.0f,  0.10f, -0.75f, 2.1f }
+			};
 
 TankSceneNode::TankRenderNode::TankRenderNode(
-				const TankSceneNode* _sceneNode) :
+				const TankSceneNode* _sceneNode, int _lod) :
 				sceneNode(_sceneNode),
+				lod(_lod),
 				isShadow(false),
 				above(false),
 				towards(false)
@@ -573,14 +780,11 @@ TankSceneNode::TankRenderNode::TankRenderNode(
     vel[i][0] = 80.0f * ((float)bzfrand() - 0.5f);
     vel[i][1] = 80.0f * ((float)bzfrand() - 0.5f);
   }
-
-  // watch for context recreation
-  OpenGLGState::registerContextInitializer(initContext, (void*)this);
 }
 
 TankSceneNode::TankRenderNode::~TankRenderNode()
 {
-  OpenGLGState::unregisterContextInitializer(initContext, (void*)this);
+  // do nothing
 }
 
 void			TankSceneNode::TankRenderNode::setShadow()
@@ -595,19 +799,27 @@ void			TankSceneNode::TankRenderNode::sortOrder(
   towards = _towards;
 }
 
-void			TankSceneNode::TankRenderNode::render()
+void			TankSceneNode::TankRenderNode::prepare()
 {
-  base = getParts(sceneNode->style);
+  parts = TankGeometry::getParts(lod, sceneNode->style);
   explodeFraction = sceneNode->explodeFraction;
   isExploding = (explodeFraction != 0.0f);
+  withLights = !isExploding && !isShadow;
   color = sceneNode->color;
   alpha = sceneNode->color[3];
+}
+
+void			TankSceneNode::TankRenderNode::render()
+{
+  prepare();
 
   if (sceneNode->clip) {
     glClipPlane(GL_CLIP_PLANE0, sceneNode->clipPlane);
     glEnable(GL_CLIP_PLANE0);
   }
 
+  TankGeometry::bind(lod);
+
   const GLfloat* sphere = sceneNode->getSphere();
   glPushMatrix();
     glTranslatef(sphere[0], sphere[1], sphere[2]);
@@ -645,6 +857,8 @@ void			TankSceneNode::TankRenderNode::render()
 
   glPopMatrix();
 
+  TankGeometry::unbind();
+
   if (!isExploding && !isShadow) {
     // FIXME -- add flare lights using addFlareLight().  pass
     // light position in world space.
@@ -653,6 +867,47 @@ void			TankSceneNode::TankRenderNode::render()
 		glDisable(GL_CLIP_PLANE0);
 }
 
+void			TankSceneNode::TankRenderNode::renderBatched()
+{
+  prepare();
+  withLights = false;
+
+  const GLfloat* sphere = sceneNode->getSphere();
+  glPushMatrix();
+    glTranslatef(sphere[0], sphere[1], sphere[2]);
+    glRotatef(sceneNode->azimuth, 0.0f, 0.0f, 1.0f);
+    glRotatef(sceneNode->elevation, 0.0f, 1.0f, 0.0f);
+
+    renderPart(LeftTread);
+    renderPart(RightTread);
+    renderPart(Body);
+    renderPart(Turret);
+    renderPart(Barrel);
+
+  glPopMatrix();
+}
+
+void			TankSceneNode::TankRenderNode::getLights(
+				GLfloat pos[3][3]) const
+{
+  // the transform render() sets up, done by hand
+  const GLfloat* factors = TankFactors::styleFactors[sceneNode->style];
+  const GLfloat* sphere = sceneNode->getSphere();
+  const GLfloat ca = cosf(sceneNode->azimuth * M_PI / 180.0f);
+  const GLfloat sa = sinf(sceneNode->azimuth * M_PI / 180.0f);
+  const GLfloat ce = cosf(sceneNode->elevation * M_PI / 180.0f);
+  const GLfloat se = sinf(sceneNode->elevation * M_PI / 180.0f);
+  for (int i = 0; i < 3; i++) {
+    const GLfloat x = lights[i][3] * factors[0];
+    const GLfloat y = lights[i][4] * factors[1];
+    const GLfloat z = lights[i][5] * factors[2];
+    const GLfloat x1 = ce * x + se * z;
+    pos[i][0] = sphere[0] + ca * x1 - sa * y;
+    pos[i][1] = sphere[1] + sa * x1 + ca * y;
+    pos[i][2] = sphere[2] - se * x + ce * z;
+  }
+}
+
 void			TankSceneNode::TankRenderNode::renderParts()
 {
   // draw parts in back to front order
@@ -720,9 +975,9 @@ void			TankSceneNode::TankRenderNode::renderPart(Part part)
   }
 
   // draw part
-  glCallList(base + part);
+  glDrawArrays(GL_TRIANGLES, parts[2 * part], parts[2 * part + 1]);
 
-  if (part == Turret && !isExploding && !isShadow) {
+  if (part == Turret && withLights) {
     renderLights();
   }
 
@@ -730,238 +985,8 @@ void			TankSceneNode::TankRenderNode::renderPart(Part part)
   if (isExploding) glPopMatrix();
 }
 
-void			TankSceneNode::TankRenderNode::prepStyle(Style style)
-{
-  curVertScale[0] = vertexScale[0] = TankFactors::styleFactors[style][0];
-  curVertScale[1] = vertexScale[1] = TankFactors::styleFactors[style][1];
-  curVertScale[2] = vertexScale[2] = TankFactors::styleFactors[style][2];
-  curNormScale[0] = normalScale[0] = (vertexScale[0] == 0.0f ? 0.0f : 1.0f / vertexScale[0]);
-  curNormScale[1] = normalScale[1] = (vertexScale[1] == 0.0f ? 0.0f : 1.0f / vertexScale[1]);
-  curNormScale[2] = normalScale[2] = (vertexScale[2] == 0.0f ? 0.0f : 1.0f / vertexScale[2]);
-}
-
-void			TankSceneNode::TankRenderNode::
-				doVertex3f(GLfloat x, GLfloat y, GLfloat z)
-{
-  glVertex3f(x * vertexScale[0], y * vertexScale[1], z * vertexScale[2]);
-}
-
-void			TankSceneNode::TankRenderNode::
-				doNormal3f(GLfloat x, GLfloat y, GLfloat z)
-{
-  const GLfloat d = hypotf(x * normalScale[0],
-			hypotf(y * normalScale[1], z * normalScale[2]));
-  if (d > 1.0e-5f) {
-    x *= normalScale[0] / d;
-    y *= normalScale[1] / d;
-    z *= normalScale[2] / d;
-  }
-  glNormal3f(x, y, z);
-}
-
-void			TankSceneNode::TankRenderNode::doInitContext()
-{
-  freeParts();
-}
-
-void			TankSceneNode::TankRenderNode::initContext(void* self)
-{
-  ((TankSceneNode::TankRenderNode*)self)->doInitContext();
-}
-
-//
-// TankSceneNode::LowTankRenderNode
-//
-
-GLuint			TankSceneNode::LowTankRenderNode::parts[lastStyle] =
-				{ _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID };
-
-TankSceneNode::LowTankRenderNode::LowTankRenderNode(
-				const TankSceneNode* sceneNode) :
-				TankRenderNode(sceneNode)
-{
-  // do nothing
-}
-
-TankSceneNode::LowTankRenderNode::~LowTankRenderNode()
-{
-  // release the lists to be nice
-  freeParts();
-}
-
-GLuint			TankSceneNode::LowTankRenderNode::
-				getParts(Style style)
-{
-  if (parts[style] == _NO_LIST_ID) {
-    prepStyle(style);
-
-    parts[style] = glGenLists(5);
-    glNewList(parts[style] + Body, GL_COMPILE);
-      makeBody();
-    glEndList();
-
-    glNewList(parts[style] + Barrel, GL_COMPILE);
-      makeBarrel();
-    glEndList();
-
-    glNewList(parts[style] + Turret, GL_COMPILE);
-      makeTurret();
-    glEndList();
-
-    glNewList(parts[style] + LeftTread, GL_COMPILE);
-      makeLeftTread();
-    glEndList();
-
-    glNewList(parts[style] + RightTread, GL_COMPILE);
-      makeRightTread();
-    glEndList();
-  }
-
-  return parts[style];
-}
-
-void			TankSceneNode::LowTankRenderNode::freeParts()
-{
-  // forget about old parts
-  for (unsigned int i = 0; i < countof(parts); i++)
-  {
-    glDeleteLists(parts[i],5);
-    parts[i] = _NO_LIST_ID;
-  }
-}
-
-//
-// TankSceneNode::MedTankRenderNode
-//
-
-GLuint			TankSceneNode::MedTankRenderNode::parts[lastStyle] =
-				{ _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID };
-
-TankSceneNode::MedTankRenderNode::MedTankRenderNode(
-				const TankSceneNode* sceneNode) :
-				TankRenderNode(sceneNode)
-{
-  // do nothing
-}
-
-TankSceneNode::MedTankRenderNode::~MedTankRenderNode()
-{
-  // release the lists to be nice
-  freeParts();
-}
-
-GLuint			TankSceneNode::MedTankRenderNode::
-				getParts(Style style)
-{
-  if (parts[style] == _NO_LIST_ID) {
-    prepStyle(style);
-
-    parts[style] = glGenLists(5);
-    glNewList(parts[style] + Body, GL_COMPILE);
-      makeBody();
-    glEndList();
-
-    glNewList(parts[style] + Barrel, GL_COMPILE);
-      makeBarrel();
-    glEndList();
-
-    glNewList(parts[style] + Turret, GL_COMPILE);
-      makeTurret();
-    glEndList();
-
-    glNewList(parts[style] + LeftTread, GL_COMPILE);
-      makeLeftTread();
-    glEndList();
-
-    glNewList(parts[style] + RightTread, GL_COMPILE);
-      makeRightTread();
-    glEndList();
-  }
-
-  return parts[style];
-}
-
-void			TankSceneNode::MedTankRenderNode::freeParts()
-{
-  // forget about old parts
-  for (unsigned int i = 0; i < countof(parts); i++){
-    glDeleteLists(parts[i],5);
-    parts[i] = _NO_LIST_ID;
-  }
-}
-
-//
-// TankSceneNode::HighTankRenderNode
-//
-
-GLuint			TankSceneNode::HighTankRenderNode::parts[lastStyle] =
-				{ _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID, _NO_LIST_ID };
-
-TankSceneNode::HighTankRenderNode::HighTankRenderNode(
-				const TankSceneNode* sceneNode) :
-				TankRenderNode(sceneNode)
-{
-  // do nothing
-}
-
-TankSceneNode::HighTankRenderNode::~HighTankRenderNode()
-{
-  // release the lists to be nice
-  freeParts();
-}
-
-GLuint			TankSceneNode::HighTankRenderNode::
-				getParts(Style style)
-{
-  if (parts[style] == _NO_LIST_ID) {
-    prepStyle(style);
-
-    parts[style] = glGenLists(5);
-    glNewList(parts[style] + Body, GL_COMPILE);
-      makeBody();
-    glEndList();
-
-    glNewList(parts[style] + Barrel, GL_COMPILE);
-      makeBarrel();
-    glEndList();
-
-    glNewList(parts[style] + Turret, GL_COMPILE);
-      makeTurret();
-    glEndList();
-
-    glNewList(parts[style] + LeftTread, GL_COMPILE);
-      makeLeftTread();
-    glEndList();
-
-    glNewList(parts[style] + RightTread, GL_COMPILE);
-      makeRightTread();
-    glEndList();
-  }
-
-  return parts[style];
-}
-
-void			TankSceneNode::HighTankRenderNode::freeParts()
-{
-  // forget about old parts
-  for (unsigned int i = 0; i < countof(parts); i++){
-    glDeleteLists(parts[i],5);
-    parts[i] = _NO_LIST_ID;
-  }
-}
-
-//
-// geometry rendering methods
-//
-
 void			TankSceneNode::TankRenderNode::renderLights()
 {
-  static const GLfloat	lights[3][6] = {
-				{ 1.0f, 1.0f, 1.0f, -1.53f,  0.00f, 2.1f },
-				{ 1.0f, 0.0f, 0.0f,  0.10f,  0.75f, 2.1f },
-				{ 0.0f, 1.0f, 0.0f,  0.10f, -0.75f, 2.1f }
-			};
-
   sceneNode->lightsGState.setState();
   glPointSize(2.0f);
   glBegin(GL_POINTS);
@@ -977,90 +1002,82 @@ void			TankSceneNode::TankRenderNode::renderLights()
 }
 
 //
-// TankSceneNode::LowTankRenderNode
+// TankSceneNode::TankBatchNode
 //
 
-void			TankSceneNode::LowTankRenderNode::makeBody()
+TankSceneNode::TankBatchNode::TankBatchNode(int _lod, bool _shadow) :
+				lod(_lod),
+				shadow(_shadow)
 {
-  buildLowBody();
-}
-
-void			TankSceneNode::LowTankRenderNode::makeBarrel()
-{
-  buildLowBarrel();
-}
-
-void			TankSceneNode::LowTankRenderNode::makeTurret()
-{
-  buildLowTurret();
-}
-
-void			TankSceneNode::LowTankRenderNode::makeLeftTread()
-{
-  buildLowLTread();
-}
-
-void			TankSceneNode::LowTankRenderNode::makeRightTread()
-{
-  buildLowRTread();
+  // do nothing
 }
 
-//
-// TankSceneNode::MedTankRenderNode
-//
-
-void			TankSceneNode::MedTankRenderNode::makeBody()
+TankSceneNode::TankBatchNode::~TankBatchNode()
 {
-  buildMedBody();
+  // do nothing
 }
 
-void			TankSceneNode::MedTankRenderNode::makeBarrel()
+void			TankSceneNode::TankBatchNode::clear()
 {
-  buildMedBarrel();
+  tanks.clear();
 }
 
-void			TankSceneNode::MedTankRenderNode::makeTurret()
+void			TankSceneNode::TankBatchNode::add(
+				const TankSceneNode* tank)
 {
-  buildMedTurret();
+  tanks.push_back(tank);
 }
 
-void			TankSceneNode::MedTankRenderNode::makeLeftTread()
+TankSceneNode::TankRenderNode&
+			TankSceneNode::TankBatchNode::getNode(
+				const TankSceneNode* tank) const
 {
-  buildMedLTread();
+  TankSceneNode* t = const_cast<TankSceneNode*>(tank);
+  if (shadow)
+    return t->shadowRenderNode;
+  switch (lod) {
+    case 0: return t->lowRenderNode;
+    case 1: return t->medRenderNode;
+    default: return t->highRenderNode;
+  }
 }
 
-void			TankSceneNode::MedTankRenderNode::makeRightTread()
+void			TankSceneNode::TankBatchNode::render()
 {
-  buildMedRTread();
-}
+  const int count = (int)tanks.size();
+  int i;
 
-//
-// TankSceneNode::HighTankRenderNode
-//
+  // every style has to exist before the array is bound
+  for (i = 0; i < count; i++)
+    TankGeometry::getParts(lod, tanks[i]->style);
 
-void			TankSceneNode::HighTankRenderNode::makeBody()
-{
-  buildHighBody();
-}
-
-void			TankSceneNode::HighTankRenderNode::makeBarrel()
-{
-  buildHighBarrel();
-}
+  // the renderer has set the first tank's gstate, the rest differ
+  // at most in texture and material
+  TankGeometry::bind(lod);
+  for (i = 0; i < count; i++) {
+    if (i > 0 && !shadow)
+      tanks[i]->gstate.setState();
+    getNode(tanks[i]).renderBatched();
+  }
+  TankGeometry::unbind();
 
-void			TankSceneNode::HighTankRenderNode::makeTurret()
-{
-  buildHighTurret();
-}
+  if (shadow)
+    return;
 
-void			TankSceneNode::HighTankRenderNode::makeLeftTread()
-{
-  buildHighLTread();
-}
-
-void			TankSceneNode::HighTankRenderNode::makeRightTread()
-{
-  buildHighRTread();
+  // then the turret lights of the lot
+  tanks[0]->lightsGState.setState();
+  glPointSize(2.0f);
+  glBegin(GL_POINTS);
+  for (i = 0; i < count; i++) {
+    GLfloat pos[3][3];
+    getNode(tanks[i]).getLights(pos);
+    for (int j = 0; j < 3; j++) {
+      myColor3fv(TankRenderNode::lights[j]);
+      glVertex3fv(pos[j]);
+    }
+  }
+  glEnd();
+  glPointSize(1.0f);
 }
 
 // Local Variables: ***
@@ -1070,4 +1087,3 @@ void			TankSceneNode::HighTankRenderNode::makeRightTread()
 // indent-tabs-mode: t ***
 // End: ***
 // ex: shiftwidth=2 tabstop=8
-
@@ -17,7 +17,7 @@
 
 void buildHighBarrel ( void )
 {
-  glBegin(GL_TRIANGLE_FAN);
+  doBegin(GL_TRIANGLE_FAN);
 		doNormal3f(1.000000f, 0.000000f, 0.000000f);
 		doVertex3f(4.940f, 0.0f, 1.410f);
 		doVertex3f(4.940f, 0.089f, 1.440f);
@@ -27,9 +27,9 @@ void buildHighBarrel ( void )
 		doVertex3f(4.940f, -0.09f, 1.620f);
 		doVertex3f(4.940f, -0.126f, 1.530f);
 		doVertex3f(4.940f, -0.09f, 1.440f);
-  glEnd();
+  doEnd();
 
-  glBegin(GL_TRIANGLE_STRIP);
+  doBegin(GL_TRIANGLE_STRIP);
 		doNormal3f(0.015873f, -0.999874f, 0.000000f);
 		doVertex3f(1.570f, -0.18f, 1.530f);
 		doVertex3f(4.940f, -0.126f, 1.530f);
@@ -61,7 +61,7 @@ void buildHighBarrel ( void )
 		doNormal3f(0.015873f, -0.999874f, 0.000000f);
 		doVertex3f(1.570f, -0.18f, 1.530f);
 		doVertex3f(4.940f, -0.126f, 1.530f);
-   glEnd();
+   doEnd();
 }
 /*
  * Local Variables: ***
@@ -17,7 +17,7 @@
 
 void buildLowBarrel ( void )
 {
-      glBegin(GL_TRIANGLE_STRIP);
+      doBegin(GL_TRIANGLE_STRIP);
 	doNormal3f(0.0f, -1.0f, 0.0f);
 	doVertex3f(1.570f, -0.18f, 1.530f);
 	doVertex3f(4.940f, -0.126f, 1.530f);
@@ -33,14 +33,14 @@ void buildLowBarrel ( void )
 	doNormal3f(0.0f, -1.0f, 0.0f);
 	doVertex3f(1.570f, -0.18f, 1.530f);
 	doVertex3f(4.940f, -0.126f, 1.530f);
-      glEnd();
-      glBegin(GL_TRIANGLE_FAN);
+      doEnd();
+      doBegin(GL_TRIANGLE_FAN);
 	doNormal3f(1.000000f, 0.000000f, 0.000000f);
 	doVertex3f(4.940f, 0.0f, 1.410f);
 	doVertex3f(4.940f, 0.126f, 1.530f);
 	doVertex3f(4.940f, 0.0f, 1.660f);
 	doVertex3f(4.940f, -0.126f, 1.530f);
-      glEnd();
+      doEnd();
 }
 /*
  * Local Variables: ***
@@ -17,54 +17,54 @@
 
 void buildLowLTread ( void )
 {
-      glBegin(GL_TRIANGLE_STRIP);
+      doBegin(GL_TRIANGLE_STRIP);
 	doNormal3f(0.020362f, 0.000000f, 0.999793f);
-	glTexCoord2f(0.033f, 0.684f);
+	doTexCoord2f(0.033f, 0.684f);
 	doVertex3f(2.730f, 0.877f, 1.294f);
-	glTexCoord2f(0.095f, 0.570f);
+	doTexCoord2f(0.095f, 0.570f);
 	doVertex3f(2.730f, 1.400f, 1.294f);
-	glTexCoord2f(0.759f, 1.070f);
+	doTexCoord2f(0.759f, 1.070f);
 	doVertex3f(-2.970f, 0.877f, 1.410f);
-	glTexCoord2f(0.813f, 0.970f);
+	doTexCoord2f(0.813f, 0.970f);
 	doVertex3f(-2.970f, 1.400f, 1.410f);
 	doNormal3f(-0.885132f, 0.000000f, -0.465341f);
-	glTexCoord2f(0.375f, 1.300f);
+	doTexCoord2f(0.375f, 1.300f);
 	doVertex3f(-2.229f, 0.877f, 0.000f);
-	glTexCoord2f(0.800f, 0.523f);
+	doTexCoord2f(0.800f, 0.523f);
 	doVertex3f(-2.229f, 1.400f, 0.000f);
 	doNormal3f(0.000000f, 0.000000f, -1.000000f);
-	glTexCoord2f(-0.156f, 1.010f);
+	doTexCoord2f(-0.156f, 1.010f);
 	doVertex3f(2.597f, 0.877f, 0.000f);
-	glTexCoord2f(0.268f, 0.233f);
+	doTexCoord2f(0.268f, 0.233f);
 	doVertex3f(2.597f, 1.400f, 0.000f);
 	doNormal3f(0.994712f, 0.000000f, -0.102699f);
-	glTexCoord2f(0.033f, 0.684f);
+	doTexCoord2f(0.033f, 0.684f);
 	doVertex3f(2.730f, 0.877f, 1.294f);
-	glTexCoord2f(0.095f, 0.570f);
+	doTexCoord2f(0.095f, 0.570f);
 	doVertex3f(2.730f, 1.400f, 1.294f);
-      glEnd();
-      glBegin(GL_TRIANGLE_FAN);
+      doEnd();
+      doBegin(GL_TRIANGLE_FAN);
 	doNormal3f(0.000000f, -1.000000f, 0.000000f);
-	glTexCoord2f(0.375f, 1.300f);
+	doTexCoord2f(0.375f, 1.300f);
 	doVertex3f(-2.229f, 0.877f, 0.000f);
-	glTexCoord2f(-0.156f, 1.010f);
+	doTexCoord2f(-0.156f, 1.010f);
 	doVertex3f(2.597f, 0.877f, 0.000f);
-	glTexCoord2f(0.033f, 0.684f);
+	doTexCoord2f(0.033f, 0.684f);
 	doVertex3f(2.730f, 0.877f, 1.294f);
-	glTexCoord2f(0.759f, 1.070f);
+	doTexCoord2f(0.759f, 1.070f);
 	doVertex3f(-2.970f, 0.877f, 1.410f);
-      glEnd();
-      glBegin(GL_TRIANGLE_FAN);
+      doEnd();
+      doBegin(GL_TRIANGLE_FAN);
 	doNormal3f(0.000000f, 1.000000f, 0.000000f);
-	glTexCoord2f(0.800f, 0.523f);
+	doTexCoord2f(0.800f, 0.523f);
 	doVertex3f(-2.229f, 1.400f, 0.000f);
-	glTexCoord2f(0.813f, 0.970f);
+	doTexCoord2f(0.813f, 0.970f);
 	doVertex3f(-2.970f, 1.400f, 1.410f);
-	glTexCoord2f(0.095f, 0.570f);
+	doTexCoord2f(0.095f, 0.570f);
 	doVertex3f(2.730f, 1.400f, 1.294f);
-	glTexCoord2f(0.268f, 0.233f);
+	doTexCoord2f(0.268f, 0.233f);
 	doVertex3f(2.597f, 1.400f, 0.000f);
-      glEnd();
+      doEnd();
 }
 /*
  * Local Variables: ***
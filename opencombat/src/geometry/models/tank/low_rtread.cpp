@@ -17,54 +17,54 @@
 
 void buildLowRTread ( void )
 {
-      glBegin(GL_TRIANGLE_STRIP);
+      doBegin(GL_TRIANGLE_STRIP);
 	doNormal3f(0.020362f, 0.000000f, 0.999793f);
-	glTexCoord2f(-0.072f, 0.099f);
+	doTexCoord2f(-0.072f, 0.099f);
 	doVertex3f(2.730f, -1.400f, 1.294f);
-	glTexCoord2f(0.032f, 0.022f);
+	doTexCoord2f(0.032f, 0.022f);
 	doVertex3f(2.730f, -0.875f, 1.294f);
-	glTexCoord2f(0.419f, 0.757f);
+	doTexCoord2f(0.419f, 0.757f);
 	doVertex3f(-2.970f, -1.400f, 1.410f);
-	glTexCoord2f(0.511f, 0.690f);
+	doTexCoord2f(0.511f, 0.690f);
 	doVertex3f(-2.970f, -0.875f, 1.410f);
 	doNormal3f(-0.885132f, 0.000000f, -0.465341f);
-	glTexCoord2f(-0.026f, 0.803f);
+	doTexCoord2f(-0.026f, 0.803f);
 	doVertex3f(-2.229f, -1.400f, 0.000f);
-	glTexCoord2f(0.690f, 0.279f);
+	doTexCoord2f(0.690f, 0.279f);
 	doVertex3f(-2.229f, -0.875f, 0.000f);
 	doNormal3f(0.000000f, 0.000000f, -1.000000f);
-	glTexCoord2f(-0.383f, 0.314f);
+	doTexCoord2f(-0.383f, 0.314f);
 	doVertex3f(2.597f, -1.400f, 0.000f);
-	glTexCoord2f(0.332f, -0.209f);
+	doTexCoord2f(0.332f, -0.209f);
 	doVertex3f(2.597f, -0.875f, 0.000f);
 	doNormal3f(0.994712f, 0.000000f, -0.102699f);
-	glTexCoord2f(-0.072f, 0.099f);
+	doTexCoord2f(-0.072f, 0.099f);
 	doVertex3f(2.730f, -1.400f, 1.294f);
-	glTexCoord2f(0.032f, 0.022f);
+	doTexCoord2f(0.032f, 0.022f);
 	doVertex3f(2.730f, -0.875f, 1.294f);
-      glEnd();
-      glBegin(GL_TRIANGLE_FAN);
+      doEnd();
+      doBegin(GL_TRIANGLE_FAN);
 	doNormal3f(0.000000f, -1.000000f, 0.000000f);
-	glTexCoord2f(-0.026f, 0.803f);
+	doTexCoord2f(-0.026f, 0.803f);
 	doVertex3f(-2.229f, -1.400f, 0.000f);
-	glTexCoord2f(-0.383f, 0.314f);
+	doTexCoord2f(-0.383f, 0.314f);
 	doVertex3f(2.597f, -1.400f, 0.000f);
-	glTexCoord2f(-0.072f, 0.099f);
+	doTexCoord2f(-0.072f, 0.099f);
 	doVertex3f(2.730f, -1.400f, 1.294f);
-	glTexCoord2f(0.419f, 0.757f);
+	doTexCoord2f(0.419f, 0.757f);
 	doVertex3f(-2.970f, -1.400f, 1.410f);
-      glEnd();
-      glBegin(GL_TRIANGLE_FAN);
+      doEnd();
+      doBegin(GL_TRIANGLE_FAN);
 	doNormal3f(0.000000f, 1.000000f, 0.000000f);
-	glTexCoord2f(0.690f, 0.279f);
+	doTexCoord2f(0.690f, 0.279f);
 	doVertex3f(-2.229f, -0.875f, 0.000f);
-	glTexCoord2f(0.511f, 0.690f);
+	doTexCoord2f(0.511f, 0.690f);
 	doVertex3f(-2.970f, -0.875f, 1.410f);
-	glTexCoord2f(0.032f, 0.022f);
+	doTexCoord2f(0.032f, 0.022f);
 	doVertex3f(2.730f, -0.875f, 1.294f);
-	glTexCoord2f(0.332f, -0.209f);
+	doTexCoord2f(0.332f, -0.209f);
 	doVertex3f(2.597f, -0.875f, 0.000f);
-      glEnd();
+      doEnd();
 }
 /*
  * Local Variables: ***
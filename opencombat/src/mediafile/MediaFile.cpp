@@ -145,6 +145,15 @@ do {							\
 unsigned char*		MediaFile::readImage(
 				const std::string& filename,
 				int* width, int* height)
+{
+  ImageFile* file = openImage(filename, width, height);
+  if (file == NULL)
+    return NULL;
+  return readImage(file, width, height);
+}
+
+ImageFile*		MediaFile::openImage(const std::string& filename,
+				int* width, int* height)
 {
 #ifdef WIN32
   // cheat and make sure the file is a windows file path
@@ -158,6 +167,16 @@ unsigned char*		MediaFile::readImage(
   if (file == NULL)
     OPENMEDIA(SGIImageFile);
 
+  if (file != NULL) {
+    *width  = file->getWidth();
+    *height = file->getHeight();
+  }
+  return file;
+}
+
+unsigned char*		MediaFile::readImage(ImageFile* file,
+				int* width, int* height)
+{
   // read the image
   unsigned char* image = NULL;
   if (file != NULL) {
@@ -220,15 +239,21 @@ unsigned char*		MediaFile::readImage(
     // clean up
     if (buffer != image)
       delete[] buffer;
-    delete file;
+    closeImage(file);
   }
 
-  // clean up
-  delete stream;
-
   return image;
 }
 
+void			MediaFile::closeImage(ImageFile* file)
+{
+  if (file == NULL)
+    return;
+  std::istream* stream = file->getStream();
+  delete file;
+  delete stream;
+}
+
 /*
 float*		MediaFile::readSound(
 			const std::string& filename,
@@ -21,6 +21,207 @@
 #include <netinet/in.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define	PNG_IMAGE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+//
+// unfiltering kernels
+//
+// each works on one line of len bytes, not counting the filter byte.
+// BPP is the size of a whole pixel in bytes (1 for bit depths below 8),
+// which is how far back the filters look for the pixel to the left.
+// prev is the unfiltered line above, all zeros for the first line.
+//
+
+#ifdef PNG_IMAGE_SSE2
+
+// byteMask + 16 - n loads a mask of the low n bytes
+static const unsigned char byteMask[32] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static inline __m128i	lowBytes(int n)
+{
+  return _mm_loadu_si128((const __m128i*)(byteMask + 16 - n));
+}
+
+// Average and Paeth depend on the finished pixel to the left, so the
+// most the vector unit can do for them is one whole pixel at a time.
+// pixels move as 4 bytes;  for 3 byte pixels the predictor is masked
+// so the extra byte is written back as it was read.
+static inline __m128i	loadPixel(const unsigned char* p)
+{
+  int v;
+  memcpy(&v, p, 4);
+  return _mm_cvtsi32_si128(v);
+}
+
+static inline void	storePixel(unsigned char* p, __m128i v)
+{
+  const int x = _mm_cvtsi128_si32(v);
+  memcpy(p, &x, 4);
+}
+
+#endif
+
+template <int BPP>
+static void		unfilterSub(unsigned char* line, int len)
+{
+  int i = BPP;
+#ifdef PNG_IMAGE_SSE2
+  // a running sum over the whole pixels that fit in 16 bytes, seeded
+  // with the last pixel of the block before.  bytes past the last
+  // whole pixel are written back untouched.
+  const int chunk = (16 / BPP) * BPP;
+  const __m128i pixel = lowBytes(BPP);
+  const __m128i keep = _mm_andnot_si128(lowBytes(chunk), _mm_set1_epi8(-1));
+  __m128i last = _mm_setzero_si128();
+  if (i + 16 <= len)
+    last = _mm_and_si128(_mm_loadu_si128((const __m128i*)line), pixel);
+  for (; i + 16 <= len; i += chunk) {
+    const __m128i raw = _mm_loadu_si128((const __m128i*)(line + i));
+    __m128i d = _mm_add_epi8(raw, last);
+    d = _mm_add_epi8(d, _mm_slli_si128(d, BPP));
+    if (2 * BPP < chunk)
+      d = _mm_add_epi8(d, _mm_slli_si128(d, 2 * BPP));
+    if (4 * BPP < chunk)
+      d = _mm_add_epi8(d, _mm_slli_si128(d, 4 * BPP));
+    if (8 * BPP < chunk)
+      d = _mm_add_epi8(d, _mm_slli_si128(d, 8 * BPP));
+    d = _mm_or_si128(_mm_andnot_si128(keep, d), _mm_and_si128(keep, raw));
+    _mm_storeu_si128((__m128i*)(line + i), d);
+    last = _mm_and_si128(_mm_srli_si128(d, chunk - BPP), pixel);
+  }
+#endif
+  for (; i < len; i++)
+    line[i] += line[i - BPP];
+}
+
+static void		unfilterUp(unsigned char* line,
+				   const unsigned char* prev, int len)
+{
+  int i = 0;
+#ifdef PNG_IMAGE_SSE2
+  for (; i + 16 <= len; i += 16) {
+    const __m128i a = _mm_loadu_si128((const __m128i*)(line + i));
+    const __m128i b = _mm_loadu_si128((const __m128i*)(prev + i));
+    _mm_storeu_si128((__m128i*)(line + i), _mm_add_epi8(a, b));
+  }
+#endif
+  for (; i < len; i++)
+    line[i] += prev[i];
+}
+
+template <int BPP>
+static void		unfilterAverage(unsigned char* line,
+					const unsigned char* prev, int len)
+{
+  int i;
+  for (i = 0; i < BPP; i++)
+    line[i] += prev[i] >> 1;
+#ifdef PNG_IMAGE_SSE2
+  if ((BPP == 3 || BPP == 4) && i + BPP + 4 <= len) {
+    // avg_epu8 rounds up, take the low bit back off to round down.
+    // the next pixel is read before this one is stored so the load
+    // never has to wait on the overlapping store.
+    const __m128i pixel = lowBytes(BPP);
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i a = _mm_and_si128(loadPixel(line), pixel);
+    __m128i x = loadPixel(line + i);
+    for (; i + BPP + 4 <= len; i += BPP) {
+      const __m128i next = loadPixel(line + i + BPP);
+      const __m128i b = _mm_and_si128(loadPixel(prev + i), pixel);
+      const __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+				       _mm_and_si128(_mm_xor_si128(a, b), one));
+      a = _mm_add_epi8(x, avg);
+      storePixel(line + i, a);
+      a = _mm_and_si128(a, pixel);
+      x = next;
+    }
+  }
+#endif
+  for (; i < len; i++)
+    line[i] += (line[i - BPP] + prev[i]) >> 1;
+}
+
+template <int BPP>
+static void		unfilterPaeth(unsigned char* line,
+				      const unsigned char* prev, int len)
+{
+  // with nothing to the left the predictor is always the byte above
+  int i;
+  for (i = 0; i < BPP; i++)
+    line[i] += prev[i];
+#ifdef PNG_IMAGE_SSE2
+  if ((BPP == 3 || BPP == 4) && i + BPP + 4 <= len) {
+    // same choice as the scalar loop below, in 16 bit lanes.  loads
+    // run a pixel ahead of the stores, as in unfilterAverage(), and
+    // the byte past a 3 byte pixel only ever has zero added to it.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bytes = _mm_set1_epi16(0xff);
+    const __m128i pixel = _mm_unpacklo_epi8(lowBytes(BPP), zero);
+    __m128i a = _mm_and_si128(_mm_unpacklo_epi8(loadPixel(line), zero), pixel);
+    __m128i c = _mm_and_si128(_mm_unpacklo_epi8(loadPixel(prev), zero), pixel);
+    __m128i x = _mm_unpacklo_epi8(loadPixel(line + i), zero);
+    for (; i + BPP + 4 <= len; i += BPP) {
+      const __m128i next = _mm_unpacklo_epi8(loadPixel(line + i + BPP), zero);
+      const __m128i b = _mm_and_si128(_mm_unpacklo_epi8(loadPixel(prev + i),
+							zero), pixel);
+      const __m128i p = _mm_sub_epi16(b, c);
+      const __m128i q = _mm_sub_epi16(a, c);
+      const __m128i r = _mm_add_epi16(p, q);
+      const __m128i pa = _mm_max_epi16(p, _mm_sub_epi16(zero, p));
+      const __m128i pb = _mm_max_epi16(q, _mm_sub_epi16(zero, q));
+      const __m128i pc = _mm_max_epi16(r, _mm_sub_epi16(zero, r));
+
+      // b unless c is closer, then a unless either of those is closer
+      const __m128i useC = _mm_cmpgt_epi16(pb, pc);
+      const __m128i notA = _mm_or_si128(_mm_cmpgt_epi16(pa, pb),
+					_mm_cmpgt_epi16(pa, pc));
+      __m128i pred = _mm_xor_si128(b, _mm_and_si128(_mm_xor_si128(b, c), useC));
+      pred = _mm_xor_si128(a, _mm_and_si128(_mm_xor_si128(a, pred), notA));
+
+      const __m128i d = _mm_add_epi16(x, pred);
+      storePixel(line + i, _mm_packus_epi16(_mm_and_si128(d, bytes), zero));
+      a = _mm_and_si128(d, pixel);
+      c = b;
+      x = next;
+    }
+  }
+#endif
+  for (; i < len; i++) {
+    int a = line[i - BPP];
+    int b = prev[i];
+    int c = prev[i - BPP];
+
+    int p = b - c;
+    int pc = a - c;
+    int pa = abs(p);
+    int pb = abs(pc);
+    pc = abs(p + pc);
+
+    // select with a mask, the choice is too random to branch on
+    int pred = (pb <= pc) ? b : c;
+    int useA = -((pa <= pb) & (pa <= pc));
+    line[i] += (a & useA) | (pred & ~useA);
+  }
+}
+
+// pick the kernel for the pixel size.  only these sizes exist in a png.
+#define UNFILTER_BPP(_f, _bpp, _args)					\
+  switch (_bpp) {							\
+    case 1: _f<1> _args; break;						\
+    case 2: _f<2> _args; break;						\
+    case 3: _f<3> _args; break;						\
+    case 4: _f<4> _args; break;						\
+    case 6: _f<6> _args; break;						\
+    case 8: _f<8> _args; break;						\
+  }
 
 
 //
@@ -29,8 +230,6 @@
 
 unsigned char		PNGImageFile::PNGHEADER[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
 
-const unsigned char	PNGImageFile::MAX_COMPONENTS = 4;
-
 const unsigned char	PNGImageFile::FILTER_NONE = 0;
 const unsigned char	PNGImageFile::FILTER_SUB = 1;
 const unsigned char	PNGImageFile::FILTER_UP = 2;
@@ -45,9 +244,6 @@ PNGImageFile::PNGImageFile(std::istream* stream)
 
 PNGImageFile::PNGImageFile(std::istream* stream) : ImageFile(stream), palette(NULL)
 {
-  lineBuffers[0] = NULL;
-  lineBuffers[1] = NULL;
-
   char buffer[8];
   stream->read(buffer, 8);
   if (strncmp((char*)PNGHEADER, buffer, 8) != 0) {
@@ -73,30 +269,31 @@ PNGImageFile::PNGImageFile(std::istream* stream) : ImageFile(stream), palette(NU
 
   delete c;
 
-  int channels;
+  // samples per pixel in the file, and channels once expanded
+  int samples, channels;
   switch (colorDepth) {
     case 0:
-      lineBufferSize = (((width * bitDepth + ((bitDepth < 8) ? (bitDepth+1) : 0)))/8)+1;
+      samples = 1;
       channels = 1;
     break;
 
     case 2:
-      lineBufferSize = (((3 * width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      samples = 3;
       channels = 3;
     break;
 
     case 3:
-      lineBufferSize = (((width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      samples = 1;
       channels = 3;
     break;
 
     case 4:
-      lineBufferSize = (((2 * width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      samples = 2;
       channels = 2;
     break;
 
     case 6:
-      lineBufferSize = (((4 * width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      samples = 4;
       channels = 4;
     break;
 
@@ -104,13 +301,20 @@ PNGImageFile::PNGImageFile(std::istream* stream) : ImageFile(stream), palette(NU
       return;
   }
 
-  realBufferSize = channels * width + 1;
-  int allocSize = ((realBufferSize > lineBufferSize) ? realBufferSize : lineBufferSize) + MAX_COMPONENTS;
-  lineBuffers[0] = new unsigned char[allocSize];
-  lineBuffers[1] = new unsigned char[allocSize];
-  memset(lineBuffers[0], 0, MAX_COMPONENTS);
-  memset(lineBuffers[1], 0, allocSize);
-  activeBufferIndex = 0;
+  switch (bitDepth) {
+    case 1:
+    case 2:
+    case 4:
+    case 8:
+    case 16:
+    break;
+
+    default:
+      return;
+  }
+
+  lineBufferSize = (width * samples * bitDepth + 7) / 8;
+  pixelSize = (bitDepth < 8) ? 1 : samples * bitDepth / 8;
 
   if (filterMethod != 0)
     return;
@@ -131,10 +335,6 @@ PNGImageFile::~PNGImageFile()
 {
   if (palette)
     delete palette;
-  if (lineBuffers[0] != NULL)
-    delete [] lineBuffers[0];
-  if (lineBuffers[1] != NULL)
-    delete [] lineBuffers[1];
 }
 
 /*
@@ -152,13 +352,13 @@ std::string				PNGImageFile::getExtension()
 bool PNGImageFile::read(void* buffer)
 
   parses the file looking for PLTE or IDAT entries and converts to 8 bit data
-  in 1, 2, 3, or 4 channels
+  in 1, 2, 3, or 4 channels.  The whole image is inflated in one go and then
+  unfiltered and expanded a line at a time.
 */
 
 bool					PNGImageFile::read(void* buffer)
 {
   PNGChunk *c;
-  int	bufferPos = getWidth() * getNumChannels() * (getHeight() - 1);
 
   c = PNGChunk::readChunk(getStream());
   while ((c->getType() != PNGChunk::IDAT) && (c->getType() != PNGChunk::IEND)) {
@@ -168,49 +368,49 @@ bool					PNGImageFile::read(void* buffer)
     c = PNGChunk::readChunk(getStream());
   }
 
-  unsigned char *line = getLineBuffer();
+  // indexed color goes through a table, entries past the palette are black
+  unsigned char lut[256 * 3];
+  if (colorDepth == 3) {
+    if (palette == NULL) {
+      delete c;
+      return false;
+    }
+    for (int i = 0; i < 256; i++) {
+      PNGRGB &rgb = palette->get(i);
+      lut[3*i+0] = rgb.red;
+      lut[3*i+1] = rgb.green;
+      lut[3*i+2] = rgb.blue;
+    }
+  }
+
+  // every line keeps its leading filter type byte
+  const int height = getHeight();
+  const int lineSize = lineBufferSize + 1;
+  unsigned char *image = new unsigned char[lineSize * height];
 
   int err;
   z_stream stream;
-  stream.next_out = line;
-  stream.avail_out = lineBufferSize;
+  stream.next_out = image;
+  stream.avail_out = lineSize * height;
   stream.zalloc = (alloc_func)NULL;
   stream.zfree = (free_func)NULL;
 
   err = inflateInit(&stream);
   if (err != Z_OK) {
+    delete[] image;
     delete c;
     return false;
   }
 
   while (c->getType() == PNGChunk::IDAT) {
-    stream.next_in = c->getData();
-    stream.avail_in = c->getLength();
-
-    err = inflate(&stream, Z_SYNC_FLUSH);
-    while (((err == Z_OK) || err == Z_STREAM_END)  && (stream.avail_out == 0)) {
-
-      expand();
-
-      if (!filter()) {
-	delete c;
-	return false;
-      }
-
-      memcpy(((unsigned char *)buffer)+bufferPos, line+1, realBufferSize-1);
-      bufferPos -= realBufferSize-1;
-
-      switchLineBuffers();
-      line = getLineBuffer();
-
-      stream.next_out = line;
-      stream.avail_out = lineBufferSize;
-      err = inflate(&stream, Z_SYNC_FLUSH);
-    }
-
-    if ((err != Z_STREAM_END) && (err != Z_OK)) {
-      delete c;
-      return false;
+    if (stream.avail_out > 0) {
+      stream.next_in = c->getData();
+      stream.avail_in = c->getLength();
+
+      // Z_BUF_ERROR only means this chunk had nothing more to give
+      err = inflate(&stream, Z_NO_FLUSH);
+      if ((err != Z_OK) && (err != Z_STREAM_END) && (err != Z_BUF_ERROR))
+	break;
     }
 
     delete c;
@@ -218,9 +418,34 @@ bool					PNGImageFile::read(void* buffer)
   }
 
   inflateEnd(&stream);
-
   delete c;
-  return true;
+
+  if (stream.avail_out != 0) {
+    delete[] image;
+    return false;
+  }
+
+  // lines are stored bottom up
+  const int outSize = getWidth() * getNumChannels();
+  unsigned char *out = (unsigned char *)buffer + outSize * (height - 1);
+  unsigned char *zeros = new unsigned char[lineBufferSize];
+  memset(zeros, 0, lineBufferSize);
+  const unsigned char *prev = zeros;
+
+  bool ok = true;
+  for (int y = 0; y < height; y++, out -= outSize) {
+    unsigned char *line = image + y * lineSize;
+    if (!filter(line[0], line + 1, prev)) {
+      ok = false;
+      break;
+    }
+    expand(out, line + 1, lut);
+    prev = line + 1;
+  }
+
+  delete[] zeros;
+  delete[] image;
+  return ok;
 }
 
 /*
@@ -246,73 +471,32 @@ PNGPalette* PNGImageFile::readPalette(PNGChunk *c)
 }
 
 /*
-unsigned char *PNGImageFile::getLineBuffer(bool active)
-
-  This is the buffer that holds one line of data. As filters may use the previous line
-  to filter with, you can ask for the non active one, as well
-*/
-
-unsigned char *PNGImageFile::getLineBuffer(bool active)
-{
-  return MAX_COMPONENTS + lineBuffers[active ? activeBufferIndex : (1 - activeBufferIndex)];
-}
-
-/*
-void PNGImageFile::switchLineBuffers()
+void PNGImageFile::expand(unsigned char *dst, const unsigned char *line, const unsigned char *lut)
 
-  Change buffers from the active to unactive. In this way you always have the last line available
-  for filtering.
+  Expand an unfiltered line to 8 bits per channel into dst. Indexed color is
+  converted to rgb through lut.  Gray below 8 bits is scaled to the full range.
 */
 
-void PNGImageFile::switchLineBuffers()
+void PNGImageFile::expand(unsigned char *dst, const unsigned char *line, const unsigned char *lut)
 {
-  activeBufferIndex = 1 - activeBufferIndex;
-}
-
-/*
-bool PNGImageFile::expand()
-
-  Expand data to 8 bits. If the original data is indexed color, convert to rgb data.
-*/
-
-bool PNGImageFile::expand()
-{
-  if ((bitDepth == 8) && (colorDepth != 3))
-    return true;
-
-  unsigned char *pData = getLineBuffer();
-
   int width = getWidth();
   switch (bitDepth)  {
     case 1:
-    {
-      for (int i = width-1; i >= 0; i--) {
-	int byteOffset = i/8 + 1;
-	int bit = 7 - i%8;
-	if (*(pData+byteOffset) & bit)
-	  *(pData+i+1) = 0xFF;
-	else
-	  *(pData+i+1) = 0x00;
-      }
-    }
-    break;
-
     case 2:
-    {
-      for (int i = width-1; i >= 0; i--) {
-	int byteOffset = i/4 + 1;
-	int bitShift = 6-2*(i%4);
-	*(pData+i+1) = (((*(pData+byteOffset)) >> bitShift) & 0x03) << 6;
-      }
-    }
-    break;
-
     case 4:
     {
-      for (int i = width-1; i >= 0; i--) {
-	int byteOffset = i/2+1;
-	int bitShift = 4-4*(i%2);
-	*(pData+i+1) = (((*(pData+byteOffset)) >> bitShift) & 0x0F) << 4;
+      const int mask = (1 << bitDepth) - 1;
+      const int perByte = 8 / bitDepth;
+      const int scale = 255 / mask;
+      for (int i = 0; i < width; i++) {
+	int bitShift = 8 - bitDepth * (i % perByte + 1);
+	int value = (line[i / perByte] >> bitShift) & mask;
+	if (colorDepth == 3) {
+	  memcpy(dst, lut + 3 * value, 3);
+	  dst += 3;
+	} else {
+	  *(dst++) = (unsigned char)(value * scale);
+	}
       }
     }
     break;
@@ -320,109 +504,56 @@ bool PNGImageFile::expand()
     case 8:
     {
       if (colorDepth == 3) {
-	if (palette == NULL)
-	  return false;
-
-	for (int i = width-1; i >= 0; i--) {
-	  PNGRGB &rgb = palette->get(*(pData+i));
-	  *(pData + width*3 + 1) = rgb.red;
-	  *(pData + width*3 + 2) = rgb.green;
-	  *(pData + width*3 + 3) = rgb.blue;
-	}
+	for (int i = 0; i < width; i++, dst += 3)
+	  memcpy(dst, lut + 3 * line[i], 3);
+      } else {
+	memcpy(dst, line, width * getNumChannels());
       }
     }
     break;
 
     case 16:
     {
-      for (int i = 0; i < width; i++) {
-	*(pData+i+1) = (*pData + 2*i + 1);
-      }
+      // keep the high byte
+      const int count = width * getNumChannels();
+      for (int i = 0; i < count; i++)
+	dst[i] = line[2 * i];
     }
     break;
-
-    default:
-      return false;
   }
-
-  return true;
 }
 
 /*
-bool PNGImageFile::filter()
+bool PNGImageFile::filter(unsigned char type, unsigned char *line, const unsigned char *prev)
 
-  Filter a line, based on the first byte found in line. Data must be in 8 bit format
+  Undo the filter given by type on a line, using the (unfiltered) line above
 */
 
-bool PNGImageFile::filter()
+bool PNGImageFile::filter(unsigned char type, unsigned char *line, const unsigned char *prev)
 {
-  //int	len = lineBufferSize;
-  unsigned char *pData = getLineBuffer();
-
-  unsigned char filter = *pData;
-  *(pData++) = 0;
-
-  switch (filter) {
+  switch (type) {
     case FILTER_NONE:
       return true;
 
     case FILTER_SUB:
-    {
-      int channels = getNumChannels();
-      for (int i = 1; i < lineBufferSize; i++, pData++)
-	*pData += *(pData-channels);
+      UNFILTER_BPP(unfilterSub, pixelSize, (line, lineBufferSize))
       return true;
-      break;
-    }
 
     case FILTER_UP:
-    {
-      unsigned char *pUp = getLineBuffer(false)+1;
-      for (int i = 1; i < lineBufferSize; i++, pData++, pUp++)
-	*pData += *pUp;
+      unfilterUp(line, prev, lineBufferSize);
       return true;
-      break;
-    }
 
     case FILTER_AVERAGE:
-    {
-      unsigned char *pUp = getLineBuffer(false)+1;
-      int channels = getNumChannels();
-      for (int i = 1; i < lineBufferSize; i++, pData++, pUp++) {
-	int last = *(pData-channels);
-	int up = *pUp;
-
-	*pData += (last + up)/2;
-      }
+      UNFILTER_BPP(unfilterAverage, pixelSize, (line, prev, lineBufferSize))
       return true;
-      break;
-    }
 
     case FILTER_PAETH:
-    {
-      unsigned char *pUp = getLineBuffer(false)+1;
-      int channels = getNumChannels();
-      for (int i = 1; i < lineBufferSize; i++, pData++, pUp++) {
-	int a = *(pData-channels);
-	int b = *pUp;
-	int c = *(pUp-channels);
-
-	int p = b - c;
-	int pc = a - c;
-	int pa = abs(p);
-	int pb = abs(pc);
-	pc = abs(p + pc);
-
-	*pData += (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
-      }
+      UNFILTER_BPP(unfilterPaeth, pixelSize, (line, prev, lineBufferSize))
       return true;
-      break;
-    }
 
     default:
       return false;
   }
-  return false;
 }
 
 
@@ -496,10 +627,11 @@ PNGRGB& PNGPalette::get(int index)
   Retrieve rgb value in palette at index 'index'. Returns black if invalid entry
 */
 
+// file scope so images can be decoded on more than one thread
+static PNGRGB unknown(0,0,0);
+
 PNGRGB& PNGPalette::get(int index)
 {
-  static PNGRGB unknown(0,0,0);
-
   if ((index >= 0) && (index < numColors))
     return colors[index];
 
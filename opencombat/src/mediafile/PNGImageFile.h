@@ -33,13 +33,10 @@ public:
   virtual bool		read(void* buffer);
 private:
   PNGPalette* readPalette(PNGChunk *c);
-  unsigned char *getLineBuffer(bool active=true);
-  void switchLineBuffers();
-  bool filter();
-  bool expand();
+  bool filter(unsigned char type, unsigned char *line, const unsigned char *prev);
+  void expand(unsigned char *dst, const unsigned char *line, const unsigned char *lut);
   
   static unsigned char			PNGHEADER[8];
-  static const unsigned char		MAX_COMPONENTS;
   static const unsigned char		FILTER_NONE;
   static const unsigned char		FILTER_SUB;
   static const unsigned char		FILTER_UP;
@@ -52,10 +49,8 @@ private:
   unsigned char					compressionMethod;
   unsigned char					filterMethod;
   unsigned char					interlaceMethod;
-  unsigned char					*lineBuffers[2];
-  int								activeBufferIndex;
   int								lineBufferSize;
-  int								realBufferSize;
+  int								pixelSize;
 };
 
 /** This class represents a RGB color value used by the PNG reader. */
@@ -0,0 +1,475 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * pngbench:
+ *	Offline benchmark for the PNG decoder.  Decodes every .png under
+ *	the data directory, first with the line at a time decoder
+ *	PNGImageFile used to have and then with PNGImageFile, checks that
+ *	the two produce the same pixels and reports how long each takes.
+ *	The old decoder only got 8 bit gray, gray alpha, RGB and RGBA
+ *	right, so images in any other format are only checked to decode.
+ *
+ *	usage: pngbench [data directory] [passes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include "common.h"
+#include "OSFile.h"
+#include "Pack.h"
+#include "PNGImageFile.h"
+#include "TimeKeeper.h"
+#include "../zlib/zconf.h"
+#include "../zlib/zlib.h"
+
+/*
+ * the decoder as it was, inflating and unfiltering one line at a time
+ */
+
+class OldPNGImageFile : public ImageFile {
+public:
+  OldPNGImageFile(std::istream*);
+  virtual ~OldPNGImageFile();
+
+  virtual bool		read(void* buffer);
+
+  // whether this decoder got the format right
+  bool			isComparable() const;
+
+private:
+  bool			expand();
+  bool			filter();
+  unsigned char*	getLineBuffer(bool active = true);
+  void			switchLineBuffers();
+
+  static const unsigned char	MAX_COMPONENTS = 4;
+
+  PNGPalette*		palette;
+  unsigned char		bitDepth;
+  unsigned char		colorDepth;
+  unsigned char		compressionMethod;
+  unsigned char		filterMethod;
+  unsigned char		interlaceMethod;
+  unsigned char*	lineBuffers[2];
+  int			activeBufferIndex;
+  int			lineBufferSize;
+  int			realBufferSize;
+};
+
+OldPNGImageFile::OldPNGImageFile(std::istream* stream) :
+				ImageFile(stream), palette(NULL)
+{
+  static const unsigned char header[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+  lineBuffers[0] = NULL;
+  lineBuffers[1] = NULL;
+
+  char buffer[8];
+  stream->read(buffer, 8);
+  if (memcmp(header, buffer, 8) != 0)
+    return;
+
+  PNGChunk *c = PNGChunk::readChunk(stream);
+  if (c->getType() != PNGChunk::IHDR) {
+    delete c;
+    return;
+  }
+
+  unsigned char* data = c->getData();
+  int width, height;
+  data = (unsigned char *)nboUnpackInt(data, width);
+  data = (unsigned char *)nboUnpackInt(data, height);
+  data = (unsigned char *)nboUnpackUByte(data, bitDepth);
+  data = (unsigned char *)nboUnpackUByte(data, colorDepth);
+  data = (unsigned char *)nboUnpackUByte(data, compressionMethod);
+  data = (unsigned char *)nboUnpackUByte(data, filterMethod);
+  data = (unsigned char *)nboUnpackUByte(data, interlaceMethod);
+  delete c;
+
+  int channels;
+  switch (colorDepth) {
+    case 0:
+      lineBufferSize = (((width * bitDepth + ((bitDepth < 8) ? (bitDepth+1) : 0)))/8)+1;
+      channels = 1;
+      break;
+    case 2:
+      lineBufferSize = (((3 * width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      channels = 3;
+      break;
+    case 3:
+      lineBufferSize = (((width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      channels = 3;
+      break;
+    case 4:
+      lineBufferSize = (((2 * width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      channels = 2;
+      break;
+    case 6:
+      lineBufferSize = (((4 * width * bitDepth + ((bitDepth < 8) ? (bitDepth-1) : 0)))/8)+1;
+      channels = 4;
+      break;
+    default:
+      return;
+  }
+
+  realBufferSize = channels * width + 1;
+  int allocSize = ((realBufferSize > lineBufferSize) ? realBufferSize : lineBufferSize) + MAX_COMPONENTS;
+  lineBuffers[0] = new unsigned char[allocSize];
+  lineBuffers[1] = new unsigned char[allocSize];
+  memset(lineBuffers[0], 0, MAX_COMPONENTS);
+  memset(lineBuffers[1], 0, allocSize);
+  activeBufferIndex = 0;
+
+  if (filterMethod != 0)
+    return;
+  if (interlaceMethod != 0)
+    return;
+
+  init(channels, width, height);
+}
+
+OldPNGImageFile::~OldPNGImageFile()
+{
+  delete palette;
+  delete[] lineBuffers[0];
+  delete[] lineBuffers[1];
+}
+
+bool			OldPNGImageFile::isComparable() const
+{
+  return (bitDepth == 8) && (colorDepth != 3);
+}
+
+bool			OldPNGImageFile::read(void* buffer)
+{
+  PNGChunk *c;
+  int bufferPos = getWidth() * getNumChannels() * (getHeight() - 1);
+
+  c = PNGChunk::readChunk(getStream());
+  while ((c->getType() != PNGChunk::IDAT) && (c->getType() != PNGChunk::IEND)) {
+    if (c->getType() == PNGChunk::PLTE) {
+      int numColors = c->getLength() / 3;
+      palette = new PNGPalette(numColors);
+      unsigned char *pData = c->getData();
+      for (int i = 0; i < numColors; i++, pData += 3) {
+	PNGRGB rgb(pData[0], pData[1], pData[2]);
+	palette->add(rgb);
+      }
+    }
+    delete c;
+    c = PNGChunk::readChunk(getStream());
+  }
+
+  unsigned char *line = getLineBuffer();
+
+  int err;
+  z_stream stream;
+  stream.next_out = line;
+  stream.avail_out = lineBufferSize;
+  stream.zalloc = (alloc_func)NULL;
+  stream.zfree = (free_func)NULL;
+
+  err = inflateInit(&stream);
+  if (err != Z_OK) {
+    delete c;
+    return false;
+  }
+
+  while (c->getType() == PNGChunk::IDAT) {
+    stream.next_in = c->getData();
+    stream.avail_in = c->getLength();
+
+    err = inflate(&stream, Z_SYNC_FLUSH);
+    while (((err == Z_OK) || err == Z_STREAM_END) && (stream.avail_out == 0)) {
+      expand();
+      if (!filter()) {
+	delete c;
+	return false;
+      }
+
+      memcpy(((unsigned char *)buffer)+bufferPos, line+1, realBufferSize-1);
+      bufferPos -= realBufferSize-1;
+
+      switchLineBuffers();
+      line = getLineBuffer();
+
+      stream.next_out = line;
+      stream.avail_out = lineBufferSize;
+      err = inflate(&stream, Z_SYNC_FLUSH);
+    }
+
+    if ((err != Z_STREAM_END) && (err != Z_OK)) {
+      delete c;
+      return false;
+    }
+
+    delete c;
+    c = PNGChunk::readChunk(getStream());
+  }
+
+  inflateEnd(&stream);
+
+  delete c;
+  return true;
+}
+
+unsigned char*		OldPNGImageFile::getLineBuffer(bool active)
+{
+  return MAX_COMPONENTS + lineBuffers[active ? activeBufferIndex : (1 - activeBufferIndex)];
+}
+
+void			OldPNGImageFile::switchLineBuffers()
+{
+  activeBufferIndex = 1 - activeBufferIndex;
+}
+
+bool			OldPNGImageFile::expand()
+{
+  if ((bitDepth == 8) && (colorDepth != 3))
+    return true;
+
+  unsigned char *pData = getLineBuffer();
+
+  int width = getWidth();
+  switch (bitDepth) {
+    case 1:
+      for (int i = width-1; i >= 0; i--) {
+	int byteOffset = i/8 + 1;
+	int bit = 7 - i%8;
+	if (*(pData+byteOffset) & bit)
+	  *(pData+i+1) = 0xFF;
+	else
+	  *(pData+i+1) = 0x00;
+      }
+      break;
+
+    case 2:
+      for (int i = width-1; i >= 0; i--) {
+	int byteOffset = i/4 + 1;
+	int bitShift = 6-2*(i%4);
+	*(pData+i+1) = (((*(pData+byteOffset)) >> bitShift) & 0x03) << 6;
+      }
+      break;
+
+    case 4:
+      for (int i = width-1; i >= 0; i--) {
+	int byteOffset = i/2+1;
+	int bitShift = 4-4*(i%2);
+	*(pData+i+1) = (((*(pData+byteOffset)) >> bitShift) & 0x0F) << 4;
+      }
+      break;
+
+    case 8:
+      if (colorDepth == 3) {
+	if (palette == NULL)
+	  return false;
+	for (int i = width-1; i >= 0; i--) {
+	  PNGRGB &rgb = palette->get(*(pData+i));
+	  *(pData + width*3 + 1) = rgb.red;
+	  *(pData + width*3 + 2) = rgb.green;
+	  *(pData + width*3 + 3) = rgb.blue;
+	}
+      }
+      break;
+
+    case 16:
+      for (int i = 0; i < width; i++)
+	*(pData+i+1) = (*pData + 2*i + 1);
+      break;
+
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+bool			OldPNGImageFile::filter()
+{
+  unsigned char *pData = getLineBuffer();
+
+  unsigned char filter = *pData;
+  *(pData++) = 0;
+
+  const int channels = getNumChannels();
+  unsigned char *pUp = getLineBuffer(false)+1;
+  int i;
+  switch (filter) {
+    case 0:
+      return true;
+
+    case 1:
+      for (i = 1; i < lineBufferSize; i++, pData++)
+	*pData += *(pData-channels);
+      return true;
+
+    case 2:
+      for (i = 1; i < lineBufferSize; i++, pData++, pUp++)
+	*pData += *pUp;
+      return true;
+
+    case 3:
+      for (i = 1; i < lineBufferSize; i++, pData++, pUp++) {
+	int last = *(pData-channels);
+	int up = *pUp;
+	*pData += (last + up)/2;
+      }
+      return true;
+
+    case 4:
+      for (i = 1; i < lineBufferSize; i++, pData++, pUp++) {
+	int a = *(pData-channels);
+	int b = *pUp;
+	int c = *(pUp-channels);
+
+	int p = b - c;
+	int pc = a - c;
+	int pa = abs(p);
+	int pb = abs(pc);
+	pc = abs(p + pc);
+
+	*pData += (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+      }
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+/*
+ * the script
+ */
+
+typedef struct {
+  std::string		name;
+  std::string		data;
+} PNGData;
+
+static void		findImages(const std::string& directory,
+				   std::vector<PNGData>& images)
+{
+  OSFile file;
+  OSDir dir(directory.c_str());
+  while (dir.getNextFile(file, true)) {
+    const char *ext = file.getExtension();
+    if (!ext || strcasecmp(ext, "png") != 0)
+      continue;
+    if (!file.open("rb"))
+      continue;
+    PNGData image;
+    image.name = file.getStdName();
+    image.data.resize(file.size());
+    if (image.data.size() > 0 &&
+	file.read(&image.data[0], (int)image.data.size()) == 1)
+      images.push_back(image);
+    file.close();
+  }
+}
+
+// decode one image with either decoder, in memory so only decoding is
+// timed.  the old decoder isn't run on formats it didn't handle, as it
+// could write past its line buffers on those.
+static bool		decode(bool old, const PNGData& image,
+			       std::vector<unsigned char>& pixels)
+{
+  std::istringstream stream(image.data);
+  ImageFile* file;
+  bool ok;
+  if (old) {
+    OldPNGImageFile* oldFile = new OldPNGImageFile(&stream);
+    ok = oldFile->isComparable();
+    file = oldFile;
+  } else {
+    file = new PNGImageFile(&stream);
+    ok = true;
+  }
+
+  ok = ok && file->isOpen();
+  if (ok) {
+    pixels.resize(file->getWidth() * file->getHeight() * file->getNumChannels());
+    ok = file->read(&pixels[0]);
+  }
+  delete file;
+  return ok;
+}
+
+static double		timeDecoder(bool old, const std::vector<PNGData>& images,
+				    int passes)
+{
+  std::vector<unsigned char> pixels;
+  TimeKeeper start = TimeKeeper::getCurrent();
+  for (int p = 0; p < passes; p++)
+    for (size_t i = 0; i < images.size(); i++)
+      decode(old, images[i], pixels);
+  return TimeKeeper::getCurrent() - start;
+}
+
+int			main(int argc, char** argv)
+{
+  const std::string directory = (argc > 1) ? argv[1] : "data";
+  const int passes = (argc > 2) ? atoi(argv[2]) : 5;
+
+  std::vector<PNGData> images;
+  findImages(directory, images);
+  if (images.size() == 0) {
+    printf("no .png files under %s\n", directory.c_str());
+    return 1;
+  }
+
+  // every image must decode, and those both decoders handle must match
+  std::vector<PNGData> compared;
+  int failed = 0, differ = 0;
+  long bytes = 0;
+  std::vector<unsigned char> oldPixels, newPixels;
+  for (size_t i = 0; i < images.size(); i++) {
+    if (!decode(false, images[i], newPixels)) {
+      printf("%s: cannot be decoded\n", images[i].name.c_str());
+      failed++;
+      continue;
+    }
+    if (!decode(true, images[i], oldPixels))
+      continue;
+    compared.push_back(images[i]);
+    bytes += (long)newPixels.size();
+    if (oldPixels != newPixels) {
+      printf("%s: decoders differ\n", images[i].name.c_str());
+      differ++;
+    }
+  }
+
+  const double oldTime = timeDecoder(true, compared, passes);
+  const double newTime = timeDecoder(false, compared, passes);
+
+  printf("%d images, %d compared, %.1f MB of pixels, %d passes\n",
+	 (int)images.size(), (int)compared.size(),
+	 (double)bytes / (1024.0 * 1024.0), passes);
+  printf("line at a time: %8.1f msec/pass\n", oldTime / passes * 1000.0);
+  printf("whole image:    %8.1f msec/pass (%.2fx)\n",
+	 newTime / passes * 1000.0, oldTime / newTime);
+  printf("%d failed, %d of %d compared images differ\n",
+	 failed, differ, (int)compared.size());
+
+  return (failed > 0 || differ > 0) ? 1 : 0;
+}
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
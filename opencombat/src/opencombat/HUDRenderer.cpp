@@ -1272,6 +1272,7 @@ void			HUDRenderer::renderPlaying(SceneRenderer& renderer)
   glMatrixMode(GL_MODELVIEW);
   glPushMatrix();
   glLoadIdentity();
+  fm.beginBatch();
 
   LocalPlayer *myTank = LocalPlayer::getMyTank();
   if (myTank && myTank->getPosition()[2] < 0.0f) {
@@ -1328,6 +1329,9 @@ void			HUDRenderer::renderPlaying(SceneRenderer& renderer)
   // draw targeting box
   renderBox(renderer);
 
+  // all the text goes out together, one draw per font
+  fm.flushBatch();
+
   // restore graphics state
   glPopMatrix();
 }
@@ -1353,6 +1357,7 @@ void			HUDRenderer::renderNotPlaying(SceneRenderer& renderer)
   glMatrixMode(GL_MODELVIEW);
   glPushMatrix();
   glLoadIdentity();
+  fm.beginBatch();
 
   // draw cracks
   if (showCracks)
@@ -1398,6 +1403,9 @@ void			HUDRenderer::renderNotPlaying(SceneRenderer& renderer)
     }
   }
 
+  // all the text goes out together, one draw per font
+  fm.flushBatch();
+
   // restore graphics state
   glPopMatrix();
 }
@@ -1423,6 +1431,7 @@ void			HUDRenderer::renderRoaming(SceneRenderer& renderer)
   glMatrixMode(GL_MODELVIEW);
   glPushMatrix();
   glLoadIdentity();
+  fm.beginBatch();
 
   // draw alert messages
   renderAlerts();
@@ -1457,6 +1466,9 @@ void			HUDRenderer::renderRoaming(SceneRenderer& renderer)
   if (altitude != -1.0f)
     renderBox(renderer);
 
+  // all the text goes out together, one draw per font
+  fm.flushBatch();
+
   // restore graphics state
   glPopMatrix();
 }
@@ -186,6 +186,10 @@ SceneDatabase*		SceneDatabaseBuilder::make(const World* world)
     db = new BSPSceneDatabase;
   // FIXME -- when making BSP tree, try several shuffles for best tree
 
+  // the add functions request their textures rather than load them, so
+  // the scene is ready at once and the images are swapped in over the
+  // next few frames as the loader threads finish them
+
   // add nodes to database
   const std::vector<WallObstacle> &walls = world->getWalls();
   std::vector<WallObstacle>::const_iterator wallScan = walls.begin();
@@ -235,9 +239,9 @@ void			SceneDatabaseBuilder::addWall(SceneDatabase* db,
 
   // try object, standard, then default
   if (o.userTextures[0].size())
-    wallTexture = tm.getTextureID(o.userTextures[0].c_str(),false);
+    wallTexture = tm.requestTexture(o.userTextures[0].c_str(),false);
   if (wallTexture < 0)
-    wallTexture = tm.getTextureID( "wall" );
+    wallTexture = tm.requestTexture( "wall" );
   else
     useColorTexture = wallTexture>=0;
 
@@ -270,18 +274,18 @@ void			SceneDatabaseBuilder::addBox(SceneDatabase* db,
 
   // try object, standard, then default
   if (o.userTextures[0].size())
-    boxTexture = tm.getTextureID(o.userTextures[0].c_str(),false);
+    boxTexture = tm.requestTexture(o.userTextures[0].c_str(),false);
   if (boxTexture < 0)
-    boxTexture = tm.getTextureID(BZDB.get("boxWallTexture").c_str(),true);
+    boxTexture = tm.requestTexture(BZDB.get("boxWallTexture").c_str(),true);
    
   useColorTexture[0] = boxTexture >= 0;
 
   int boxTopTexture = -1;
 
   if (o.userTextures[1].size())
-    boxTopTexture = tm.getTextureID(o.userTextures[1].c_str(),false);
+    boxTopTexture = tm.requestTexture(o.userTextures[1].c_str(),false);
   if (boxTopTexture < 0)
-    boxTopTexture = tm.getTextureID(BZDB.get("boxTopTexture").c_str(),true);
+    boxTopTexture = tm.requestTexture(BZDB.get("boxTopTexture").c_str(),true);
 
   useColorTexture[1] = boxTopTexture >= 0;
 
@@ -331,9 +335,9 @@ void			SceneDatabaseBuilder::addPyramid(SceneDatabase* db,
   bool useColorTexture = false;
   // try object, standard, then default
   if (o.userTextures[0].size())
-    pyramidTexture = tm.getTextureID(o.userTextures[0].c_str(),false);
+    pyramidTexture = tm.requestTexture(o.userTextures[0].c_str(),false);
   if (pyramidTexture < 0)
-    pyramidTexture = tm.getTextureID(BZDB.get("pyrWallTexture").c_str(),false);
+    pyramidTexture = tm.requestTexture(BZDB.get("pyrWallTexture").c_str(),false);
 
   useColorTexture = pyramidTexture >= 0;
 
@@ -372,26 +376,26 @@ void			SceneDatabaseBuilder::addBase(SceneDatabase *db,
 
   // try object, standard, then default
   if (o.userTextures[0].size())
-    boxTexture = tm.getTextureID(o.userTextures[0].c_str(),false);
+    boxTexture = tm.requestTexture(o.userTextures[0].c_str(),false);
   if (boxTexture < 0)
   {
     std::string teamBase = Team::getImagePrefix((TeamColor)o.getTeam());
     teamBase+=BZDB.get("baseWallTexture");
-    boxTexture = tm.getTextureID(teamBase.c_str(),false);
+    boxTexture = tm.requestTexture(teamBase.c_str(),false);
   }
   if (boxTexture < 0)
-    boxTexture = tm.getTextureID( BZDB.get("boxWallTexture").c_str() );
+    boxTexture = tm.requestTexture( BZDB.get("boxWallTexture").c_str() );
 
   useColorTexture[0] = boxTexture >= 0;
 
   int   baseTopTexture = -1;
 
   if (o.userTextures[1].size())
-    baseTopTexture = tm.getTextureID(o.userTextures[1].c_str(),false);
+    baseTopTexture = tm.requestTexture(o.userTextures[1].c_str(),false);
   if (baseTopTexture < 0){
     std::string teamBase = Team::getImagePrefix((TeamColor)o.getTeam());
     teamBase+=BZDB.get("baseTopTexture").c_str();
-    baseTopTexture = tm.getTextureID(teamBase.c_str(),false);
+    baseTopTexture = tm.requestTexture(teamBase.c_str(),false);
   }
   if (baseTopTexture < 0)
     baseTopTexture = -1;
@@ -448,9 +452,9 @@ void			SceneDatabaseBuilder::addTeleporter(SceneDatabase* db,
 
   // try object, standard, then default
   if (o.userTextures[0].size())
-    teleporterTexture = tm.getTextureID(o.userTextures[0].c_str(),false);
+    teleporterTexture = tm.requestTexture(o.userTextures[0].c_str(),false);
   if (teleporterTexture < 0)
-    teleporterTexture = tm.getTextureID(BZDB.get("cautionTexture").c_str(),true);
+    teleporterTexture = tm.requestTexture(BZDB.get("cautionTexture").c_str(),true);
    
   useColorTexture = teleporterTexture >= 0;
 
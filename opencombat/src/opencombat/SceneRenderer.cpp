@@ -546,6 +546,7 @@ void			SceneRenderer::render(
     orderedList.clear();
     shadowList.clear();
     flareLightList.clear();
+    TankSceneNode::clearBatches();
 
     // make the lists of render nodes sorted in optimal rendering order
     if (sceneIterator) {
@@ -13,6 +13,10 @@
 /* interface header */
 #include "ServerList.h"
 
+/* system implementation headers */
+#include <algorithm>
+#include <time.h>
+
 /* common implementation headers */
 #include "version.h"
 #include "bzsignal.h"
@@ -29,6 +33,12 @@
 #if !defined(_WIN32)
 #include <errno.h>
 #endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#endif
                                                                                 
 /* from playing.h */
 StartupInfo* getStartupInfo();
@@ -36,20 +46,83 @@ typedef void (*PlayingCallback)(void*);
 void addPlayingCallback(PlayingCallback, void* data);
 void removePlayingCallback(PlayingCallback, void* data);
 
+// most list server replies moved from the search thread into the
+// list per frame
+static const int	MaxRepliesPerFrame = 256;
+
+// most listed servers pinged at once, and how many seconds to wait
+// for each to answer
+static const int	MaxPingsOut = 32;
+static const time_t	PingTimeout = 2;
+
+//
+// the lock shared with the search thread.  there's only ever one
+// server list (the server menu's) so it lives here rather than in
+// the class.
+//
+
+#if defined(_WIN32)
+
+static CRITICAL_SECTION	searchLock;
+static HANDLE		searchThread;
+
+static void		lockSearch()	{ EnterCriticalSection(&searchLock); }
+static void		unlockSearch()	{ LeaveCriticalSection(&searchLock); }
+
+static DWORD WINAPI	serverListThread(LPVOID self);
+
+#elif defined(HAVE_PTHREAD)
+
+static pthread_mutex_t	searchLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t	searchThread;
+
+static void		lockSearch()	{ pthread_mutex_lock(&searchLock); }
+static void		unlockSearch()	{ pthread_mutex_unlock(&searchLock); }
+
+static void*		serverListThread(void* self);
+
+#else
+
+static void		lockSearch()	{ }
+static void		unlockSearch()	{ }
+
+#endif
+
 ServerList::ServerList() :
+	addedCacheToList(false),
+	cacheSaved(false),
 	numListServers(0),
 	phase(-1),
+	nextAdded(0),
+	sorted(true),
 	serverCache(ServerListCache::get()),
-	pingBcastSocket(-1)
+	pingBcastSocket(-1),
+	pingSocket(-1),
+	searching(false),
+	threaded(false),
+	quitting(false),
+	listDone(false),
+	listFailed(false)
 {
+#if defined(_WIN32)
+  InitializeCriticalSection(&searchLock);
+#endif
 }
 
 ServerList::~ServerList() {
   _shutDown();
+#if defined(_WIN32)
+  DeleteCriticalSection(&searchLock);
+#endif
 }
 
 void ServerList::startServerPings() {
 
+  // drop whatever the last search left behind
+  _shutDown();
+  addedCacheToList = false;
+  cacheSaved = false;
+
   // schedule lookup of server list url.  dereference URL chain every
   // time instead of only first time just in case one of the pointers
   // has changed.
@@ -69,6 +142,7 @@ void ServerList::startServerPings() {
 void ServerList::readServerList(int index)
 {
   ListServer& listServer = listServers[index];
+  std::vector<ServerItem> replies;
 
   // read more data into server list buffer
   int n = recv(listServer.socket, listServer.buffer + listServer.bufferSize,
@@ -151,8 +225,11 @@ void ServerList::readServerList(int index)
 	}
 
 	serverInfo.cached = false;
-	// add to list & add it to the server cache
-	addToList(serverInfo,true);
+	replies.push_back(serverInfo);
+
+	// and ask the server itself how many are playing now
+	if (pingSocket != -1)
+	  pingQueue.push_back(serverInfo);
       }
 
       // next reply
@@ -172,58 +249,33 @@ void ServerList::readServerList(int index)
     listServer.socket = -1;
     listServer.phase = -1;
   }
+
+  // hand them to the main thread, which adds them to the list and
+  // the server cache
+  if (!replies.empty()) {
+    lockSearch();
+    listReplies.insert(listReplies.end(), replies.begin(), replies.end());
+    unlockSearch();
+  }
 }
 
 void ServerList::addToList(ServerItem& info, bool doCache)
 {
-  // update if we already have it
-  int i;
-
-  // search and delete entry for this item if it exists
-  // (updating info in place may "unsort" the list)
-  for (i = 0; i < (int)servers.size(); i++) {
-    ServerItem& server = servers[i];
-    if (server.ping.serverId.serverHost.s_addr == info.ping.serverId.serverHost.s_addr
-	&& server.ping.serverId.port == info.ping.serverId.port) {
-      servers.erase(servers.begin() + i); // erase this item
-    }
-  }
-
-  // find point to insert new player at
-  int insertPoint = -1; // point to insert server into
-
-  // insert new item before the first serveritem with is deemed to be less
-  // in value than the item to be inserted -- cached items are less than
-  // non-cached, items that have more players are more, etc..
-  for (i = 0; i < (int)servers.size(); i++) {
-    ServerItem& server = servers[i];
-    if (server < info){
-      insertPoint = i;
-      break;
-    }
-  }
-
-  if (insertPoint == -1){ // no spot to insert it into -- goes on back
+  // update if we already have it, otherwise add it to the end.  either
+  // way it counts as the newest item when sorting, so it ends up after
+  // the items it ties with just as if it had been erased and inserted.
+  const ServerKey key((unsigned long)info.ping.serverId.serverHost.s_addr,
+		      (int)info.ping.serverId.port);
+  ServerIndex::iterator found = serverIndex.find(key);
+  if (found == serverIndex.end()) {
+    serverIndex[key] = servers.size();
     servers.push_back(info);
-  } else {  // found a spot to insert it into
-    servers.insert(servers.begin() + insertPoint,info);
+    serverAdded.push_back(nextAdded++);
+  } else {
+    servers[found->second] = info;
+    serverAdded[found->second] = nextAdded++;
   }
-
-  // update display
-  /*
-  char buffer [80];
-  std::vector<std::string> args;
-  sprintf(buffer, "%d", (int)servers.size());
-  args.push_back(buffer);
-  setStatus("Servers found: {1}", &args);
-  */
-  
-  // force update
-  /*
-  const int oldSelectedIndex = selectedIndex;
-  selectedIndex = -1;
-  setSelected(oldSelectedIndex);
-  */
+  sorted = false;
 
   if (doCache) {
     // update server cache if asked for
@@ -241,14 +293,7 @@ void ServerList::addToList(ServerItem& info, bool doCache)
     // update the last updated time to now
     info.setUpdateTime();
 
-    SRV_STR_MAP::iterator iter;
-    iter = serverCache->find(serverAddress);  // erase entry to allow update
-    if (iter != serverCache->end()){ // if we find it, update it
-      iter->second = info;
-    } else {
-      // insert into cache -- wasn't found
-      serverCache->insert(serverAddress,info);
-    }
+    serverCache->update(serverAddress, info);
   }
 }
 
@@ -289,169 +334,344 @@ void			ServerList::checkEchos()
       listServers[numListServers].pathname = path;
       listServers[numListServers].port    = port;
       listServers[numListServers].socket  = -1;
-      listServers[numListServers].phase   = 2;
+      listServers[numListServers].phase   = 1;
       numListServers++;
     }
 
-    // do phase 1 only if we found a valid list server url
-    if (numListServers > 0)
-      phase = 1;
-    else
+    // the connections are made by the search
+    if (numListServers > 0) {
+      phase = 2;
+      startSearch();
+    } else {
       phase = -1;
+    }
   }
 
-  // connect to list servers in phase 1
-  else if (phase == 1) {
-    phase = -1;
-    for (int i = 0; i < numListServers; i++) {
-      ListServer& listServer = listServers[i];
-
-      // create socket.  give up on failure.
-      listServer.socket = socket(AF_INET, SOCK_STREAM, 0);
-      if (listServer.socket < 0) {
-	printError("Can't create list server socket");
-	listServer.socket = -1;
-	if (!addedCacheToList) {
-	  addedCacheToList = true;
-	  addCacheToList();
-	}
-	continue;
-      }
+  // without a search thread the list servers are polled from here
+  if (searching && !threaded) {
+    sendPings();
+    while (pollSearch(250)) {
+      // keep reading while there's something to read
+    }
+    listDone = !listServersActive() && !pingsPending();
+  }
 
-      // set to non-blocking.  we don't want to wait for the connection.
-      if (BzfNetwork::setNonBlocking(listServer.socket) < 0) {
-	printError("Error with list server socket");
-	close(listServer.socket);
-	listServer.socket = -1;
-	if (!addedCacheToList){
-	  addedCacheToList = true;
-	  addCacheToList();
-	}
-	continue;
-      }
+  // get echo messages.  they need a name lookup, which only works on
+  // this thread, but there's only ever a few of them.
+  while (pingBcastSocket != -1) {
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 250;
+
+    fd_set read_set;
+    FD_ZERO(&read_set);
+    _FD_SET(pingBcastSocket, &read_set);
+    const int nfound = select(pingBcastSocket+1, (fd_set*)&read_set,
+					0, 0, &timeout);
+    if (nfound <= 0) {
+      break;
+    }
+
+    ServerItem serverInfo;
+    sockaddr_in addr;
+    if (serverInfo.ping.read(pingBcastSocket, &addr)) {
+      serverInfo.ping.serverId.serverHost = addr.sin_addr;
+      serverInfo.cached = false;
+      addToListWithLookup(serverInfo);
+    }
+  }
+
+  // take what the list servers sent so far
+  std::vector<ServerItem> listed;
+  std::vector<std::string> errors;
+  lockSearch();
+  while (!listReplies.empty() &&
+	 (int)listed.size() < MaxRepliesPerFrame) {
+    listed.push_back(listReplies.front());
+    listReplies.pop_front();
+  }
+  errors.swap(listErrors);
+  const bool failed = listFailed;
+  const bool finished = listDone && listReplies.empty();
+  unlockSearch();
 
-      // start connection
-      struct sockaddr_in addr;
-      addr.sin_family = AF_INET;
-      addr.sin_port = htons(listServer.port);
-      addr.sin_addr = listServer.address;
-      if (connect(listServer.socket, (CNCTType*)&addr, sizeof(addr)) < 0) {
+  int i;
+  for (i = 0; i < (int)errors.size(); i++)
+    printError(errors[i].c_str());
+  if (failed && !addedCacheToList) {
+    addedCacheToList = true;
+    addCacheToList();
+  }
+  for (i = 0; i < (int)listed.size(); i++)
+    addToList(listed[i], true);
+
+  // save what the list servers told us now rather than at exit.  only
+  // the servers that changed get written.
+  if (finished && phase == 2 && !cacheSaved) {
+    cacheSaved = true;
+    serverCache->saveCache();
+  }
+}
+
+void			ServerList::startSearch()
+{
+  searching = true;
+  quitting = false;
+  listDone = false;
+  listFailed = false;
+
+  threaded = false;
+#if defined(_WIN32)
+  DWORD id;
+  searchThread = CreateThread(NULL, 0, serverListThread, this, 0, &id);
+  threaded = (searchThread != NULL);
+#elif defined(HAVE_PTHREAD)
+  threaded = (pthread_create(&searchThread, NULL, serverListThread, this) == 0);
+#endif
+
+  // otherwise checkEchos() does the polling
+  if (!threaded)
+    connectListServers();
+}
+
+// search thread (or checkEchos() without one) from here on
+
+void			ServerList::connectListServers()
+{
+  // one socket pings all the listed servers.  without it they just
+  // show what the list server said.
+  pingSocket = socket(AF_INET, SOCK_DGRAM, 0);
+  if (pingSocket < 0) {
+    pingSocket = -1;
+  } else if (BzfNetwork::setNonBlocking(pingSocket) < 0) {
+    close(pingSocket);
+    pingSocket = -1;
+  }
+
+  for (int i = 0; i < numListServers; i++) {
+    ListServer& listServer = listServers[i];
+
+    // create socket.  give up on failure.
+    listServer.socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listServer.socket < 0) {
+      listServer.socket = -1;
+      listServerFailed(listServer, "Can't create list server socket");
+      continue;
+    }
+
+    // set to non-blocking.  we don't want to wait for the connection.
+    if (BzfNetwork::setNonBlocking(listServer.socket) < 0) {
+      listServerFailed(listServer, "Error with list server socket");
+      continue;
+    }
+
+    // start connection
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(listServer.port);
+    addr.sin_addr = listServer.address;
+    if (connect(listServer.socket, (CNCTType*)&addr, sizeof(addr)) < 0) {
 #if defined(_WIN32)
 #undef EINPROGRESS
 #define EINPROGRESS EWOULDBLOCK
 #endif
-	if (getErrno() != EINPROGRESS) {
-	  printError("Can't connect list server socket");
-	  close(listServer.socket);
-	  listServer.socket = -1;
-	  if (!addedCacheToList){
-	    addedCacheToList = true;
-	    addCacheToList();
-	  }
-	  continue;
-	}
+      if (getErrno() != EINPROGRESS) {
+	listServerFailed(listServer, "Can't connect list server socket");
+	continue;
       }
+    }
 
-      // at least this socket is okay so proceed to phase 2
-      phase = 2;
+    // wait for the connection
+    listServer.phase = 2;
+  }
+}
+
+void			ServerList::listServerFailed(ListServer& listServer,
+						     const char* msg)
+{
+  if (listServer.socket != -1) {
+    close(listServer.socket);
+    listServer.socket = -1;
+  }
+  listServer.phase = -1;
+
+  // checkEchos() reports it and falls back to the cache
+  lockSearch();
+  if (msg)
+    listErrors.push_back(msg);
+  listFailed = true;
+  unlockSearch();
+}
+
+bool			ServerList::listServersActive() const
+{
+  for (int i = 0; i < numListServers; i++)
+    if (listServers[i].socket != -1)
+      return true;
+  return false;
+}
+
+bool			ServerList::pingsPending() const
+{
+  return pingSocket != -1 && (!pingQueue.empty() || !pingsOut.empty());
+}
+
+void			ServerList::sendPings()
+{
+  // give up on servers that didn't answer in time
+  const time_t now = time(NULL);
+  PingMap::iterator iter = pingsOut.begin();
+  while (iter != pingsOut.end()) {
+    if (now - iter->second.sent > PingTimeout)
+      pingsOut.erase(iter++);
+    else
+      iter++;
+  }
+
+  // and ping more of them, up to MaxPingsOut at a time
+  while ((int)pingsOut.size() < MaxPingsOut && !pingQueue.empty()) {
+    const ServerItem& server = pingQueue.front();
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = server.ping.serverId.port;
+    addr.sin_addr = server.ping.serverId.serverHost;
+    if (PingPacket::sendRequest(pingSocket, &addr)) {
+      PendingPing& pending =
+	pingsOut[ServerKey((unsigned long)addr.sin_addr.s_addr,
+			   (int)addr.sin_port)];
+      pending.server = server;
+      pending.sent = now;
     }
+    pingQueue.pop_front();
   }
+}
 
-  // get echo messages
-  while (1) {
-    int i;
+void			ServerList::readPing()
+{
+  PingPacket reply;
+  struct sockaddr_in addr;
+  if (!reply.read(pingSocket, &addr))
+    return;
+
+  // only take answers to our own pings
+  PingMap::iterator found =
+    pingsOut.find(ServerKey((unsigned long)addr.sin_addr.s_addr,
+			    (int)addr.sin_port));
+  if (found == pingsOut.end())
+    return;
+
+  // keep the address the list server gave.  the server may not know
+  // its public one.
+  ServerItem serverInfo = found->second.server;
+  const ServerId serverId = serverInfo.ping.serverId;
+  serverInfo.ping = reply;
+  serverInfo.ping.serverId = serverId;
+  serverInfo.cached = false;
+  pingsOut.erase(found);
+
+  // checkEchos() updates the listed server with it
+  lockSearch();
+  listReplies.push_back(serverInfo);
+  unlockSearch();
+}
 
-    // *** NOTE *** searching spinner update was here
-    
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 250;
+bool			ServerList::pollSearch(long usec)
+{
+  int i;
 
-    fd_set read_set, write_set;
-    FD_ZERO(&read_set);
-    FD_ZERO(&write_set);
-    if (pingBcastSocket != -1) _FD_SET(pingBcastSocket, &read_set);
-    int fdMax = pingBcastSocket;
-
-    // check for list server connection or data
-    for (i = 0; i < numListServers; i++) {
-      ListServer& listServer = listServers[i];
-      if (listServer.socket != -1) {
-	if (listServer.phase == 2) {
-	  _FD_SET(listServer.socket, &write_set);
-	} else if (listServer.phase == 3) {
-	  _FD_SET(listServer.socket, &read_set);
-	}
-	if (listServer.socket > fdMax) {
-	  fdMax = listServer.socket;
-	}
+  struct timeval timeout;
+  timeout.tv_sec = usec / 1000000;
+  timeout.tv_usec = usec % 1000000;
+
+  fd_set read_set, write_set;
+  FD_ZERO(&read_set);
+  FD_ZERO(&write_set);
+  int fdMax = -1;
+
+  // check for list server connection or data
+  for (i = 0; i < numListServers; i++) {
+    ListServer& listServer = listServers[i];
+    if (listServer.socket != -1) {
+      if (listServer.phase == 2) {
+	_FD_SET(listServer.socket, &write_set);
+      } else if (listServer.phase == 3) {
+	_FD_SET(listServer.socket, &read_set);
+      }
+      if (listServer.socket > fdMax) {
+	fdMax = listServer.socket;
       }
     }
+  }
 
-    const int nfound = select(fdMax+1, (fd_set*)&read_set,
-					(fd_set*)&write_set, 0, &timeout);
-    if (nfound <= 0) {
-      break;
-    }
-    
-    // check broadcast sockets
-    ServerItem serverInfo;
-    sockaddr_in addr;
-    
-    if (pingBcastSocket != -1 && FD_ISSET(pingBcastSocket, &read_set)) {
-      if (serverInfo.ping.read(pingBcastSocket, &addr)) {
-	serverInfo.ping.serverId.serverHost = addr.sin_addr;
-	serverInfo.cached = false;
-	addToListWithLookup(serverInfo);
-      }
+  // check for ping replies
+  if (pingSocket != -1 && !pingsOut.empty()) {
+    _FD_SET(pingSocket, &read_set);
+    if (pingSocket > fdMax) {
+      fdMax = pingSocket;
     }
+  }
 
-    // check list servers
-    for (i = 0; i < numListServers; i++) {
-      ListServer& listServer = listServers[i];
-      if (listServer.socket != -1) {
-	// read more data from server
-	if (FD_ISSET(listServer.socket, &read_set)) {
-	  readServerList(i);
-	}
+  if (fdMax == -1)
+    return false;
+  const int nfound = select(fdMax+1, (fd_set*)&read_set,
+				      (fd_set*)&write_set, 0, &timeout);
+  if (nfound <= 0) {
+    return false;
+  }
 
-	// send list request
-	else if (FD_ISSET(listServer.socket, &write_set)) {
-#if !defined(_WIN32)
-	  // ignore SIGPIPE for this send
-	  SIG_PF oldPipeHandler = bzSignal(SIGPIPE, SIG_IGN);
-#endif
-	  bool errorSending;
-	  {
-	    char url[1024];
-	    snprintf(url, sizeof(url),
-		     "GET %s?action=LIST&version=%s HTTP/1.1\r\nHost: %s\r\nCache-control: no-cache\r\n\r\n",
-		     listServer.pathname.c_str(), getServerVersion(),
-		     listServer.hostname.c_str());
-	    errorSending = send(listServer.socket, url, strlen(url), 0)
-	      != (int) strlen(url);
-	  }
-	  if (errorSending) {
-	    // probably unable to connect to server
-	    close(listServer.socket);
-	    listServer.socket = -1;
-	    if (!addedCacheToList){
-	      addedCacheToList = true;
-	      addCacheToList();
-	     }
-	  } else {
-	    listServer.phase = 3;
-	    listServer.bufferSize = 0;
-	  }
-#if !defined(_WIN32)
-	  bzSignal(SIGPIPE, oldPipeHandler);
+  // check list servers
+  for (i = 0; i < numListServers; i++) {
+    ListServer& listServer = listServers[i];
+    if (listServer.socket != -1) {
+      // read more data from server
+      if (FD_ISSET(listServer.socket, &read_set)) {
+	readServerList(i);
+      }
+
+      // send list request
+      else if (FD_ISSET(listServer.socket, &write_set)) {
+	int flags = 0;
+#if defined(MSG_NOSIGNAL)
+	// don't let a dropped connection raise SIGPIPE
+	flags = MSG_NOSIGNAL;
+#elif !defined(_WIN32)
+	// ignore SIGPIPE for this send
+	SIG_PF oldPipeHandler = bzSignal(SIGPIPE, SIG_IGN);
 #endif
+	bool errorSending;
+	{
+	  char url[1024];
+	  snprintf(url, sizeof(url),
+		   "GET %s?action=LIST&version=%s HTTP/1.1\r\nHost: %s\r\nCache-control: no-cache\r\nConnection: close\r\n\r\n",
+		   listServer.pathname.c_str(), getServerVersion(),
+		   listServer.hostname.c_str());
+	  errorSending = send(listServer.socket, url, strlen(url), flags)
+	    != (int) strlen(url);
+	}
+	if (errorSending) {
+	  // probably unable to connect to server
+	  listServerFailed(listServer, NULL);
+	} else {
+	  listServer.phase = 3;
+	  listServer.bufferSize = 0;
 	}
+#if !defined(MSG_NOSIGNAL) && !defined(_WIN32)
+	bzSignal(SIGPIPE, oldPipeHandler);
+#endif
       }
     }
   }
+
+  // read a ping reply
+  if (pingSocket != -1 && FD_ISSET(pingSocket, &read_set)) {
+    readPing();
+  }
+  return true;
 }
 
+// main thread from here on
+
 void			ServerList::addToListWithLookup(ServerItem& info)
 {
   info.name = Address::getHostByAddress(info.ping.serverId.serverHost);
@@ -478,7 +698,60 @@ void			ServerList::addCacheToList()
   }
 }
 
+// the order ServerItem::operator< gives, highest first, with ties in
+// the order the servers were added.  the age is looked up once per
+// server rather than once per comparison.
+struct ServerOrder {
+  bool		cached;
+  int		players;
+  time_t	age;
+  unsigned int	added;
+  size_t	slot;
+
+  bool		operator<(const ServerOrder& right) const
+  {
+    if (cached != right.cached)
+      return !cached;
+    if (players != right.players)
+      return players > right.players;
+    if (cached && age != right.age)
+      return age < right.age;
+    return added < right.added;
+  }
+};
+
+void ServerList::sortServers() {
+  if (sorted)
+    return;
+
+  const size_t count = servers.size();
+  std::vector<ServerOrder> order(count);
+  size_t i;
+  for (i = 0; i < count; i++) {
+    const ServerItem& server = servers[i];
+    order[i].cached = server.cached;
+    order[i].players = server.getPlayerCount();
+    order[i].age = server.cached ? server.getAgeMinutes() : 0;
+    order[i].added = serverAdded[i];
+    order[i].slot = i;
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<ServerItem> sortedServers;
+  sortedServers.reserve(count);
+  for (i = 0; i < count; i++) {
+    const ServerItem& server = servers[order[i].slot];
+    sortedServers.push_back(server);
+    serverAdded[i] = order[i].added;
+    serverIndex[ServerKey((unsigned long)server.ping.serverId.serverHost.s_addr,
+			  (int)server.ping.serverId.port)] = i;
+  }
+  servers.swap(sortedServers);
+  sorted = true;
+}
+
 const std::vector<ServerItem>& ServerList::getServers() {
+  sortServers();
   return servers;
 }
 
@@ -488,6 +761,9 @@ std::vector<ServerItem>::size_type ServerList::size() {
 
 void ServerList::clear() {
   servers.clear();
+  serverAdded.clear();
+  serverIndex.clear();
+  sorted = true;
 }
 
 int ServerList::updateFromCache() {
@@ -515,6 +791,21 @@ bool ServerList::searchActive() {
 }
 
 void ServerList::_shutDown() {
+  // stop the search thread.  it notices within one select().
+  if (threaded) {
+    lockSearch();
+    quitting = true;
+    unlockSearch();
+#if defined(_WIN32)
+    WaitForSingleObject(searchThread, INFINITE);
+    CloseHandle(searchThread);
+#elif defined(HAVE_PTHREAD)
+    pthread_join(searchThread, NULL);
+#endif
+    threaded = false;
+  }
+  searching = false;
+
   // close server list sockets
   for (int i = 0; i < numListServers; i++)
     if (listServers[i].socket != -1) {
@@ -523,11 +814,67 @@ void ServerList::_shutDown() {
     }
   numListServers = 0;
 
+  // and the ping socket, forgetting any pings in flight
+  if (pingSocket != -1) {
+    close(pingSocket);
+    pingSocket = -1;
+  }
+  pingQueue.clear();
+  pingsOut.clear();
+
   // close input multicast socket
   closeMulticast(pingBcastSocket);
   pingBcastSocket = -1;
+
+  // forget replies nobody took
+  listReplies.clear();
+  listErrors.clear();
 }
 
+//
+// ServerListThread
+//
+
+class ServerListThread {
+  public:
+    static void		run(ServerList*);
+};
+
+void			ServerListThread::run(ServerList* list)
+{
+  list->connectListServers();
+
+  // read the list servers until they hang up and ping what they sent
+  // until every server answered or timed out, or the menu goes away
+  for (;;) {
+    lockSearch();
+    const bool quit = list->quitting;
+    unlockSearch();
+    if (quit || (!list->listServersActive() && !list->pingsPending()))
+      break;
+    list->sendPings();
+    list->pollSearch(250000);
+  }
+
+  lockSearch();
+  list->listDone = true;
+  unlockSearch();
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI	serverListThread(LPVOID self)
+{
+  ServerListThread::run((ServerList*)self);
+  return 0;
+}
+#elif defined(HAVE_PTHREAD)
+static void*		serverListThread(void* self)
+{
+  ServerListThread::run((ServerList*)self);
+  return NULL;
+}
+#endif
+
 // Local Variables: ***
 // mode: C++ ***
 // tab-width: 8 ***
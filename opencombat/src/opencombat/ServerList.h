@@ -10,9 +10,26 @@
  * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
  */
 
+/*
+ * ServerList:
+ *	The servers shown by the server menu.
+ *
+ * Talking to the list servers is done on a background thread (where
+ * there's thread support).  The thread only parses replies into a
+ * queue;  checkEchos() moves a bounded number of them into the list
+ * each frame, so a list server with thousands of entries doesn't
+ * stall the menu.  The thread also pings each listed server, at most
+ * MaxPingsOut at a time, and queues each answer as it arrives so the
+ * player counts the list server sent get replaced by current ones.
+ * Broadcast replies are still read by checkEchos() since they need a
+ * name lookup and Address can't do those off the main thread.
+ */
+
 #ifndef __SERVERLIST_H__
 #define __SERVERLIST_H__
 
+#include <map>
+#include <deque>
 #include "ListServer.h"
 #include "BzfEvent.h"
 #include "ServerItem.h"
@@ -39,17 +56,57 @@ public:
   int updateFromCache();
   void clear();
 private:
+  friend class ServerListThread;
   void _shutDown();
+  void startSearch();
+  void connectListServers();
+  bool pollSearch(long usec);
+  bool listServersActive() const;
+  void sendPings();
+  void readPing();
+  bool pingsPending() const;
+  void listServerFailed(ListServer&, const char* msg);
+  void sortServers();
 private:
+  // servers are found by address and port
+  typedef std::pair<unsigned long, int> ServerKey;
+  typedef std::map<ServerKey, size_t> ServerIndex;
+
+  // a ping sent to a listed server and not answered yet
+  struct PendingPing {
+    ServerItem	server;
+    time_t	sent;
+  };
+  typedef std::map<ServerKey, PendingPing> PingMap;
+
   bool addedCacheToList;
+  bool cacheSaved;
   long numListServers;
   int phase;
   std::vector<ServerItem> servers;
+  std::vector<unsigned int> serverAdded; // when each server was added
+  unsigned int nextAdded;
+  ServerIndex serverIndex;
+  bool sorted;
   ListServer listServers[MaxListServers];
   ServerListCache* serverCache;
   struct sockaddr_in pingInAddr;
   int pingBcastSocket;
   struct sockaddr_in pingBcastAddr;
+
+  // only used by the search
+  int pingSocket;
+  std::deque<ServerItem> pingQueue;
+  PingMap pingsOut;
+
+  // shared with the search thread
+  bool searching;
+  bool threaded;
+  bool quitting;
+  bool listDone;
+  bool listFailed;
+  std::deque<ServerItem> listReplies;
+  std::vector<std::string> listErrors;
 };
 
 #endif
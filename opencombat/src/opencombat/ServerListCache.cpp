@@ -12,6 +12,7 @@
 
 #include "ServerListCache.h"
 
+#include <fstream>
 #include "FileManager.h"
 #include "playing.h"
 #include "Protocol.h"
@@ -20,6 +21,27 @@
 // invoke persistent rebuilding for build versioning
 #include "version.h"
 
+// appending goes on until the file holds this many more records than
+// there are servers in the cache, then the file is rewritten
+static const size_t	MaxStaleRecords = 256;
+
+// servers not heard from in this many minutes are weeded out on save
+static const time_t	MaxRecordAge = 60*24*30;
+
+// write one record:  the index of the map then the server info
+static void		writeRecord(std::ostream& out,
+				    const std::string& serverAddress,
+				    const ServerItem& info)
+{
+  char buffer[MAX_STRING+1];
+  memset(&buffer,0, sizeof(buffer));
+  size_t lenCpy = serverAddress.size() < MAX_STRING ?
+		  serverAddress.size() : MAX_STRING;
+  strncpy(&buffer[0],serverAddress.c_str(),lenCpy);
+  out.write(buffer,sizeof(buffer));
+  info.writeToFile(out);
+}
+
 
 //
 // ServerListCache
@@ -28,7 +50,8 @@
 ServerListCache	ServerListCache::globalCache;
 
 
-ServerListCache::ServerListCache() : cacheAddedNum (0)
+ServerListCache::ServerListCache() : cacheAddedNum (0), fileRecords(0),
+				     rewrite(false)
 {
 
 }
@@ -47,7 +70,16 @@ ServerListCache*  ServerListCache::get()
 // insert a serverItem mapped by the serverAddress
 void ServerListCache::insert(std::string serverAddress,ServerItem& info)
 {
-  serverCache.insert(SRV_STR_MAP::value_type(serverAddress,info));
+  if (serverCache.insert(SRV_STR_MAP::value_type(serverAddress,info)).second)
+    changed.insert(serverAddress);
+}
+
+// add or replace the serverItem mapped by the serverAddress
+void ServerListCache::update(const std::string& serverAddress,
+			     const ServerItem& info)
+{
+  serverCache[serverAddress] = info;
+  changed.insert(serverAddress);
 }
 
 // a wrapper that allows access to the maps find method
@@ -70,63 +102,94 @@ SRV_STR_MAP::iterator ServerListCache::end()
 
 
 
-// load the server cache from the file fileName
-void			ServerListCache::saveCache()
+// get a file named e.g. BZFS1910Server.bzs in the cache dir
+// allows separation of server caches by protocol version
+std::string		ServerListCache::getFileName() const
 {
-  // get a file named e.g. BZFS1910Server.bzs in the cache dir
-  // allows separation of server caches by protocol version
   std::string fileName = getCacheDirName();
-  if (fileName == "") return;
+  if (fileName == "") return fileName;
   std::string verString = getServerVersion();
 #ifdef _WIN32
   fileName = fileName + "\\" + verString + "Servers.bzs";
 #else
   fileName = fileName + "/" + verString + "Servers.bzs";
 #endif
+  return fileName;
+}
 
-  char buffer[MAX_STRING+1];
+// save the server cache
+void			ServerListCache::saveCache()
+{
+  std::string fileName = getFileName();
+  if (fileName == "") return;
 
-  std::ostream* outFile = FILEMGR.createDataOutStream(fileName, true, true);
-  int lenCpy = MAX_STRING;
-  bool doWeed = (cacheAddedNum >0); // weed out as many items as were added
+  // old servers can only be weeded out of the file by rewriting it
+  bool doWeed = (cacheAddedNum > 0); // weed out as many items as were added
+  bool weedable = false;
+  if (doWeed) {
+    for (SRV_STR_MAP::const_iterator iter = serverCache.begin();
+	 iter != serverCache.end() && !weedable; iter++)
+      weedable = (iter->second.getAgeMinutes() > MaxRecordAge);
+  }
 
-  if (outFile != NULL){
-    for (SRV_STR_MAP::iterator iter = serverCache.begin(); iter != serverCache.end(); iter++){
-      // weed out after 30 days *if* if we should
-      if (doWeed && iter->second.getAgeMinutes() > 60*24*30) {
-       cacheAddedNum --;
-       doWeed = (cacheAddedNum >0);
-       continue;
+  // just add the servers that changed unless the file is getting
+  // mostly stale.  loadCache() keeps the last record for a server.
+  if (!rewrite && !weedable &&
+      fileRecords + changed.size() <= 2 * serverCache.size() + MaxStaleRecords) {
+    if (changed.empty()) return;
+    std::ofstream outFile(fileName.c_str(),
+			  std::ios::out | std::ios::binary | std::ios::app);
+    if (outFile) {
+      for (std::set<std::string>::iterator it = changed.begin();
+	   it != changed.end(); ++it) {
+	SRV_STR_MAP::iterator iter = serverCache.find(*it);
+	if (iter == serverCache.end())
+	  continue;
+	writeRecord(outFile, iter->first, iter->second);
+	fileRecords++;
+      }
+      outFile.close();
+      if (outFile) {
+	changed.clear();
+	return;
       }
+    }
+    // couldn't append so try starting over
+  }
 
-      // write out the index of the map
-      memset(&buffer,0, sizeof(buffer));
-      lenCpy = (iter->first).size() < MAX_STRING ? (iter->first).size() : MAX_STRING;
-      strncpy(&buffer[0],(iter->first.c_str()),lenCpy);
-      outFile->write(buffer,sizeof(buffer));
+  std::ostream* outFile = FILEMGR.createDataOutStream(fileName, true, true);
 
-      ServerItem x = iter->second;
-      // write out the serverinfo -- which is mapped by index
-      (iter->second).writeToFile(*outFile);
+  if (outFile != NULL){
+    size_t numWritten = 0;
+    SRV_STR_MAP::iterator iter = serverCache.begin();
+    while (iter != serverCache.end()) {
+      // weed out after 30 days *if* if we should.  they go from memory
+      // too, or every save after this would have to rewrite again.
+      if (doWeed && iter->second.getAgeMinutes() > MaxRecordAge) {
+	cacheAddedNum --;
+	doWeed = (cacheAddedNum >0);
+	serverCache.erase(iter++);
+	continue;
+      }
 
+      // write out the index of the map and the serverinfo
+      writeRecord(*outFile, iter->first, iter->second);
+      numWritten++;
+      iter++;
     }
     delete outFile;
+
+    fileRecords = numWritten;
+    rewrite = false;
+    changed.clear();
   }
 }
 
 // load the server cache
 void			ServerListCache::loadCache()
 {
-  // get a file named BZFS1910Server.bzs in the cache dir
-  // allows separation of server caches by protocol version
-  std::string fileName = getCacheDirName();
+  std::string fileName = getFileName();
   if (fileName == "") return;
-  std::string verString = getServerVersion();
-#ifdef _WIN32
-  fileName = fileName + "\\" + verString + "Servers.bzs";
-#else
-  fileName = fileName + "/" + verString + "Servers.bzs";
-#endif
 
   char buffer[MAX_STRING+1];
 
@@ -139,15 +202,25 @@ void			ServerListCache::loadCache()
       ServerItem info;
 
       inFile.read(buffer,sizeof(buffer)); //read the index of the map
-      if ((size_t)inFile.gcount() < sizeof(buffer)) break; // failed to read entire string
+      if ((size_t)inFile.gcount() < sizeof(buffer)) {
+	// failed to read entire string.  anything appended after a
+	// partial record would be lost so start over on the next save.
+	if (inFile.gcount() > 0) rewrite = true;
+	break;
+      }
       serverIndex = buffer;
 
       infoWorked = info.readFromFile(inFile);
       // after a while it is doubtful that player counts are accurate
       if (info.getAgeMinutes() > (time_t)30) info.ping.zeroPlayerCounts();
-      if (!infoWorked) break;
+      if (!infoWorked) {
+	rewrite = true;
+	break;
+      }
 
-      serverCache.insert(SRV_STR_MAP::value_type(serverIndex,info));
+      // servers that changed were appended so the last record wins
+      serverCache[serverIndex] = info;
+      fileRecords++;
     }
     inFile.close();
   }
@@ -164,6 +237,8 @@ bool			ServerListCache::clearCache()
 {
   if (serverCache.size() > 0){
     serverCache.clear();
+    changed.clear();
+    rewrite = true;
     return true;
 
   } else {
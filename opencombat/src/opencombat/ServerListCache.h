@@ -20,6 +20,7 @@
 /* system interface headers */
 #include <string>
 #include <map>
+#include <set>
 
 /* local interface headers */
 #include "ServerItem.h"
@@ -43,17 +44,25 @@ public:
   SRV_STR_MAP::iterator end();
   SRV_STR_MAP::iterator find(std::string ServerAddress);
   void			insert(std::string serverAddress,ServerItem& info);
+  void			update(const std::string& serverAddress,
+			       const ServerItem& info);
   void			incAddedNum();
 
 
 public:
 
 private:
+  std::string		getFileName() const;
 
 private:
   SRV_STR_MAP		serverCache;
   time_t		maxCacheAge; // age after we don't show servers in cache
   int			cacheAddedNum; // how many items were added to cache
+  // saveCache() appends the servers that changed since the last save
+  // and only rewrites the file once it's mostly stale records
+  std::set<std::string>	changed;
+  size_t		fileRecords; // records in the file, stale ones too
+  bool			rewrite; // next save has to rewrite the file
   static ServerListCache globalCache;
 };
 
@@ -65,6 +65,9 @@
 #include "ActionBinding.h"
 #include "ServerStartMenu.h"
 #include "FontManager.h"
+#include "TextureManager.h"
+#include "AssetLoader.h"
+#include "TimeKeeper.h"
 #include "MainDrawables.h"
 
 // invoke incessant rebuilding for build versioning
@@ -1111,6 +1114,75 @@ void setDataDir ( void )
 	}
 }
 
+//
+// startup timing, reported at debug level 1
+//
+static TimeKeeper	startupTime;
+static TimeKeeper	startupPhaseTime;
+
+void startupPhase ( const char* name )
+{
+	const TimeKeeper now = TimeKeeper::getCurrent();
+	if (name)
+		DEBUG1("startup: %-10s %.3fs\n", name, now - startupPhaseTime);
+	else
+		startupTime = now;
+	startupPhaseTime = now;
+}
+
+void startupReport ( void )
+{
+	AssetLoader &loader = AssetLoader::instance();
+	DEBUG1("startup: total      %.3fs\n", TimeKeeper::getCurrent() - startupTime);
+	DEBUG1("startup: %d media files read on %d loader threads, "
+	       "%.3fs waiting for them, %.3fs creating textures\n",
+	       loader.getNumLoaded(), loader.getNumThreads(),
+	       loader.getWaitTime(), TextureManager::instance().getUploadTime());
+}
+
+//
+// start reading media in the background
+//
+static const char*	startupTextures[] = {
+				"title",
+				"menu_arrow",
+				"flag",
+				"wall",
+				"boxwall",
+				"roof",
+				"pyrwall",
+				"caution",
+				"clouds",
+				"moon",
+				"mountain1",
+				"mountain2",
+				"mountain3",
+				"std_ground",
+				"zone_ground"
+			};
+
+void startAssetLoader ( void )
+{
+	AssetLoader::instance().start();
+	if (!noAudio)
+		prefetchSounds();
+}
+
+void preloadTextures ( void )
+{
+	// the texture manager needs a current OpenGL context.  fonts are
+	// built when they're first drawn;  get the faces the menus and the
+	// console use started.
+	FontManager &fm = FontManager::instance();
+	fm.preload(BZDB.get("consoleFont"));
+	fm.preload(BZDB.get("sansSerifFont"));
+	fm.preload(BZDB.get("serifFont"));
+
+	TextureManager &tm = TextureManager::instance();
+	for (int i = 0; i < (int)countof(startupTextures); i++)
+		tm.preload(startupTextures[i]);
+}
+
 //
 // initialize font system
 //
@@ -1430,6 +1502,7 @@ void shutdown ( MainWindow *pmainWindow, WordFilter *filter, PlatformFactory* pl
 		delete visual;
 
 	closeSound();
+	AssetLoader::instance().stop();
 	delete display;
 
 	if (platformFactory != NULL)
@@ -1467,6 +1540,7 @@ int			main(int argc, char** argv)
 	BzfWindow*				window = NULL;
 	bool							useFullscreen = false;
 	BzfVisual*				visual = NULL;
+	startupPhase(NULL);
 	initTimers();
 	setupBZDB(argc,argv);
 
@@ -1491,15 +1565,20 @@ int			main(int argc, char** argv)
 	loadBadwords(filter);
 	setEmailAddy();
 
+	startupPhase("config");
+
   if (openDisplay(platformFactory,window,visual) != 0)
 		return 1;
 
 	BzfJoystick* joystick = initGameDevice(platformFactory);
 	setAudioDriver();
 	setDataDir();
+	startAssetLoader();
+	startupPhase("display");
 
 	if (initFontSystem() != 0)
 		return 1;
+	startupPhase("fonts");
 
 	// register the 
 	registerVisualElements();
@@ -1516,10 +1595,13 @@ int			main(int argc, char** argv)
 
 	MainWindow& mainWindow = createMainWindow(new MainWindow(window, joystick),window,useFullscreen);
   MainWindow* pmainWindow = &mainWindow;
+	startupPhase("window");
 
 	initAudio();
+	startupPhase("audio");
 
   setGraphicOptions(mainWindow);
+	preloadTextures();
 
   // make scene renderer
   SceneRenderer renderer(mainWindow);
@@ -1529,6 +1611,8 @@ int			main(int argc, char** argv)
 
 	setupServerList();
   setupSilenceLists();
+	startupPhase("renderer");
+	startupReport();
 
   startPlaying(display, renderer, &startupInfo);
 
@@ -0,0 +1,396 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * mixbench:
+ *	Offline benchmark for the sound effect mixer.  Mixes a canned
+ *	script of overlapping local, world and looping sounds, first with
+ *	the per-sample loops the mixer used to have and then with the
+ *	AudioMixer kernels, checks that the two agree and reports how many
+ *	output samples per second each one manages.
+ *
+ *	usage: mixbench [seconds of audio] [passes]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "common.h"
+#include "AudioMixer.h"
+#include "TimeKeeper.h"
+
+const int		OutputRate = 22050;
+const long		BlockFrames = 1024;
+const long		BlockSamples = 2 * BlockFrames;
+const int		MaxEvents = 30;
+const int		SafetyMargin = 8;
+const int		NumSounds = 6;
+
+typedef struct {
+  long			length;		/* total number samples in data */
+  long			mlength;	/* total number samples in mono */
+  double		dmlength;	/* mlength as a double minus one */
+  float*		data;		/* left in even, right in odd */
+  float*		mono;		/* avg of channels for world sfx */
+  float*		monoRaw;	/* mono with silence before & after */
+} Samples;
+
+enum EventType { LocalEvent, WorldEvent, FixedEvent };
+
+typedef struct {
+  EventType		type;
+  Samples*		samples;
+  bool			busy;
+  long			ptr;
+  double		ptrFracLeft;
+  double		ptrFracRight;
+  float			lastLeftAtten;
+  float			lastRightAtten;
+  int			seed;		/* drives the fake motion */
+} Event;
+
+typedef int		(*Contribution)(Event*, float* scratch, long* len,
+					float leftAtten, float rightAtten,
+					double sampleStep);
+
+static Samples		sounds[NumSounds];
+static unsigned int	randState = 1;
+
+static unsigned int	nextRand()
+{
+  randState = randState * 1103515245 + 12345;
+  return (randState >> 16) & 0x7fff;
+}
+
+static void		makeSounds()
+{
+  // noise bursts of different lengths with a decay, like shots and booms
+  for (int i = 0; i < NumSounds; i++) {
+    Samples* s = sounds + i;
+    const long frames = OutputRate / 5 + i * OutputRate / 3;
+    s->length = 2 * frames;
+    s->mlength = frames;
+    s->dmlength = double(frames - 1);
+    s->data = new float[s->length];
+    s->monoRaw = new float[frames + 2 * SafetyMargin];
+    s->mono = s->monoRaw + SafetyMargin;
+    for (long n = 0; n < frames; n++) {
+      const float decay = 1.0f - (float)n / (float)frames;
+      s->data[2*n] = decay * (float)((int)nextRand() - 16384);
+      s->data[2*n+1] = decay * (float)((int)nextRand() - 16384);
+      s->mono[n] = 0.5f * (s->data[2*n] + s->data[2*n+1]);
+    }
+    for (int j = 0; j < SafetyMargin; j++)
+      s->monoRaw[j] = s->monoRaw[frames + SafetyMargin + j] = 0.0f;
+  }
+}
+
+/*
+ * the mixer as it was, one sample at a time
+ */
+
+const int		FadeDuration = 16;
+static float		fadeIn[FadeDuration];
+static float		fadeOut[FadeDuration];
+
+static int		oldLocal(Event* e, float* scratch, long* len,
+				float volumeAtten, float, double)
+{
+  long n, numSamples = e->samples->length - e->ptr;
+  if (numSamples > BlockSamples) numSamples = BlockSamples;
+  if (numSamples > *len) {
+    for (n = *len; n < numSamples; n += 2)
+      scratch[n] = scratch[n+1] = 0.0f;
+    *len = numSamples;
+  }
+  const float* src = e->samples->data + e->ptr;
+  if (numSamples <= FadeDuration) {
+    for (n = 0; n < numSamples; n += 2) {
+      int fs = int(FadeDuration * float(n) / float(numSamples)) & ~1;
+      scratch[n] += src[n] * (fadeIn[fs] * volumeAtten +
+			      fadeOut[fs] * e->lastLeftAtten);
+      scratch[n+1] += src[n+1] * (fadeIn[fs] * volumeAtten +
+				  fadeOut[fs] * e->lastRightAtten);
+    }
+  }
+  else {
+    for (n = 0; n < FadeDuration; n += 2) {
+      scratch[n] += src[n] * (fadeIn[n] * volumeAtten +
+			      fadeOut[n] * e->lastLeftAtten);
+      scratch[n+1] += src[n+1] * (fadeIn[n] * volumeAtten +
+				  fadeOut[n] * e->lastRightAtten);
+    }
+    for (; n < numSamples; n += 2) {
+      scratch[n] += src[n] * volumeAtten;
+      scratch[n+1] += src[n+1] * volumeAtten;
+    }
+  }
+  e->lastLeftAtten = e->lastRightAtten = volumeAtten;
+  if ((e->ptr += numSamples) == e->samples->length) {
+    e->busy = false;
+    return -1;
+  }
+  return 0;
+}
+
+static int		oldWorld(Event* e, float* scratch, long* len,
+				float leftAtten, float rightAtten,
+				double sampleStep)
+{
+  int fini = (sampleStep <= 0.0);
+  long n, nmL, nmR;
+  float* src = e->samples->mono;
+  float fracL, fracR, fsampleL, fsampleR;
+  const bool loop = (e->type == FixedEvent);
+
+  if (BlockSamples > *len) {
+    for (n = *len; n < BlockSamples; n += 2)
+      scratch[n] = scratch[n+1] = 0.0f;
+    *len = BlockSamples;
+  }
+  for (n = 0; !fini && n < BlockSamples; n += 2) {
+    nmL = (long)e->ptrFracLeft;
+    nmR = (long)e->ptrFracRight;
+    fracL = (float)(e->ptrFracLeft - floor(e->ptrFracLeft));
+    fracR = (float)(e->ptrFracRight - floor(e->ptrFracRight));
+    fsampleL = (1.0f - fracL) * src[nmL] + fracL * src[nmL+1];
+    fsampleR = (1.0f - fracR) * src[nmR] + fracR * src[nmR+1];
+    if (n < FadeDuration) {
+      scratch[n] += fsampleL * (fadeIn[n] * leftAtten +
+				fadeOut[n] * e->lastLeftAtten);
+      scratch[n+1] += fsampleR * (fadeIn[n] * rightAtten +
+				  fadeOut[n] * e->lastRightAtten);
+    }
+    else {
+      scratch[n] += fsampleL * leftAtten;
+      scratch[n+1] += fsampleR * rightAtten;
+    }
+    if ((e->ptrFracLeft += sampleStep) >= e->samples->dmlength) {
+      if (loop) e->ptrFracLeft -= e->samples->dmlength;
+      else fini = true;
+    }
+    if ((e->ptrFracRight += sampleStep) >= e->samples->dmlength) {
+      if (loop) e->ptrFracRight -= e->samples->dmlength;
+      else fini = true;
+    }
+  }
+  e->lastLeftAtten = leftAtten;
+  e->lastRightAtten = rightAtten;
+  if (fini) {
+    e->busy = false;
+    return -1;
+  }
+  return 0;
+}
+
+static void		oldConvert(short* dst, const float* src, long samples)
+{
+  for (long j = 0; j < samples; j++) {
+    if (src[j] < -32767.0f) dst[j] = -32767;
+    else if (src[j] > 32767.0f) dst[j] = 32767;
+    else dst[j] = short(src[j]);
+  }
+}
+
+/*
+ * the mixer using the block kernels, as in sound.cpp
+ */
+
+static float		resampled[BlockSamples];
+
+static int		newLocal(Event* e, float* scratch, long* len,
+				float volumeAtten, float, double)
+{
+  long n, numSamples = e->samples->length - e->ptr;
+  if (numSamples > BlockSamples) numSamples = BlockSamples;
+  if (numSamples > *len) {
+    for (n = *len; n < numSamples; n += 2)
+      scratch[n] = scratch[n+1] = 0.0f;
+    *len = numSamples;
+  }
+  audioMixStereo(scratch, e->samples->data + e->ptr, numSamples >> 1,
+		 e->lastLeftAtten, e->lastRightAtten,
+		 volumeAtten, volumeAtten);
+  e->lastLeftAtten = e->lastRightAtten = volumeAtten;
+  if ((e->ptr += numSamples) == e->samples->length) {
+    e->busy = false;
+    return -1;
+  }
+  return 0;
+}
+
+static int		newWorld(Event* e, float* scratch, long* len,
+				float leftAtten, float rightAtten,
+				double sampleStep)
+{
+  long n;
+  const bool loop = (e->type == FixedEvent);
+  const double dmlength = e->samples->dmlength;
+
+  if (BlockSamples > *len) {
+    for (n = *len; n < BlockSamples; n += 2)
+      scratch[n] = scratch[n+1] = 0.0f;
+    *len = BlockSamples;
+  }
+  bool fini = (sampleStep <= 0.0);
+  if (!fini) {
+    long frames = audioResampleMono(resampled, e->samples->mono, BlockFrames,
+				    &e->ptrFracLeft, &e->ptrFracRight,
+				    sampleStep, dmlength, loop);
+    audioMixStereo(scratch, resampled, frames,
+		   e->lastLeftAtten, e->lastRightAtten, leftAtten, rightAtten);
+    fini = !loop &&
+	   (e->ptrFracLeft >= dmlength || e->ptrFracRight >= dmlength);
+  }
+  e->lastLeftAtten = leftAtten;
+  e->lastRightAtten = rightAtten;
+  if (fini) {
+    e->busy = false;
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * the script
+ */
+
+typedef struct {
+  Contribution		local;
+  Contribution		world;
+  void			(*convert)(short*, const float*, long);
+} Mixer;
+
+static void		startEvent(Event* events, EventType type, int block)
+{
+  int i;
+  for (i = 0; i < MaxEvents; i++)
+    if (!events[i].busy)
+      break;
+  if (i == MaxEvents)
+    return;
+
+  Event* e = events + i;
+  e->type = type;
+  e->samples = sounds + (block * 7 + i) % NumSounds;
+  e->busy = true;
+  e->ptr = 0;
+  // the far ear hears it a little later
+  e->ptrFracLeft = 0.0;
+  e->ptrFracRight = (type == LocalEvent) ? 0.0 : -(double)(block % 5);
+  e->lastLeftAtten = e->lastRightAtten = 0.0f;
+  e->seed = block + i;
+}
+
+static void		runScript(const Mixer& mixer, long blocks,
+				  float* scratch, short* output)
+{
+  Event events[MaxEvents];
+  int i;
+  for (i = 0; i < MaxEvents; i++)
+    events[i].busy = false;
+
+  // a couple of looping sounds the whole time
+  startEvent(events, FixedEvent, 0);
+  startEvent(events, FixedEvent, 1);
+
+  for (long b = 0; b < blocks; b++) {
+    // a fight: shots all over the place, and some of our own
+    if (b % 2 == 0) startEvent(events, WorldEvent, (int)b);
+    if (b % 3 == 0) startEvent(events, WorldEvent, (int)b + 1);
+    if (b % 7 == 0) startEvent(events, LocalEvent, (int)b);
+
+    long numSamples = 0;
+    for (i = 0; i < MaxEvents; i++) {
+      Event* e = events + i;
+      if (!e->busy) continue;
+      if (e->type == LocalEvent) {
+	mixer.local(e, scratch, &numSamples, 0.8f, 0.8f, 1.0);
+      }
+      else {
+	// the listener and the sources move around a bit every block
+	const float phase = 0.1f * (float)b + (float)e->seed;
+	const float leftAtten = 0.5f + 0.4f * sinf(phase);
+	const float rightAtten = 0.5f + 0.4f * cosf(phase);
+	const double sampleStep = 1.0 + 0.03 * sin(0.37 * (double)phase);
+	mixer.world(e, scratch, &numSamples, leftAtten, rightAtten, sampleStep);
+      }
+    }
+    for (long j = numSamples; j < BlockSamples; j++)
+      scratch[j] = 0.0f;
+    mixer.convert(output + b * BlockSamples, scratch, BlockSamples);
+  }
+}
+
+static double		timeScript(const Mixer& mixer, long blocks, int passes,
+				   float* scratch, short* output)
+{
+  TimeKeeper start = TimeKeeper::getCurrent();
+  for (int p = 0; p < passes; p++)
+    runScript(mixer, blocks, scratch, output);
+  return TimeKeeper::getCurrent() - start;
+}
+
+int			main(int argc, char** argv)
+{
+  const double seconds = (argc > 1) ? atof(argv[1]) : 60.0;
+  const int passes = (argc > 2) ? atoi(argv[2]) : 3;
+  const long blocks = (long)(seconds * OutputRate / BlockFrames) + 1;
+  const double samples = (double)blocks * BlockSamples * passes;
+
+  for (int i = 0; i < FadeDuration; i += 2) {
+    fadeIn[i] = fadeIn[i+1] =
+		sinf(M_PI / 2.0f * (float)i / (float)(FadeDuration-2));
+    fadeOut[i] = fadeOut[i+1] = 1.0f - fadeIn[i];
+  }
+  makeSounds();
+
+  float* scratch = new float[BlockSamples];
+  short* oldOutput = new short[blocks * BlockSamples];
+  short* newOutput = new short[blocks * BlockSamples];
+
+  Mixer oldMixer = { oldLocal, oldWorld, oldConvert };
+  Mixer newMixer = { newLocal, newWorld, audioConvertToShort };
+
+  const double oldTime = timeScript(oldMixer, blocks, passes, scratch, oldOutput);
+  const double newTime = timeScript(newMixer, blocks, passes, scratch, newOutput);
+
+  // the kernels round a little differently, so allow a count of slack
+  long differ = 0;
+  int maxDiff = 0;
+  for (long n = 0; n < blocks * BlockSamples; n++) {
+    const int diff = abs((int)oldOutput[n] - (int)newOutput[n]);
+    if (diff > 0) differ++;
+    if (diff > maxDiff) maxDiff = diff;
+  }
+
+  printf("%.0f seconds of audio, %d passes, %ld frames per block\n",
+	 (double)blocks * BlockFrames / OutputRate, passes, BlockFrames);
+  printf("per-sample loops: %12.0f samples/sec\n", samples / oldTime);
+  printf("block kernels:    %12.0f samples/sec (%.2fx)\n",
+	 samples / newTime, oldTime / newTime);
+  printf("%ld of %ld samples differ, by at most %d\n",
+	 differ, blocks * BlockSamples, maxDiff);
+
+  delete[] scratch;
+  delete[] oldOutput;
+  delete[] newOutput;
+  return (maxDiff > 1) ? 1 : 0;
+}
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
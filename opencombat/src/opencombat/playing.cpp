@@ -102,6 +102,7 @@ static const char copyright[] = "Copyright (c) 1993 - 2004 Tim Riker";
 
 
 static const float	FlagHelpDuration = 60.0f;
+static const float	MaxTextureUploadTime = 0.005f;	// per frame, seconds
 static StartupInfo	startupInfo;
 static MainMenu*	mainMenu;
 ServerLink*		serverLink = NULL;
@@ -3859,6 +3860,7 @@ static bool		joinGame(const StartupInfo* info,
   numFlags = world->getMaxFlags();
 
   // make scene database
+  TimeKeeper sceneStart = TimeKeeper::getCurrent();
   const bool oldUseZBuffer = BZDB.isTrue("zbuffer");
   BZDB.set("zbuffer", "0");
   bspScene = sceneBuilder->make(world);
@@ -3868,6 +3870,7 @@ static bool		joinGame(const StartupInfo* info,
     zScene = sceneBuilder->make(world);
   BZDB.set("zbuffer", oldUseZBuffer ? "1" : "0");
   setSceneDatabase();
+  DEBUG1("world scene built in %.3fs\n", TimeKeeper::getCurrent() - sceneStart);
 
 
   mainWindow->getWindow()->yieldCurrent();
@@ -5029,6 +5032,9 @@ static void		playingLoop()
 
 			setFrameStartTime();
 
+			// swap in textures the loader threads have finished
+			TextureManager::instance().update(MaxTextureUploadTime);
+
 			drawScene(fov);
 			
 			removeDynamicSceneNodes();
@@ -17,6 +17,8 @@
 #include "TimeKeeper.h"
 #include "PlatformFactory.h"
 #include "BzfMedia.h"
+#include "AudioMixer.h"
+#include "AssetLoader.h"
 
 #include <map>
 #include <vector>
@@ -67,6 +69,7 @@ static void		sendSound(SoundCommand* s);
 static void		audioLoop(void*);
 static bool		allocAudioSamples();
 static void		freeAudioSamples(void);
+static void		freeSoundJobs(void);
 static int		resampleAudio(const float* in,
 				int frames, int rate, AudioSamples* out);
 
@@ -109,6 +112,26 @@ static const char*	soundFiles[] = {
 			};
 #define	SFX_COUNT	((int)(countof(soundFiles)))
 
+/* reads one sound effect file on a loader thread */
+class SoundJob : public AssetJob {
+  public:
+			SoundJob(BzfMedia* _media, const char* _name) :
+				media(_media), name(_name), samples(NULL),
+				numFrames(0), rate(0) { }
+			~SoundJob() { delete[] samples; }
+
+    void		load()
+			{ samples = media->readSound(name, numFrames, rate); }
+
+    BzfMedia*		media;
+    std::string		name;
+    float*		samples;
+    int			numFrames;
+    int			rate;
+};
+
+static SoundJob*	soundJobs[SFX_COUNT];
+
 
 /*
  * producer/consumer shared arena
@@ -151,14 +174,12 @@ static SoundEvent	events[MaxEvents];
 static int		portUseCount;
 static double		endTime;
 
-/* fade in/out table */
-const int		FadeDuration = 16;
-static float		fadeIn[FadeDuration];
-static float		fadeOut[FadeDuration];
-
 /* scratch buffer for adding contributions from sources */
 static float*		scratch;
 
+/* world sounds are resampled into here a block at a time */
+static float*		resampled;
+
 static bool		usingSameThread = false;
 
 static bool		audioInnerLoop();
@@ -170,8 +191,10 @@ void			openSound(const char*)
   if (usingAudio) return;			// already opened
 
   media = PlatformFactory::getMedia();
-  if (!media->openAudio())
+  if (!media->openAudio()) {
+    freeSoundJobs();
     return;
+  }
 
   // initialize buffers
  /* for (i = 0; i < SFX_COUNT; i++) {
@@ -199,12 +222,8 @@ void			openSound(const char*)
     events[i].busy = false;
   }
   portUseCount = 0;
-  for (i = 0; i < FadeDuration; i += 2) {
-    fadeIn[i] = fadeIn[i+1] =
-		sinf(M_PI / 2.0f * (float)i / (float)(FadeDuration-2));
-    fadeOut[i] = fadeOut[i+1] = 1.0f - fadeIn[i];
-  }
   scratch = new float[audioBufferSize];
+  resampled = new float[audioBufferSize];
 
   startTime = TimeKeeper::getCurrent();
   curTime = 0.0;
@@ -252,6 +271,7 @@ void			closeSound(void)
   PlatformFactory::getMedia()->closeAudio();
 
   delete[] scratch;
+  delete[] resampled;
 
   // free memory used for sfx samples
   freeAudioSamples();
@@ -264,24 +284,50 @@ bool			isSoundOpen()
   return usingAudio != 0;
 }
 
+void			prefetchSounds(void)
+{
+  AssetLoader& loader = AssetLoader::instance();
+  for (int i = 0; i < SFX_COUNT; i++) {
+    if (soundJobs[i] == NULL) {
+      soundJobs[i] = new SoundJob(PlatformFactory::getMedia(), soundFiles[i]);
+      loader.queue(soundJobs[i]);
+    }
+  }
+}
+
 static bool		allocAudioSamples()
 {
   bool anyFile = false;
-	AudioSamples	sample;
 
+  // read whatever hasn't been prefetched
+  prefetchSounds();
+
+  AssetLoader& loader = AssetLoader::instance();
   for (int i = 0; i < SFX_COUNT; i++)
 	{
-    // read it
-    int numFrames, rate;
-    float* samples = PlatformFactory::getMedia()->readSound(soundFiles[i], numFrames, rate);
-    if (samples && resampleAudio(samples, numFrames, rate, soundSamples + i))
+    SoundJob* job = soundJobs[i];
+    loader.wait(job);
+    if (job->samples && resampleAudio(job->samples, job->numFrames,
+				      job->rate, soundSamples + i))
       anyFile = true;
-    delete[] samples;
   }
+  freeSoundJobs();
 
   return anyFile;
 }
 
+static void		freeSoundJobs(void)
+{
+  AssetLoader& loader = AssetLoader::instance();
+  for (int i = 0; i < SFX_COUNT; i++) {
+    if (soundJobs[i] != NULL) {
+      loader.cancel(soundJobs[i]);
+      delete soundJobs[i];
+      soundJobs[i] = NULL;
+    }
+  }
+}
+
 static void		freeAudioSamples(void)
 {
   for (int i = 0; i < SFX_COUNT; i++) {
@@ -613,7 +659,6 @@ static void		receiverVelocity(float* data)
 static int		addLocalContribution(SoundEvent* e, long* len)
 {
   long		n, numSamples;
-  float*	src;
 
   numSamples = e->samples->length - e->ptr;
   if (numSamples > audioBufferSize) numSamples = audioBufferSize;
@@ -626,37 +671,10 @@ static int		addLocalContribution(SoundEvent* e, long* len)
       *len = numSamples;
     }
 
-    // add contribution -- conditionals outside loop for run-time efficiency
-    src = e->samples->data + e->ptr;
-    if (numSamples <= FadeDuration) {
-      for (n = 0; n < numSamples; n += 2) {
-	int fs = int(FadeDuration * float(n) / float(numSamples)) & ~1;
-	scratch[n] += src[n] * (fadeIn[fs] * volumeAtten +
-					  fadeOut[fs] * e->lastLeftAtten);
-	scratch[n+1] += src[n+1] * (fadeIn[fs] * volumeAtten +
-					  fadeOut[fs] * e->lastRightAtten);
-      }
-    }
-    else {
-      for (n = 0; n < FadeDuration; n += 2) {
-	scratch[n] += src[n] * (fadeIn[n] * volumeAtten +
-					  fadeOut[n] * e->lastLeftAtten);
-	scratch[n+1] += src[n+1] * (fadeIn[n] * volumeAtten +
-					  fadeOut[n] * e->lastRightAtten);
-      }
-      if (volumeAtten == 1.0f) {
-	for (; n < numSamples; n += 2) {
-	  scratch[n] += src[n];
-	  scratch[n+1] += src[n+1];
-	}
-      }
-      else {
-	for (; n < numSamples; n += 2) {
-	  scratch[n] += src[n] * volumeAtten;
-	  scratch[n+1] += src[n+1] * volumeAtten;
-	}
-      }
-    }
+    // add contribution, fading from the last volume to the current one
+    audioMixStereo(scratch, e->samples->data + e->ptr, numSamples >> 1,
+		   e->lastLeftAtten, e->lastRightAtten,
+		   volumeAtten, volumeAtten);
 
     e->lastLeftAtten = e->lastRightAtten = volumeAtten;
   }
@@ -701,16 +719,13 @@ static void		getWorldStuff(SoundEvent *e, float* la, float* ra,
 
 static int		addWorldContribution(SoundEvent* e, long* len)
 {
-  int		fini = 0;
-  long		n, nmL, nmR;
-  float*	src = e->samples->mono;
-  float		leftAtten, rightAtten, fracL, fracR, fsampleL, fsampleR;
+  long		n;
+  float		leftAtten, rightAtten;
   double	sampleStep;
 
   if (e->flags & SEF_IGNORING) return 0;
 
   getWorldStuff(e, &leftAtten, &rightAtten, &sampleStep);
-  if (sampleStep <= 0.0) fini = 1;
 
   /* initialize new areas of scratch space and adjust output sample count */
   if (audioBufferSize > *len) {
@@ -719,52 +734,18 @@ static int		addWorldContribution(SoundEvent* e, long* len)
     *len = audioBufferSize;
   }
 
-  // add contribution with crossfade
-  for (n = 0; !fini && n < FadeDuration; n += 2) {
-    // get sample position (to subsample resolution)
-    nmL = (long)e->ptrFracLeft;
-    nmR = (long)e->ptrFracRight;
-    fracL = (float)(e->ptrFracLeft - floor(e->ptrFracLeft));
-    fracR = (float)(e->ptrFracRight - floor(e->ptrFracRight));
-
-    // get sample (lerp closest two samples)
-    fsampleL = (1.0f - fracL) * src[nmL] + fracL * src[nmL+1];
-    fsampleR = (1.0f - fracR) * src[nmR] + fracR * src[nmR+1];
-
-    // filter and accumulate
-    scratch[n] += fsampleL * (fadeIn[n] * leftAtten +
-				fadeOut[n] * e->lastLeftAtten);
-    scratch[n+1] += fsampleR * (fadeIn[n] * rightAtten +
-				fadeOut[n] * e->lastRightAtten);
-
-    // next sample
-    if ((e->ptrFracLeft += sampleStep) >= e->samples->dmlength)
-      fini = true;
-    if ((e->ptrFracRight += sampleStep) >= e->samples->dmlength)
-      fini = true;
-  }
-
-  // add contribution
-  for (; !fini && n < audioBufferSize; n += 2) {
-    // get sample position (to subsample resolution)
-    nmL = (long)e->ptrFracLeft;
-    nmR = (long)e->ptrFracRight;
-    fracL = (float)(e->ptrFracLeft - floor(e->ptrFracLeft));
-    fracR = (float)(e->ptrFracRight - floor(e->ptrFracRight));
-
-    // get sample (lerp closest two samples)
-    fsampleL = (1.0f - fracL) * src[nmL] + fracL * src[nmL+1];
-    fsampleR = (1.0f - fracR) * src[nmR] + fracR * src[nmR+1];
-
-    // filter and accumulate
-    scratch[n] += fsampleL * leftAtten;
-    scratch[n+1] += fsampleR * rightAtten;
-
-    // next sample
-    if ((e->ptrFracLeft += sampleStep) >= e->samples->dmlength)
-      fini = true;
-    if ((e->ptrFracRight += sampleStep) >= e->samples->dmlength)
-      fini = true;
+  // resample what's left of the sound for this block, then add it in
+  // with a crossfade from the last gains
+  bool fini = (sampleStep <= 0.0);
+  if (!fini) {
+    const double dmlength = e->samples->dmlength;
+    long frames = audioResampleMono(resampled, e->samples->mono,
+				    audioBufferSize >> 1,
+				    &e->ptrFracLeft, &e->ptrFracRight,
+				    sampleStep, dmlength, false);
+    audioMixStereo(scratch, resampled, frames,
+		   e->lastLeftAtten, e->lastRightAtten, leftAtten, rightAtten);
+    fini = (e->ptrFracLeft >= dmlength || e->ptrFracRight >= dmlength);
   }
   e->lastLeftAtten = leftAtten;
   e->lastRightAtten = rightAtten;
@@ -786,9 +767,8 @@ static int		addWorldContribution(SoundEvent* e, long* len)
 
 static int		addFixedContribution(SoundEvent* e, long* len)
 {
-  long		n, nmL, nmR;
-  float*	src = e->samples->mono;
-  float		leftAtten, rightAtten, fracL, fracR, fsampleL, fsampleR;
+  long		n;
+  float		leftAtten, rightAtten;
   double	sampleStep;
 
   getWorldStuff(e, &leftAtten, &rightAtten, &sampleStep);
@@ -800,53 +780,13 @@ static int		addFixedContribution(SoundEvent* e, long* len)
     *len = audioBufferSize;
   }
 
-  // add contribution with crossfade
-  for (n = 0; n < FadeDuration; n += 2) {
-    // get sample position (to subsample resolution)
-    nmL = (long)e->ptrFracLeft;
-    nmR = (long)e->ptrFracRight;
-    fracL = (float)(e->ptrFracLeft - floor(e->ptrFracLeft));
-    fracR = (float)(e->ptrFracRight - floor(e->ptrFracRight));
-
-    // get sample (lerp closest two samples)
-    fsampleL = (1.0f - fracL) * src[nmL] + fracL * src[nmL+1];
-    fsampleR = (1.0f - fracR) * src[nmR] + fracR * src[nmR+1];
-
-    // filter and accumulate
-    scratch[n] += fsampleL * (fadeIn[n] * leftAtten +
-				fadeOut[n] * e->lastLeftAtten);
-    scratch[n+1] += fsampleR * (fadeIn[n] * rightAtten +
-				fadeOut[n] * e->lastRightAtten);
-
-    // next sample
-    if ((e->ptrFracLeft += sampleStep) >= e->samples->dmlength)
-      e->ptrFracLeft -= e->samples->dmlength;
-    if ((e->ptrFracRight += sampleStep) >= e->samples->dmlength)
-      e->ptrFracRight -= e->samples->dmlength;
-  }
-
-  // add contribution
-  for (; n < audioBufferSize; n += 2) {
-    // get sample position (to subsample resolution)
-    nmL = (long)e->ptrFracLeft;
-    nmR = (long)e->ptrFracRight;
-    fracL = (float)(e->ptrFracLeft - floor(e->ptrFracLeft));
-    fracR = (float)(e->ptrFracRight - floor(e->ptrFracRight));
-
-    // get sample (lerp closest two samples)
-    fsampleL = (1.0f - fracL) * src[nmL] + fracL * src[nmL+1];
-    fsampleR = (1.0f - fracR) * src[nmR] + fracR * src[nmR+1];
-
-    // filter and accumulate
-    scratch[n] += fsampleL * leftAtten;
-    scratch[n+1] += fsampleR * rightAtten;
-
-    // next sample
-    if ((e->ptrFracLeft += sampleStep) >= e->samples->dmlength)
-      e->ptrFracLeft -= e->samples->dmlength;
-    if ((e->ptrFracRight += sampleStep) >= e->samples->dmlength)
-      e->ptrFracRight -= e->samples->dmlength;
-  }
+  // fixed sounds loop, so there is always a whole block
+  long frames = audioResampleMono(resampled, e->samples->mono,
+				  audioBufferSize >> 1,
+				  &e->ptrFracLeft, &e->ptrFracRight,
+				  sampleStep, e->samples->dmlength, true);
+  audioMixStereo(scratch, resampled, frames,
+		 e->lastLeftAtten, e->lastRightAtten, leftAtten, rightAtten);
   e->lastLeftAtten = leftAtten;
   e->lastRightAtten = rightAtten;
 
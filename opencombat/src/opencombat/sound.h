@@ -49,6 +49,10 @@
 #define SFX_MESSAGE_PRIVATE	26	/* private message received */
 #define SFX_MESSAGE_TEAM	27	/* team message received */
 
+/* start reading the sound effect files in the background, so that
+ * openSound() only has to wait for what isn't done yet */
+void			prefetchSounds(void);
+
 /* prepare sound effects generator and shut it down */
 void			openSound(const char* pname);
 void			closeSound(void);
@@ -17,10 +17,22 @@
 #include "BZWReader.h"
 
 // implementation-specific system headers
-#include <fstream>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#if defined(_WIN32)
+#include <windows.h>
+#define BZW_READER_THREADS
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#include <unistd.h>
+#define BZW_READER_THREADS
+#endif
 
 // implementation-specific bzflag headers
 #include "Team.h"
+#include "TimeKeeper.h"
+#include "bzfio.h"
 
 // implementation-specific bzfs-specific headers
 #include "BZWError.h"
@@ -39,148 +51,461 @@
 extern CmdLineOptions *clOptions;
 extern BasesList bases;
 
-BZWReader::BZWReader(std::string filename) : location(filename), input(NULL)
-{
-  errorHandler = new BZWError(location);
-  input = new std::ifstream(filename.c_str(), std::ios::in);
+// never build with more threads than this
+static const int MaxBuildThreads = 8;
+// and give each thread at least this many objects, so small maps
+// don't pay for starting threads
+static const int MinObjectsPerThread = 4096;
+// longest token, as it always was
+static const int MaxTokenLength = 1023;
 
-  if (input->peek() == EOF) {
-    errorHandler->fatalError(std::string("could not find bzflag world file"), 0);
-  }
-}
+//
+// the file is read in two passes.  the first splits it into objects
+// and their parameters, remembering where each parameter is in the
+// mapped file.  the second makes the objects and hands each one its
+// parameters.  obstacles are most of any big map and reading them only
+// touches the object itself, so they're split between threads.  the
+// rest read BZDB or the command line options and stay on this thread.
+//
 
-BZWReader::~BZWReader()
+enum ObjectType {
+  NoObject = -1,
+  // built on any thread
+  BoxObject, PyramidObject, TeleporterObject, LinkObject,
+  // built on the main thread
+  BaseObject, WeaponObject, ZoneObject, WorldObject,
+  // skipped
+  OptionsObject
+};
+
+static const char *objectNames[] = {
+  "box", "pyramid", "teleporter", "link",
+  "base", "weapon", "zone", "world"
+};
+
+static bool		isThreadSafe(int type)
 {
-  // clean up
-  delete errorHandler;
-  delete input;
+  return type < BaseObject;
 }
 
-void BZWReader::readToken(char *buffer, int n)
-{
-  int c = -1;
+// a parameter line:  the command and the rest of the line after it
+struct WorldParam {
+  const char* cmd;
+  const char* end;
+  int cmdLength;
+  int line;
+  bool unknown;			// the object didn't take it
+};
+
+struct WorldRecord {
+  int type;
+  int firstParam;
+  int numParams;
+  bool discarded;		// read, for the warnings, but not used
+  WorldFileObject* object;
+};
 
-  // skip whitespace
-  while (input->good() && (c = input->get()) != -1 && isspace(c) && c != '\n')
-    ;
+// warnings are collected and reported in line order at the end, so
+// the output doesn't depend on which thread found what
+struct WorldMessage {
+  WorldMessage() : line(0) { }
+  WorldMessage(int _line, const std::string& _text) : line(_line), text(_text) { }
+  bool operator<(const WorldMessage& other) const { return line < other.line; }
+  int line;
+  std::string text;
+};
 
-  // read up to whitespace or n - 1 characters into buffer
-  int i = 0;
-  if (c != -1 && c != '\n') {
-    buffer[i++] = c;
-    while (input->good() && i < n - 1 && (c = input->get()) != -1 && !isspace(c))
-      buffer[i++] = (char)c;
+// a read-only istream buffer over part of the mapped file.  the object
+// readers take an istream and this saves copying every line into one.
+class WorldLineBuffer : public std::streambuf {
+public:
+  void set(const char* begin, const char* end)
+  {
+    char* b = const_cast<char*>(begin);
+    setg(b, b, const_cast<char*>(end));
   }
+};
 
-  // terminate string
-  buffer[i] = 0;
+// copies of the default objects.  constructors read BZDB, which only
+// the main thread may do, so threads copy these instead.
+struct WorldPrototypes {
+  CustomBox box;
+  CustomPyramid pyramid;
+  CustomGate teleporter;
+  CustomLink link;
+};
 
-  // put back last character we didn't use
-  if (c != -1 && isspace(c))
-    input->putback(c);
-}
+struct WorldBuildJob {
+  const WorldPrototypes* prototypes;
+  WorldParam* params;
+  WorldRecord* records;
+  int first;
+  int last;
+  bool threadSafe;
+  std::vector<WorldMessage> messages;
+};
 
+static bool		isToken(const char* token, int length, const char* word)
+{
+  return (int)strlen(word) == length && strncasecmp(token, word, length) == 0;
+}
 
-bool BZWReader::readWorldStream(std::vector<WorldFileObject*>& wlist)
+static bool		scanWorld(const char* data, size_t size,
+				  std::vector<WorldRecord>& records,
+				  std::vector<WorldParam>& params,
+				  std::vector<WorldMessage>& messages,
+				  WorldMessage& fatal)
 {
+  const char* p = data;
+  const char* const end = data + size;
   int line = 1;
-  char buffer[1024];
-  WorldFileObject *object    = NULL;
-  WorldFileObject *newObject = NULL;
-  WorldFileObject * const fakeObject = (WorldFileObject*)((char*)NULL + 1); // for options
-
+  int object = NoObject;
+  int newObject = NoObject;
   bool gotWorld = false;
 
-  while (!input->eof())
-  {
+  for (;;) {
     // watch out for starting a new object when one is already in progress
-    if (newObject) {
-      if (object) {
-	errorHandler->warning(std::string("discarding incomplete object"), line);
-	if (object != fakeObject)
-	  delete object;
+    if (newObject != NoObject) {
+      if (object != NoObject) {
+	messages.push_back(WorldMessage(line, "discarding incomplete object"));
+	if (object != OptionsObject)
+	  records.back().discarded = true;
       }
       object = newObject;
-      newObject = NULL;
+      newObject = NoObject;
+      if (object != OptionsObject) {
+	WorldRecord record;
+	record.type = object;
+	record.firstParam = (int)params.size();
+	record.numParams = 0;
+	record.discarded = false;
+	record.object = NULL;
+	records.push_back(record);
+      }
     }
 
-    // read first token but do not skip newlines
-    readToken(buffer, sizeof(buffer));
-    if (strcmp(buffer, "") == 0) {
+    // first token on the line
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    const char* lineEnd = eol ? eol : end;
+    const char* token = p;
+    while (token < lineEnd && isspace((unsigned char)*token))
+      ++token;
+    const char* tokenEnd = token;
+    while (tokenEnd < lineEnd && !isspace((unsigned char)*tokenEnd) &&
+	   tokenEnd - token < MaxTokenLength)
+      ++tokenEnd;
+    const int length = (int)(tokenEnd - token);
+
+    if (length == 0) {
       // ignore blank line
-    } else if (buffer[0] == '#') {
+    } else if (token[0] == '#') {
       // ignore comment
-    } else if (strcasecmp(buffer, "end") == 0) {
-      if (object) {
-        if (object != fakeObject) {
-	  wlist.push_back(object);
-	}
-	object = NULL;
+    } else if (isToken(token, length, "end")) {
+      if (object != NoObject) {
+	object = NoObject;
       } else {
-	errorHandler->fatalError(std::string("unexpected \"end\" token"), line);
+	fatal = WorldMessage(line, "unexpected \"end\" token");
 	return false;
       }
-    } else if (strcasecmp(buffer, "box") == 0) {
-      newObject = new CustomBox;
-    } else if (strcasecmp(buffer, "pyramid") == 0) {
-      newObject = new CustomPyramid();
-    } else if (strcasecmp(buffer, "teleporter") == 0) {
-      newObject = new CustomGate();
-    } else if (strcasecmp(buffer, "link") == 0) {
-      newObject = new CustomLink();
-    } else if (strcasecmp(buffer, "base") == 0) {
-      newObject = new CustomBase;
-    } else if (strcasecmp(buffer, "weapon") == 0) {
-      newObject = new CustomWeapon;
-    } else if (strcasecmp(buffer, "zone") == 0) {
-      newObject = new CustomZone;
-    } else if (strcasecmp(buffer, "world") == 0) {
+    } else if (isToken(token, length, "box")) {
+      newObject = BoxObject;
+    } else if (isToken(token, length, "pyramid")) {
+      newObject = PyramidObject;
+    } else if (isToken(token, length, "teleporter")) {
+      newObject = TeleporterObject;
+    } else if (isToken(token, length, "link")) {
+      newObject = LinkObject;
+    } else if (isToken(token, length, "base")) {
+      newObject = BaseObject;
+    } else if (isToken(token, length, "weapon")) {
+      newObject = WeaponObject;
+    } else if (isToken(token, length, "zone")) {
+      newObject = ZoneObject;
+    } else if (isToken(token, length, "world")) {
       if (!gotWorld) {
-	newObject = new CustomWorld();
+	newObject = WorldObject;
 	gotWorld = true;
       } else {
-	errorHandler->warning(std::string("multiple \"world\" sections found"), line);
+	messages.push_back(WorldMessage(line, "multiple \"world\" sections found"));
       }
-    } else if (strcasecmp(buffer, "options") == 0) {
-      newObject = fakeObject;
-    } else if (object) {
-      if (object != fakeObject) {
-        if (!object->read(buffer, *input)) {
-  	  // unknown token
-	  errorHandler->warning(std::string("unknown object parameter \"") + std::string(buffer) + std::string("\" - skipping"), line);
-	  // delete object;
-	  // return false;
-	}
+    } else if (isToken(token, length, "options")) {
+      newObject = OptionsObject;
+    } else if (object != NoObject) {
+      // a parameter for the current object, read later
+      if (object != OptionsObject) {
+	WorldParam param;
+	param.cmd = token;
+	param.end = lineEnd;
+	param.cmdLength = length;
+	param.line = line;
+	param.unknown = false;
+	params.push_back(param);
+	records.back().numParams++;
       }
-    } else { // filling the current object
+    } else {
       // unknown token
-      errorHandler->warning(std::string("invalid object type \"") + std::string(buffer) + std::string("\" - skipping"), line);
-      if (object != fakeObject)
-        delete object;
-     // return false;
+      messages.push_back(WorldMessage(line, std::string("invalid object type \"") + std::string(token, length) + std::string("\" - skipping")));
     }
 
-    // discard remainder of line
-    while (input->good() && input->peek() != '\n')
-      input->get(buffer, sizeof(buffer));
-    input->getline(buffer, sizeof(buffer));
     ++line;
+    if (eol == NULL)
+      break;
+    p = eol + 1;
   }
 
-  if (object) {
-    errorHandler->fatalError(std::string("missing \"end\" parameter"), line);
-    if (object != fakeObject)
-      delete object;
+  if (object != NoObject) {
+    fatal = WorldMessage(line, "missing \"end\" parameter");
     return false;
   }
 
   return true;
 }
 
+static WorldFileObject*	makeObject(int type, const WorldPrototypes* prototypes)
+{
+  switch (type) {
+    case BoxObject:		return new CustomBox(prototypes->box);
+    case PyramidObject:		return new CustomPyramid(prototypes->pyramid);
+    case TeleporterObject:	return new CustomGate(prototypes->teleporter);
+    case LinkObject:		return new CustomLink(prototypes->link);
+    case BaseObject:		return new CustomBase;
+    case WeaponObject:		return new CustomWeapon;
+    case ZoneObject:		return new CustomZone;
+    case WorldObject:		return new CustomWorld();
+  }
+  return NULL;
+}
+
+static void		buildObjects(WorldBuildJob* job)
+{
+  WorldLineBuffer buffer;
+  std::istream input(&buffer);
+  char cmd[MaxTokenLength + 1];
+
+  for (int i = job->first; i < job->last; i++) {
+    WorldRecord& record = job->records[i];
+    if (isThreadSafe(record.type) != job->threadSafe)
+      continue;
+
+    record.object = makeObject(record.type, job->prototypes);
+    for (int j = 0; j < record.numParams; j++) {
+      WorldParam& param = job->params[record.firstParam + j];
+      memcpy(cmd, param.cmd, param.cmdLength);
+      cmd[param.cmdLength] = '\0';
+
+      // the object reads its arguments from the rest of the line
+      buffer.set(param.cmd + param.cmdLength, param.end);
+      input.clear();
+      if (!record.object->read(cmd, input)) {
+	// unknown token
+	param.unknown = true;
+	job->messages.push_back(WorldMessage(param.line, std::string("unknown object parameter \"") + std::string(cmd) + std::string("\" - skipping")));
+      }
+    }
+  }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI	buildThread(LPVOID job)
+{
+  buildObjects((WorldBuildJob*)job);
+  return 0;
+}
+#elif defined(HAVE_PTHREAD)
+static void*		buildThread(void* job)
+{
+  buildObjects((WorldBuildJob*)job);
+  return NULL;
+}
+#endif
+
+BZWReader::BZWReader(std::string filename) : location(filename),
+  data(NULL), dataSize(0), buildThreads(0)
+{
+  memset(&timings, 0, sizeof(timings));
+  errorHandler = new BZWError(location);
+
+  TimeKeeper start = TimeKeeper::getCurrent();
+  if (!file.open(filename) || file.getSize() == 0) {
+    errorHandler->fatalError(std::string("could not find bzflag world file"), 0);
+  }
+  data = file.getData();
+  dataSize = file.getSize();
+  timings.map = TimeKeeper::getCurrent() - start;
+}
+
+BZWReader::BZWReader(std::string _location, const std::string& _text) :
+  location(_location), text(_text), buildThreads(0)
+{
+  memset(&timings, 0, sizeof(timings));
+  errorHandler = new BZWError(location);
+  data = text.data();
+  dataSize = text.size();
+}
+
+BZWReader::~BZWReader()
+{
+  // clean up
+  delete errorHandler;
+}
+
+void BZWReader::setBuildThreads(int count)
+{
+  buildThreads = count;
+}
+
+const BZWReader::Timings& BZWReader::getTimings() const
+{
+  return timings;
+}
+
+const std::string& BZWReader::getServerObjects() const
+{
+  return serverObjects;
+}
+
+bool BZWReader::readWorldStream(std::vector<WorldFileObject*>& wlist)
+{
+  TimeKeeper start = TimeKeeper::getCurrent();
+
+  // split the file into objects
+  std::vector<WorldRecord> records;
+  std::vector<WorldParam> params;
+  std::vector<WorldMessage> messages;
+  WorldMessage fatal;
+  const bool ok = scanWorld(data, dataSize,
+			    records, params, messages, fatal);
+
+  TimeKeeper scanned = TimeKeeper::getCurrent();
+  timings.scan = scanned - start;
+
+  if (!ok) {
+    for (unsigned int i = 0; i < messages.size(); i++)
+      errorHandler->warning(messages[i].text, messages[i].line);
+    errorHandler->fatalError(fatal.text, fatal.line);
+    return false;
+  }
+
+  // pick a number of threads
+  const int numRecords = (int)records.size();
+  int count = buildThreads;
+  if (count <= 0) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    count = (int)info.dwNumberOfProcessors;
+#elif defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  }
+  if (count > MaxBuildThreads)
+    count = MaxBuildThreads;
+  if (count > numRecords / MinObjectsPerThread)
+    count = numRecords / MinObjectsPerThread;
+  if (count < 1)
+    count = 1;
+#ifndef BZW_READER_THREADS
+  count = 1;
+#endif
+
+  // split the obstacles between the threads.  the first share and
+  // everything else is done right here.
+  WorldPrototypes prototypes;
+  std::vector<WorldBuildJob> jobs(count + 1);
+  for (int i = 0; i <= count; i++) {
+    WorldBuildJob& job = jobs[i];
+    job.prototypes = &prototypes;
+    job.params = params.empty() ? NULL : &params[0];
+    job.records = records.empty() ? NULL : &records[0];
+    if (i < count) {
+      job.first = (int)((double)numRecords * i / count);
+      job.last = (int)((double)numRecords * (i + 1) / count);
+      job.threadSafe = true;
+    } else {
+      job.first = 0;
+      job.last = numRecords;
+      job.threadSafe = false;
+    }
+  }
+
+#if defined(_WIN32)
+  std::vector<HANDLE> threads(count, (HANDLE)NULL);
+  for (int i = 1; i < count; i++) {
+    DWORD id;
+    threads[i] = CreateThread(NULL, 0, buildThread, &jobs[i], 0, &id);
+  }
+#elif defined(HAVE_PTHREAD)
+  std::vector<pthread_t> threads(count);
+  std::vector<bool> started(count, false);
+  for (int i = 1; i < count; i++)
+    started[i] = (pthread_create(&threads[i], NULL, buildThread, &jobs[i]) == 0);
+#endif
+
+  buildObjects(&jobs[count]);
+  buildObjects(&jobs[0]);
+
+  // wait for the others.  a thread that didn't start is done here.
+  for (int i = 1; i < count; i++) {
+#if defined(_WIN32)
+    if (threads[i] != NULL) {
+      WaitForSingleObject(threads[i], INFINITE);
+      CloseHandle(threads[i]);
+      continue;
+    }
+#elif defined(HAVE_PTHREAD)
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+      continue;
+    }
+#endif
+    buildObjects(&jobs[i]);
+  }
+
+  timings.build = TimeKeeper::getCurrent() - scanned;
+  timings.objects = numRecords;
+  timings.threads = count;
+
+  // report warnings in the order they'd have been found
+  for (int i = 0; i <= count; i++)
+    messages.insert(messages.end(), jobs[i].messages.begin(), jobs[i].messages.end());
+  std::stable_sort(messages.begin(), messages.end());
+  for (unsigned int i = 0; i < messages.size(); i++)
+    errorHandler->warning(messages[i].text, messages[i].line);
+
+  wlist.reserve(wlist.size() + numRecords);
+  serverObjects = "";
+  for (int i = 0; i < numRecords; i++) {
+    const WorldRecord& record = records[i];
+    if (record.discarded) {
+      delete record.object;
+      continue;
+    }
+    wlist.push_back(record.object);
+
+    // keep the ones that aren't obstacles as text, less what they
+    // didn't understand
+    if (!isThreadSafe(record.type)) {
+      serverObjects += objectNames[record.type];
+      serverObjects += "\n";
+      for (int j = 0; j < record.numParams; j++) {
+	const WorldParam& param = params[record.firstParam + j];
+	if (!param.unknown) {
+	  serverObjects += "  ";
+	  serverObjects.append(param.cmd, param.end - param.cmd);
+	  serverObjects += "\n";
+	}
+      }
+      serverObjects += "end\n\n";
+    }
+  }
+
+  return true;
+}
+
 WorldInfo* BZWReader::defineWorldFromFile()
 {
   // make sure input is valid
-  if (input->peek() == EOF) {
+  if (dataSize == 0) {
     errorHandler->fatalError(std::string("unexpected EOF"), 0);
     return NULL;
   }
@@ -192,16 +517,14 @@ WorldInfo* BZWReader::defineWorldFromFile()
     return NULL;
   }
 
-  // read file
-  std::vector<WorldFileObject*> list;
-  if (!readWorldStream(list)) {
-    emptyWorldFileObjectList(list);
-    errorHandler->fatalError(std::string("world file failed to load."), 0);
+  if (!addWorldObjects(world)) {
     delete world;
     return NULL;
   }
 
-  // make walls
+  TimeKeeper start = TimeKeeper::getCurrent();
+
+  // make walls.  the world section may have changed the size.
   float wallHeight = BZDB.eval(StateDatabase::BZDB_WALLHEIGHT);
   float worldSize = BZDB.eval(StateDatabase::BZDB_WORLDSIZE);
   world->addWall(0.0f, 0.5f * worldSize, 0.0f, 1.5f * M_PI, 0.5f * worldSize, wallHeight);
@@ -209,6 +532,28 @@ WorldInfo* BZWReader::defineWorldFromFile()
   world->addWall(0.0f, -0.5f * worldSize, 0.0f, 0.5f * M_PI, 0.5f * worldSize, wallHeight);
   world->addWall(-0.5f * worldSize, 0.0f, 0.0f, 0.0f, 0.5f * worldSize, wallHeight);
 
+  world->finishWorld();
+
+  timings.world += TimeKeeper::getCurrent() - start;
+  DEBUG1("read %d objects from %s: map %.3f, scan %.3f, build %.3f (%d thread%s), world %.3f seconds\n",
+	 timings.objects, location.c_str(), timings.map, timings.scan,
+	 timings.build, timings.threads, timings.threads == 1 ? "" : "s",
+	 timings.world);
+  return world;
+}
+
+bool BZWReader::addWorldObjects(WorldInfo *world)
+{
+  // read file
+  std::vector<WorldFileObject*> list;
+  if (!readWorldStream(list)) {
+    emptyWorldFileObjectList(list);
+    errorHandler->fatalError(std::string("world file failed to load."), 0);
+    return false;
+  }
+
+  TimeKeeper start = TimeKeeper::getCurrent();
+
   // add objects
   const int n = list.size();
   for (int i = 0; i < n; ++i)
@@ -226,8 +571,9 @@ WorldInfo* BZWReader::defineWorldFromFile()
 
   // clean up
   emptyWorldFileObjectList(list);
-  world->finishWorld();
-  return world;
+
+  timings.world = TimeKeeper::getCurrent() - start;
+  return true;
 }
 
 // Local Variables: ***
@@ -237,4 +583,3 @@ WorldInfo* BZWReader::defineWorldFromFile()
 // indent-tabs-mode: t ***
 // End: ***
 // ex: shiftwidth=2 tabstop=8
-
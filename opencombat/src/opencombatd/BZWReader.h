@@ -17,6 +17,9 @@
 #include <iostream>
 #include <vector>
 
+// common headers
+#include "MappedFile.h"
+
 // implementation headers
 #include "BZWError.h"
 
@@ -26,23 +29,52 @@ class WorldInfo;
 class BZWReader {
 public:
   BZWReader(std::string filename);
+  // read world file text from memory;  location is for messages
+  BZWReader(std::string location, const std::string& text);
   ~BZWReader();
 
   // external interface
   WorldInfo *defineWorldFromFile();
+  // read the objects into an existing world, without the walls
+  bool addWorldObjects(WorldInfo *world);
+
+  // the bases, weapons, zones and world section read last time, as
+  // world file text.  these set up more than the world's obstacles.
+  const std::string& getServerObjects() const;
+
+  // threads to build objects with, 0 (the default) picks a count from
+  // the number of processors.  small maps always use just one.
+  void setBuildThreads(int count);
+
+  // seconds spent in each phase of loading the world file
+  struct Timings {
+    float map;			// opening the file
+    float scan;			// splitting it into objects and parameters
+    float build;		// reading the parameters into objects
+    float world;		// adding the objects to the world
+    int objects;
+    int threads;
+  };
+  const Timings& getTimings() const;
 
 private:
   // functions for internal use
-  void readToken(char *buffer, int n);
   bool readWorldStream(std::vector<WorldFileObject*>& wlist);
 
-  // stream to open
+  // file to read
   std::string location;
-  std::istream *input;
+  MappedFile file;
+  std::string text;
+  const char *data;
+  size_t dataSize;
+  std::string serverObjects;
 
   // data/dependent objects
   BZWError *errorHandler;
 
+  int buildThreads;
+  Timings timings;
+
   // no default constructor
   BZWReader();
 };
@@ -121,6 +121,7 @@ const char *usageString =
 "[-vars <filename>] "
 "[-version] "
 "[-world <filename>] "
+"[-worldcache <filename>] "
 "[-worldsize < world size>] ";
 
 const char *extraUsageString =
@@ -205,6 +206,7 @@ const char *extraUsageString =
 "\t-vars: file to read for worlds configuration variables\n"
 "\t-version: print version and exit\n"
 "\t-world: world file to load\n"
+"\t-worldcache: binary copy of the world file, used while the file is unchanged\n"
 "\t-worldsize: numeric value for the size of the world ( def 400 )\n"
 "\n"
 "Poll Variables:  (see -poll)\n"
@@ -1027,6 +1029,9 @@ void parse(int argc, char **argv, CmdLineOptions &options, bool fromWorldFile)
 
       if (options.useTeleporters)
         std::cerr << "-t is meaningless when using a custom world, ignoring" << std::endl;
+    } else if (strcmp(argv[i], "-worldcache") == 0) {
+      checkArgc(1, i, argc, argv[i]);
+      options.worldCacheFile = argv[i];
     } else if (strcmp(argv[i], "-worldsize") == 0) {
       checkArgc(1, i, argc, argv[i]);
       BZDB.set(StateDatabase::BZDB_WORLDSIZE, string_util::format("%d",atoi(argv[i])*2));
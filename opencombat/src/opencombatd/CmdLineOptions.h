@@ -52,7 +52,7 @@ struct CmdLineOptions
   : wksPort(ServerPort), gameStyle(PlainGameStyle),
     rabbitSelection(ScoreRabbitSelection), msgTimer(0), spamWarnMax(0),
     servermsg(""),
-    advertisemsg(""), worldFile(""), pingInterface(""),
+    advertisemsg(""), worldFile(""), worldCacheFile(""), pingInterface(""),
     listServerURL(DefaultListServerURL), password(""),
     publicizedTitle(""), publicizedAddress(""),
     maxShots(1), maxTeamScore(0), maxPlayerScore(0),
@@ -93,6 +93,7 @@ struct CmdLineOptions
   std::string   servermsg;
   std::string   advertisemsg;
   std::string   worldFile;
+  std::string   worldCacheFile;
   std::string   pingInterface;
   std::string   listServerURL;
   std::string   password;
@@ -17,6 +17,7 @@
 
 /* implementation headers */
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 #include <errno.h>
 #include "bzfio.h"
@@ -24,9 +25,102 @@
 #include "TextUtils.h"
 #include "Protocol.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#include <sys/time.h>
+#else
+#include <sys/time.h>
+#endif
+
 extern Address serverAddress;
 extern PingPacket getTeamCounts();
 
+// give up on a request after this many seconds
+static const float ListServerTimeout = 10.0f;
+// at shutdown, wait no longer than this for the REMOVE to go out
+static const float ListServerQuitTimeout = 3.0f;
+// hang up when the connection has been idle this long
+static const float ListServerKeepAlive = 60.0f;
+// no list server answer is anywhere near this big
+static const size_t ListServerMaxResponse = 64 * 1024;
+
+//
+// the lock and signal shared with the list server thread.  there's
+// only ever one link at a time (publicize() deletes the old one before
+// making a new one) so they live here rather than in the class.
+//
+
+#if defined(_WIN32)
+
+static CRITICAL_SECTION	linkLock;
+static HANDLE		linkWake;	// auto reset
+static HANDLE		linkThread;
+
+static void		lockLink()	{ EnterCriticalSection(&linkLock); }
+static void		unlockLink()	{ LeaveCriticalSection(&linkLock); }
+static void		wakeLink()	{ SetEvent(linkWake); }
+
+static DWORD WINAPI	listServerThread(LPVOID self);
+
+#elif defined(HAVE_PTHREAD)
+
+static pthread_mutex_t	linkLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	linkWake = PTHREAD_COND_INITIALIZER;
+static pthread_t	linkThread;
+
+static void		lockLink()	{ pthread_mutex_lock(&linkLock); }
+static void		unlockLink()	{ pthread_mutex_unlock(&linkLock); }
+static void		wakeLink()	{ pthread_cond_signal(&linkWake); }
+
+static void*		listServerThread(void* self);
+
+#else
+
+static void		lockLink()	{ }
+static void		unlockLink()	{ }
+static void		wakeLink()	{ }
+
+#endif
+
+// TimeKeeper::getCurrent() isn't safe off the main thread, so the link
+// keeps its own clock
+static double		linkTime()
+{
+#if defined(_WIN32)
+  return (double)GetTickCount() * 0.001;
+#else
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (double)now.tv_sec + 1.0e-6 * (double)now.tv_usec;
+#endif
+}
+
+// wait for wakeLink() or a timeout (forever if seconds < 0).  the
+// caller holds the lock.
+static void		waitLink(double seconds)
+{
+#if defined(_WIN32)
+  unlockLink();
+  WaitForSingleObject(linkWake, seconds < 0.0 ? INFINITE :
+		      (DWORD)(1000.0 * seconds));
+  lockLink();
+#elif defined(HAVE_PTHREAD)
+  if (seconds < 0.0) {
+    pthread_cond_wait(&linkWake, &linkLock);
+  } else {
+    const double until = linkTime() + seconds;
+    struct timespec abstime;
+    abstime.tv_sec = (time_t)floor(until);
+    abstime.tv_nsec = (long)(1.0e+9 * (until - floor(until)));
+    pthread_cond_timedwait(&linkWake, &linkLock, &abstime);
+  }
+#else
+  (void)seconds;
+#endif
+}
+
 ListServerLink::ListServerLink(std::string listServerURL, std::string publicizedAddress, std::string publicizedTitle)
 {
   // parse url
@@ -51,6 +145,7 @@ ListServerLink::ListServerLink(std::string listServerURL, std::string publicized
   if (useDefault) {
     BzfNetwork::parseURL(DefaultListServerURL, protocol, hostname, port, pathname);
     DEBUG1("Provided list server URL (%s) is invalid.  Using default of %s.\n", listServerURL.c_str(), DefaultListServerURL);
+    address = Address::getHostAddress(hostname);
   }
 
   // add to list
@@ -64,6 +159,26 @@ ListServerLink::ListServerLink(std::string listServerURL, std::string publicized
   this->publicizeDescription = publicizedTitle;
   this->publicizeServer	     = true;  //if this c'tor is called, it's safe to publicize
 
+  this->lookupAgain  = false;
+  this->quitting     = false;
+  this->quitDeadline = 0.0;
+  this->pendingType  = NONE;
+  this->pendingSince = 0.0;
+  memset(&stats, 0, sizeof(stats));
+
+  // start the list server thread.  without one, messages are sent
+  // as they're queued.
+  threaded = false;
+#if defined(_WIN32)
+  InitializeCriticalSection(&linkLock);
+  linkWake = CreateEvent(NULL, FALSE, FALSE, NULL);
+  DWORD id;
+  linkThread = CreateThread(NULL, 0, listServerThread, this, 0, &id);
+  threaded = (linkThread != NULL);
+#elif defined(HAVE_PTHREAD)
+  threaded = (pthread_create(&linkThread, NULL, listServerThread, this) == 0);
+#endif
+
   // schedule initial ADD message
   queueMessage(ListServerLink::ADD);
 }
@@ -75,59 +190,215 @@ ListServerLink::ListServerLink()
   // to happen if publicizeServer is false
   this->linkSocket = NotConnected;
   this->publicizeServer = false;
+  this->threaded = false;
+  this->lookupAgain = false;
+  this->quitting = false;
+  this->pendingType = NONE;
+  memset(&stats, 0, sizeof(stats));
 }
 
 ListServerLink::~ListServerLink()
 {
-  // now tell the list server that we're going away.  this can
-  // take some time but we don't want to wait too long.  we do
-  // our own multiplexing loop and wait for a maximum of 3 seconds
-  // total.
+  // now tell the list server that we're going away.  this can take
+  // some time but we don't want to wait too long:  the list server
+  // thread gives up on it after ListServerQuitTimeout.
 
   // if we aren't supposed to be publicizing, skip the whole thing
-  // and don't waste 3 seconds.
   if (!publicizeServer)
     return;
 
+  lockLink();
+  quitting = true;
+  quitDeadline = linkTime() + ListServerQuitTimeout;
+  unlockLink();
   queueMessage(ListServerLink::REMOVE);
-  TimeKeeper start = TimeKeeper::getCurrent();
-  do {
-    // compute timeout
-    float waitTime = 3.0f - (TimeKeeper::getCurrent() - start);
-    if (waitTime <= 0.0f)
-      break;
-    if (!isConnected()) //queueMessage should have connected us
-      break;
-    // check for list server socket connection
-    int fdMax = -1;
-    fd_set write_set;
-    fd_set read_set;
-    FD_ZERO(&write_set);
-    FD_ZERO(&read_set);
-    if (phase == ListServerLink::CONNECTING)
-      _FD_SET(linkSocket, &write_set);
-    else
-      _FD_SET(linkSocket, &read_set);
-    fdMax = linkSocket;
-
-    // wait for socket to connect or timeout
-    struct timeval timeout;
-    timeout.tv_sec = long(floorf(waitTime));
-    timeout.tv_usec = long(1.0e+6f * (waitTime - floorf(waitTime)));
-    int nfound = select(fdMax + 1, (fd_set*)&read_set, (fd_set*)&write_set,
-			0, &timeout);
-    if (nfound == 0)
-      // Time has gone, close and go
-      break;
-    // check for connection to list server
-    if (FD_ISSET(linkSocket, &write_set))
-      sendQueuedMessages();
-    else if (FD_ISSET(linkSocket, &read_set))
-      read();
-  } while (true);
+
+#if defined(_WIN32)
+  if (threaded) {
+    WaitForSingleObject(linkThread, INFINITE);
+    CloseHandle(linkThread);
+  }
+  CloseHandle(linkWake);
+  DeleteCriticalSection(&linkLock);
+#elif defined(HAVE_PTHREAD)
+  if (threaded)
+    pthread_join(linkThread, NULL);
+#endif
+  threaded = false;
 
   // stop list server communication
   closeLink();
+
+  if (stats.published > 0)
+    DEBUG1("List server: %d published (%d merged), %d failed, "
+	   "%d connections, latency %.0f ms average, %.0f ms max\n",
+	   stats.published, stats.merged, stats.failed, stats.connects,
+	   1000.0f * stats.totalLatency / (float)stats.published,
+	   1000.0f * stats.maxLatency);
+
+  // publicize() deletes the link, serverStop() calls us directly
+  publicizeServer = false;
+}
+
+void ListServerLink::queueMessage(MessageType type)
+{
+  // ignore if the server is not public
+  if (!publicizeServer) return;
+
+  // the message is built here since it needs the team counts
+  std::string request;
+  if (type == ListServerLink::ADD) {
+    request = addMe(getTeamCounts(), publicizeAddress, url_encode(publicizeDescription));
+    lastAddTime = TimeKeeper::getCurrent();
+  } else if (type == ListServerLink::REMOVE) {
+    request = removeMe(publicizeAddress);
+  } else {
+    return;
+  }
+
+  // name lookups use alarm(), which only works on the main thread,
+  // so the list server thread asks us to redo one when it can't connect
+  lockLink();
+  const bool lookup = lookupAgain;
+  lookupAgain = false;
+  unlockLink();
+  if (lookup)
+    address = Address::getHostAddress(hostname);
+
+  // record next message to send.  a message still waiting is replaced,
+  // the list server only needs to hear the latest.
+  lockLink();
+  pendingAddress = address;
+  if (pendingType != ListServerLink::NONE)
+    stats.merged++;
+  else
+    pendingSince = linkTime();
+  pendingType = type;
+  pendingRequest = request;
+  wakeLink();
+  if (!threaded)
+    sendPending();
+  unlockLink();
+}
+
+ListServerLink::Stats ListServerLink::getStats()
+{
+  lockLink();
+  Stats copy = stats;
+  unlockLink();
+  return copy;
+}
+
+//
+// ListServerThread
+//
+
+class ListServerThread {
+  public:
+    static void		run(ListServerLink*);
+};
+
+void ListServerThread::run(ListServerLink* link)
+{
+  link->run();
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI	listServerThread(LPVOID self)
+{
+  ListServerThread::run((ListServerLink*)self);
+  return 0;
+}
+#elif defined(HAVE_PTHREAD)
+static void*		listServerThread(void* self)
+{
+  ListServerThread::run((ListServerLink*)self);
+  return NULL;
+}
+#endif
+
+void ListServerLink::run()
+{
+  // runs on the list server thread
+  double idleSince = linkTime();
+  lockLink();
+  for (;;) {
+    if (pendingType != ListServerLink::NONE) {
+      sendPending();
+      idleSince = linkTime();
+    } else if (quitting) {
+      break;
+    } else if (isConnected()) {
+      // keep the connection for the next message, but not forever
+      const double idle = linkTime() - idleSince;
+      if (idle >= ListServerKeepAlive) {
+	DEBUG4("Closing idle List Server connection\n");
+	closeLink();
+      } else {
+	waitLink(ListServerKeepAlive - idle);
+      }
+    } else {
+      waitLink(-1.0);
+    }
+  }
+  unlockLink();
+}
+
+void ListServerLink::sendPending()
+{
+  // called with the lock held, from the list server thread or, without
+  // one, from queueMessage().  the lock is dropped while we talk.
+  if (pendingType == ListServerLink::NONE)
+    return;
+  const std::string request = pendingRequest;
+  const double since = pendingSince;
+  if (!(pendingAddress == linkAddress)) {
+    // the list server moved;  don't keep talking to the old one
+    linkAddress = pendingAddress;
+    closeLink();
+  }
+  const double deadline = quitting ? quitDeadline :
+			  linkTime() + ListServerTimeout;
+  pendingType = ListServerLink::NONE;
+  unlockLink();
+
+  const bool ok = publish(request, deadline);
+
+  lockLink();
+  if (ok) {
+    const float latency = (float)(linkTime() - since);
+    stats.published++;
+    stats.lastLatency = latency;
+    stats.totalLatency += latency;
+    if (latency > stats.maxLatency)
+      stats.maxLatency = latency;
+  } else {
+    stats.failed++;
+  }
+}
+
+bool ListServerLink::publish(const std::string &request, double deadline)
+{
+  // a kept connection may have been dropped by the other end while it
+  // sat idle, in which case a fresh one gets a second try
+  for (int attempt = 0; attempt < 2; attempt++) {
+    const bool reused = isConnected();
+    if (!reused && !openLink(deadline))
+      return false;
+
+    DEBUG3("%s\n", request.c_str());
+    bool keepAlive = false;
+    if (sendRequest(request, deadline) && readResponse(deadline, keepAlive)) {
+      if (!keepAlive)
+	closeLink();
+      return true;
+    }
+    closeLink();
+    if (!reused)
+      break;
+  }
+  DEBUG3("Unable to send to the list server!\n");
+  return false;
 }
 
 void ListServerLink::closeLink()
@@ -139,153 +410,234 @@ void ListServerLink::closeLink()
   }
 }
 
-void ListServerLink::read()
+bool ListServerLink::waitForLink(bool write, double deadline)
 {
-  if (isConnected()) {
-    char    buf[256];
-    recv(linkSocket, buf, sizeof(buf), 0);
-    closeLink();
-    if (nextMessageType != ListServerLink::NONE)
-      // There was a pending request arrived after we write:
-      // we should redo all the stuff
-      openLink();
+  for (;;) {
+    // don't sit out a long timeout once we've been told to quit
+    double timeout = deadline - linkTime();
+    lockLink();
+    if (quitting && quitDeadline - linkTime() < timeout)
+      timeout = quitDeadline - linkTime();
+    unlockLink();
+    if (timeout <= 0.0)
+      return false;
+    if (timeout > 0.25)
+      timeout = 0.25;
+
+    fd_set set;
+    FD_ZERO(&set);
+    _FD_SET(linkSocket, &set);
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = long(1.0e+6 * timeout);
+    const int nfound = select(linkSocket + 1, write ? NULL : (fd_set*)&set,
+			      write ? (fd_set*)&set : NULL, 0, &tv);
+    if (nfound > 0)
+      return true;
+    if (nfound < 0 && getErrno() != EINTR)
+      return false;
   }
 }
 
-void ListServerLink::openLink()
+bool ListServerLink::openLink(double deadline)
 {
-  // start opening connection if not already doing so
+  linkSocket = socket(AF_INET, SOCK_STREAM, 0);
+  DEBUG4("Opening List Server\n");
   if (!isConnected()) {
-    linkSocket = socket(AF_INET, SOCK_STREAM, 0);
-    DEBUG4("Opening List Server\n");
-    if (!isConnected()) {
-      return;
-    }
+    return false;
+  }
 
-    // set to non-blocking for connect
-    if (BzfNetwork::setNonBlocking(linkSocket) < 0) {
-      closeLink();
-      return;
-    }
+  // set to non-blocking for connect
+  if (BzfNetwork::setNonBlocking(linkSocket) < 0) {
+    closeLink();
+    return false;
+  }
 
-    // Make our connection come from our serverAddress in case we have
-    // multiple/masked IPs so the list server can verify us.
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr = serverAddress;
-
-    // assign the address to the socket
-    if (bind(linkSocket, (CNCTType*)&addr, sizeof(addr)) < 0) {
-      closeLink();
-      return;
-    }
+  // Make our connection come from our serverAddress in case we have
+  // multiple/masked IPs so the list server can verify us.
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr = serverAddress;
 
-    // connect.  this should fail with EINPROGRESS but check for
-    // success just in case.
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port   = htons(port);
-    addr.sin_addr   = address;
-    if (connect(linkSocket, (CNCTType*)&addr, sizeof(addr)) < 0) {
+  // assign the address to the socket
+  if (bind(linkSocket, (CNCTType*)&addr, sizeof(addr)) < 0) {
+    closeLink();
+    return false;
+  }
+
+  // connect.  this should fail with EINPROGRESS but check for
+  // success just in case.
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port   = htons(port);
+  addr.sin_addr   = linkAddress;
+  bool connected = (connect(linkSocket, (CNCTType*)&addr, sizeof(addr)) == 0);
+  if (!connected) {
 #if defined(_WIN32)
 #undef EINPROGRESS
 #define EINPROGRESS EWOULDBLOCK
 #endif
-      if (getErrno() != EINPROGRESS) {
-	nerror("connecting to list server");
-	// try to lookup dns name again in case it moved
-  	this->address = Address::getHostAddress(this->hostname);
-	closeLink();
-      } else {
-	phase = CONNECTING;
-      }
-    } else {
-      // shouldn't arrive here. Just in case, clean
-      closeLink();
+    if (getErrno() == EINPROGRESS && waitForLink(true, deadline)) {
+      int error = 0;
+      socklen_t len = sizeof(error);
+      if (getsockopt(linkSocket, SOL_SOCKET, SO_ERROR, (char*)&error, &len) == 0)
+	connected = (error == 0);
     }
   }
+  if (!connected) {
+    nerror("connecting to list server");
+    // try to lookup dns name again in case it moved
+    lockLink();
+    lookupAgain = true;
+    unlockLink();
+    closeLink();
+    return false;
+  }
+
+  lockLink();
+  stats.connects++;
+  unlockLink();
+  return true;
 }
 
-void ListServerLink::queueMessage(MessageType type)
+bool ListServerLink::sendRequest(const std::string &request, double deadline)
 {
-  // ignore if the server is not public
-  if (!publicizeServer) return;
-
-  // Open network connection only if closed
-  if (!isConnected()) openLink();
-
-  // record next message to send.
-  nextMessageType = type;
+  const char* data = request.c_str();
+  int left = (int)request.size();
+  while (left > 0) {
+    const int sent = send(linkSocket, data, left, 0);
+    if (sent > 0) {
+      data += sent;
+      left -= sent;
+    } else if (sent < 0 && getErrno() != EWOULDBLOCK && getErrno() != EINTR) {
+      nerror("List server send failed");
+      return false;
+    } else if (!waitForLink(true, deadline)) {
+      return false;
+    }
+  }
+  return true;
 }
 
-void ListServerLink::sendQueuedMessages()
+bool ListServerLink::readResponse(double deadline, bool &keepAlive)
 {
-  if (!isConnected())
-    return;
+  // read the whole answer so the connection is ready for the next
+  // request.  the body is only logged.
+  std::string response;
+  std::string::size_type headerEnd = std::string::npos;
+  long contentLength = -1;
+  bool chunked = false;
+  bool closed = false;
+  keepAlive = false;
+
+  for (;;) {
+    // parse the headers once they're all here
+    if (headerEnd == std::string::npos) {
+      headerEnd = response.find("\r\n\r\n");
+      if (headerEnd != std::string::npos) {
+	std::string headers = response.substr(0, headerEnd + 2);
+	std::string lower = string_util::tolower(headers);
+	if (headers.compare(0, 5, "HTTP/") != 0)
+	  return false;
+	keepAlive = (headers.compare(5, 3, "1.1") == 0);
+	std::string::size_type pos = lower.find("\r\ncontent-length:");
+	if (pos != std::string::npos)
+	  contentLength = atol(lower.c_str() + pos + 17);
+	if (lower.find("\r\ntransfer-encoding: chunked") != std::string::npos)
+	  chunked = true;
+	if (lower.find("\r\nconnection: close") != std::string::npos)
+	  keepAlive = false;
+	else if (lower.find("\r\nconnection: keep-alive") != std::string::npos)
+	  keepAlive = true;
+	const int status = atoi(headers.c_str() + headers.find(' ') + 1);
+	if (status < 200 || status > 299)
+	  DEBUG1("List server answered %d\n", status);
+	headerEnd += 4;
+      }
+    }
 
-  if (nextMessageType == ListServerLink::ADD) {
-    DEBUG3("Queuing ADD message to list server\n");
-    addMe(getTeamCounts(), publicizeAddress, url_encode(publicizeDescription));
-    lastAddTime = TimeKeeper::getCurrent();
-  } else if (nextMessageType == ListServerLink::REMOVE) {
-    DEBUG3("Queuing REMOVE message to list server\n");
-    removeMe(publicizeAddress);
+    // see if the body is complete
+    if (headerEnd != std::string::npos) {
+      if (chunked) {
+	// walk the chunks;  a zero size one ends the body
+	std::string::size_type pos = headerEnd;
+	bool complete = false;
+	for (;;) {
+	  std::string::size_type lineEnd = response.find("\r\n", pos);
+	  if (lineEnd == std::string::npos)
+	    break;
+	  const long size = strtol(response.c_str() + pos, NULL, 16);
+	  if (size == 0) {
+	    complete = (response.find("\r\n\r\n", lineEnd) != std::string::npos);
+	    break;
+	  }
+	  pos = lineEnd + 2 + size + 2;
+	  if (pos > response.size())
+	    break;
+	}
+	if (complete)
+	  break;
+      } else if (contentLength >= 0) {
+	if (response.size() >= headerEnd + contentLength)
+	  break;
+      } else if (closed) {
+	// the end of the connection is the end of the body
+	keepAlive = false;
+	break;
+      }
+    }
+    if (closed)
+      return false;
+    if (response.size() > ListServerMaxResponse)
+      return false;
+
+    // get some more
+    char buf[4096];
+    const int n = recv(linkSocket, buf, sizeof(buf), 0);
+    if (n > 0) {
+      response.append(buf, n);
+    } else if (n == 0) {
+      closed = true;
+      keepAlive = false;
+    } else if (getErrno() == EWOULDBLOCK || getErrno() == EINTR) {
+      if (!waitForLink(false, deadline))
+	return false;
+    } else {
+      return false;
+    }
   }
+
+  DEBUG4("%s\n", response.c_str() + headerEnd);
+  return true;
 }
 
-void ListServerLink::addMe(PingPacket pingInfo,
-			   std::string publicizedAddress,
-			   std::string publicizedTitle)
+std::string ListServerLink::addMe(PingPacket pingInfo,
+				  std::string publicizedAddress,
+				  std::string publicizedTitle)
 {
-  std::string msg;
-
   // encode ping reply as ascii hex digits plus NULL
   char gameInfo[PingPacketHexPackedSize + 1];
   pingInfo.packHex(gameInfo);
 
-  // send ADD message (must send blank line)
-  msg = string_util::format("GET %s?action=ADD&nameport=%s&version=%s&gameinfo=%s&build=%s&title=%s HTTP/1.1\r\n"
+  // ADD message (must send blank line)
+  return string_util::format("GET %s?action=ADD&nameport=%s&version=%s&gameinfo=%s&build=%s&title=%s HTTP/1.1\r\n"
     "Host: %s\r\nCache-Control: no-cache\r\n\r\n",
     pathname.c_str(), publicizedAddress.c_str(),
     getServerVersion(), gameInfo,
     getAppVersion(),
     publicizedTitle.c_str(),
     hostname.c_str());
-  sendMessage(msg);
 }
 
-void ListServerLink::removeMe(std::string publicizedAddress)
+std::string ListServerLink::removeMe(std::string publicizedAddress)
 {
-  std::string msg;
-  // send REMOVE (must send blank line)
-  msg = string_util::format("GET %s?action=REMOVE&nameport=%s HTTP/1.1\r\n"
+  // REMOVE message (must send blank line)
+  return string_util::format("GET %s?action=REMOVE&nameport=%s HTTP/1.1\r\n"
     "Host: %s\r\nCache-Control: no-cache\r\n\r\n",
     pathname.c_str(),
     publicizedAddress.c_str(),
     hostname.c_str());
-  sendMessage(msg);
-}
-
-void ListServerLink::sendMessage(std::string message)
-{
-  const int bufsize = 4096;
-  char msg[bufsize];
-  strncpy(msg, message.c_str(), bufsize);
-  msg[bufsize - 1] = 0;
-  if (strlen(msg) > 0) {
-    DEBUG3("%s\n", msg);
-    if (send(linkSocket, msg, strlen(msg), 0) == -1) {
-      perror("List server send failed");
-      DEBUG3("Unable to send to the list server!\n");
-      closeLink();
-    } else {
-      nextMessageType = ListServerLink::NONE;
-      phase           = ListServerLink::WRITTEN;
-    }
-  } else {
-    closeLink();
-  }
 }
 
 // Local Variables: ***
@@ -11,6 +11,11 @@
  */
 
 // Provide BZFS with a list server connection
+//
+// All talking to the list server happens on a thread of its own, so a
+// slow or dead list server never holds up the game loop.  Messages
+// queued while one is in flight are merged (only the latest matters)
+// and the HTTP connection is kept open between them.
 
 #ifndef __LISTSERVERCONNECTION_H__
 #define __LISTSERVERCONNECTION_H__
@@ -31,39 +36,66 @@ public:
     // d'tor will REMOVE server and close connection
     ~ListServerLink();
 
-    enum MessageType {NONE, ADD, REMOVE} nextMessageType;
-    enum Phase {CONNECTING, WRITTEN} phase;
+    enum MessageType {NONE, ADD, REMOVE};
     TimeKeeper lastAddTime;
 
-    // connection functions
-    bool isConnected();
-    void queueMessage(MessageType type);
-    void sendQueuedMessages();
-    void read();
+    // publish counters, for /lagstats
+    struct Stats {
+      int published;		// requests the list server answered
+      int failed;		// requests that got no answer
+      int merged;		// requests replaced by a later one before going out
+      int connects;		// connections opened
+      float lastLatency;	// seconds from queueing a change to the answer
+      float maxLatency;
+      float totalLatency;	// over all published requests
+    };
 
-//  FIXME - linkSocket shouldn't have to be public.  Write functions to avoid directly accessing the socket.
-    int linkSocket;
+    // hand a message to the list server thread.  doesn't block.
+    void queueMessage(MessageType type);
+    Stats getStats();
+    bool isPublic() const;
 
 private:
-    // list server information
+    // list server information.  the address is looked up on the main
+    // thread and handed over with each message.
     Address address;
     int port;
     std::string hostname;
     std::string pathname;
 
-    // connect/disconnect
-    void openLink();
+    // connect/disconnect (list server thread only)
+    int linkSocket;
+    Address linkAddress;
+    bool isConnected();
+    bool openLink(double deadline);
     void closeLink();
+    bool waitForLink(bool write, double deadline);
+    bool sendRequest(const std::string &request, double deadline);
+    bool readResponse(double deadline, bool &keepAlive);
+    bool publish(const std::string &request, double deadline);
 
     // local server information
     bool publicizeServer;
     std::string publicizeAddress;
     std::string publicizeDescription;
 
-    // messages to send, used by sendQueuedMessages
-    void addMe(PingPacket pingInfo, std::string publicizedAddress, std::string publicizedTitle);
-    void removeMe(std::string publicizedAddress);
-    void sendMessage(std::string message);
+    // messages to send, built on the main thread
+    std::string addMe(PingPacket pingInfo, std::string publicizedAddress, std::string publicizedTitle);
+    std::string removeMe(std::string publicizedAddress);
+
+    // the list server thread and what's shared with it
+    friend class ListServerThread;
+    void run();
+    void sendPending();
+    bool threaded;
+    bool quitting;
+    double quitDeadline;	// give up on the REMOVE at shutdown after this
+    MessageType pendingType;
+    std::string pendingRequest;
+    double pendingSince;	// when the oldest unsent change was queued
+    Address pendingAddress;
+    bool lookupAgain;		// couldn't connect, look the name up again
+    Stats stats;
 };
 
 inline bool ListServerLink::isConnected()
@@ -71,6 +103,11 @@ inline bool ListServerLink::isConnected()
   return (linkSocket != NotConnected);
 }
 
+inline bool ListServerLink::isPublic() const
+{
+  return publicizeServer;
+}
+
 #endif //__LISTSERVERCONNECTION_H__
 
 // Local Variables: ***
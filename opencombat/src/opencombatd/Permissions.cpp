@@ -16,6 +16,7 @@
 
 #include <string>
 #include <fstream>
+#include <stdio.h>
 #include <stdlib.h>
 #include "Permissions.h"
 #include "md5.h"
@@ -25,6 +26,14 @@
 #include "Protocol.h"
 #include "TextUtils.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#define	DATABASE_THREADS
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#define	DATABASE_THREADS
+#endif
+
 PlayerAccessMap	groupAccess;
 PlayerAccessMap	userDatabase;
 PasswordMap	passwordDatabase;
@@ -32,7 +41,8 @@ PasswordMap	passwordDatabase;
 void setUserPassword(const std::string &nick, const std::string &pass);
 
 PlayerAccessInfo::PlayerAccessInfo()
-  : verified(false), loginTime(TimeKeeper::getCurrent()), loginAttempts (0),
+  : effectiveValid(false), verified(false),
+    loginTime(TimeKeeper::getCurrent()), loginAttempts (0),
     Admin(false), passwordAttempts(0)
 {
   groups.push_back("DEFAULT");
@@ -65,10 +75,13 @@ void PlayerAccessInfo::setPermissionRights() {
   explicitAllows = info.explicitAllows;
   explicitDenys = info.explicitDenys;
   groups = info.groups;
+  computeEffectivePerms();
   DEBUG1("Identify %s\n", regName.c_str());
 }
 
 void PlayerAccessInfo::reloadInfo() {
+  // the group rights may have changed even if ours didn't
+  effectiveValid = false;
   if (verified && userExists(regName)) {
     PlayerAccessInfo accessInfo = getUserInfo(regName);
     explicitAllows = accessInfo.explicitAllows;
@@ -121,12 +134,12 @@ void PlayerAccessInfo::storeInfo(const char* pwd) {
   setUserPassword(regName.c_str(), pass.c_str());
   userDatabase[regName] = info;
   DEBUG1("Register %s %s\n", regName.c_str(), pwd);
-  updateDatabases();
+  updateUser(regName);
 }
 
 void PlayerAccessInfo::setPasswd(const std::string&  pwd) {
   setUserPassword(regName.c_str(), pwd.c_str());
-  updateDatabases();
+  updateUser(regName);
 }
 
 uint8_t PlayerAccessInfo::getPlayerProperties() {
@@ -167,6 +180,7 @@ bool PlayerAccessInfo::addGroup(const std::string &group)
   makeupper(str);
 
   groups.push_back(str);
+  effectiveValid = false;
   return true;
 }
 
@@ -182,6 +196,7 @@ bool PlayerAccessInfo::removeGroup(const std::string &group)
   while (itr != groups.end()) {
     if ((*itr) == str) {
       itr = groups.erase(itr);
+      effectiveValid = false;
       return true;
     } else
       itr++;
@@ -198,20 +213,24 @@ bool PlayerAccessInfo::canSet(const std::string& group) {
 bool PlayerAccessInfo::hasPerm(PlayerAccessInfo::AccessPerm right) {
   if (Admin)
     return true;
-  if (explicitDenys.test(right))
-    return false;
-  if (explicitAllows.test(right))
-    return true;
+  if (!effectiveValid)
+    computeEffectivePerms();
+  return effectivePerms.test(right);
+}
+
+void PlayerAccessInfo::computeEffectivePerms() {
+  effectivePerms = explicitAllows;
   std::vector<std::string>::iterator itr = groups.begin();
   PlayerAccessMap::iterator group;
   while (itr != groups.end()) {
     group = groupAccess.find(*itr);
     if (group != groupAccess.end())
-      if (group->second.explicitAllows.test(right))
-	return true;
+      effectivePerms |= group->second.explicitAllows;
     itr++;
   }
-  return false;
+  // a deny beats any allow
+  effectivePerms &= ~explicitDenys;
+  effectiveValid = true;
 }
 
 bool userExists(const std::string &nick)
@@ -342,14 +361,434 @@ void parsePermissionString(const std::string &permissionString, std::bitset<Play
   }
 }
 
-bool readPassFile(const std::string &filename)
+//
+// journals
+//
+// every change to a user is appended to a journal beside the password
+// or user file as it happens, which costs a line of output instead of
+// rewriting the whole file.  now and then the main loop hands a copy of
+// the databases to a thread that rewrites the files and then throws
+// away the part of the journal the copy covers.  on startup (and
+// /reload) the journals are replayed on top of the files.
+//
+// the journal moves to <file>.journal.old while its file is being
+// written, and new changes go to a fresh <file>.journal.  both are
+// replayed, oldest first, so a crash at any point loses nothing.
+//
+
+// rewrite the files after this many changes, or this long after the
+// first change, whichever comes first
+static const int	JournalCompactRecords = 512;
+static const float	JournalCompactTime = 300.0f;
+
+struct Journal {
+  public:
+			Journal() : file(NULL), records(0) { }
+    FILE*		file;
+    int			records;	// since the last rewrite started
+};
+
+static Journal		passJournal;
+static Journal		permsJournal;
+static TimeKeeper	firstJournalRecord;
+
+// the databases as they were when a rewrite started
+struct Compaction {
+  public:
+			Compaction() : passOk(false), permsOk(false),
+					done(false), threaded(false) { }
+    std::string		passFile;	// empty if it isn't being written
+    std::string		permsFile;
+    PasswordMap		passwords;
+    PlayerAccessMap	users;
+    bool		passOk;
+    bool		permsOk;
+    bool		done;
+    bool		threaded;
+};
+
+static Compaction*	compaction = NULL;
+
+#if defined(_WIN32)
+static HANDLE		compactThread;
+static DWORD WINAPI	compactionThread(LPVOID job);
+#elif defined(HAVE_PTHREAD)
+static pthread_t	compactThread;
+static pthread_mutex_t	compactLock = PTHREAD_MUTEX_INITIALIZER;
+static void*		compactionThread(void* job);
+#endif
+
+static std::string	journalName(const std::string &filename)
 {
-  std::ifstream in(filename.c_str());
+  return filename + ".journal";
+}
+
+static std::string	oldJournalName(const std::string &filename)
+{
+  return filename + ".journal.old";
+}
+
+static bool		replaceFile(const std::string &from,
+				    const std::string &to)
+{
+#if defined(_WIN32)
+  // rename won't replace an existing file on windows
+  remove(to.c_str());
+#endif
+  return rename(from.c_str(), to.c_str()) == 0;
+}
+
+// add the contents of one file to the end of another and remove it
+static bool		appendFile(const std::string &from,
+				   const std::string &to)
+{
+  FILE* in = fopen(from.c_str(), "rb");
   if (!in)
+    return true;
+  FILE* out = fopen(to.c_str(), "ab");
+  if (!out) {
+    fclose(in);
+    return false;
+  }
+  char buffer[4096];
+  size_t n;
+  bool ok = true;
+  while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    if (fwrite(buffer, 1, n, out) != n)
+      ok = false;
+  fclose(in);
+  if (fclose(out) != 0)
+    ok = false;
+  if (ok)
+    remove(from.c_str());
+  return ok;
+}
+
+static void		closeJournal(Journal &journal)
+{
+  if (journal.file) {
+    fclose(journal.file);
+    journal.file = NULL;
+  }
+}
+
+static void		countJournalRecord(Journal &journal)
+{
+  if (passJournal.records + permsJournal.records == 0)
+    firstJournalRecord = TimeKeeper::getCurrent();
+  journal.records++;
+}
+
+static void		appendJournal(Journal &journal,
+				      const std::string &filename,
+				      const std::string &record)
+{
+  if (filename.empty())
+    return;
+  if (!journal.file) {
+    journal.file = fopen(journalName(filename).c_str(), "a");
+    if (!journal.file) {
+      DEBUG1("Can't open journal for %s\n", filename.c_str());
+      return;
+    }
+  }
+  fprintf(journal.file, "%s\n", record.c_str());
+  fflush(journal.file);
+  countJournalRecord(journal);
+}
+
+static std::string	permNames(const std::bitset<PlayerAccessInfo::lastPerm> &perms)
+{
+  std::string names;
+  for (int i = 0; i < PlayerAccessInfo::lastPerm; i++)
+    if (perms.test(i)) {
+      names += nameFromPerm((PlayerAccessInfo::AccessPerm) i);
+      names += ' ';
+    }
+  return names;
+}
+
+/* journal records, one per line:
+ *	P name:hash				password set
+ *	U name:allows:denys:groups		user permissions set
+ *	D name					user removed
+ * names are escaped the way the password file escapes them.  the groups
+ * come last since, like in the user file, they are just space separated.
+ */
+bool PlayerAccessInfo::readJournal(const std::string &filename,
+				   bool passwords)
+{
+  Journal &journal = passwords ? passJournal : permsJournal;
+  const std::string names[2] = { oldJournalName(filename),
+				 journalName(filename) };
+  // the journals hold every change since the last rewrite, so count them
+  // afresh rather than on top of what a reload already counted
+  journal.records = 0;
+  bool found = false;
+  for (int i = 0; i < 2; i++) {
+    std::ifstream in(names[i].c_str());
+    if (!in)
+      continue;
+    found = true;
+
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.size() < 3 || line[1] != ' ')
+	continue;
+      const char type = line[0];
+      std::string rest = line.substr(2);
+      int colonpos = unescape_lookup(rest, '\\', ':');
+      std::string name = unescape(colonpos == -1 ? rest :
+				  rest.substr(0, colonpos), '\\');
+      makeupper(name);
+      if (name.empty())
+	continue;
+
+      if (type == 'D') {
+	if (passwords)
+	  passwordDatabase.erase(name);
+	else
+	  userDatabase.erase(name);
+      } else if (colonpos != -1) {
+	rest = rest.substr(colonpos + 1);
+	if (type == 'P' && passwords) {
+	  passwordDatabase[name] = rest;
+	} else if (type == 'U' && !passwords) {
+	  std::string::size_type allowEnd = rest.find(':');
+	  std::string::size_type denyEnd = std::string::npos;
+	  if (allowEnd != std::string::npos)
+	    denyEnd = rest.find(':', allowEnd + 1);
+	  if (denyEnd == std::string::npos)
+	    continue;
+
+	  PlayerAccessInfo info;
+	  info.groups.clear();
+	  std::istringstream groupstream(rest.substr(denyEnd + 1));
+	  std::string group;
+	  while (groupstream >> group)
+	    info.groups.push_back(group);
+	  parsePermissionString(rest.substr(0, allowEnd), info.explicitAllows);
+	  parsePermissionString(rest.substr(allowEnd + 1,
+					    denyEnd - allowEnd - 1),
+				info.explicitDenys);
+	  userDatabase[name] = info;
+	}
+      }
+      // count what we replayed so the next rewrite picks it up
+      countJournalRecord(journal);
+    }
+  }
+  return found;
+}
+
+void PlayerAccessInfo::updateUser(const std::string &nick)
+{
+  std::string name = nick;
+  makeupper(name);
+
+  PasswordMap::iterator pass = passwordDatabase.find(name);
+  if (pass != passwordDatabase.end())
+    appendJournal(passJournal, passFile,
+		  "P " + escape(name, '\\') + ':' + pass->second);
+
+  PlayerAccessMap::iterator user = userDatabase.find(name);
+  if (user != userDatabase.end()) {
+    std::string record = "U " + escape(name, '\\') + ':';
+    record += permNames(user->second.explicitAllows) + ':';
+    record += permNames(user->second.explicitDenys) + ':';
+    std::vector<std::string>::iterator group = user->second.groups.begin();
+    while (group != user->second.groups.end()) {
+      record += (*group) + ' ';
+      group++;
+    }
+    appendJournal(permsJournal, userDatabaseFile, record);
+  }
+}
+
+void PlayerAccessInfo::removeUser(const std::string &nick)
+{
+  std::string name = nick;
+  makeupper(name);
+  const std::string record = "D " + escape(name, '\\');
+  if (passwordDatabase.erase(name) > 0)
+    appendJournal(passJournal, passFile, record);
+  if (userDatabase.erase(name) > 0)
+    appendJournal(permsJournal, userDatabaseFile, record);
+}
+
+static bool		writePasswords(const std::string &filename,
+				       const PasswordMap &passwords)
+{
+  std::ofstream out(filename.c_str());
+  if (!out)
     return false;
+  PasswordMap::const_iterator itr = passwords.begin();
+  while (itr != passwords.end()) {
+    out << escape(itr->first, '\\') << ':' << itr->second << std::endl;
+    itr++;
+  }
+  out.close();
+  return !out.fail();
+}
 
+// runs on the compaction thread (or inline, without threads).  it only
+// touches the copies in the job.
+static void		runCompaction(Compaction* job)
+{
+  if (!job->passFile.empty()) {
+    const std::string temp = job->passFile + ".tmp";
+    job->passOk = writePasswords(temp, job->passwords) &&
+		  replaceFile(temp, job->passFile);
+  }
+  if (!job->permsFile.empty()) {
+    const std::string temp = job->permsFile + ".tmp";
+    job->permsOk = PlayerAccessInfo::writePermsFile(temp, job->users) &&
+		   replaceFile(temp, job->permsFile);
+  }
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+  pthread_mutex_lock(&compactLock);
+#endif
+  job->done = true;
+#if defined(HAVE_PTHREAD) && !defined(_WIN32)
+  pthread_mutex_unlock(&compactLock);
+#endif
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI	compactionThread(LPVOID job)
+{
+  runCompaction((Compaction*)job);
+  return 0;
+}
+#elif defined(HAVE_PTHREAD)
+static void*		compactionThread(void* job)
+{
+  runCompaction((Compaction*)job);
+  return NULL;
+}
+#endif
+
+// move the journal aside for a rewrite.  anything already aside is
+// from a rewrite that failed or a server that died during one;  it's
+// older, so the current journal goes after it.
+static void		rotateJournal(Journal &journal,
+				      const std::string &filename)
+{
+  closeJournal(journal);
+  journal.records = 0;
+  if (!appendFile(journalName(filename), oldJournalName(filename)))
+    DEBUG1("Can't move journal for %s\n", filename.c_str());
+}
+
+// the rewrite is done:  drop the old journal or, if it failed, put the
+// journal back together so the changes are written next time
+static void		finishJournal(Journal &journal,
+				      const std::string &filename, bool ok)
+{
+  if (filename.empty())
+    return;
+  if (ok) {
+    remove(oldJournalName(filename).c_str());
+    return;
+  }
+  DEBUG1("Failed to write %s\n", filename.c_str());
+  closeJournal(journal);
+  if (appendFile(journalName(filename), oldJournalName(filename)))
+    replaceFile(oldJournalName(filename), journalName(filename));
+  // try again, but not straight away
+  countJournalRecord(journal);
+  firstJournalRecord = TimeKeeper::getCurrent();
+}
+
+static void		startCompaction()
+{
+  Compaction* job = new Compaction;
+  if (passJournal.records > 0 && passFile.size()) {
+    job->passFile = passFile;
+    job->passwords = passwordDatabase;
+    rotateJournal(passJournal, passFile);
+  }
+  if (permsJournal.records > 0 && userDatabaseFile.size()) {
+    job->permsFile = userDatabaseFile;
+    job->users = userDatabase;
+    rotateJournal(permsJournal, userDatabaseFile);
+  }
+  compaction = job;
+
+#if defined(_WIN32)
+  DWORD id;
+  compactThread = CreateThread(NULL, 0, compactionThread, job, 0, &id);
+  job->threaded = (compactThread != NULL);
+#elif defined(HAVE_PTHREAD)
+  job->threaded = (pthread_create(&compactThread, NULL,
+				  compactionThread, job) == 0);
+#endif
+  if (job->threaded)
+    return;
+  // no thread, do it here
+  runCompaction(job);
+}
+
+static void		finishCompaction(bool wait)
+{
+  if (!compaction)
+    return;
+
+#if defined(_WIN32)
+  if (compaction->threaded) {
+    if (WaitForSingleObject(compactThread, wait ? INFINITE : 0) !=
+	WAIT_OBJECT_0)
+      return;
+    CloseHandle(compactThread);
+  }
+#elif defined(HAVE_PTHREAD)
+  if (compaction->threaded) {
+    pthread_mutex_lock(&compactLock);
+    const bool done = compaction->done;
+    pthread_mutex_unlock(&compactLock);
+    if (!done && !wait)
+      return;
+    pthread_join(compactThread, NULL);
+  }
+#endif
+
+  finishJournal(passJournal, compaction->passFile, compaction->passOk);
+  finishJournal(permsJournal, compaction->permsFile, compaction->permsOk);
+  delete compaction;
+  compaction = NULL;
+}
+
+void PlayerAccessInfo::compactDatabases()
+{
+  finishCompaction(false);
+  if (compaction)
+    return;
+
+  const int records = passJournal.records + permsJournal.records;
+  if (records == 0)
+    return;
+  if (records >= JournalCompactRecords ||
+      TimeKeeper::getCurrent() - firstJournalRecord >= JournalCompactTime)
+    startCompaction();
+}
+
+void PlayerAccessInfo::updateDatabases()
+{
+  finishCompaction(true);
+  if (passJournal.records + permsJournal.records > 0) {
+    startCompaction();
+    finishCompaction(true);
+  }
+}
+
+bool readPassFile(const std::string &filename)
+{
+  // don't read a file that's still being written
+  finishCompaction(true);
+
+  std::ifstream in(filename.c_str());
   std::string line;
-  while (std::getline(in, line)) {
+  while (in && std::getline(in, line)) {
     // Should look at an unescaped ':'
     int colonpos = unescape_lookup(line, '\\', ':');
     if (colonpos == -1)
@@ -361,22 +800,14 @@ bool readPassFile(const std::string &filename)
       setUserPassword(name.c_str(), pass.c_str());
     }
   }
+  PlayerAccessInfo::readJournal(filename, true);
 
   return (passwordDatabase.size() > 0);
 }
 
 bool writePassFile(const std::string &filename)
 {
-  std::ofstream out(filename.c_str());
-  if (!out)
-    return false;
-  PasswordMap::iterator itr = passwordDatabase.begin();
-  while (itr != passwordDatabase.end()) {
-    out << escape(itr->first, '\\') << ':' << itr->second << std::endl;
-    itr++;
-  }
-  out.close();
-  return true;
+  return writePasswords(filename, passwordDatabase);
 }
 
 bool PlayerAccessInfo::readGroupsFile(const std::string &filename)
@@ -404,17 +835,20 @@ bool PlayerAccessInfo::readGroupsFile(const std::string &filename)
 
 bool PlayerAccessInfo::readPermsFile(const std::string &filename)
 {
+  // don't read a file that's still being written
+  finishCompaction(true);
+
   std::ifstream in(filename.c_str());
-  if (!in)
-    return false;
 
-  for (;;) {
+  while (in) {
     // 1st line - name
     std::string name;
     if (!std::getline(in, name))
       break;
 
     PlayerAccessInfo info;
+    // the file has the whole list, DEFAULT included
+    info.groups.clear();
 
     // 2nd line - groups
     std::string groupline;
@@ -436,18 +870,24 @@ bool PlayerAccessInfo::readPermsFile(const std::string &filename)
     userDatabase[name] = info;
   }
 
-  return true;
+  const bool journal = readJournal(filename, false);
+  return in.is_open() || journal;
 }
 
 bool PlayerAccessInfo::writePermsFile(const std::string &filename)
 {
-  int i;
+  return writePermsFile(filename, userDatabase);
+}
+
+bool PlayerAccessInfo::writePermsFile(const std::string &filename,
+				      const PlayerAccessMap &users)
+{
   std::ofstream out(filename.c_str());
   if (!out)
     return false;
-  PlayerAccessMap::iterator itr = userDatabase.begin();
-  std::vector<std::string>::iterator group;
-  while (itr != userDatabase.end()) {
+  PlayerAccessMap::const_iterator itr = users.begin();
+  std::vector<std::string>::const_iterator group;
+  while (itr != users.end()) {
     out << itr->first << std::endl;
     group = itr->second.groups.begin();
     while (group != itr->second.groups.end()) {
@@ -456,33 +896,19 @@ bool PlayerAccessInfo::writePermsFile(const std::string &filename)
     }
     out << std::endl;
     // allows
-    for (i = 0; i < PlayerAccessInfo::lastPerm; i++)
-      if (itr->second.explicitAllows.test(i))
-	out << nameFromPerm((PlayerAccessInfo::AccessPerm) i);
-    out << std::endl;
+    out << permNames(itr->second.explicitAllows) << std::endl;
     // denys
-    for (i = 0; i < PlayerAccessInfo::lastPerm; i++)
-      if (itr->second.explicitDenys.test(i))
-	out << nameFromPerm((PlayerAccessInfo::AccessPerm) i);
-    out << std::endl;
+    out << permNames(itr->second.explicitDenys) << std::endl;
     itr++;
   }
   out.close();
-  return true;
+  return !out.fail();
 }
 
 std::string		groupsFile;
 std::string		passFile;
 std::string		userDatabaseFile;
 
-void PlayerAccessInfo::updateDatabases()
-{
-  if(passFile.size())
-    writePassFile(passFile);
-  if(userDatabaseFile.size())
-    writePermsFile(userDatabaseFile);
-}
-
 // Local Variables: ***
 // mode:C++ ***
 // tab-width: 8 ***
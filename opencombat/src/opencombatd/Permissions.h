@@ -90,6 +90,9 @@ public:
   bool        removeGroup(const std::string& group);
   bool        canSet(const std::string& group);
 
+  /** True if the player has the right.  The answer comes from a bitset
+      of the player's own and group rights, built at identify time and
+      rebuilt only when the groups change. */
   bool        hasPerm(AccessPerm right);
   bool        isRegistered() const;
   bool        isIdentifyRequired();
@@ -101,11 +104,32 @@ public:
   static bool readGroupsFile(const std::string &filename);
   static bool readPermsFile(const std::string &filename);
   static bool writePermsFile(const std::string &filename);
+  static bool writePermsFile(const std::string &filename,
+			     const std::map<std::string, PlayerAccessInfo> &users);
+  /** Replay the journal kept beside a password (passwords true) or user
+      file.  readPassFile() and readPermsFile() call it after loading. */
+  static bool readJournal(const std::string &filename, bool passwords);
+
+  /** Append the user's password and permissions to the journals.  The
+      full files are rewritten later, in the background. */
+  static void updateUser(const std::string &nick);
+  /** Remove the user from the databases and journal the removal. */
+  static void removeUser(const std::string &nick);
+  /** Call from the main loop.  Starts a background rewrite of the
+      databases once the journals are big or old enough, and cleans up
+      after one that has finished. */
+  static void compactDatabases();
+  /** Rewrite the databases now and wait for it, e.g. at shutdown. */
   static void updateDatabases();
   std::bitset<lastPerm>		explicitAllows;
   std::vector<std::string>	groups;
 private:
+  void				computeEffectivePerms();
+
   std::bitset<lastPerm>		explicitDenys;
+  // explicit and group rights, less the denied ones
+  std::bitset<lastPerm>		effectivePerms;
+  bool				effectiveValid;
   bool				verified;
   TimeKeeper			loginTime;
   int				loginAttempts;
@@ -0,0 +1,201 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/* bzflag special common - 1st one */
+#include "common.h"
+
+// interface header
+#include "WorldCache.h"
+
+// implementation-specific system headers
+#include <stdio.h>
+#include <string.h>
+
+// implementation-specific bzflag headers
+#include "MappedFile.h"
+#include "StateDatabase.h"
+#include "TimeKeeper.h"
+#include "Pack.h"
+#include "md5.h"
+#include "version.h"
+#include "bzfio.h"
+
+// implementation-specific bzfs-specific headers
+#include "BZWReader.h"
+#include "WorldInfo.h"
+
+// change this whenever the layout, or what goes into the tables or
+// the database, changes
+static const uint16_t WorldCacheVersion = 1;
+
+// magic, version, digest, then the sizes of the tables, the server
+// objects and the database, which follow in that order
+static const char WorldCacheMagic[4] = { 'B', 'Z', 'W', 'C' };
+static const int DigestSize = 32;
+static const int HeaderSize = 4 + 2 + DigestSize + 3 * 4;
+
+// the default sizes of the obstacles and the walls
+static const std::string *keyVariables[] = {
+  &StateDatabase::BZDB_BOXBASE,
+  &StateDatabase::BZDB_BOXHEIGHT,
+  &StateDatabase::BZDB_PYRBASE,
+  &StateDatabase::BZDB_PYRHEIGHT,
+  &StateDatabase::BZDB_TELEWIDTH,
+  &StateDatabase::BZDB_TELEBREADTH,
+  &StateDatabase::BZDB_TELEHEIGHT,
+  &StateDatabase::BZDB_WALLHEIGHT,
+  &StateDatabase::BZDB_WORLDSIZE
+};
+
+WorldCache::WorldCache(const std::string& _worldFile,
+		       const std::string& _cacheFile) :
+  worldFile(_worldFile), cacheFile(_cacheFile)
+{
+  // the key has to be made before the world file is read, since the
+  // world section can change the world size
+  MappedFile file;
+  if (!file.open(worldFile))
+    return;
+
+  std::string settings = getProtocolVersion();
+  for (unsigned int i = 0; i < sizeof(keyVariables) / sizeof(keyVariables[0]); i++)
+    settings += " " + *keyVariables[i] + "=" + BZDB.get(*keyVariables[i]);
+
+  MD5 md5;
+  md5.update(settings.c_str(), settings.size());
+  md5.update(file.getData(), file.getSize());
+  md5.finalize();
+  digest = md5.hexdigest();
+}
+
+WorldCache::~WorldCache()
+{
+  // do nothing
+}
+
+WorldInfo *WorldCache::load()
+{
+  if (digest.size() != DigestSize)
+    return NULL;
+
+  TimeKeeper start = TimeKeeper::getCurrent();
+
+  MappedFile file;
+  if (!file.open(cacheFile))
+    return NULL;
+  char *data = const_cast<char*>(file.getData());
+  const size_t size = file.getSize();
+  if (size < (size_t)HeaderSize || memcmp(data, WorldCacheMagic, 4) != 0) {
+    DEBUG1("%s is not a world cache, ignoring it\n", cacheFile.c_str());
+    return NULL;
+  }
+
+  uint16_t version;
+  char fileDigest[DigestSize];
+  uint32_t tablesSize, objectsSize, databaseSize;
+  void *buf = data + 4;
+  buf = nboUnpackUShort(buf, version);
+  buf = nboUnpackString(buf, fileDigest, DigestSize);
+  buf = nboUnpackUInt(buf, tablesSize);
+  buf = nboUnpackUInt(buf, objectsSize);
+  buf = nboUnpackUInt(buf, databaseSize);
+  if (version != WorldCacheVersion ||
+      memcmp(fileDigest, digest.c_str(), DigestSize) != 0) {
+    DEBUG1("world cache %s is out of date\n", cacheFile.c_str());
+    return NULL;
+  }
+  if ((double)HeaderSize + tablesSize + objectsSize + databaseSize != (double)size) {
+    DEBUG1("world cache %s is damaged, ignoring it\n", cacheFile.c_str());
+    return NULL;
+  }
+
+  char *tables = data + HeaderSize;
+  char *objects = tables + tablesSize;
+  char *database = objects + objectsSize;
+
+  WorldInfo *world = new WorldInfo;
+  if (!world->unpackTables(tables, tablesSize)) {
+    DEBUG1("world cache %s is damaged, ignoring it\n", cacheFile.c_str());
+    delete world;
+    return NULL;
+  }
+
+  // the rest are read like any other world file
+  BZWReader reader(cacheFile, std::string(objects, objectsSize));
+  if (!reader.addWorldObjects(world)) {
+    delete world;
+    return NULL;
+  }
+  world->finishWorld();
+  world->setDatabase(database, databaseSize);
+
+  DEBUG1("loaded %s from world cache %s in %.3f seconds\n",
+	 worldFile.c_str(), cacheFile.c_str(),
+	 (float)(TimeKeeper::getCurrent() - start));
+  return world;
+}
+
+bool WorldCache::save(const WorldInfo *world, const std::string& serverObjects)
+{
+  if (digest.size() != DigestSize || world->getDatabase() == NULL)
+    return false;
+
+  char header[HeaderSize];
+  void *buf = header;
+  buf = nboPackString(buf, WorldCacheMagic, 4);
+  buf = nboPackUShort(buf, WorldCacheVersion);
+  buf = nboPackString(buf, digest.c_str(), DigestSize);
+  buf = nboPackUInt(buf, world->packTablesSize());
+  buf = nboPackUInt(buf, serverObjects.size());
+  buf = nboPackUInt(buf, world->getDatabaseSize());
+
+  const int tablesSize = world->packTablesSize();
+  char *tables = new char[tablesSize];
+  world->packTables(tables);
+
+  // write it under another name first so a server that's stopped
+  // part way doesn't leave half a cache behind
+  const std::string tempFile = cacheFile + ".tmp";
+  FILE *file = fopen(tempFile.c_str(), "wb");
+  bool ok = (file != NULL);
+  if (ok) {
+    ok = fwrite(header, HeaderSize, 1, file) == 1 &&
+	 fwrite(tables, tablesSize, 1, file) == 1 &&
+	 (serverObjects.empty() ||
+	  fwrite(serverObjects.data(), serverObjects.size(), 1, file) == 1) &&
+	 fwrite(world->getDatabase(), world->getDatabaseSize(), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+  }
+  delete[] tables;
+
+  if (ok) {
+    // rename() won't replace a file everywhere
+    remove(cacheFile.c_str());
+    ok = (rename(tempFile.c_str(), cacheFile.c_str()) == 0);
+  }
+  if (!ok) {
+    remove(tempFile.c_str());
+    DEBUG1("couldn't write world cache %s\n", cacheFile.c_str());
+    return false;
+  }
+
+  DEBUG1("saved %s to world cache %s\n", worldFile.c_str(), cacheFile.c_str());
+  return true;
+}
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
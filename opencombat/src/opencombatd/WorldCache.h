@@ -0,0 +1,64 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * WorldCache:
+ *	A binary copy of a world file, loaded instead of reading the
+ *	file while the file hasn't changed.
+ *
+ * The cache holds the obstacle tables and the packed world database,
+ * which are nearly all of a big map.  Bases, weapons, zones and the
+ * world section set up more than the world itself (team bases, world
+ * weapons, BZDB) so they're kept as world file text and read again.
+ * The cache is keyed by an MD5 of the world file and the variables the
+ * obstacles get their default sizes from.
+ */
+
+#ifndef __WORLDCACHE_H__
+#define __WORLDCACHE_H__
+
+// system headers
+#include <string>
+
+class WorldInfo;
+
+class WorldCache {
+public:
+  WorldCache(const std::string& worldFile, const std::string& cacheFile);
+  ~WorldCache();
+
+  // the world in the cache, already packed, or NULL if the cache is
+  // missing or doesn't match the world file
+  WorldInfo *load();
+
+  // save a world just read from the world file.  the world has to be
+  // packed;  serverObjects is BZWReader::getServerObjects().
+  bool save(const WorldInfo *world, const std::string& serverObjects);
+
+private:
+  std::string worldFile;
+  std::string cacheFile;
+  std::string digest;
+
+  // no default constructor
+  WorldCache();
+};
+
+#endif
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
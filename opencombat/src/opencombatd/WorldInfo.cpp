@@ -405,6 +405,142 @@ int WorldInfo::getDatabaseSize() const
   return databaseSize;
 }
 
+// counts and world size, then each obstacle:  position, rotation and
+// size, a flag byte and for teleporters the border and both links
+static const int TablesHeaderSize = 4 * 4 + 3 * 4;
+static const int ObstacleSize = 3 * 4 + 4 + 3 * 4 + 1;
+static const int TeleporterExtraSize = 4 + 2 * 4;
+
+static void *packObstacle(void *buf, const ObstacleLocation &obstacle, uint8_t bitMask)
+{
+  if (obstacle.driveThrough)
+    bitMask |= _DRIVE_THRU;
+  if (obstacle.shootThrough)
+    bitMask |= _SHOOT_THRU;
+  buf = nboPackVector(buf, obstacle.pos);
+  buf = nboPackFloat(buf, obstacle.rotation);
+  buf = nboPackVector(buf, obstacle.size);
+  return nboPackUByte(buf, bitMask);
+}
+
+static void *unpackObstacle(void *buf, ObstacleLocation &obstacle, uint8_t &bitMask)
+{
+  buf = nboUnpackVector(buf, obstacle.pos);
+  buf = nboUnpackFloat(buf, obstacle.rotation);
+  buf = nboUnpackVector(buf, obstacle.size);
+  buf = nboUnpackUByte(buf, bitMask);
+  obstacle.driveThrough = (bitMask & _DRIVE_THRU) != 0;
+  obstacle.shootThrough = (bitMask & _SHOOT_THRU) != 0;
+  return buf;
+}
+
+int WorldInfo::packTablesSize() const
+{
+  return TablesHeaderSize +
+    ObstacleSize * (walls.size() + boxes.size() + pyramids.size()) +
+    (ObstacleSize + TeleporterExtraSize) * teleporters.size();
+}
+
+void *WorldInfo::packTables(void *buf) const
+{
+  buf = nboPackUInt(buf, walls.size());
+  buf = nboPackUInt(buf, boxes.size());
+  buf = nboPackUInt(buf, pyramids.size());
+  buf = nboPackUInt(buf, teleporters.size());
+  buf = nboPackFloat(buf, size[0]);
+  buf = nboPackFloat(buf, size[1]);
+  buf = nboPackFloat(buf, gravity);
+
+  unsigned int i;
+  for (i = 0; i < walls.size(); i++)
+    buf = packObstacle(buf, walls[i], 0);
+  for (i = 0; i < boxes.size(); i++)
+    buf = packObstacle(buf, boxes[i], 0);
+  for (i = 0; i < pyramids.size(); i++)
+    buf = packObstacle(buf, pyramids[i], pyramids[i].flipZ ? _FLIP_Z : 0);
+  for (i = 0; i < teleporters.size(); i++) {
+    const Teleporter &tele = teleporters[i];
+    buf = packObstacle(buf, tele, 0);
+    buf = nboPackFloat(buf, tele.border);
+    buf = nboPackInt(buf, tele.to[0]);
+    buf = nboPackInt(buf, tele.to[1]);
+  }
+  return buf;
+}
+
+bool WorldInfo::unpackTables(void *buf, int len)
+{
+  if (len < TablesHeaderSize)
+    return false;
+
+  uint32_t numWalls, numBoxes, numPyramids, numTeleporters;
+  buf = nboUnpackUInt(buf, numWalls);
+  buf = nboUnpackUInt(buf, numBoxes);
+  buf = nboUnpackUInt(buf, numPyramids);
+  buf = nboUnpackUInt(buf, numTeleporters);
+
+  // the counts have to account for exactly what's there
+  const double expected = TablesHeaderSize +
+    (double)ObstacleSize * ((double)numWalls + numBoxes + numPyramids) +
+    (double)(ObstacleSize + TeleporterExtraSize) * numTeleporters;
+  if (expected != (double)len)
+    return false;
+
+  buf = nboUnpackFloat(buf, size[0]);
+  buf = nboUnpackFloat(buf, size[1]);
+  buf = nboUnpackFloat(buf, gravity);
+
+  uint8_t bitMask;
+  unsigned int i;
+  walls.resize(numWalls);
+  for (i = 0; i < numWalls; i++)
+    buf = unpackObstacle(buf, walls[i], bitMask);
+  boxes.resize(numBoxes);
+  for (i = 0; i < numBoxes; i++)
+    buf = unpackObstacle(buf, boxes[i], bitMask);
+  pyramids.resize(numPyramids);
+  for (i = 0; i < numPyramids; i++) {
+    buf = unpackObstacle(buf, pyramids[i], bitMask);
+    pyramids[i].flipZ = (bitMask & _FLIP_Z) != 0;
+  }
+  teleporters.resize(numTeleporters);
+  for (i = 0; i < numTeleporters; i++) {
+    Teleporter &tele = teleporters[i];
+    int32_t to;
+    buf = unpackObstacle(buf, tele, bitMask);
+    buf = nboUnpackFloat(buf, tele.border);
+    buf = nboUnpackInt(buf, to);
+    tele.to[0] = to;
+    buf = nboUnpackInt(buf, to);
+    tele.to[1] = to;
+  }
+
+  // the same height the add functions would have found
+  maxHeight = 0.0f;
+  for (i = 0; i < numWalls; i++)
+    if (walls[i].pos[2] + walls[i].size[2] > maxHeight)
+      maxHeight = walls[i].pos[2] + walls[i].size[2];
+  for (i = 0; i < numBoxes; i++)
+    if (boxes[i].pos[2] + boxes[i].size[2] > maxHeight)
+      maxHeight = boxes[i].pos[2] + boxes[i].size[2];
+  for (i = 0; i < numPyramids; i++)
+    if (pyramids[i].pos[2] + pyramids[i].size[2] > maxHeight)
+      maxHeight = pyramids[i].pos[2] + pyramids[i].size[2];
+  for (i = 0; i < numTeleporters; i++)
+    if (teleporters[i].pos[2] + teleporters[i].size[2] > maxHeight)
+      maxHeight = teleporters[i].pos[2] + teleporters[i].size[2];
+
+  return true;
+}
+
+void WorldInfo::setDatabase(const void *data, int len)
+{
+  delete[] database;
+  database = new char[len];
+  databaseSize = len;
+  memcpy(database, data, len);
+}
+
 // Local Variables: ***
 // mode: C++ ***
 // tab-width: 8 ***
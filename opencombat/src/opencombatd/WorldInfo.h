@@ -93,6 +93,15 @@ public:
   void *getDatabase() const;
   int getDatabaseSize() const;
 
+  /** the world cache keeps the packed database and the obstacle tables
+   * (walls, boxes, pyramids and teleporters with their links).  bases
+   * and zones come back from their objects like everything else.
+   */
+  int packTablesSize() const;
+  void *packTables(void *buf) const;
+  bool unpackTables(void *buf, int len);
+  void setDatabase(const void *data, int len);
+
 private:
 
   bool rectHitCirc(float dx, float dy, const float *p, float r) const;
@@ -37,6 +37,7 @@
 #include "TeamBases.h"
 #include "WorldWeapons.h"
 #include "BZWReader.h"
+#include "WorldCache.h"
 #include "PackVars.h"
 #include "SpawnPosition.h"
 #include "commands.h"
@@ -101,7 +102,7 @@ char hexDigest[50];
 TimeKeeper gameStartTime;
 bool countdownActive = false;
 #endif
-static ListServerLink *listServerLink = NULL;
+ListServerLink *listServerLink = NULL;
 static int listServerLinksCount = 0;
 
 // FIXME: should be static, but needed by SpawnPosition
@@ -1144,18 +1145,31 @@ static bool defineWorld()
     delete[] worldDatabase;
 
   // make world and add buildings
+  WorldCache* cache = NULL;
+  bool cached = false;
+  std::string serverObjects;
   if (clOptions->worldFile != "") {
-    BZWReader* reader = new BZWReader(clOptions->worldFile);
-    world = reader->defineWorldFromFile();
-    delete reader;
+    if (clOptions->worldCacheFile != "") {
+      cache = new WorldCache(clOptions->worldFile, clOptions->worldCacheFile);
+      world = cache->load();
+      cached = (world != NULL);
+    }
+    if (!cached) {
+      BZWReader* reader = new BZWReader(clOptions->worldFile);
+      world = reader->defineWorldFromFile();
+      serverObjects = reader->getServerObjects();
+      delete reader;
+    }
   } else if (clOptions->gameStyle & TeamFlagGameStyle) {
     world = defineTeamWorld();
   } else {
     world = defineRandomWorld();
   }
 
-  if (world == NULL)
+  if (world == NULL) {
+    delete cache;
     return false;
+  }
 
   maxWorldHeight = world->getMaxWorldHeight();
     
@@ -1163,8 +1177,14 @@ static bool defineWorld()
   for (BasesList::iterator it = bases.begin(); it != bases.end(); ++it)
     numBases += it->second.size();
 
-  // package up world
-  world->packDatabase();
+  // package up world.  a cached one comes packed.
+  if (!cached)
+    world->packDatabase();
+  if (cache) {
+    if (!cached)
+      cache->save(world, serverObjects);
+    delete cache;
+  }
   // now get world packaged for network transmission
   worldDatabaseSize = 4 + WorldCodeHeaderSize +
       world->getDatabaseSize() + 4 + WorldCodeEndSize;
@@ -3961,17 +3981,6 @@ int main(int argc, char **argv)
     if (wksSocket > maxFileDescriptor)
       maxFileDescriptor = wksSocket;
 
-    // check for list server socket connected
-    if (listServerLinksCount)
-      if (listServerLink->isConnected()) {
-	if (listServerLink->phase == ListServerLink::CONNECTING)
-	  _FD_SET(listServerLink->linkSocket, &write_set);
-	else
-	  _FD_SET(listServerLink->linkSocket, &read_set);
-	if (listServerLink->linkSocket > maxFileDescriptor)
-	  maxFileDescriptor = listServerLink->linkSocket;
-      }
-
     // find timeout when next flag would hit ground
     TimeKeeper tm = TimeKeeper::getCurrent();
     // lets start by waiting 3 sec
@@ -4433,14 +4442,6 @@ int main(int argc, char **argv)
       if (FD_ISSET(wksSocket, &read_set))
 	acceptClient();
 
-      // check for connection to list server
-      if (listServerLinksCount)
-	if (listServerLink->isConnected())
-	  if (FD_ISSET(listServerLink->linkSocket, &write_set))
-	    listServerLink->sendQueuedMessages();
-	  else if (FD_ISSET(listServerLink->linkSocket, &read_set)) 
-	    listServerLink->read();
-
       // check if we have any UDP packets pending
       if (NetHandler::isUdpFdSet(&read_set)) {
 	TimeKeeper receiveTime = TimeKeeper::getCurrent();
@@ -4567,10 +4568,16 @@ int main(int argc, char **argv)
 
     // Fire world weapons
     wWeapons.fire();
+
+    // write out the user databases if the journals have grown
+    PlayerAccessInfo::compactDatabases();
   }
 
   serverStop();
 
+  // leave the user databases complete, without journals
+  PlayerAccessInfo::updateDatabases();
+
   // free misc stuff
   delete clOptions; clOptions = NULL;
   delete[] flag;  flag = NULL;
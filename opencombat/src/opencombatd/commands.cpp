@@ -48,6 +48,7 @@
 #include "GameKeeper.h"
 #include "PackVars.h"
 #include "FlagInfo.h"
+#include "ListServerConnection.h"
 
 #if defined(_WIN32)
 #define popen _popen
@@ -89,6 +90,9 @@ extern void resetFlag(int flagIndex);
 // externs that countdown requires
 extern bool countdownActive;
 
+// externs that lagstats requires
+extern ListServerLink *listServerLink;
+
 // externs that identify and password requires
 extern void sendIPUpdate(int targetPlayer = -1, int playerIndex = -1);
 
@@ -629,6 +633,19 @@ void handleLagstatsCmd(int t, const char *)
       }
     }
   }
+
+  // and how the list server is keeping up
+  if (listServerLink && listServerLink->isPublic()) {
+    ListServerLink::Stats stats = listServerLink->getStats();
+    snprintf(reply, MessageLen, "List server: %d published (%d merged),"
+	     " %d failed, latency %d ms last, %d ms average, %d ms max",
+	     stats.published, stats.merged, stats.failed,
+	     int(1000.0f * stats.lastLatency),
+	     stats.published ? int(1000.0f * stats.totalLatency /
+				   (float)stats.published) : 0,
+	     int(1000.0f * stats.maxLatency));
+    sendMessage(ServerPlayer, t, reply);
+  }
 }
 
 
@@ -880,13 +897,7 @@ void handleDeregisterCmd(int t, const char *message)
 
   if (strlen(message) == 11) {
     // removing own callsign
-    PasswordMap::iterator itr1
-      = passwordDatabase.find(playerData->accessInfo.getName());
-    PlayerAccessMap::iterator itr2
-      = userDatabase.find(playerData->accessInfo.getName());
-    passwordDatabase.erase(itr1);
-    userDatabase.erase(itr2);
-    PlayerAccessInfo::updateDatabases();
+    PlayerAccessInfo::removeUser(playerData->accessInfo.getName());
     sendMessage(ServerPlayer, t, "Your callsign has been deregistered");
   } else if (strlen(message) > 12
 	     && playerData->accessInfo.hasPerm(PlayerAccessInfo::setAll)) {
@@ -894,11 +905,7 @@ void handleDeregisterCmd(int t, const char *message)
     std::string name = message + 12;
     makeupper(name);
     if (userExists(name)) {
-      PasswordMap::iterator itr1 = passwordDatabase.find(name);
-      PlayerAccessMap::iterator itr2 = userDatabase.find(name);
-      passwordDatabase.erase(itr1);
-      userDatabase.erase(itr2);
-      PlayerAccessInfo::updateDatabases();
+      PlayerAccessInfo::removeUser(name);
       char text[MessageLen];
       sprintf(text, "%s has been deregistered", name.c_str());
       sendMessage(ServerPlayer, t, text);
@@ -1066,7 +1073,7 @@ void handleSetgroupCmd(int t, const char *message)
 	    GameKeeper::Player::getPlayerByIndex(getID)->accessInfo.
 	      addGroup(group);
 	  }
-	  PlayerAccessInfo::updateDatabases();
+	  PlayerAccessInfo::updateUser(settie);
 	} else {
 	  sendMessage(ServerPlayer, t, "Group Add failed (user may already be in that group)");
 	}
@@ -1112,7 +1119,7 @@ void handleRemovegroupCmd(int t, const char *message)
 	    GameKeeper::Player::getPlayerByIndex(getID)->accessInfo.
 	      removeGroup(group);
 	  }
-	  PlayerAccessInfo::updateDatabases();
+	  PlayerAccessInfo::updateUser(settie);
 	} else {
 	  sendMessage(ServerPlayer, t, "Group Remove failed (user may not have been in group)");
 	}
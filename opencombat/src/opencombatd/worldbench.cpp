@@ -0,0 +1,250 @@
+/* bzflag
+ * Copyright (c) 1993 - 2004 Tim Riker
+ *
+ * This package is free software;  you can redistribute it and/or
+ * modify it under the terms of the license found in the file
+ * named COPYING that should have accompanied this file.
+ *
+ * THIS PACKAGE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+/*
+ * worldbench:
+ *	Offline benchmark for the world file reader.  Writes a generated
+ *	map of boxes, pyramids, teleporters, links and a few zones (or
+ *	uses the given world file), loads it on one thread and then on as
+ *	many as the reader picks (or as asked), checks that both give the
+ *	same packed world database and reports the time spent in each phase.
+ *	Then it saves the world to a world cache, loads it back and checks
+ *	that gives the same database too.
+ *
+ *	usage: worldbench [objects | file.bzw] [passes] [threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include "common.h"
+#include "global.h"
+#include "StateDatabase.h"
+#include "TimeKeeper.h"
+#include "BZWReader.h"
+#include "WorldCache.h"
+#include "CmdLineOptions.h"
+#include "TeamBases.h"
+#include "WorldInfo.h"
+#include "WorldWeapons.h"
+
+// what the reader and the objects expect from bzfs
+CmdLineOptions*		clOptions;
+BasesList		bases;
+WorldWeapons		wWeapons;
+int			debugLevel = 0;
+
+static char		msgBuffer[MaxPacketLen];
+char*			getDirectMessageBuffer()
+{
+  return &msgBuffer[2 * sizeof(short)];
+}
+void			broadcastMessage(uint16_t, int, const void*)
+{
+  // nobody to tell
+}
+
+static unsigned int	randState = 1;
+
+static float		nextRand(float lo, float hi)
+{
+  randState = randState * 1103515245 + 12345;
+  return lo + (hi - lo) * (float)((randState >> 16) & 0x7fff) / 32767.0f;
+}
+
+static bool		makeWorld(const char* filename, int objects)
+{
+  FILE* file = fopen(filename, "w");
+  if (file == NULL)
+    return false;
+
+  fprintf(file, "# generated by worldbench\nworld\n  size 2000\nend\n\n");
+  int teleporters = 0;
+  for (int i = 0; i < objects; i++) {
+    const int kind = i % 20;
+    const float x = nextRand(-1900.0f, 1900.0f);
+    const float y = nextRand(-1900.0f, 1900.0f);
+    if (kind < 9) {
+      fprintf(file, "box\n  position %.2f %.2f %.2f\n  rotation %.1f\n"
+	      "  size %.2f %.2f %.2f\nend\n\n", x, y,
+	      kind == 0 ? 10.0f : 0.0f, nextRand(0.0f, 360.0f),
+	      nextRand(2.0f, 30.0f), nextRand(2.0f, 30.0f),
+	      nextRand(2.0f, 20.0f));
+    } else if (kind < 16) {
+      fprintf(file, "pyramid\n  position %.2f %.2f 0\n  size %.2f %.2f %.2f\n"
+	      "%s  rotation %.1f\nend\n\n", x, y, nextRand(2.0f, 30.0f),
+	      nextRand(2.0f, 30.0f), nextRand(2.0f, 20.0f),
+	      kind == 15 ? "  flipz\n" : "", nextRand(0.0f, 360.0f));
+    } else if (kind < 18) {
+      fprintf(file, "teleporter\n  position %.2f %.2f 0\n  rotation %.1f\n"
+	      "  size 0.56 4.48 20.16\n  border 1.12\nend\n\n", x, y,
+	      nextRand(0.0f, 360.0f));
+      teleporters++;
+    } else if (i % 1000 == 18) {
+      // zones are few in real maps, and entry zones don't scale well
+      fprintf(file, "zone\n  position %.2f %.2f 0\n  size 10 10 5\n"
+	      "  flag good\nend\n\n", x, y);
+    } else {
+      fprintf(file, "box\n  position %.2f %.2f 0 # comment\n  size 5 5 5\n"
+	      "  drivethrough\n  shootthrough\nend\n\n", x, y);
+    }
+  }
+  for (int t = 0; t < teleporters; t++)
+    fprintf(file, "link\n  from %d\n  to %d\nend\n\n",
+	    2 * t, 2 * ((t + 1) % teleporters) + 1);
+
+  fclose(file);
+  return true;
+}
+
+static std::string	loadWorld(const char* filename, int threads,
+				  BZWReader::Timings& best, float& total)
+{
+  BZWReader* reader = new BZWReader(filename);
+  reader->setBuildThreads(threads);
+  TimeKeeper start = TimeKeeper::getCurrent();
+  WorldInfo* world = reader->defineWorldFromFile();
+  const float elapsed = TimeKeeper::getCurrent() - start;
+  if (world == NULL) {
+    delete reader;
+    return std::string();
+  }
+
+  const BZWReader::Timings& timings = reader->getTimings();
+  if (total == 0.0f || elapsed + timings.map < total) {
+    total = elapsed + timings.map;
+    best = timings;
+  }
+  delete reader;
+
+  world->packDatabase();
+  std::string database((const char*)world->getDatabase(),
+		       world->getDatabaseSize());
+  delete world;
+  bases.clear();
+  wWeapons.clear();
+  return database;
+}
+
+static std::string	cacheWorld(const char* filename, const char* cacheFile,
+				   float& saveTime, float& loadTime)
+{
+  TimeKeeper start = TimeKeeper::getCurrent();
+  WorldCache* cache = new WorldCache(filename, cacheFile);
+  BZWReader* reader = new BZWReader(filename);
+  WorldInfo* world = reader->defineWorldFromFile();
+  if (world == NULL) {
+    delete reader;
+    delete cache;
+    return std::string();
+  }
+  world->packDatabase();
+  cache->save(world, reader->getServerObjects());
+  saveTime = TimeKeeper::getCurrent() - start;
+  delete reader;
+  delete cache;
+  delete world;
+  bases.clear();
+  wWeapons.clear();
+
+  // and load it back, hashing the world file again as a server would
+  start = TimeKeeper::getCurrent();
+  cache = new WorldCache(filename, cacheFile);
+  world = cache->load();
+  loadTime = TimeKeeper::getCurrent() - start;
+  delete cache;
+  if (world == NULL)
+    return std::string();
+  std::string database((const char*)world->getDatabase(),
+		       world->getDatabaseSize());
+  delete world;
+  bases.clear();
+  wWeapons.clear();
+  return database;
+}
+
+static void		report(const char* name, const BZWReader::Timings& t,
+			       float total)
+{
+  printf("%-10s %6d objects, %d thread%s: map %.3f scan %.3f build %.3f"
+	 " world %.3f, total %.3f s\n", name, t.objects, t.threads,
+	 t.threads == 1 ? " " : "s", t.map, t.scan, t.build, t.world, total);
+}
+
+int			main(int argc, char** argv)
+{
+  const char* generated = "worldbench.bzw";
+  const char* filename = generated;
+  int objects = 200000;
+  if (argc > 1) {
+    if (isdigit(argv[1][0]))
+      objects = atoi(argv[1]);
+    else
+      filename = argv[1];
+  }
+  const int passes = (argc > 2) ? atoi(argv[2]) : 3;
+  const int threads = (argc > 3) ? atoi(argv[3]) : 0;
+
+  for (unsigned int i = 0; i < numGlobalDBItems; i++) {
+    if (globalDBItems[i].value != NULL) {
+      BZDB.set(globalDBItems[i].name, globalDBItems[i].value);
+      BZDB.setDefault(globalDBItems[i].name, globalDBItems[i].value);
+    }
+  }
+  Flags::init();
+  clOptions = new CmdLineOptions();
+
+  if (filename == generated && !makeWorld(generated, objects)) {
+    fprintf(stderr, "can't write %s\n", generated);
+    return 1;
+  }
+
+  BZWReader::Timings single, threaded;
+  float singleTotal = 0.0f, threadedTotal = 0.0f;
+  std::string singleDatabase, threadedDatabase;
+  for (int i = 0; i < passes; i++) {
+    singleDatabase = loadWorld(filename, 1, single, singleTotal);
+    threadedDatabase = loadWorld(filename, threads, threaded, threadedTotal);
+  }
+  float saveTime = 0.0f, loadTime = 0.0f;
+  const char* cacheFile = "worldbench.cache";
+  std::string cachedDatabase = cacheWorld(filename, cacheFile,
+					  saveTime, loadTime);
+  remove(cacheFile);
+  if (filename == generated)
+    remove(generated);
+  if (singleDatabase.empty() || threadedDatabase.empty()) {
+    fprintf(stderr, "world file failed to load\n");
+    return 1;
+  }
+
+  printf("%s, best of %d passes\n", filename, passes);
+  report("1 thread", single, singleTotal);
+  report("threaded", threaded, threadedTotal);
+  printf("world cache: read and save %.3f s, load %.3f s\n",
+	 saveTime, loadTime);
+  const bool match = (singleDatabase == threadedDatabase &&
+		      singleDatabase == cachedDatabase);
+  printf("packed databases %s (%d bytes)\n", match ? "match" : "DIFFER",
+	 (int)singleDatabase.size());
+  return match ? 0 : 1;
+}
+
+// Local Variables: ***
+// mode:C++ ***
+// tab-width: 8 ***
+// c-basic-offset: 2 ***
+// indent-tabs-mode: t ***
+// End: ***
+// ex: shiftwidth=2 tabstop=8
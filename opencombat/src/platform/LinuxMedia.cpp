@@ -23,6 +23,7 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include "bzsignal.h"
+#include "AudioMixer.h"
 #include <sys/soundcard.h>
 #include <sys/ioctl.h>
 #include <TimeKeeper.h>
@@ -398,11 +399,7 @@ void			LinuxMedia::writeAudioFrames16Bit(
   while (numSamples > 0) {
     if (numSamples>audioBufferSize) limit=audioBufferSize;
     else limit=numSamples;
-    for (int j = 0; j < limit; j++) {
-      if (samples[j] < -32767.0) outputBuffer[j] = -32767;
-      else if (samples[j] > 32767.0) outputBuffer[j] = 32767;
-      else outputBuffer[j] = short(samples[j]);
-    }
+    audioConvertToShort(outputBuffer, samples, limit);
 
     // fill out the chunk (we never write a partial chunk)
     if (limit < audioBufferSize) {
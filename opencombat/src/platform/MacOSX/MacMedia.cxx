@@ -1,5 +1,6 @@
 #include <QuickTime/QuickTime.h>
 #include "MacMedia.h"
+#include "AudioMixer.h"
 
 static SndCallBackUPP gCarbonSndCallBackUPP = nil;
 static int queued_chunks = 0;
@@ -120,23 +121,14 @@ void    MacMedia::writeAudioFrames(const float *samples, int numFrames)
   int numSamples = 2 * numFrames;
   while (numSamples > BUFFER_SIZE)
   {
-    for (int j = 0; j < BUFFER_SIZE; j++)
-      if (samples[j] < -32767.0f) buffer[j] = -32767;
-      else if (samples[j] > 32767.0f) buffer[j] = 32767;
-      else buffer[j] = short(samples[j]);
+    audioConvertToShort(buffer, samples, BUFFER_SIZE);
     writeAudio();
     samples += BUFFER_SIZE;
     numSamples -= BUFFER_SIZE;
   }
 
   if (numSamples > 0) {
-    for (int j = 0; j < numSamples; j++)
-      if (samples[j] < -32767.0f)
-	buffer[j] = -32767;
-      else if (samples[j] > 32767.0f)
-	buffer[j] = 32767;
-      else
-	buffer[j] = short(samples[j]);
+    audioConvertToShort(buffer, samples, numSamples);
     writeAudio();
   }
 }
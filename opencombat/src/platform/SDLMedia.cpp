@@ -17,6 +17,7 @@
 #include <stdlib.h>
 #include "SDLMedia.h"
 #include "ErrorHandler.h"
+#include "AudioMixer.h"
 
 #ifdef HALF_RATE_AUDIO
 static const int defaultAudioRate=11025;
@@ -207,15 +208,7 @@ void			SDLMedia::writeAudioFrames(
       limit=audioBufferSize;
     else
       limit=numSamples;
-    for (int j = 0; j < limit; j++) {
-      if (samples[j] < -32767.0)
-	outputBuffer[j] = -32767;
-      else
-	if (samples[j] > 32767.0)
-	  outputBuffer[j] = 32767;
-	else
-	  outputBuffer[j] = short(samples[j]);
-    }
+    audioConvertToShort(outputBuffer, samples, limit);
 
     // fill out the chunk (we never write a partial chunk)
     if (limit < audioBufferSize) {
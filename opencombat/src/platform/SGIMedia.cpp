@@ -22,6 +22,7 @@
 #include <sys/prctl.h>
 #include <sys/wait.h>
 #include "bzsignal.h"
+#include "AudioMixer.h"
 #include <limits.h>
 #include <sys/schedctl.h>
 
@@ -297,20 +298,14 @@ void			SGIMedia::writeAudioFrames(
 {
   int numSamples = 2 * numFrames;
   while (numSamples > audioBufferSize) {
-    for (int j = 0; j < audioBufferSize; j++)
-      if (samples[j] < -32767.0f) outputBuffer[j] = -32767;
-      else if (samples[j] > 32767.0f) outputBuffer[j] = 32767;
-      else outputBuffer[j] = short(samples[j]);
+    audioConvertToShort(outputBuffer, samples, audioBufferSize);
     ALwritesamps(audioPort, outputBuffer, audioBufferSize);
     samples += audioBufferSize;
     numSamples -= audioBufferSize;
   }
 
   if (numSamples > 0) {
-    for (int j = 0; j < numSamples; j++)
-      if (samples[j] < -32767.0f) outputBuffer[j] = -32767;
-      else if (samples[j] > 32767.0f) outputBuffer[j] = 32767;
-      else outputBuffer[j] = short(samples[j]);
+    audioConvertToShort(outputBuffer, samples, numSamples);
     ALwritesamps(audioPort, outputBuffer, numSamples);
   }
 }
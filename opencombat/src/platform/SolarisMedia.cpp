@@ -12,6 +12,7 @@
 
 #include "SolarisMedia.h"
 #include "TimeKeeper.h"
+#include "AudioMixer.h"
 
 #define DEBUG_SOLARIS			0	//(1 = debug, 0 = don't!)
 
@@ -260,11 +261,7 @@ void			SolarisMedia::writeAudioFrames(
   while (numSamples > 0) {
     if (numSamples>512) limit=512;
     else limit=numSamples;
-    for (int j = 0; j < limit; j++) {
-      if (samples[j] < -32767.0) tmp_buf[j] = -32767;
-      else if (samples[j] > 32767.0) tmp_buf[j] = 32767;
-      else tmp_buf[j] = short(samples[j]);
-    }
+    audioConvertToShort(tmp_buf, samples, limit);
 
     // fill out the chunk (we never write a partial chunk)
     if (limit < 512) {
@@ -19,6 +19,7 @@
 #include "WinWindow.h"
 #include "TimeKeeper.h"
 #include "Pack.h"
+#include "AudioMixer.h"
 #include <stdio.h>
 
 static const int	defaultOutputRate = 22050;
@@ -371,11 +372,7 @@ void			WinMedia::writeAudioFrames(
   // but we won't send too many samples so we don't care.
   int numSamples = audioNumChannels * numFrames;
   if (numSamples > audioBufferChunkSize) numSamples = audioBufferChunkSize;
-  for (int j = 0; j < numSamples; j++) {
-    if (samples[j] < -32767.0f) outputBuffer[j] = -32767;
-    else if (samples[j] > 32767.0f) outputBuffer[j] = 32767;
-    else outputBuffer[j] = (short)samples[j];
-  }
+  audioConvertToShort(outputBuffer, samples, numSamples);
 
   // lock enough of the buffer for numFrames, starting at the write
   // pointer.  it's worth noting here that the DirectSound API really
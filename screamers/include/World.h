@@ -30,7 +30,12 @@
 class WorldObject
 {
 public:
-	WorldObject(){};
+	WorldObject()
+	{
+		pos[0] = pos[1] = pos[2] = 0;
+		rot[0] = rot[1] = rot[2] = 0;
+		scale[0] = scale[1] = scale[2] = 1;
+	};
 	virtual ~WorldObject(){};
 
 	std::string type;
@@ -53,6 +58,7 @@ typedef struct
 
 class World
 {
+	friend class WorldCache;
 public:
 			 World ();
 			~World ();
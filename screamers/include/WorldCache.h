@@ -0,0 +1,107 @@
+/*
+ * WorldCache.h - compiled binary worlds
+ *
+ * Copyright (C) 2005 Screamers Group (see AUTHORS)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ *
+ */
+
+#ifndef _WORLD_CACHE_H_
+#define _WORLD_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include "World.h"
+
+/*
+ * A compiled world is a single flat file: a header, a table of interned
+ * strings, and flat arrays of materials, objects, positions, rotations,
+ * scales, attribute pairs and material references.  Everything is 4-byte
+ * aligned and indexed by offset, so the file is memory-mapped and read in
+ * place with no parsing.  XML stays the authoring format; compile-world
+ * turns it into this.
+ */
+class WorldCache
+{
+public:
+	// returns true if the file starts with the compiled world magic
+	static bool	 isCompiled (const char *filename);
+
+	static bool	 write (World &world, const char *filename);
+	static bool	 read (World &world, const char *filename);
+
+	// returns true if both worlds hold the same data
+	static bool	 compare (World &a, World &b);
+
+protected:
+	enum {
+		Magic = 0x57524353,	// "SCRW"
+		Version = 1,
+	};
+
+	typedef struct
+	{
+		unsigned int	magic;
+		unsigned int	version;
+		unsigned int	fileSize;
+		unsigned int	stringCount;
+		unsigned int	stringDataSize;
+		unsigned int	materialCount;
+		unsigned int	objectCount;
+		unsigned int	attributeCount;
+		unsigned int	materialRefCount;
+		unsigned int	name;
+		float		size[2];
+		float		wallHeight;
+	} Header;
+
+	typedef struct
+	{
+		unsigned int	name;
+		unsigned int	image;
+		unsigned int	ogreMat;
+		float		c[4];
+	} Material;
+
+	typedef struct
+	{
+		unsigned int	type;
+		unsigned int	firstAttribute;
+		unsigned int	attributeCount;
+		unsigned int	firstMaterial;
+		unsigned int	materialCount;
+	} Object;
+
+	typedef struct
+	{
+		unsigned int	name;
+		unsigned int	value;
+	} Attribute;
+
+	// builds the interned string table while writing
+	class StringTable
+	{
+	public:
+		unsigned int	 intern (const std::string &s);
+
+		std::vector<unsigned int>		offsets;
+		std::string				data;
+		std::map<std::string, unsigned int>	index;
+	};
+};
+
+#endif //_WORLD_CACHE_H_
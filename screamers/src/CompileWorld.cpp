@@ -0,0 +1,56 @@
+/*
+ * CompileWorld.cpp - compiles XML worlds into the binary format
+ *
+ * Copyright (C) 2005 Screamers Group (see AUTHORS)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ *
+ */
+
+#include <iostream>
+#include "World.h"
+#include "WorldParser.h"
+#include "WorldCache.h"
+
+int main (int argc, char *argv[])
+{
+	if (argc != 3) {
+		std::cerr << "usage: " << argv[0] << " <world.xml> <world.swc>\n";
+		return 1;
+	}
+
+	World world;
+	WorldParser parser (world);
+
+	if (!parser.load (argv[1])) {
+		std::cerr << "could not load " << argv[1] << std::endl;
+		return 1;
+	}
+
+	if (!WorldCache::write (world, argv[2])) {
+		std::cerr << "could not write " << argv[2] << std::endl;
+		return 1;
+	}
+
+	// read it back so a bad compile never makes it into a map rotation
+	World compiled;
+	if (!WorldCache::read (compiled, argv[2]) || !WorldCache::compare (world, compiled)) {
+		std::cerr << "round trip check failed for " << argv[2] << std::endl;
+		remove (argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
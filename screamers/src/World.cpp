@@ -25,6 +25,7 @@ World::World()
 {
 	params.size[0] = 1000;
 	params.size[1] = 1000;
+	params.wallHeight = 0;
 }
 
 World::~World()
@@ -33,7 +34,7 @@ World::~World()
 
 void World::addAttribute (std::string &attribute, std::string &value)
 {
-	std::string name = TextUtils::toupper(attribute);
+	std::string name = TextUtils::tolower(attribute);
 
 	if (name == "size") {
 		std::vector<std::string> l = TextUtils::tokenize (value, std::string (","));
@@ -69,6 +70,7 @@ int World::addMaterial (const char* name)
 
 	mat.name = name;
 	mat.ogreMat = true;
+	mat.c[0] = mat.c[1] = mat.c[2] = mat.c[3] = 1;
 
 	materials.push_back (mat);
 	return (int) materials.size () - 1;
@@ -105,24 +107,76 @@ int World::findMaterialByName (const char* name)
 	return -1;
 }
 
+WorldObject *World::getObject (int object)
+{
+	if (object < 0 || object >= (int) objects.size ())
+		return NULL;
+	return &objects[object];
+}
+
+WorldMaterial *World::getMaterial (int material)
+{
+	if (material < 0 || material >= (int) materials.size ())
+		return NULL;
+	return &materials[material];
+}
+
 void World::setObjectAttribute (int object, std::string &attribute, std::string &value)
 {
+	WorldObject *o = getObject (object);
+	if (o)
+		o->attributes[attribute] = value;
 }
 
 void World::setObjectPos (int object, float p[3])
 {
+	WorldObject *o = getObject (object);
+	if (o) {
+		o->pos[0] = p[0];
+		o->pos[1] = p[1];
+		o->pos[2] = p[2];
+	}
 }
 
 void World::setObjectRot (int object, float r[3])
 {
+	WorldObject *o = getObject (object);
+	if (o) {
+		o->rot[0] = r[0];
+		o->rot[1] = r[1];
+		o->rot[2] = r[2];
+	}
 }
 
 void World::setObjectScale (int object, float s[3])
 {
+	WorldObject *o = getObject (object);
+	if (o) {
+		o->scale[0] = s[0];
+		o->scale[1] = s[1];
+		o->scale[2] = s[2];
+	}
 }
 
 void World::addObjectMaterial (int object, int materialID)
 {
+	WorldObject *o = getObject (object);
+	if (o)
+		o->materials.push_back (materialID);
+}
+
+void World::getObjectIDList (std::vector<int> &objectList)
+{
+	objectList.clear ();
+	for (unsigned int i = 0; i < objects.size (); i++)
+		objectList.push_back (i);
+}
+
+void World::getMaterialIDList (std::vector<int> &materialList)
+{
+	materialList.clear ();
+	for (unsigned int i = 0; i < materials.size (); i++)
+		materialList.push_back (i);
 }
 
 void World::clear (void)
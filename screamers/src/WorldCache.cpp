@@ -0,0 +1,374 @@
+/*
+ * WorldCache.cpp - compiled binary worlds
+ *
+ * Copyright (C) 2005 Screamers Group (see AUTHORS)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "WorldCache.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// a read-only view of a whole file
+typedef struct
+{
+	const char	*data;
+	unsigned int	 size;
+#ifdef _WIN32
+	HANDLE		 file;
+	HANDLE		 mapping;
+#endif
+} MappedFile;
+
+static bool mapFile (const char *filename, MappedFile &map)
+{
+	map.data = NULL;
+	map.size = 0;
+#ifdef _WIN32
+	map.file = CreateFile (filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (map.file == INVALID_HANDLE_VALUE)
+		return false;
+	map.size = GetFileSize (map.file, NULL);
+	map.mapping = CreateFileMapping (map.file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!map.mapping) {
+		CloseHandle (map.file);
+		return false;
+	}
+	map.data = (const char *) MapViewOfFile (map.mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!map.data) {
+		CloseHandle (map.mapping);
+		CloseHandle (map.file);
+		return false;
+	}
+#else
+	int fd = open (filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat (fd, &st) < 0 || st.st_size == 0) {
+		close (fd);
+		return false;
+	}
+	void *data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (data == MAP_FAILED)
+		return false;
+	map.data = (const char *) data;
+	map.size = (unsigned int) st.st_size;
+#endif
+	return true;
+}
+
+static void unmapFile (MappedFile &map)
+{
+	if (!map.data)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile (map.data);
+	CloseHandle (map.mapping);
+	CloseHandle (map.file);
+#else
+	munmap ((void *) map.data, map.size);
+#endif
+	map.data = NULL;
+}
+
+static unsigned int align4 (unsigned int size)
+{
+	return (size + 3) & ~3;
+}
+
+unsigned int WorldCache::StringTable::intern (const std::string &s)
+{
+	std::map<std::string, unsigned int>::iterator i = index.find (s);
+	if (i != index.end ())
+		return i->second;
+
+	unsigned int id = (unsigned int) offsets.size ();
+	offsets.push_back ((unsigned int) data.size ());
+	data.append (s);
+	data.push_back ('\0');
+	index[s] = id;
+	return id;
+}
+
+bool WorldCache::isCompiled (const char *filename)
+{
+	FILE *f = fopen (filename, "rb");
+	if (!f)
+		return false;
+
+	unsigned int magic = 0;
+	bool compiled = fread (&magic, sizeof (magic), 1, f) == 1 && magic == Magic;
+	fclose (f);
+	return compiled;
+}
+
+bool WorldCache::write (World &world, const char *filename)
+{
+	StringTable strings;
+	std::vector<Material> materials;
+	std::vector<Object> objects;
+	std::vector<float> positions, rotations, scales;
+	std::vector<Attribute> attributes;
+	std::vector<int> materialRefs;
+
+	for (unsigned int i = 0; i < world.materials.size (); i++) {
+		WorldMaterial &m = world.materials[i];
+		Material mat;
+
+		mat.name = strings.intern (m.name);
+		mat.image = strings.intern (m.image);
+		mat.ogreMat = m.ogreMat ? 1 : 0;
+		memcpy (mat.c, m.c, sizeof (mat.c));
+		materials.push_back (mat);
+	}
+
+	for (unsigned int i = 0; i < world.objects.size (); i++) {
+		WorldObject &o = world.objects[i];
+		Object obj;
+
+		obj.type = strings.intern (o.type);
+		obj.firstAttribute = (unsigned int) attributes.size ();
+		obj.attributeCount = (unsigned int) o.attributes.size ();
+		obj.firstMaterial = (unsigned int) materialRefs.size ();
+		obj.materialCount = (unsigned int) o.materials.size ();
+		objects.push_back (obj);
+
+		positions.insert (positions.end (), o.pos, o.pos + 3);
+		rotations.insert (rotations.end (), o.rot, o.rot + 3);
+		scales.insert (scales.end (), o.scale, o.scale + 3);
+
+		std::map<std::string,std::string>::iterator a;
+		for (a = o.attributes.begin (); a != o.attributes.end (); a++) {
+			Attribute attr;
+			attr.name = strings.intern (a->first);
+			attr.value = strings.intern (a->second);
+			attributes.push_back (attr);
+		}
+		materialRefs.insert (materialRefs.end (), o.materials.begin (), o.materials.end ());
+	}
+
+	Header header;
+	header.magic = Magic;
+	header.version = Version;
+	header.name = strings.intern (world.params.name);
+	header.size[0] = world.params.size[0];
+	header.size[1] = world.params.size[1];
+	header.wallHeight = world.params.wallHeight;
+	header.stringCount = (unsigned int) strings.offsets.size ();
+	header.stringDataSize = align4 ((unsigned int) strings.data.size ());
+	header.materialCount = (unsigned int) materials.size ();
+	header.objectCount = (unsigned int) objects.size ();
+	header.attributeCount = (unsigned int) attributes.size ();
+	header.materialRefCount = (unsigned int) materialRefs.size ();
+	header.fileSize = sizeof (Header)
+		+ header.stringCount * sizeof (unsigned int)
+		+ header.stringDataSize
+		+ header.materialCount * sizeof (Material)
+		+ header.objectCount * (sizeof (Object) + 9 * sizeof (float))
+		+ header.attributeCount * sizeof (Attribute)
+		+ header.materialRefCount * sizeof (int);
+
+	strings.data.resize (header.stringDataSize, '\0');
+
+	FILE *f = fopen (filename, "wb");
+	if (!f)
+		return false;
+
+	bool ok = fwrite (&header, sizeof (header), 1, f) == 1;
+	if (header.stringCount)
+		ok = ok && fwrite (&strings.offsets[0], sizeof (unsigned int), header.stringCount, f) == header.stringCount;
+	if (header.stringDataSize)
+		ok = ok && fwrite (strings.data.data (), 1, header.stringDataSize, f) == header.stringDataSize;
+	if (header.materialCount)
+		ok = ok && fwrite (&materials[0], sizeof (Material), header.materialCount, f) == header.materialCount;
+	if (header.objectCount) {
+		ok = ok && fwrite (&objects[0], sizeof (Object), header.objectCount, f) == header.objectCount;
+		ok = ok && fwrite (&positions[0], sizeof (float), positions.size (), f) == positions.size ();
+		ok = ok && fwrite (&rotations[0], sizeof (float), rotations.size (), f) == rotations.size ();
+		ok = ok && fwrite (&scales[0], sizeof (float), scales.size (), f) == scales.size ();
+	}
+	if (header.attributeCount)
+		ok = ok && fwrite (&attributes[0], sizeof (Attribute), header.attributeCount, f) == header.attributeCount;
+	if (header.materialRefCount)
+		ok = ok && fwrite (&materialRefs[0], sizeof (int), header.materialRefCount, f) == header.materialRefCount;
+
+	if (fclose (f) != 0)
+		ok = false;
+	if (!ok)
+		remove (filename);
+	return ok;
+}
+
+bool WorldCache::read (World &world, const char *filename)
+{
+	MappedFile map;
+	if (!mapFile (filename, map))
+		return false;
+
+	if (map.size < sizeof (Header)) {
+		unmapFile (map);
+		return false;
+	}
+
+	const Header *header = (const Header *) map.data;
+	if (header->magic != Magic || header->version != Version || header->fileSize != map.size ||
+	    header->stringDataSize == 0 || header->stringCount == 0) {
+		unmapFile (map);
+		return false;
+	}
+
+	// lay out the sections over the mapping, checking each one fits
+	const char *p = map.data + sizeof (Header);
+	const char *end = map.data + map.size;
+	const unsigned int *offsets = (const unsigned int *) p;
+	p += header->stringCount * sizeof (unsigned int);
+	const char *stringData = p;
+	p += header->stringDataSize;
+	const Material *materials = (const Material *) p;
+	p += header->materialCount * sizeof (Material);
+	const Object *objects = (const Object *) p;
+	p += header->objectCount * sizeof (Object);
+	const float *positions = (const float *) p;
+	p += header->objectCount * 3 * sizeof (float);
+	const float *rotations = (const float *) p;
+	p += header->objectCount * 3 * sizeof (float);
+	const float *scales = (const float *) p;
+	p += header->objectCount * 3 * sizeof (float);
+	const Attribute *attributes = (const Attribute *) p;
+	p += header->attributeCount * sizeof (Attribute);
+	const int *materialRefs = (const int *) p;
+	p += header->materialRefCount * sizeof (int);
+
+	if (p != end || stringData[header->stringDataSize - 1] != '\0') {
+		unmapFile (map);
+		return false;
+	}
+
+	// build the string objects once, then share them across every
+	// object and attribute that references them
+	std::vector<std::string> strings (header->stringCount);
+	for (unsigned int i = 0; i < header->stringCount; i++) {
+		if (offsets[i] >= header->stringDataSize) {
+			unmapFile (map);
+			return false;
+		}
+		strings[i] = stringData + offsets[i];
+	}
+
+#define CHECK_STRING(id) if ((id) >= header->stringCount) { world.clear (); unmapFile (map); return false; }
+
+	world.clear ();
+	CHECK_STRING (header->name);
+	world.params.name = strings[header->name];
+	world.params.size[0] = header->size[0];
+	world.params.size[1] = header->size[1];
+	world.params.wallHeight = header->wallHeight;
+
+	world.materials.resize (header->materialCount);
+	for (unsigned int i = 0; i < header->materialCount; i++) {
+		const Material &m = materials[i];
+		WorldMaterial &mat = world.materials[i];
+
+		CHECK_STRING (m.name);
+		CHECK_STRING (m.image);
+		mat.name = strings[m.name];
+		mat.image = strings[m.image];
+		mat.ogreMat = m.ogreMat != 0;
+		memcpy (mat.c, m.c, sizeof (mat.c));
+	}
+
+	world.objects.resize (header->objectCount);
+	for (unsigned int i = 0; i < header->objectCount; i++) {
+		const Object &o = objects[i];
+		WorldObject &obj = world.objects[i];
+
+		CHECK_STRING (o.type);
+		if (o.firstAttribute + o.attributeCount > header->attributeCount ||
+		    o.firstMaterial + o.materialCount > header->materialRefCount) {
+			world.clear ();
+			unmapFile (map);
+			return false;
+		}
+
+		obj.type = strings[o.type];
+		memcpy (obj.pos, positions + i * 3, sizeof (obj.pos));
+		memcpy (obj.rot, rotations + i * 3, sizeof (obj.rot));
+		memcpy (obj.scale, scales + i * 3, sizeof (obj.scale));
+
+		for (unsigned int a = 0; a < o.attributeCount; a++) {
+			const Attribute &attr = attributes[o.firstAttribute + a];
+			CHECK_STRING (attr.name);
+			CHECK_STRING (attr.value);
+			// attributes were written in map order, so hint at the end
+			obj.attributes.insert (obj.attributes.end (),
+				std::make_pair (strings[attr.name], strings[attr.value]));
+		}
+		obj.materials.assign (materialRefs + o.firstMaterial,
+				      materialRefs + o.firstMaterial + o.materialCount);
+	}
+
+#undef CHECK_STRING
+
+	unmapFile (map);
+	return true;
+}
+
+bool WorldCache::compare (World &a, World &b)
+{
+	if (a.params.name != b.params.name ||
+	    a.params.size[0] != b.params.size[0] ||
+	    a.params.size[1] != b.params.size[1] ||
+	    a.params.wallHeight != b.params.wallHeight)
+		return false;
+
+	if (a.materials.size () != b.materials.size () ||
+	    a.objects.size () != b.objects.size ())
+		return false;
+
+	for (unsigned int i = 0; i < a.materials.size (); i++) {
+		WorldMaterial &ma = a.materials[i];
+		WorldMaterial &mb = b.materials[i];
+		if (ma.name != mb.name || ma.image != mb.image || ma.ogreMat != mb.ogreMat ||
+		    memcmp (ma.c, mb.c, sizeof (ma.c)) != 0)
+			return false;
+	}
+
+	for (unsigned int i = 0; i < a.objects.size (); i++) {
+		WorldObject &oa = a.objects[i];
+		WorldObject &ob = b.objects[i];
+		if (oa.type != ob.type ||
+		    memcmp (oa.pos, ob.pos, sizeof (oa.pos)) != 0 ||
+		    memcmp (oa.rot, ob.rot, sizeof (oa.rot)) != 0 ||
+		    memcmp (oa.scale, ob.scale, sizeof (oa.scale)) != 0 ||
+		    oa.attributes != ob.attributes ||
+		    oa.materials != ob.materials)
+			return false;
+	}
+	return true;
+}
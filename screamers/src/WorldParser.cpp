@@ -22,6 +22,7 @@
 #include <vector>
 #include "tinyxml.h"
 #include "WorldParser.h"
+#include "WorldCache.h"
 #include "TextUtils.h"
 
 typedef struct
@@ -40,6 +41,10 @@ WorldParser::~WorldParser ()
 
 bool WorldParser::load (const char* mapFile)
 {
+	// worlds run through compile-world are mapped straight in
+	if (WorldCache::isCompiled (mapFile))
+		return WorldCache::read (world, mapFile);
+
 	TiXmlDocument doc (mapFile);
 
 	if (!doc.LoadFile ())
@@ -0,0 +1,241 @@
+//-----------------------------------------------------------------------------------
+//
+//   Torque Network Library
+//   Copyright (C) 2004 GarageGames.com, Inc.
+//   For more information see http://www.opentnl.org
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation; either version 2 of the License, or
+//   (at your option) any later version.
+//
+//   For use in products that are not compatible with the terms of the GNU 
+//   General Public License, alternative licensing options are available 
+//   from GarageGames.com.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program; if not, write to the Free Software
+//   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//------------------------------------------------------------------------------------
+
+#include "tnl.h"
+#include "tnlConnectionTable.h"
+#include "tnlNetConnection.h"
+#include "tnlRandom.h"
+
+namespace TNL {
+
+/// Marker for a slot whose connection was removed.  Probes continue past it.
+static NetConnection * const Tombstone = (NetConnection *) 1;
+
+ConnectionTable::ConnectionTable()
+{
+   mHashSeed = Random::readI();
+   mMigrateIndex = 0;
+   mOldCount = 0;
+   mCount = 0;
+   mTombstones = 0;
+   mTable.setSize(InitialSize);
+   for(S32 i = 0; i < mTable.size(); i++)
+      mTable[i].conn = NULL;
+}
+
+U32 ConnectionTable::hashAddress(const Address &address) const
+{
+   // Address::hash() leaves most of its entropy in the low bits of the
+   // IP and port; mix it so every bit of the table index depends on it.
+   U32 h = address.hash() ^ mHashSeed;
+   h ^= h >> 16;
+   h *= 0x85ebca6b;
+   h ^= h >> 13;
+   h *= 0xc2b2ae35;
+   h ^= h >> 16;
+   return h;
+}
+
+S32 ConnectionTable::findSlot(Vector<Entry> &table, const Address &address, U32 hash)
+{
+   U32 mask = table.size() - 1;
+   for(U32 index = hash & mask; table[index].conn != NULL; index = (index + 1) & mask)
+   {
+      Entry &e = table[index];
+      if(e.conn != Tombstone && e.hash == hash && e.conn->getNetAddress() == address)
+         return index;
+   }
+   return -1;
+}
+
+S32 ConnectionTable::findSlot(Vector<Entry> &table, NetConnection *conn, U32 hash)
+{
+   U32 mask = table.size() - 1;
+   for(U32 index = hash & mask; table[index].conn != NULL; index = (index + 1) & mask)
+      if(table[index].conn == conn)
+         return index;
+   return -1;
+}
+
+void ConnectionTable::place(NetConnection *conn, U32 hash, S32 index)
+{
+   U32 mask = mTable.size() - 1;
+   U32 slot = hash & mask;
+   while(mTable[slot].conn != NULL && mTable[slot].conn != Tombstone)
+      slot = (slot + 1) & mask;
+
+   if(mTable[slot].conn == Tombstone)
+      mTombstones--;
+   mTable[slot].conn = conn;
+   mTable[slot].hash = hash;
+   mTable[slot].index = index;
+   mCount++;
+}
+
+void ConnectionTable::migrate(U32 count)
+{
+   while(count-- && mMigrateIndex < U32(mOldTable.size()))
+   {
+      Entry &e = mOldTable[mMigrateIndex++];
+      if(e.conn != NULL && e.conn != Tombstone)
+      {
+         place(e.conn, e.hash, e.index);
+         mOldCount--;
+      }
+      // leave a tombstone behind so lookups in the old table keep probing
+      // past slots that have already moved.
+      if(e.conn != NULL)
+         e.conn = Tombstone;
+   }
+   if(!mOldCount)
+   {
+      mOldTable.clear();
+      mMigrateIndex = 0;
+   }
+}
+
+void ConnectionTable::checkLoad()
+{
+   U32 used = mCount + mTombstones;
+   if(used * 100 < U32(mTable.size()) * MaxLoadPercent)
+      return;
+
+   // finish any resize still in progress before starting another.
+   if(mOldCount)
+      migrate(mOldTable.size());
+
+   // grow if the table is mostly live entries, otherwise the same size
+   // is enough to clear out the tombstones.
+   U32 newSize = mTable.size();
+   if(mCount * 4 >= newSize)
+      newSize <<= 1;
+
+   mOldTable = mTable;
+   mOldCount = mCount;
+   mMigrateIndex = 0;
+
+   mTable.setSize(newSize);
+   for(S32 i = 0; i < mTable.size(); i++)
+      mTable[i].conn = NULL;
+   mCount = 0;
+   mTombstones = 0;
+
+   if(!mOldCount)
+   {
+      mOldTable.clear();
+   }
+}
+
+NetConnection *ConnectionTable::find(const Address &address)
+{
+   U32 hash = hashAddress(address);
+   S32 index = findSlot(mTable, address, hash);
+   if(index != -1)
+      return mTable[index].conn;
+
+   if(mOldCount)
+   {
+      index = findSlot(mOldTable, address, hash);
+      if(index != -1)
+         return mOldTable[index].conn;
+   }
+   return NULL;
+}
+
+void ConnectionTable::insert(NetConnection *conn, S32 index)
+{
+   if(mOldCount)
+      migrate(MigrateStep);
+   checkLoad();
+   place(conn, hashAddress(conn->getNetAddress()), index);
+}
+
+bool ConnectionTable::remove(NetConnection *conn, S32 *index)
+{
+   if(mOldCount)
+      migrate(MigrateStep);
+
+   U32 hash = hashAddress(conn->getNetAddress());
+   S32 slot = findSlot(mTable, conn, hash);
+   if(slot != -1)
+   {
+      if(index)
+         *index = mTable[slot].index;
+      mTable[slot].conn = Tombstone;
+      mCount--;
+      mTombstones++;
+      return true;
+   }
+   if(mOldCount)
+   {
+      slot = findSlot(mOldTable, conn, hash);
+      if(slot != -1)
+      {
+         if(index)
+            *index = mOldTable[slot].index;
+         mOldTable[slot].conn = Tombstone;
+         mOldCount--;
+         if(!mOldCount)
+            migrate(0);
+         return true;
+      }
+   }
+   return false;
+}
+
+bool ConnectionTable::setIndex(NetConnection *conn, S32 index)
+{
+   U32 hash = hashAddress(conn->getNetAddress());
+   S32 slot = findSlot(mTable, conn, hash);
+   if(slot != -1)
+   {
+      mTable[slot].index = index;
+      return true;
+   }
+   if(mOldCount)
+   {
+      slot = findSlot(mOldTable, conn, hash);
+      if(slot != -1)
+      {
+         mOldTable[slot].index = index;
+         return true;
+      }
+   }
+   return false;
+}
+
+void ConnectionTable::clear()
+{
+   mOldTable.clear();
+   mMigrateIndex = 0;
+   mOldCount = 0;
+   mCount = 0;
+   mTombstones = 0;
+   for(S32 i = 0; i < mTable.size(); i++)
+      mTable[i].conn = NULL;
+}
+
+};
@@ -0,0 +1,441 @@
+/*
+ * connectionTableBench.cpp - offline benchmark for the connection tables
+ *
+ * Copyright (C) 2005 Screamers Group (see AUTHORS)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ *
+ */
+
+// Replays a scripted flood of connection handshakes against the pending
+// list scan and linear probed hash table NetInterface used to have, and
+// against the ConnectionTable based bookkeeping that replaced them.  Every
+// lookup in the script has a known answer, so both are checked as they
+// run; the report is the number of table operations per second each one
+// manages.
+//
+// usage: connectionbench [handshakes] [max pending]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "tnl.h"
+#include "tnlNetConnection.h"
+#include "tnlConnectionTable.h"
+
+using namespace TNL;
+
+/// The connection bookkeeping NetInterface does on every packet.
+class Tables
+{
+public:
+   virtual ~Tables() { }
+   virtual void addPendingConnection(NetConnection *conn) = 0;
+   virtual void removePendingConnection(NetConnection *conn) = 0;
+   virtual NetConnection *findPendingConnection(const Address &address) = 0;
+   virtual void addConnection(NetConnection *conn) = 0;
+   virtual void removeConnection(NetConnection *conn) = 0;
+   virtual NetConnection *findConnection(const Address &address) = 0;
+};
+
+/// The pending list scan and connection hash table NetInterface used to
+/// have, kept as they were apart from reference counting.
+class ReferenceTables : public Tables
+{
+   Vector<NetConnection *> mPendingConnections;
+   Vector<NetConnection *> mConnectionList;
+   Vector<NetConnection *> mConnectionHashTable;
+public:
+   ReferenceTables()
+   {
+      mConnectionHashTable.setSize(129);
+      for(S32 i = 0; i < mConnectionHashTable.size(); i++)
+         mConnectionHashTable[i] = NULL;
+   }
+
+   void addPendingConnection(NetConnection *connection)
+   {
+      mPendingConnections.push_back(connection);
+   }
+
+   void removePendingConnection(NetConnection *connection)
+   {
+      for(S32 i = 0; i < mPendingConnections.size(); i++)
+         if(mPendingConnections[i] == connection)
+         {
+            mPendingConnections.erase(i);
+            return;
+         }
+   }
+
+   NetConnection *findPendingConnection(const Address &address)
+   {
+      for(S32 i = 0; i < mPendingConnections.size(); i++)
+         if(address == mPendingConnections[i]->getNetAddress())
+            return mPendingConnections[i];
+      return NULL;
+   }
+
+   NetConnection *findConnection(const Address &addr)
+   {
+      U32 hashIndex = addr.hash() % mConnectionHashTable.size();
+      while(mConnectionHashTable[hashIndex] != NULL)
+      {
+         if(addr == mConnectionHashTable[hashIndex]->getNetAddress())
+            return mConnectionHashTable[hashIndex];
+         hashIndex++;
+         if(hashIndex >= (U32) mConnectionHashTable.size())
+            hashIndex = 0;
+      }
+      return NULL;
+   }
+
+   void removeConnection(NetConnection *conn)
+   {
+      for(S32 i = 0; i < mConnectionList.size(); i++)
+      {
+         if(mConnectionList[i] == conn)
+         {
+            mConnectionList.erase_fast(i);
+            break;
+         }
+      }
+      U32 index = conn->getNetAddress().hash() % mConnectionHashTable.size();
+      U32 startIndex = index;
+
+      while(mConnectionHashTable[index] != conn)
+      {
+         index++;
+         if(index >= (U32) mConnectionHashTable.size())
+            index = 0;
+         if(index == startIndex)
+            return;
+      }
+      mConnectionHashTable[index] = NULL;
+
+      for(;;)
+      {
+         index++;
+         if(index >= (U32) mConnectionHashTable.size())
+            index = 0;
+         if(!mConnectionHashTable[index])
+            break;
+         NetConnection *rehashConn = mConnectionHashTable[index];
+         mConnectionHashTable[index] = NULL;
+         U32 realIndex = rehashConn->getNetAddress().hash() % mConnectionHashTable.size();
+         while(mConnectionHashTable[realIndex] != NULL)
+         {
+            realIndex++;
+            if(realIndex >= (U32) mConnectionHashTable.size())
+               realIndex = 0;
+         }
+         mConnectionHashTable[realIndex] = rehashConn;
+      }
+   }
+
+   void addConnection(NetConnection *conn)
+   {
+      mConnectionList.push_back(conn);
+      S32 numConnections = mConnectionList.size();
+      if(numConnections > mConnectionHashTable.size() / 2)
+      {
+         mConnectionHashTable.setSize(numConnections * 4 - 1);
+         for(S32 i = 0; i < mConnectionHashTable.size(); i++)
+            mConnectionHashTable[i] = NULL;
+         for(S32 i = 0; i < numConnections; i++)
+         {
+            U32 index = mConnectionList[i]->getNetAddress().hash() % mConnectionHashTable.size();
+            while(mConnectionHashTable[index] != NULL)
+            {
+               index++;
+               if(index >= (U32) mConnectionHashTable.size())
+                  index = 0;
+            }
+            mConnectionHashTable[index] = mConnectionList[i];
+         }
+      }
+      else
+      {
+         U32 index = mConnectionList[numConnections - 1]->getNetAddress().hash() % mConnectionHashTable.size();
+         while(mConnectionHashTable[index] != NULL)
+         {
+            index++;
+            if(index >= (U32) mConnectionHashTable.size())
+               index = 0;
+         }
+         mConnectionHashTable[index] = mConnectionList[numConnections - 1];
+      }
+   }
+};
+
+/// The same bookkeeping as NetInterface does it now.
+class HashedTables : public Tables
+{
+   Vector<NetConnection *> mPendingConnections;
+   Vector<NetConnection *> mConnectionList;
+   ConnectionTable mPendingConnectionTable;
+   ConnectionTable mConnectionTable;
+public:
+   void addPendingConnection(NetConnection *connection)
+   {
+      mPendingConnectionTable.insert(connection, mPendingConnections.size());
+      mPendingConnections.push_back(connection);
+   }
+
+   void removePendingConnection(NetConnection *connection)
+   {
+      S32 index;
+      if(!mPendingConnectionTable.remove(connection, &index))
+         return;
+
+      mPendingConnections.erase_fast(index);
+      if(index < mPendingConnections.size())
+         mPendingConnectionTable.setIndex(mPendingConnections[index], index);
+   }
+
+   NetConnection *findPendingConnection(const Address &address)
+   {
+      return mPendingConnectionTable.find(address);
+   }
+
+   NetConnection *findConnection(const Address &addr)
+   {
+      return mConnectionTable.find(addr);
+   }
+
+   void removeConnection(NetConnection *conn)
+   {
+      S32 index;
+      if(!mConnectionTable.remove(conn, &index))
+         return;
+
+      mConnectionList.erase_fast(index);
+      if(index < mConnectionList.size())
+         mConnectionTable.setIndex(mConnectionList[index], index);
+   }
+
+   void addConnection(NetConnection *conn)
+   {
+      mConnectionTable.insert(conn, mConnectionList.size());
+      mConnectionList.push_back(conn);
+   }
+};
+
+enum OpType {
+   FindPending,
+   AddPending,
+   RemovePending,
+   FindConnection,
+   AddConnection,
+   RemoveConnection,
+};
+
+/// One step of the script.  For the find operations, address is an index
+/// into addresses and expect the index of the connection that should be
+/// found, or -1.  For the others, conn is an index into connections.
+struct Op
+{
+   U8 type;
+   S32 conn;
+   S32 address;
+   S32 expect;
+};
+
+static Vector<Op> script;
+static Vector<Address> addresses;
+static Vector<NetConnection *> connections;
+static U32 randState = 1;
+
+static U32 nextRand()
+{
+   randState = randState * 1103515245 + 12345;
+   return (randState >> 16) & 0x7fff;
+}
+
+static Address makeAddress(U32 host, U16 port)
+{
+   Address address(IPProtocol, Address::Any, port);
+   address.netNum[0] = host;
+   address.netNum[1] = 0;
+   address.netNum[2] = 0;
+   address.netNum[3] = 0;
+   return address;
+}
+
+static void addOp(OpType type, S32 conn, S32 address = -1, S32 expect = -1)
+{
+   Op op;
+   op.type = type;
+   op.conn = conn;
+   op.address = address;
+   op.expect = expect;
+   script.push_back(op);
+}
+
+static S32 pickAndMaybeRemove(Vector<S32> &list, bool remove)
+{
+   S32 i = nextRand() % list.size();
+   S32 conn = list[i];
+   if(remove)
+      list.erase_fast(i);
+   return conn;
+}
+
+/// Scripts a flood of handshakes, most from a handful of subnets the way a
+/// busy server sees them, with stray packets from unknown hosts mixed in.
+/// Handshakes either complete and become connections that later drop, or
+/// time out while pending.
+static void makeScript(S32 handshakes, S32 maxPending)
+{
+   S32 i;
+   for(i = 0; i < handshakes; i++)
+   {
+      addresses.push_back(makeAddress(0x0a000000 + (i >> 3), U16(28000 + (i & 7))));
+      NetConnection *conn = new NetConnection;
+      conn->setNetAddress(addresses[i]);
+      connections.push_back(conn);
+   }
+   const S32 strays = 256;
+   for(i = 0; i < strays; i++)
+      addresses.push_back(makeAddress(0x0b000000 + nextRand(), U16(nextRand())));
+
+   Vector<S32> pending;
+   Vector<S32> established;
+   S32 started = 0;
+   while(started < handshakes || pending.size())
+   {
+      U32 roll = nextRand() % 8;
+      if(roll < 3 && started < handshakes && pending.size() < maxPending)
+      {
+         // a new client says hello
+         addOp(FindConnection, -1, started, -1);
+         addOp(FindPending, -1, started, -1);
+         addOp(AddPending, started);
+         pending.push_back(started++);
+      }
+      else if(roll < 5 && pending.size())
+      {
+         // the next handshake packet from a pending client
+         S32 conn = pickAndMaybeRemove(pending, false);
+         addOp(FindConnection, -1, conn, -1);
+         addOp(FindPending, -1, conn, conn);
+
+         U32 outcome = nextRand() % 8;
+         if(outcome < 4)
+         {
+            addOp(RemovePending, conn);
+            addOp(AddConnection, conn);
+            established.push_back(conn);
+         }
+         else if(outcome == 4)
+            addOp(RemovePending, conn);
+         else
+            continue;
+         for(i = 0; i < pending.size(); i++)
+            if(pending[i] == conn)
+            {
+               pending.erase_fast(i);
+               break;
+            }
+      }
+      else if(roll == 5)
+      {
+         // a stray packet from a host nobody knows
+         S32 address = handshakes + nextRand() % strays;
+         addOp(FindConnection, -1, address, -1);
+         addOp(FindPending, -1, address, -1);
+      }
+      else if(established.size())
+      {
+         // game traffic, and now and then a client leaving
+         bool leaving = nextRand() % 32 == 0;
+         S32 conn = pickAndMaybeRemove(established, leaving);
+         addOp(FindConnection, -1, conn, conn);
+         if(leaving)
+            addOp(RemoveConnection, conn);
+      }
+   }
+}
+
+static bool runScript(Tables &tables, F64 &seconds)
+{
+   S64 start = Platform::getHighPrecisionTimerValue();
+   for(S32 i = 0; i < script.size(); i++)
+   {
+      const Op &op = script[i];
+      NetConnection *found = NULL;
+      switch(op.type)
+      {
+         case FindPending:
+            found = tables.findPendingConnection(addresses[op.address]);
+            break;
+         case FindConnection:
+            found = tables.findConnection(addresses[op.address]);
+            break;
+         case AddPending:
+            tables.addPendingConnection(connections[op.conn]);
+            continue;
+         case RemovePending:
+            tables.removePendingConnection(connections[op.conn]);
+            continue;
+         case AddConnection:
+            tables.addConnection(connections[op.conn]);
+            continue;
+         case RemoveConnection:
+            tables.removeConnection(connections[op.conn]);
+            continue;
+      }
+      NetConnection *expect = op.expect == -1 ? NULL : connections[op.expect];
+      if(found != expect)
+      {
+         printf("step %d: lookup of %s went wrong\n", i, addresses[op.address].toString());
+         return false;
+      }
+   }
+   S64 delta = Platform::getHighPrecisionTimerValue() - start;
+   seconds = Platform::getHighPrecisionMilliseconds(delta) / 1000.0;
+   return true;
+}
+
+int main(int argc, char **argv)
+{
+   const S32 handshakes = argc > 1 ? atoi(argv[1]) : 10000;
+   const S32 maxPending = argc > 2 ? atoi(argv[2]) : 1000;
+   if(handshakes <= 0 || maxPending <= 0)
+   {
+      fprintf(stderr, "usage: %s [handshakes] [max pending]\n", argv[0]);
+      return 1;
+   }
+
+   makeScript(handshakes, maxPending);
+   printf("%d handshakes, at most %d pending, %d table operations\n",
+          handshakes, maxPending, script.size());
+
+   F64 oldTime, newTime;
+   ReferenceTables reference;
+   HashedTables hashed;
+   if(!runScript(reference, oldTime) || !runScript(hashed, newTime))
+   {
+      printf("FAILED: lookups disagree with the script\n");
+      return 1;
+   }
+
+   const F64 count = script.size();
+   printf("old %.3fs (%.0f ops/s)  new %.3fs (%.0f ops/s)  %.2fx\n",
+          oldTime, count / oldTime, newTime, count / newTime, oldTime / newTime);
+
+   for(S32 i = 0; i < connections.size(); i++)
+      delete connections[i];
+   return 0;
+}
@@ -239,6 +239,10 @@ void EventConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
 
    EventNote *packQueueHead = NULL, *packQueueTail = NULL;
 
+   // stay within our share of the packet if ghost updates are waiting too,
+   // but always send at least one event so a large one can't be starved.
+   U32 trafficLimit = getTrafficLimit(bstream, TrafficEvents);
+
    while(mUnorderedSendEventQueueHead)
    {
       if(bstream->isFull())
@@ -261,7 +265,8 @@ void EventConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
       if(mConnectionParameters.mDebugObjectSizes)
          bstream->writeIntAt(bstream->getBitPosition(), BitStreamPosBitSize, start);
 
-      if(bstream->getBitSpaceAvailable() < MinimumPaddingBits)
+      if(bstream->getBitSpaceAvailable() < MinimumPaddingBits ||
+            (packQueueHead && bstream->getBitPosition() > trafficLimit))
       {
          // rewind to before the event, and break out of the loop:
          bstream->setBitPosition(start - 1);
@@ -317,7 +322,8 @@ void EventConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
       if(mConnectionParameters.mDebugObjectSizes)
          bstream->writeIntAt(bstream->getBitPosition(), BitStreamPosBitSize, start - BitStreamPosBitSize);
 
-      if(bstream->getBitSpaceAvailable() < MinimumPaddingBits)
+      if(bstream->getBitSpaceAvailable() < MinimumPaddingBits ||
+            (packQueueHead && bstream->getBitPosition() > trafficLimit))
       {
          // rewind to before the event, and break out of the loop:
          bstream->setBitPosition(eventStart);
@@ -491,4 +497,11 @@ bool EventConnection::isDataToTransmit()
    return mUnorderedSendEventQueueHead || mSendEventQueueHead || Parent::isDataToTransmit();
 }
 
+bool EventConnection::isTrafficPending(TrafficClass trafficClass)
+{
+   if(trafficClass == TrafficEvents)
+      return mUnorderedSendEventQueueHead || mSendEventQueueHead;
+   return Parent::isTrafficPending(trafficClass);
+}
+
 };
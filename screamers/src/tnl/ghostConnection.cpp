@@ -235,6 +235,13 @@ bool GhostConnection::isDataToTransmit()
    return Parent::isDataToTransmit() || mGhostZeroUpdateIndex != 0;
 }
 
+bool GhostConnection::isTrafficPending(TrafficClass trafficClass)
+{
+   if(trafficClass == TrafficGhosts)
+      return doesGhostFrom() && mGhosting && mScopeObject.isValid() && mGhostZeroUpdateIndex != 0;
+   return Parent::isTrafficPending(trafficClass);
+}
+
 void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
 {
    Parent::writePacket(bstream, pnotify);
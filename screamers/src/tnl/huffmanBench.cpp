@@ -0,0 +1,394 @@
+/*
+ * huffmanBench.cpp - offline benchmark for the Huffman string coder
+ *
+ * Copyright (C) 2005 Screamers Group (see AUTHORS)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ *
+ */
+
+// Codes a canned set of chat-like strings, first with the bit-at-a-time
+// coder HuffmanStringProcessor used to have and then with the table-driven
+// one, checks that both produce the same bitstream and decode it back to
+// the original text, and reports how many strings per second each manages.
+//
+// usage: huffmanbench [passes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tnlBitStream.h"
+#include "tnlVector.h"
+#include "tnlHuffmanStringProcessor.h"
+
+using namespace TNL;
+
+namespace TNL {
+namespace HuffmanStringProcessor {
+   extern const U32 mCharFreqs[256];
+};
+};
+
+// The previous coder, kept verbatim apart from the namespace so that the
+// two are built from the same frequency table.
+namespace ReferenceHuffman {
+   struct HuffNode {
+      U32 pop;
+
+      S16 index0;
+      S16 index1;
+   };
+   struct HuffLeaf {
+      U32 pop;
+
+      U8  numBits;
+      U8  symbol;
+      U32 code;
+   };
+
+   Vector<HuffNode> mHuffNodes;
+   Vector<HuffLeaf> mHuffLeaves;
+
+   struct HuffWrap {
+      HuffNode* pNode;
+      HuffLeaf* pLeaf;
+
+     public:
+      HuffWrap() : pNode(NULL), pLeaf(NULL) { }
+
+      void set(HuffLeaf* in_leaf) { pNode = NULL; pLeaf = in_leaf; }
+      void set(HuffNode* in_node) { pLeaf = NULL; pNode = in_node; }
+
+      U32 getPop() { if (pNode) return pNode->pop; else return pLeaf->pop; }
+   };
+
+   S16 determineIndex(HuffWrap& rWrap)
+   {
+      if (rWrap.pLeaf != NULL)
+         return -((rWrap.pLeaf - mHuffLeaves.address()) + 1);
+      else
+         return rWrap.pNode - mHuffNodes.address();
+   }
+
+   void generateCodes(BitStream& rBS, S32 index, S32 depth)
+   {
+      if (index < 0) {
+         HuffLeaf& rLeaf = mHuffLeaves[-(index + 1)];
+
+         memcpy(&rLeaf.code, rBS.getBuffer(), sizeof(rLeaf.code));
+         rLeaf.numBits = depth;
+      } else {
+         HuffNode& rNode = mHuffNodes[index];
+
+         S32 pos = rBS.getBitPosition();
+
+         rBS.writeFlag(false);
+         generateCodes(rBS, rNode.index0, depth + 1);
+
+         rBS.setBitPosition(pos);
+         rBS.writeFlag(true);
+         generateCodes(rBS, rNode.index1, depth + 1);
+
+         rBS.setBitPosition(pos);
+      }
+   }
+
+   void buildTables()
+   {
+      S32 i;
+
+      mHuffLeaves.setSize(256);
+      mHuffNodes.reserve(256);
+      mHuffNodes.setSize(mHuffNodes.size() + 1);
+      for (i = 0; i < 256; i++) {
+         HuffLeaf& rLeaf = mHuffLeaves[i];
+
+         rLeaf.pop    = HuffmanStringProcessor::mCharFreqs[i] + 1;
+         rLeaf.symbol = U8(i);
+
+         memset(&rLeaf.code, 0, sizeof(rLeaf.code));
+         rLeaf.numBits = 0;
+      }
+
+      S32 currWraps = 256;
+      HuffWrap* pWrap = new HuffWrap[256];
+      for (i = 0; i < 256; i++) {
+         pWrap[i].set(&mHuffLeaves[i]);
+      }
+
+      while (currWraps != 1) {
+         U32 min1 = 0xfffffffe, min2 = 0xffffffff;
+         S32 index1 = -1, index2 = -1;
+
+         for (i = 0; i < currWraps; i++) {
+            if (pWrap[i].getPop() < min1) {
+               min2   = min1;
+               index2 = index1;
+
+               min1   = pWrap[i].getPop();
+               index1 = i;
+            } else if (pWrap[i].getPop() < min2) {
+               min2   = pWrap[i].getPop();
+               index2 = i;
+            }
+         }
+
+         mHuffNodes.setSize(mHuffNodes.size() + 1);
+         HuffNode& rNode = mHuffNodes.last();
+         rNode.pop    = pWrap[index1].getPop() + pWrap[index2].getPop();
+         rNode.index0 = determineIndex(pWrap[index1]);
+         rNode.index1 = determineIndex(pWrap[index2]);
+
+         S32 mergeIndex = index1 > index2 ? index2 : index1;
+         S32 nukeIndex  = index1 > index2 ? index1 : index2;
+         pWrap[mergeIndex].set(&rNode);
+
+         if (index2 != (currWraps - 1)) {
+            pWrap[nukeIndex] = pWrap[currWraps - 1];
+         }
+         currWraps--;
+      }
+
+      mHuffNodes[0] = *(pWrap[0].pNode);
+      delete [] pWrap;
+
+      U32 code = 0;
+      BitStream bs((U8 *) &code, 4);
+
+      generateCodes(bs, 0, 0);
+   }
+
+   bool readHuffBuffer(BitStream* pStream, char* out_pBuffer)
+   {
+      if (pStream->readFlag()) {
+         U32 len = pStream->readInt(8);
+         for (U32 i = 0; i < len; i++) {
+            S32 index = 0;
+            while (true) {
+               if (index >= 0) {
+                  if (pStream->readFlag() == true) {
+                     index = mHuffNodes[index].index1;
+                  } else {
+                     index = mHuffNodes[index].index0;
+                  }
+               } else {
+                  out_pBuffer[i] = mHuffLeaves[-(index+1)].symbol;
+                  break;
+               }
+            }
+         }
+         out_pBuffer[len] = '\0';
+         return true;
+      } else {
+         U32 len = pStream->readInt(8);
+         pStream->read(len, out_pBuffer);
+         out_pBuffer[len] = '\0';
+         return true;
+      }
+   }
+
+   bool writeHuffBuffer(BitStream* pStream, const char* out_pBuffer, U32 maxLen)
+   {
+      U32 len = strlen(out_pBuffer);
+      if (len > maxLen)
+         len = maxLen;
+
+      U32 numBits = 0;
+      U32 i;
+      for (i = 0; i < len; i++)
+         numBits += mHuffLeaves[(unsigned char)out_pBuffer[i]].numBits;
+
+      if (numBits >= (len * 8)) {
+         pStream->writeFlag(false);
+         pStream->writeInt(len, 8);
+         pStream->write(len, out_pBuffer);
+      } else {
+         pStream->writeFlag(true);
+         pStream->writeInt(len, 8);
+         for (i = 0; i < len; i++) {
+            HuffLeaf& rLeaf = mHuffLeaves[((unsigned char)out_pBuffer[i])];
+            pStream->writeBits(rLeaf.numBits, &rLeaf.code);
+         }
+      }
+
+      return true;
+   }
+};
+
+typedef bool (*Writer)(BitStream*, const char*, U32);
+typedef bool (*Reader)(BitStream*, char*);
+
+enum {
+   NumStrings = 4096,
+   StreamSize = 512,
+};
+
+static const char* phrases[] = {
+   "gg", "lol", "nice shot", "who has the flag?", "cover me, going in",
+   "brb", "anyone up for a rematch?", "that was close", "incoming!",
+   "/msg admin can you kick the camper", "ok", "thanks", "haha",
+   "I'm stuck on the ramp", "left side is clear", "need backup at base",
+   "WTF was that", "shields at 12%", "ready", "8 kills in a row :)",
+};
+static const int numPhrases = sizeof(phrases) / sizeof(phrases[0]);
+
+static char strings[NumStrings][256];
+static unsigned int randState = 1;
+
+static unsigned int nextRand()
+{
+   randState = randState * 1103515245 + 12345;
+   return (randState >> 16) & 0x7fff;
+}
+
+static void makeStrings()
+{
+   for (int i = 0; i < NumStrings; i++) {
+      char* s = strings[i];
+      s[0] = '\0';
+
+      // mostly one to three phrases, with the occasional long rant
+      int count = 1 + nextRand() % 3;
+      if (nextRand() % 16 == 0)
+         count = 12;
+      for (int j = 0; j < count; j++) {
+         const char* phrase = phrases[nextRand() % numPhrases];
+         if (strlen(s) + strlen(phrase) + 2 > 255)
+            break;
+         if (j > 0)
+            strcat(s, " ");
+         strcat(s, phrase);
+      }
+
+      // rare characters take the long codes the decode table cannot resolve
+      if (nextRand() % 8 == 0 && strlen(s) < 250) {
+         size_t len = strlen(s);
+         s[len++] = char(0x80 + nextRand() % 0x80);
+         s[len++] = '~';
+         s[len] = '\0';
+      }
+   }
+}
+
+static bool encodeMatches(int& bytes)
+{
+   bytes = 0;
+   for (int i = 0; i < NumStrings; i++) {
+      U8 refBuffer[StreamSize], newBuffer[StreamSize];
+      memset(refBuffer, 0, sizeof(refBuffer));
+      memset(newBuffer, 0, sizeof(newBuffer));
+
+      BitStream refStream(refBuffer, sizeof(refBuffer));
+      BitStream newStream(newBuffer, sizeof(newBuffer));
+      ReferenceHuffman::writeHuffBuffer(&refStream, strings[i], 255);
+      HuffmanStringProcessor::writeHuffBuffer(&newStream, strings[i], 255);
+
+      U32 bits = refStream.getBitPosition();
+      if (newStream.getBitPosition() != bits
+          || memcmp(refBuffer, newBuffer, (bits + 7) >> 3) != 0) {
+         printf("bitstreams differ for \"%s\"\n", strings[i]);
+         return false;
+      }
+      bytes += (bits + 7) >> 3;
+
+      // each decoder must read the stream back to the original text
+      char refText[256], newText[256];
+      BitStream refRead(refBuffer, sizeof(refBuffer));
+      BitStream newRead(refBuffer, sizeof(refBuffer));
+      refRead.setMaxBitSizes(bits);
+      newRead.setMaxBitSizes(bits);
+      ReferenceHuffman::readHuffBuffer(&refRead, refText);
+      HuffmanStringProcessor::readHuffBuffer(&newRead, newText);
+      if (strcmp(refText, strings[i]) != 0 || strcmp(newText, strings[i]) != 0
+          || newRead.getBitPosition() != bits) {
+         printf("decode differs for \"%s\"\n", strings[i]);
+         return false;
+      }
+   }
+   return true;
+}
+
+static F64 timeEncode(Writer write, int passes)
+{
+   U8 buffer[StreamSize];
+   S64 start = Platform::getHighPrecisionTimerValue();
+   for (int pass = 0; pass < passes; pass++) {
+      for (int i = 0; i < NumStrings; i++) {
+         BitStream stream(buffer, sizeof(buffer));
+         write(&stream, strings[i], 255);
+      }
+   }
+   S64 delta = Platform::getHighPrecisionTimerValue() - start;
+   return Platform::getHighPrecisionMilliseconds(delta) / 1000.0;
+}
+
+static F64 timeDecode(Reader read, int passes)
+{
+   static U8 buffers[NumStrings][StreamSize];
+   static U32 bits[NumStrings];
+   for (int i = 0; i < NumStrings; i++) {
+      BitStream stream(buffers[i], StreamSize);
+      HuffmanStringProcessor::writeHuffBuffer(&stream, strings[i], 255);
+      bits[i] = stream.getBitPosition();
+   }
+
+   char text[256];
+   S64 start = Platform::getHighPrecisionTimerValue();
+   for (int pass = 0; pass < passes; pass++) {
+      for (int i = 0; i < NumStrings; i++) {
+         BitStream stream(buffers[i], StreamSize);
+         stream.setMaxBitSizes(bits[i]);
+         read(&stream, text);
+      }
+   }
+   S64 delta = Platform::getHighPrecisionTimerValue() - start;
+   return Platform::getHighPrecisionMilliseconds(delta) / 1000.0;
+}
+
+static void report(const char* name, F64 oldTime, F64 newTime, int passes)
+{
+   const F64 count = F64(NumStrings) * passes;
+   printf("%s:  old %.3fs (%.0f strings/s)  new %.3fs (%.0f strings/s)  %.2fx\n",
+          name, oldTime, count / oldTime, newTime, count / newTime,
+          oldTime / newTime);
+}
+
+int main(int argc, char** argv)
+{
+   const int passes = argc > 1 ? atoi(argv[1]) : 50;
+   if (passes <= 0) {
+      fprintf(stderr, "usage: %s [passes]\n", argv[0]);
+      return 1;
+   }
+
+   makeStrings();
+   ReferenceHuffman::buildTables();
+
+   // the new coder builds its tables on first use; get that out of the way
+   // before anything is timed
+   int bytes;
+   if (!encodeMatches(bytes)) {
+      printf("FAILED: coders disagree\n");
+      return 1;
+   }
+   printf("%d strings, %d bytes coded, bitstreams identical\n",
+          NumStrings, bytes);
+
+   report("encode", timeEncode(ReferenceHuffman::writeHuffBuffer, passes),
+          timeEncode(HuffmanStringProcessor::writeHuffBuffer, passes), passes);
+   report("decode", timeDecode(ReferenceHuffman::readHuffBuffer, passes),
+          timeDecode(HuffmanStringProcessor::readHuffBuffer, passes), passes);
+   return 0;
+}
@@ -52,7 +52,35 @@ namespace HuffmanStringProcessor {
    Vector<HuffNode> mHuffNodes;
    Vector<HuffLeaf> mHuffLeaves;
 
+   /// Number of bits resolved by a single lookup in mDecodeTable.
+   enum {
+      DecodeTableBits = 10,
+      DecodeTableSize = 1 << DecodeTableBits,
+      DecodeTableMask = DecodeTableSize - 1,
+   };
+
+   /// Entry in the multi-bit decode table.  If numBits is non-zero, the
+   /// lookup resolved a complete code of that length to symbol.  Otherwise
+   /// the code is longer than DecodeTableBits and the tree walk continues
+   /// from node index after consuming DecodeTableBits bits.
+   struct HuffDecodeEntry {
+      U8  numBits;
+      U8  symbol;
+      S16 index;
+   };
+
+   /// Leaf codes in host byte order, so that the encoder can pack them
+   /// with shifts instead of going through BitStream::writeBits per symbol.
+   struct HuffCode {
+      U32 code;
+      U32 numBits;
+   };
+
+   HuffDecodeEntry mDecodeTable[DecodeTableSize];
+   HuffCode mCodeTable[256];
+
    void buildTables();
+   void buildCodeTables();
 
    // We have to be a bit careful with these, since they are pointers...
    struct HuffWrap {
@@ -153,6 +181,47 @@ void HuffmanStringProcessor::buildTables()
    BitStream bs((U8 *) &code, 4);
 
    generateCodes(bs, 0, 0);
+   buildCodeTables();
+}
+
+void HuffmanStringProcessor::buildCodeTables()
+{
+   S32 i;
+   for (i = 0; i < 256; i++) {
+      // generateCodes leaves stale bits from sibling paths above numBits,
+      // so mask the code down to its real length.
+      U32 numBits = mHuffLeaves[i].numBits;
+      U32 code    = convertLEndianToHost(mHuffLeaves[i].code);
+      if (numBits < 32)
+         code &= (1 << numBits) - 1;
+      mCodeTable[i].code    = code;
+      mCodeTable[i].numBits = numBits;
+   }
+
+   // Walk the tree once for every possible DecodeTableBits-bit prefix.  Bits
+   // come out of the stream LSB first, so bit 0 of the prefix is the first
+   // branch taken from the root.
+   for (i = 0; i < DecodeTableSize; i++) {
+      HuffDecodeEntry& rEntry = mDecodeTable[i];
+      S32 index = 0;
+      U32 depth = 0;
+      while (index >= 0 && depth < DecodeTableBits) {
+         if (i & (1 << depth))
+            index = mHuffNodes[index].index1;
+         else
+            index = mHuffNodes[index].index0;
+         depth++;
+      }
+      if (index < 0) {
+         rEntry.numBits = U8(depth);
+         rEntry.symbol  = mHuffLeaves[-(index + 1)].symbol;
+         rEntry.index   = 0;
+      } else {
+         rEntry.numBits = 0;
+         rEntry.symbol  = 0;
+         rEntry.index   = S16(index);
+      }
+   }
 }
 
 void HuffmanStringProcessor::generateCodes(BitStream& rBS, S32 index, S32 depth)
@@ -199,8 +268,37 @@ bool HuffmanStringProcessor::readHuffBuffer(BitStream* pStream, char* out_pBuffe
 
    if (pStream->readFlag()) {
       U32 len = pStream->readInt(8);
+      const U8* pBuffer = pStream->getBuffer();
       for (U32 i = 0; i < len; i++) {
+         // Peek up to DecodeTableBits bits without advancing the stream.  Bits
+         // past the end of the readable data are treated as zero; if the code
+         // turns out to need them, the tree walk below flags the overrun.
+         U32 bitPos   = pStream->getBitPosition();
+         U32 maxBits  = pStream->getMaxReadBitPosition();
+         U32 avail    = bitPos < maxBits ? maxBits - bitPos : 0;
+         U32 peekBits = avail < DecodeTableBits ? avail : DecodeTableBits;
+
+         U32 peek = 0;
+         U32 bytePos = bitPos >> 3;
+         U32 shift   = bitPos & 0x7;
+         U32 numBytes = (shift + peekBits + 7) >> 3;
+         for (U32 j = 0; j < numBytes; j++)
+            peek |= U32(pBuffer[bytePos + j]) << (j << 3);
+         peek = (peek >> shift) & ((1 << peekBits) - 1);
+
+         const HuffDecodeEntry& rEntry = mDecodeTable[peek & DecodeTableMask];
+         if (rEntry.numBits != 0 && rEntry.numBits <= peekBits) {
+            pStream->setBitPosition(bitPos + rEntry.numBits);
+            out_pBuffer[i] = rEntry.symbol;
+            continue;
+         }
+
+         // Long code (or truncated stream); finish with the bit-at-a-time walk.
          S32 index = 0;
+         if (rEntry.numBits == 0 && peekBits == DecodeTableBits) {
+            pStream->setBitPosition(bitPos + DecodeTableBits);
+            index = rEntry.index;
+         }
          while (true) {
             if (index >= 0) {
                if (pStream->readFlag() == true) {
@@ -253,10 +351,28 @@ bool HuffmanStringProcessor::writeHuffBuffer(BitStream* pStream, const char* out
    } else {
       pStream->writeFlag(true);
       pStream->writeInt(len, 8);
+
+      // Pack the codes into a local buffer and hand the whole run to the
+      // stream in one writeBits call.  numBits < len * 8 <= 2040, so the
+      // packed string always fits in 256 bytes.
+      U8  packed[256];
+      U32 packedBytes = 0;
+      U64 accum = 0;
+      U32 accumBits = 0;
       for (i = 0; i < len; i++) {
-         HuffLeaf& rLeaf = mHuffLeaves[((unsigned char)out_pBuffer[i])];
-         pStream->writeBits(rLeaf.numBits, &rLeaf.code);
+         const HuffCode& rCode = mCodeTable[(unsigned char)out_pBuffer[i]];
+         accum |= U64(rCode.code) << accumBits;
+         accumBits += rCode.numBits;
+         while (accumBits >= 8) {
+            packed[packedBytes++] = U8(accum);
+            accum >>= 8;
+            accumBits -= 8;
+         }
       }
+      if (accumBits)
+         packed[packedBytes] = U8(accum);
+
+      pStream->writeBits(numBits, packed);
    }
 
    return true;
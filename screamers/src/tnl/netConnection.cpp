@@ -57,6 +57,10 @@ NetConnection *NetConnectionRep::create(const char *name)
    return NULL;
 }
 
+static const F32 MinCongestionScale = 0.25f;      ///< Lowest fraction of the negotiated bandwidth the rate is cut back to.
+static const F32 CongestionDecreaseScale = 0.75f; ///< Multiplier applied to the rate on a dropped packet.
+static const F32 CongestionIncreaseStep = 0.02f;  ///< Amount added to the rate scale for each acknowledged packet.
+
 static const char *packetTypeNames[] = 
 {
    "DataPacket",
@@ -90,8 +94,18 @@ NetConnection::NetConnection()
 
    mRemoteRate = mLocalRate;
    mLocalRateChanged = true;
+
+   mCongestionControl = false;
+   mCongestionScale = 1;
+   mMinRoundTripTime = 0;
+   mWindowMinRoundTripTime = 0;
+   mMinRoundTripWindowStart = 0;
+   mLastCongestionTime = 0;
    computeNegotiatedRate();
 
+   for(U32 i = 0; i < TrafficClassCount; i++)
+      mTrafficWeight[i] = DefaultTrafficWeight;
+
    mPingSendCount = 0;
    mLastPingSendTime = 0;
 
@@ -458,6 +472,7 @@ bool NetConnection::readPacketHeader(BitStream *pstream)
          mRoundTripTime = mRoundTripTime * 0.9f + roundTripDelta * 0.1f;
          if(mRoundTripTime < 0)
             mRoundTripTime = 0;
+         updateMinRoundTripTime(roundTripDelta);
       }      
       if(packetTransmitSuccess)
          mLastRecvAckAck = mLastSeqRecvdAtSend[notifyIndex & PacketWindowMask];
@@ -527,6 +542,8 @@ void NetConnection::computeNegotiatedRate()
    mCurrentPacketSendPeriod = getMax(mLocalRate.minPacketSendPeriod, mRemoteRate.minPacketRecvPeriod);
 
    U32 maxBandwidth = getMin(mLocalRate.maxSendBandwidth, mRemoteRate.maxRecvBandwidth);
+   if(mCongestionControl)
+      maxBandwidth = U32(maxBandwidth * mCongestionScale);
    mCurrentPacketSendSize = U32(maxBandwidth * mCurrentPacketSendPeriod * 0.001f);
 
    // make sure we don't try to overwrite the maximum packet size
@@ -552,6 +569,106 @@ void NetConnection::setFixedRateParameters(U32 minPacketSendPeriod, U32 minPacke
    computeNegotiatedRate();
 }
 
+void NetConnection::setCongestionControl(bool enabled)
+{
+   mCongestionControl = enabled;
+   mCongestionScale = 1;
+   computeNegotiatedRate();
+}
+
+void NetConnection::setConnectionState(NetConnectionState state)
+{
+   if(state == Connected && mConnectionState != Connected)
+   {
+      mMinRoundTripTime = 0;
+      mWindowMinRoundTripTime = 0;
+      mMinRoundTripWindowStart = mInterface.isValid() ? mInterface->getCurrentTime() : 0;
+   }
+   mConnectionState = state;
+}
+
+void NetConnection::updateMinRoundTripTime(S32 roundTripDelta)
+{
+   // keep the minimum over a sliding window so the baseline can rise again
+   // when the route gets slower; a single lucky sample would otherwise hold
+   // the rate down for the life of the connection.
+   U32 curTime = mInterface->getCurrentTime();
+   if(curTime - mMinRoundTripWindowStart >= MinRoundTripWindow)
+   {
+      mMinRoundTripTime = mWindowMinRoundTripTime;
+      mWindowMinRoundTripTime = 0;
+      mMinRoundTripWindowStart = curTime;
+   }
+   if(roundTripDelta <= 0)
+      return;
+   if(!mWindowMinRoundTripTime || roundTripDelta < mWindowMinRoundTripTime)
+      mWindowMinRoundTripTime = F32(roundTripDelta);
+   if(!mMinRoundTripTime || roundTripDelta < mMinRoundTripTime)
+      mMinRoundTripTime = F32(roundTripDelta);
+}
+
+void NetConnection::updateCongestion(bool recvd)
+{
+   if(!mCongestionControl || isAdaptive())
+      return;
+
+   F32 scale = mCongestionScale;
+   if(recvd)
+   {
+      // only grow back toward the negotiated rate while latency stays near
+      // its baseline; a growing round trip means queues are filling up.
+      if(mRoundTripTime <= mMinRoundTripTime * 2 + CongestionDelaySlack)
+         scale += CongestionIncreaseStep;
+   }
+   else
+   {
+      // back off at most once per round trip, so a burst of losses from a
+      // single congestion event only cuts the rate once.
+      U32 curTime = mInterface->getCurrentTime();
+      U32 backoffPeriod = getMax(U32(mRoundTripTime), mCurrentPacketSendPeriod);
+      if(curTime - mLastCongestionTime >= backoffPeriod)
+      {
+         mLastCongestionTime = curTime;
+         scale *= CongestionDecreaseScale;
+      }
+   }
+   if(scale > 1)
+      scale = 1;
+   if(scale < MinCongestionScale)
+      scale = MinCongestionScale;
+
+   if(scale != mCongestionScale)
+   {
+      mCongestionScale = scale;
+      computeNegotiatedRate();
+   }
+}
+
+void NetConnection::setTrafficWeight(TrafficClass trafficClass, U32 weight)
+{
+   TNLAssert(trafficClass < TrafficClassCount, "Invalid traffic class.");
+   mTrafficWeight[trafficClass] = weight;
+}
+
+U32 NetConnection::getTrafficLimit(BitStream *bstream, TrafficClass trafficClass)
+{
+   // the given class competes only with the classes written after it.
+   U32 totalWeight = mTrafficWeight[trafficClass];
+   for(U32 i = trafficClass + 1; i < TrafficClassCount; i++)
+      if(isTrafficPending(TrafficClass(i)))
+         totalWeight += mTrafficWeight[i];
+
+   if(totalWeight == mTrafficWeight[trafficClass])
+      return 0xFFFFFFFF;
+
+   U32 position = bstream->getBitPosition();
+   U32 packetBits = bstream->getBufferSize() << 3;
+   if(position >= packetBits)
+      return position;
+   U32 share = U32((U64(packetBits - position) * mTrafficWeight[trafficClass]) / totalWeight);
+   return position + share;
+}
+
 //--------------------------------------------------------------------
 
 void NetConnection::sendPingPacket()
@@ -585,6 +702,8 @@ void NetConnection::handleNotify(U32 sequence, bool recvd)
    if(note->rateChanged && !recvd)
       mLocalRateChanged = true;
 
+   updateCongestion(recvd);
+
    if(recvd)
    {
       mHighestAckedSendTime = note->sendTime;
@@ -51,9 +51,6 @@ NetInterface::NetInterface(const Address &bindAddress) : mSocket(bindAddress)
 
    Random::read(mRandomHashData, sizeof(mRandomHashData));
 
-   mConnectionHashTable.setSize(129);
-   for(S32 i = 0; i < mConnectionHashTable.size(); i++)
-      mConnectionHashTable[i] = NULL;
    mSendPacketList = NULL;
    mCurrentTime = Platform::getRealMilliseconds();
 }
@@ -152,42 +149,44 @@ void NetInterface::addPendingConnection(NetConnection *connection)
 
    // hang on to the connection and add it to the pending connection list
    connection->incRef();
+   mPendingConnectionTable.insert(connection, mPendingConnections.size());
    mPendingConnections.push_back(connection);
 }
 
 void NetInterface::removePendingConnection(NetConnection *connection)
 {
-   // search the pending connection list for the specified connection
-   // and remove it.
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(mPendingConnections[i] == connection)
-      {
-         connection->decRef();
-         mPendingConnections.erase(i);
-         return;
-      }
+   // the address index knows where the connection is in the pending
+   // list; move the last pending connection into its place.
+   S32 index;
+   if(!mPendingConnectionTable.remove(connection, &index))
+      return;
+
+   mPendingConnections.erase_fast(index);
+   if(index < mPendingConnections.size())
+      mPendingConnectionTable.setIndex(mPendingConnections[index], index);
+   connection->decRef();
 }
 
 NetConnection *NetInterface::findPendingConnection(const Address &address)
 {
-   // Loop through all the pending connections and compare the NetAddresses
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(address == mPendingConnections[i]->getNetAddress())
-         return mPendingConnections[i];
-   return NULL;
+   return mPendingConnectionTable.find(address);
 }
 
 void NetInterface::findAndRemovePendingConnection(const Address &address)
 {
-   // Search through the list by Address and remove any connection
-   // that matches.
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(address == mPendingConnections[i]->getNetAddress())
-      {
-         mPendingConnections[i]->decRef();
-         mPendingConnections.erase(i);
-         return;
-      }
+   // Look up the connection by Address and remove it if there is one.
+   NetConnection *conn = mPendingConnectionTable.find(address);
+   if(conn)
+      removePendingConnection(conn);
+}
+
+void NetInterface::setPendingConnectionAddress(NetConnection *conn, const Address &address)
+{
+   S32 index;
+   bool indexed = mPendingConnectionTable.remove(conn, &index);
+   conn->setNetAddress(address);
+   if(indexed)
+      mPendingConnectionTable.insert(conn, index);
 }
 
 //-----------------------------------------------------------------------------
@@ -196,105 +195,29 @@ void NetInterface::findAndRemovePendingConnection(const Address &address)
 
 NetConnection *NetInterface::findConnection(const Address &addr)
 {
-   // The connection hash table is a single vector, with hash collisions
-   // resolved to the next open space in the table.
-
-   // Compute the hash index based on the network address
-   U32 hashIndex = addr.hash() % mConnectionHashTable.size();
-
-   // Search through the table for an address that matches the source
-   // address.  If the connection pointer is NULL, we've found an
-   // empty space and a connection with that address is not in the table
-   while(mConnectionHashTable[hashIndex] != NULL)
-   {
-      if(addr == mConnectionHashTable[hashIndex]->getNetAddress())
-         return mConnectionHashTable[hashIndex];
-      hashIndex++;
-      if(hashIndex >= (U32) mConnectionHashTable.size())
-         hashIndex = 0;
-   }
-   return NULL;
+   return mConnectionTable.find(addr);
 }
 
 void NetInterface::removeConnection(NetConnection *conn)
 {
-   for(S32 i = 0; i < mConnectionList.size(); i++)
-   {
-      if(mConnectionList[i] == conn)
-      {
-         mConnectionList.erase_fast(i);
-         break;
-      }
-   }
-   U32 index = conn->getNetAddress().hash() % mConnectionHashTable.size();
-   U32 startIndex = index;
-
-   while(mConnectionHashTable[index] != conn)
-   {
-      index++;
-      if(index >= (U32) mConnectionHashTable.size())
-         index = 0;
-      TNLAssert(index != startIndex, "Attempting to remove a connection that is not in the table.") // not in the table
-      if(index == startIndex)
-         return;
-   }
-   mConnectionHashTable[index] = NULL;
+   // same as the pending list, the address index has the list position.
+   S32 index;
+   bool removed = mConnectionTable.remove(conn, &index);
+   TNLAssert(removed, "Attempting to remove a connection that is not in the table.");
+   if(!removed)
+      return;
 
-   // rehash all subsequent entries until we find a NULL entry:
-   for(;;)
-   {
-      index++;
-      if(index >= (U32) mConnectionHashTable.size())
-         index = 0;
-      if(!mConnectionHashTable[index])
-         break;
-      NetConnection *rehashConn = mConnectionHashTable[index];
-      mConnectionHashTable[index] = NULL;
-      U32 realIndex = rehashConn->getNetAddress().hash() % mConnectionHashTable.size();
-      while(mConnectionHashTable[realIndex] != NULL)
-      {
-         realIndex++;
-         if(realIndex >= (U32) mConnectionHashTable.size())
-            realIndex = 0;
-      }
-      mConnectionHashTable[realIndex] = rehashConn;
-   }
+   mConnectionList.erase_fast(index);
+   if(index < mConnectionList.size())
+      mConnectionTable.setIndex(mConnectionList[index], index);
    conn->decRef();
 }
 
 void NetInterface::addConnection(NetConnection *conn)
 {
    conn->incRef();
+   mConnectionTable.insert(conn, mConnectionList.size());
    mConnectionList.push_back(conn);
-   S32 numConnections = mConnectionList.size();
-   if(numConnections > mConnectionHashTable.size() / 2)
-   {
-      mConnectionHashTable.setSize(numConnections * 4 - 1);
-      for(S32 i = 0; i < mConnectionHashTable.size(); i++)
-         mConnectionHashTable[i] = NULL;
-      for(S32 i = 0; i < numConnections; i++)
-      {
-         U32 index = mConnectionList[i]->getNetAddress().hash() % mConnectionHashTable.size();
-         while(mConnectionHashTable[index] != NULL)
-         {
-            index++;
-            if(index >= (U32) mConnectionHashTable.size())
-               index = 0;
-         }
-         mConnectionHashTable[index] = mConnectionList[i];
-      }
-   }
-   else
-   {
-      U32 index = mConnectionList[numConnections - 1]->getNetAddress().hash() % mConnectionHashTable.size();
-      while(mConnectionHashTable[index] != NULL)
-      {
-         index++;
-         if(index >= (U32) mConnectionHashTable.size())
-            index = 0;
-      }
-      mConnectionHashTable[index] = mConnectionList[numConnections - 1];
-   }
 }
 
 //-----------------------------------------------------------------------------
@@ -376,6 +299,7 @@ void NetInterface::processConnections()
             pending->setConnectionState(NetConnection::ConnectTimedOut);
             pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
             removePendingConnection(pending);
+            continue;
          }
          i++;
       }
@@ -1080,7 +1004,7 @@ void NetInterface::handlePunch(const Address &theAddress, BitStream *stream)
       Random::read(theParams.mSymmetricKey, SymmetricCipher::KeySize);
       theParams.mUsingCrypto = true;
    }
-   conn->setNetAddress(theAddress);
+   setPendingConnectionAddress(conn, theAddress);
    TNLLogMessageV(LogNetInterface, ("Punch from %s matched nonces - connecting...", theAddress.toString()));
 
    conn->setConnectionState(NetConnection::AwaitingConnectResponse);
@@ -1213,7 +1137,7 @@ void NetInterface::handleArrangedConnectRequest(const Address &theAddress, BitSt
    if(oldConnection)
       disconnect(oldConnection, NetConnection::ReasonSelfDisconnect, "");
 
-   conn->setNetAddress(theAddress);
+   setPendingConnectionAddress(conn, theAddress);
    conn->setInitialRecvSequence(connectSequence);
    if(theParams.mUsingCrypto)
       conn->setSymmetricCipher(new SymmetricCipher(theParams.mSymmetricKey, theParams.mInitVector));
@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------------
+//
+//   Torque Network Library
+//   Copyright (C) 2004 GarageGames.com, Inc.
+//   For more information see http://www.opentnl.org
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation; either version 2 of the License, or
+//   (at your option) any later version.
+//
+//   For use in products that are not compatible with the terms of the GNU 
+//   General Public License, alternative licensing options are available 
+//   from GarageGames.com.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program; if not, write to the Free Software
+//   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//------------------------------------------------------------------------------------
+
+#ifndef _TNL_CONNECTIONTABLE_H_
+#define _TNL_CONNECTIONTABLE_H_
+
+#ifndef _TNL_VECTOR_H_
+#include "tnlVector.h"
+#endif
+
+#ifndef _TNL_UDP_H_
+#include "tnlUDP.h"
+#endif
+
+namespace TNL {
+
+class NetConnection;
+
+/// ConnectionTable indexes NetConnections by their network address.
+///
+/// The table is a flat open addressing hash table with linear probing.
+/// Removed entries are marked with a tombstone instead of rehashing the rest
+/// of the probe chain, and when the table passes its load factor the
+/// entries are moved into a new table a few slots at a time by subsequent
+/// operations, so no single insert pays for rehashing every connection.
+///
+/// Only connection pointers are stored; the key is the connection's own
+/// address.  If a connection's address changes while it is in the table,
+/// it must be removed and reinserted.  Each entry also carries an index for
+/// the caller, such as where the connection sits in a list, so the caller
+/// can find and swap remove it without searching the list.
+class ConnectionTable
+{
+   struct Entry
+   {
+      NetConnection *conn; ///< The connection, NULL for an empty slot or Tombstone for a removed one.
+      U32 hash;            ///< Hash of the connection's address, so most probes don't touch the connection.
+      S32 index;           ///< The caller's index for the connection.
+   };
+
+   enum {
+      InitialSize = 64,    ///< Initial number of slots.  Table sizes are always powers of 2.
+      MaxLoadPercent = 50, ///< Resize once live entries and tombstones fill this much of the table.
+      MigrateStep = 8,     ///< Number of old table slots moved into the new table per operation.
+   };
+
+   Vector<Entry> mTable;    ///< The current table.
+   Vector<Entry> mOldTable; ///< Table being drained into mTable during an incremental resize.
+   U32 mMigrateIndex;       ///< Next slot in mOldTable to move.
+   U32 mOldCount;           ///< Number of live entries left in mOldTable.
+   U32 mCount;              ///< Number of live entries in mTable.
+   U32 mTombstones;         ///< Number of tombstones in mTable.
+   U32 mHashSeed;           ///< Random seed mixed into each address hash, so remote hosts can't pick colliding addresses.
+
+   /// Computes the table hash for an address.
+   U32 hashAddress(const Address &address) const;
+
+   /// Returns the slot in table holding an entry for address, or -1.
+   S32 findSlot(Vector<Entry> &table, const Address &address, U32 hash);
+
+   /// Returns the slot in table holding conn, or -1.
+   S32 findSlot(Vector<Entry> &table, NetConnection *conn, U32 hash);
+
+   /// Places an entry in the first free or tombstone slot of its probe chain in mTable.
+   void place(NetConnection *conn, U32 hash, S32 index);
+
+   /// Moves up to count slots of mOldTable into mTable.
+   void migrate(U32 count);
+
+   /// Starts an incremental resize if mTable is past its load factor.
+   void checkLoad();
+public:
+   ConnectionTable();
+
+   /// Returns the connection with the given address, or NULL if there is none.
+   NetConnection *find(const Address &address);
+
+   /// Adds a connection to the table, keyed on its current address, along
+   /// with the caller's index for it.
+   void insert(NetConnection *conn, S32 index = -1);
+
+   /// Removes a connection from the table.  Returns false if it was not found,
+   /// otherwise sets index, if given, to the caller's index for it.
+   bool remove(NetConnection *conn, S32 *index = NULL);
+
+   /// Changes the caller's index for a connection.  Returns false if it is
+   /// not in the table.
+   bool setIndex(NetConnection *conn, S32 index);
+
+   /// Removes all entries from the table.
+   void clear();
+
+   /// Returns the number of connections in the table.
+   U32 size() const { return mCount + mOldCount; }
+};
+
+};
+
+#endif
@@ -98,6 +98,9 @@ protected:
    /// Returns true if there are events pending that should be sent across the wire
    virtual bool isDataToTransmit();
 
+   /// Reports pending events for the TrafficEvents class
+   bool isTrafficPending(TrafficClass trafficClass);
+
    /// Dispatches an event
    void processEvent(NetEvent *theEvent);
 
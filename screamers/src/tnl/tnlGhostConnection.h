@@ -122,6 +122,9 @@ protected:
    /// Override to check if there is data pending on this GhostConnection.
    bool isDataToTransmit();
 
+   /// Reports pending ghost updates for the TrafficGhosts class.
+   bool isTrafficPending(TrafficClass trafficClass);
+
 //----------------------------------------------------------------
 // ghost manager functions/code:
 //----------------------------------------------------------------
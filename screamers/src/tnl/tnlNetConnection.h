@@ -281,6 +281,36 @@ protected:
    /// override this so you allocate a subclass of PacketNotify with extra fields.
    virtual PacketNotify *allocNotify() { return new PacketNotify; }
 
+public:
+   /// Classes of traffic that share the space in each data packet.
+   ///
+   /// Classes are written into the packet in this order.  When more than one
+   /// class has data waiting, each is limited to its weighted share of the
+   /// packet; space a class does not use is left to the classes after it.
+   enum TrafficClass {
+      TrafficEvents, ///< NetEvents (RPCs), guaranteed and unguaranteed.
+      TrafficGhosts, ///< Ghost (NetObject) updates.
+      TrafficClassCount,
+   };
+
+   /// Sets the relative weight of a traffic class when dividing up each packet.
+   void setTrafficWeight(TrafficClass trafficClass, U32 weight);
+
+   /// Returns the relative weight of a traffic class.
+   U32 getTrafficWeight(TrafficClass trafficClass) { return mTrafficWeight[trafficClass]; }
+
+protected:
+   /// Returns true if the given traffic class has data waiting to go into the current packet.
+   ///
+   /// Subclasses that write a traffic class override this for that class and
+   /// call the Parent:: function for the others.
+   virtual bool isTrafficPending(TrafficClass trafficClass) { return false; }
+
+   /// Returns the bit position in bstream past which the given traffic class
+   /// should stop writing, based on its weight and the classes still waiting
+   /// to write after it.
+   U32 getTrafficLimit(BitStream *bstream, TrafficClass trafficClass);
+
 public:
    /// Returns the next send sequence that will be sent by this side.
    U32 getNextSendSequence() { return mLastSendSeq + 1; }
@@ -384,6 +414,13 @@ private:
       DefaultFixedSendPeriod = 96,    ///< The default delay between each packet send - approx 10 packets per second.
       MaxFixedBandwidth      = 65535, ///< The maximum bandwidth for a connection using the fixed rate transmission method.
       MaxFixedSendPeriod     = 2047,  ///< The maximum period between packets in the fixed rate send transmission method.
+      DefaultTrafficWeight   = 1,     ///< The default share of each packet for each traffic class.
+   };
+
+   /// Constants controlling the congestion response of fixed rate connections.
+   enum CongestionConstants {
+      CongestionDelaySlack = 100, ///< Milliseconds of round trip time above the baseline that are tolerated before the rate stops growing.
+      MinRoundTripWindow = 10000, ///< Milliseconds covered by each window of the minimum round trip time.
    };
 
    /// Rate management structure used specify the rate at which packets are sent and the maximum size of each packet.
@@ -402,6 +439,17 @@ private:
    U32 mCurrentPacketSendSize;   ///< Current size of each packet sent to the remote host.
    U32 mCurrentPacketSendPeriod; ///< Millisecond delay between sent packets.
 
+   bool mCongestionControl;      ///< Set to true if the fixed rate send size is scaled back under packet loss and rising latency.
+   F32 mCongestionScale;         ///< Fraction of the negotiated bandwidth currently used when congestion control is on.
+   F32 mMinRoundTripTime;        ///< Lowest round trip time over the current and previous window, used as the uncongested baseline.
+   F32 mWindowMinRoundTripTime;  ///< Lowest round trip time seen in the current window.
+   U32 mMinRoundTripWindowStart; ///< Time the current minimum round trip time window started.
+   void updateMinRoundTripTime(S32 roundTripDelta); ///< Folds a round trip sample into the windowed minimum.
+   U32 mLastCongestionTime;      ///< Last time the send rate was cut back because of a dropped packet.
+   void updateCongestion(bool recvd); ///< Adjusts mCongestionScale in response to a packet notify.
+
+   U32 mTrafficWeight[TrafficClassCount]; ///< Relative share of each packet given to each traffic class.
+
    Address mNetAddress;       ///< The network address of the host this instance is connected to.
 
    // timeout management stuff:
@@ -525,7 +573,10 @@ public:
    NetConnectionState mConnectionState; ///< Current state of this NetConnection.
 
    /// Sets the current connection state of this NetConnection.
-   void setConnectionState(NetConnectionState state) { mConnectionState = state; }
+   ///
+   /// Becoming connected discards the round trip baseline from any earlier
+   /// connection, since the new path may be slower.
+   void setConnectionState(NetConnectionState state);
 
    /// Gets the current connection state of this NetConnection.
    NetConnectionState getConnectionState() { return mConnectionState; }
@@ -559,6 +610,17 @@ public:
    /// sets the fixed rate send and receive data sizes, and sets the connection to not behave as an adaptive rate connection
    void setFixedRateParameters( U32 minPacketSendPeriod, U32 minPacketRecvPeriod, U32 maxSendBandwidth, U32 maxRecvBandwidth );
 
+   /// Enables or disables congestion control on a fixed rate connection.
+   ///
+   /// When enabled, the packet size is cut back multiplicatively (at most once
+   /// per round trip) when packets are dropped, and grown back additively
+   /// toward the negotiated rate as packets are acknowledged, as long as the
+   /// round trip time stays near its observed minimum.
+   void setCongestionControl(bool enabled);
+
+   /// Returns the fraction of the negotiated bandwidth currently in use.
+   F32 getCongestionScale() { return mCongestionScale; }
+
    /// Query the adaptive status of the connection.
    bool isAdaptive()    { return mTypeFlags.test(ConnectionAdaptive | ConnectionRemoteAdaptive); }
 
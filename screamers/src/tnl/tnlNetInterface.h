@@ -41,6 +41,10 @@
 #include "tnlNetObject.h"
 #endif
 
+#ifndef _TNL_CONNECTIONTABLE_H_
+#include "tnlConnectionTable.h"
+#endif
+
 #ifndef _TNL_NETCONNECTION_H_
 #include "tnlNetConnection.h"
 #endif
@@ -170,10 +174,11 @@ public:
 
 protected:
    Vector<NetConnection *> mConnectionList;      ///< List of all the connections that are in a connected state on this NetInterface.
-   Vector<NetConnection *> mConnectionHashTable; ///< A resizable hash table for all connected connections.  This is a flat hash table (no buckets).
+   ConnectionTable mConnectionTable;             ///< Address index of all connected connections, with their positions in mConnectionList.
 
    Vector<NetConnection *> mPendingConnections; ///< List of connections that are in the startup state, where the remote host has not fully
                                                 ///  validated the connection.
+   ConnectionTable mPendingConnectionTable;     ///< Address index of the pending connections, with their positions in mPendingConnections.
 
    RefPtr<AsymmetricKey> mPrivateKey;  ///< The private key used by this NetInterface for secure key exchange.
    RefPtr<Certificate> mCertificate;   ///< A certificate, signed by some Certificate Authority, to authenticate this host.
@@ -239,6 +244,9 @@ protected:
    /// Finds a connection by address from the pending list and removes it.
    void findAndRemovePendingConnection(const Address &address);
 
+   /// Changes the address of a pending connection, keeping the pending connection index up to date.
+   void setPendingConnectionAddress(NetConnection *conn, const Address &address);
+
    /// Adds a connection to the internal connection list.
    void addConnection(NetConnection *connection);
 